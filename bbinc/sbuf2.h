@@ -68,6 +68,11 @@ typedef int (*sbuf2writefn)(SBUF2 *sb, const char *buf, int nbytes);
 int SBUF2_FUNC(sbuf2fileno)(SBUF2 *sb);
 #define sbuf2fileno SBUF2_FUNC(sbuf2fileno)
 
+/* Number of bytes already read from the fd (or SSL) but not yet consumed.
+   A non-zero return means the next read will not block. */
+int SBUF2_FUNC(sbuf2pending)(SBUF2 *sb);
+#define sbuf2pending SBUF2_FUNC(sbuf2pending)
+
 /* set flags on an SBUF2 after opening */
 void SBUF2_FUNC(sbuf2setflags)(SBUF2 *sb, int flags);
 #define sbuf2setflags SBUF2_FUNC(sbuf2setflags)
@@ -39,6 +39,10 @@ struct berkdb_thread_stats {
     unsigned n_memp_pgs;
     uint64_t memp_pg_time_us;
 
+    unsigned n_pf_pages;
+    unsigned n_pf_hits;
+    unsigned n_pf_misses;
+
     unsigned n_shallocs;
     uint64_t shalloc_time_us;
 
@@ -48,53 +48,19 @@
 
 extern int gbl_debug_omit_dta_write;
 
-/* if dta is not null, it will be tailed after the genid in btree data part */
-static int bdb_prim_addkey_int(bdb_state_type *bdb_state, tran_type *tran,
-                               void *ixdta, int ixnum, int rrn,
-                               unsigned long long genid, void *dta, int dtalen,
-                               int isnull, int *bdberr)
+/* Form the data payload of an index entry: the genid, followed by the
+ * datacopy tail if there is one.  Short payloads are built in stackbuf,
+ * longer ones are malloced and returned in *mallocd for the caller to free. */
+static int form_ix_payload(bdb_state_type *bdb_state, int ixnum,
+                           unsigned long long genid, void *dta, int dtalen,
+                           unsigned int *stackbuf, void **mallocd,
+                           DBT *dbt_data, int *bdberr)
 {
-    DBT dbt_key, dbt_data;
-    int rc;
     unsigned int *keydata;
     int keydata_len;
     unsigned int *iptr;
-    void *mallocedkeydata;
-    unsigned int stackkeydata[3];
-    void *pKeyMaxBuf = 0;
-
-    *bdberr = BDBERR_NOERROR;
 
-    if (bdb_write_preamble(bdb_state, bdberr))
-        return -1;
-
-    /* if we require the dta, but they didnt give us the dta, fail */
-    if ((bdb_state->ixdta[ixnum]) && ((dta == NULL) || (dtalen == 0))) {
-        *bdberr = BDBERR_BADARGS;
-        return 1;
-    }
-
-    /* if we were given a dta without a genid, fail */
-    if ((dta) && (!genid)) {
-        *bdberr = BDBERR_BADARGS;
-        return 1;
-    }
-
-    if ((isnull) && (!bdb_state->ixnulls[ixnum])) {
-        *bdberr = BDBERR_BADARGS;
-        return 1;
-    }
-
-    if (bdb_state->ixlen[ixnum] > bdb_state->keymaxsz) {
-        logmsg(LOGMSG_FATAL, "calling abort 3\n");
-        abort();
-    }
-
-    /* JJM 2018-05-02: This value is not actually used by this function. */
-    /* rrn = 2; */
-
-    /* for fixed format (rrn+genid, or genid) we dont malloc */
-    mallocedkeydata = NULL;
+    *mallocd = NULL;
 
     /* establish the size of the data payload on the index */
     keydata_len = sizeof(unsigned long long);
@@ -109,14 +75,14 @@ static int bdb_prim_addkey_int(bdb_state_type *bdb_state, tran_type *tran,
 
     /* get storage for the payload, mallocing if needed */
     if (dta) {
-        mallocedkeydata = malloc(keydata_len);
-        if (!mallocedkeydata) {
+        *mallocd = malloc(keydata_len);
+        if (!*mallocd) {
             *bdberr = BDBERR_MALLOC;
             return -1;
         }
-        keydata = mallocedkeydata;
+        keydata = *mallocd;
     } else
-        keydata = stackkeydata;
+        keydata = stackbuf;
 
     /* form the payload */
     iptr = (unsigned int *)keydata;
@@ -147,7 +113,60 @@ static int bdb_prim_addkey_int(bdb_state_type *bdb_state, tran_type *tran,
         }
     }
 
-    /* keydata and keydata_len are set now */
+    memset(dbt_data, 0, sizeof(*dbt_data));
+    dbt_data->data = keydata;
+    dbt_data->size = keydata_len;
+    return 0;
+}
+
+/* if dta is not null, it will be tailed after the genid in btree data part */
+static int bdb_prim_addkey_int(bdb_state_type *bdb_state, tran_type *tran,
+                               void *ixdta, int ixnum, int rrn,
+                               unsigned long long genid, void *dta, int dtalen,
+                               int isnull, int *bdberr)
+{
+    DBT dbt_key, dbt_data;
+    int rc;
+    void *mallocedkeydata;
+    unsigned int stackkeydata[3];
+    void *pKeyMaxBuf = 0;
+
+    *bdberr = BDBERR_NOERROR;
+
+    if (bdb_write_preamble(bdb_state, bdberr))
+        return -1;
+
+    /* if we require the dta, but they didnt give us the dta, fail */
+    if ((bdb_state->ixdta[ixnum]) && ((dta == NULL) || (dtalen == 0))) {
+        *bdberr = BDBERR_BADARGS;
+        return 1;
+    }
+
+    /* if we were given a dta without a genid, fail */
+    if ((dta) && (!genid)) {
+        *bdberr = BDBERR_BADARGS;
+        return 1;
+    }
+
+    if ((isnull) && (!bdb_state->ixnulls[ixnum])) {
+        *bdberr = BDBERR_BADARGS;
+        return 1;
+    }
+
+    if (bdb_state->ixlen[ixnum] > bdb_state->keymaxsz) {
+        logmsg(LOGMSG_FATAL, "calling abort 3\n");
+        abort();
+    }
+
+    /* JJM 2018-05-02: This value is not actually used by this function. */
+    /* rrn = 2; */
+
+    /* for fixed format (rrn+genid, or genid) we dont malloc */
+    if (form_ix_payload(bdb_state, ixnum, genid, dta, dtalen, stackkeydata,
+                        &mallocedkeydata, &dbt_data, bdberr))
+        return -1;
+
+    /* dbt_data is set now */
 
     /*
       now add to the ix.
@@ -165,11 +184,6 @@ static int bdb_prim_addkey_int(bdb_state_type *bdb_state, tran_type *tran,
      * only done when supporting multiple NULL values in a UNIQUE index. */
     bdb_maybe_use_genid_for_key(bdb_state, &dbt_key, ixdta, ixnum, genid, isnull, &pKeyMaxBuf);
 
-    /* set up the dbt_data */
-    memset(&dbt_data, 0, sizeof(dbt_data));
-    dbt_data.data = keydata;
-    dbt_data.size = keydata_len;
-
     /* write to the index */
     rc = ll_key_add(bdb_state, genid, tran, ixnum, &dbt_key, &dbt_data);
 
@@ -210,6 +224,317 @@ int bdb_prim_addkey_genid(bdb_state_type *bdb_state, tran_type *tran,
     return rc;
 }
 
+/*
+  Bulk index builds.
+
+  During a schema change that rebuilds an index while the table is readonly,
+  each convert thread hands its keys to a bdb_bulk_ix collector instead of
+  writing them to the new btree.  A collector is a sorted temp table keyed by
+  the btree key with the genid appended, so that a retried record simply
+  overwrites its own keys and duplicate btree keys stay side by side.  Once
+  every thread is done, bdb_bulk_ix_load_* merges the collectors in key order
+  and builds the btree bottom-up, which writes each page once instead of
+  splitting its way there.
+ */
+
+struct __bam_bulk;
+extern u_int32_t __bam_bulk_maxkey(DB *);
+extern int __bam_bulk_begin(DB *, struct __bam_bulk **);
+extern int __bam_bulk_put(struct __bam_bulk *, DB_TXN *, DBT *, DBT *);
+extern int __bam_bulk_finish(struct __bam_bulk *, DB_TXN *);
+extern void __bam_bulk_free(struct __bam_bulk *);
+
+struct bdb_bulk_ix {
+    bdb_state_type *bdb_state;
+    int ixnum;
+    int keylen; /* btree key length, fixed for an index */
+    struct temp_table *tbl;
+    struct temp_cursor *cur;
+    long long nkeys;
+};
+
+struct bdb_bulk_ix_load {
+    bdb_state_type *bdb_state;
+    int ixnum;
+    int keylen;
+    int nparts;
+    struct bdb_bulk_ix **parts;
+    int *more; /* parts[i]->cur is on an unconsumed row */
+    struct __bam_bulk *bulk;
+    int havelast;
+    unsigned char lastkey[MAXKEYLEN + 1 + sizeof(unsigned long long)];
+    long long nkeys;
+};
+
+static int bulk_ix_keylen(bdb_state_type *bdb_state, int ixnum)
+{
+    int keylen = bdb_state->ixlen[ixnum];
+    if (bdb_keycontainsgenid(bdb_state, ixnum))
+        keylen += sizeof(unsigned long long);
+    return keylen;
+}
+
+/* Returns NULL with *bdberr == BDBERR_NOERROR if the index cannot be built in
+ * bulk; the caller then writes it the usual way. */
+struct bdb_bulk_ix *bdb_bulk_ix_open(bdb_state_type *bdb_state, int ixnum,
+                                     int *bdberr)
+{
+    struct bdb_bulk_ix *b;
+    int keylen;
+
+    *bdberr = BDBERR_NOERROR;
+
+    keylen = bulk_ix_keylen(bdb_state, ixnum);
+    if (keylen > __bam_bulk_maxkey(bdb_state->dbp_ix[ixnum]))
+        return NULL;
+
+    b = calloc(1, sizeof(*b));
+    if (b == NULL) {
+        *bdberr = BDBERR_MALLOC;
+        return NULL;
+    }
+    b->bdb_state = bdb_state;
+    b->ixnum = ixnum;
+    b->keylen = keylen;
+    b->tbl = bdb_temp_table_create(bdb_state->parent, bdberr);
+    if (b->tbl == NULL)
+        goto err;
+    b->cur = bdb_temp_table_cursor(bdb_state->parent, b->tbl, NULL, bdberr);
+    if (b->cur == NULL)
+        goto err;
+    return b;
+
+err:
+    logmsg(LOGMSG_ERROR, "%s: %s ix %d failed to create temp table %d\n",
+           __func__, bdb_state->name, ixnum, *bdberr);
+    bdb_bulk_ix_close(b);
+    if (*bdberr == BDBERR_NOERROR)
+        *bdberr = BDBERR_MISC;
+    return NULL;
+}
+
+int bdb_bulk_ix_add(struct bdb_bulk_ix *b, void *ixdta,
+                    unsigned long long genid, void *dta, int dtalen,
+                    int isnull, int *bdberr)
+{
+    bdb_state_type *bdb_state = b->bdb_state;
+    unsigned char tkey[MAXKEYLEN + 1 + 2 * sizeof(unsigned long long)];
+    unsigned int stackkeydata[3];
+    void *mallocedkeydata = NULL;
+    void *pKeyMaxBuf = NULL;
+    DBT dbt_key, dbt_data;
+    int rc;
+
+    *bdberr = BDBERR_NOERROR;
+
+    if (bdb_state->ixdta[b->ixnum] && (dta == NULL || dtalen == 0)) {
+        *bdberr = BDBERR_BADARGS;
+        return 1;
+    }
+    if (isnull && !bdb_state->ixnulls[b->ixnum]) {
+        *bdberr = BDBERR_BADARGS;
+        return 1;
+    }
+
+    if (form_ix_payload(bdb_state, b->ixnum, genid, dta, dtalen, stackkeydata,
+                        &mallocedkeydata, &dbt_data, bdberr))
+        return -1;
+
+    bdb_maybe_use_genid_for_key(bdb_state, &dbt_key, ixdta, b->ixnum, genid,
+                                isnull, &pKeyMaxBuf);
+    assert(dbt_key.size == b->keylen);
+    memcpy(tkey, dbt_key.data, dbt_key.size);
+    memcpy(tkey + dbt_key.size, &genid, sizeof(genid));
+
+    rc = bdb_temp_table_insert(bdb_state->parent, b->cur, tkey,
+                               dbt_key.size + sizeof(genid), dbt_data.data,
+                               dbt_data.size, bdberr);
+
+    if (pKeyMaxBuf)
+        free(pKeyMaxBuf);
+    if (mallocedkeydata)
+        free(mallocedkeydata);
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "%s: %s ix %d temp table insert rc %d bdberr %d\n",
+               __func__, bdb_state->name, b->ixnum, rc, *bdberr);
+        *bdberr = BDBERR_MISC;
+        return -1;
+    }
+    b->nkeys++;
+    return 0;
+}
+
+void bdb_bulk_ix_close(struct bdb_bulk_ix *b)
+{
+    int bdberr;
+
+    if (b == NULL)
+        return;
+    if (b->cur)
+        bdb_temp_table_close_cursor(b->bdb_state->parent, b->cur, &bdberr);
+    if (b->tbl)
+        bdb_temp_table_close(b->bdb_state->parent, b->tbl, &bdberr);
+    free(b);
+}
+
+/* All parts must belong to the same index; parts may be NULL. */
+struct bdb_bulk_ix_load *bdb_bulk_ix_load_begin(struct bdb_bulk_ix **parts,
+                                                int nparts, int *bdberr)
+{
+    struct bdb_bulk_ix_load *l;
+    bdb_state_type *bdb_state = NULL;
+    int i, rc;
+
+    *bdberr = BDBERR_NOERROR;
+
+    for (i = 0; i < nparts && bdb_state == NULL; i++)
+        if (parts[i])
+            bdb_state = parts[i]->bdb_state;
+    if (bdb_state == NULL) {
+        *bdberr = BDBERR_BADARGS;
+        return NULL;
+    }
+
+    l = calloc(1, sizeof(*l));
+    if (l == NULL) {
+        *bdberr = BDBERR_MALLOC;
+        return NULL;
+    }
+    l->more = calloc(nparts, sizeof(int));
+    if (l->more == NULL) {
+        free(l);
+        *bdberr = BDBERR_MALLOC;
+        return NULL;
+    }
+    l->bdb_state = bdb_state;
+    l->parts = parts;
+    l->nparts = nparts;
+
+    for (i = 0; i < nparts; i++) {
+        if (parts[i] == NULL)
+            continue;
+        l->ixnum = parts[i]->ixnum;
+        l->keylen = parts[i]->keylen;
+        rc = bdb_temp_table_first(bdb_state->parent, parts[i]->cur, bdberr);
+        if (rc == IX_OK)
+            l->more[i] = 1;
+        else if (rc != IX_EMPTY) {
+            *bdberr = BDBERR_MISC;
+            goto err;
+        }
+    }
+
+    rc = __bam_bulk_begin(bdb_state->dbp_ix[l->ixnum], &l->bulk);
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "%s: %s ix %d __bam_bulk_begin rc %d\n", __func__,
+               bdb_state->name, l->ixnum, rc);
+        *bdberr = BDBERR_MISC;
+        goto err;
+    }
+    return l;
+
+err:
+    bdb_bulk_ix_load_free(l);
+    return NULL;
+}
+
+/* Move up to nkeys keys into the btree under tran.  Returns 1 once every key
+ * has been loaded, 0 if there are more, -1 on error.  A failed step leaves
+ * the load unusable. */
+int bdb_bulk_ix_load_step(struct bdb_bulk_ix_load *l, tran_type *tran,
+                          int nkeys, int *bdberr)
+{
+    bdb_state_type *bdb_state = l->bdb_state;
+    DBT dbt_key, dbt_data;
+    int i, min, n, rc;
+
+    *bdberr = BDBERR_NOERROR;
+
+    for (n = 0; n < nkeys; n++) {
+        min = -1;
+        for (i = 0; i < l->nparts; i++) {
+            if (!l->more[i])
+                continue;
+            if (min == -1 ||
+                memcmp(bdb_temp_table_key(l->parts[i]->cur),
+                       bdb_temp_table_key(l->parts[min]->cur),
+                       l->keylen + sizeof(unsigned long long)) < 0)
+                min = i;
+        }
+        if (min == -1)
+            return 1;
+
+        struct temp_cursor *cur = l->parts[min]->cur;
+        memset(&dbt_key, 0, sizeof(dbt_key));
+        memset(&dbt_data, 0, sizeof(dbt_data));
+        dbt_key.data = bdb_temp_table_key(cur);
+        dbt_key.size = l->keylen;
+        dbt_data.data = bdb_temp_table_data(cur);
+        dbt_data.size = bdb_temp_table_datasize(cur);
+
+        if (l->havelast && memcmp(l->lastkey, dbt_key.data, l->keylen) == 0) {
+            *bdberr = BDBERR_ADD_DUPE;
+            return -1;
+        }
+
+        rc = __bam_bulk_put(l->bulk, tran->tid, &dbt_key, &dbt_data);
+        if (rc) {
+            logmsg(LOGMSG_ERROR, "%s: %s ix %d __bam_bulk_put rc %d\n",
+                   __func__, bdb_state->name, l->ixnum, rc);
+            *bdberr = (rc == DB_LOCK_DEADLOCK) ? BDBERR_DEADLOCK : BDBERR_MISC;
+            return -1;
+        }
+        memcpy(l->lastkey, dbt_key.data, l->keylen);
+        l->havelast = 1;
+        l->nkeys++;
+
+        rc = bdb_temp_table_next(bdb_state->parent, cur, bdberr);
+        if (rc == IX_PASTEOF)
+            l->more[min] = 0;
+        else if (rc != IX_OK) {
+            *bdberr = BDBERR_MISC;
+            return -1;
+        }
+    }
+
+    for (i = 0; i < l->nparts; i++)
+        if (l->more[i])
+            return 0;
+    return 1;
+}
+
+/* Publish the loaded btree.  Must be called once load_step returned 1. */
+int bdb_bulk_ix_load_end(struct bdb_bulk_ix_load *l, tran_type *tran,
+                         int *bdberr)
+{
+    int rc;
+
+    *bdberr = BDBERR_NOERROR;
+    rc = __bam_bulk_finish(l->bulk, tran->tid);
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "%s: %s ix %d __bam_bulk_finish rc %d\n",
+               __func__, l->bdb_state->name, l->ixnum, rc);
+        *bdberr = (rc == DB_LOCK_DEADLOCK) ? BDBERR_DEADLOCK : BDBERR_MISC;
+        return -1;
+    }
+    return 0;
+}
+
+long long bdb_bulk_ix_load_count(struct bdb_bulk_ix_load *l)
+{
+    return l->nkeys;
+}
+
+void bdb_bulk_ix_load_free(struct bdb_bulk_ix_load *l)
+{
+    if (l == NULL)
+        return;
+    if (l->bulk)
+        __bam_bulk_free(l->bulk);
+    free(l->more);
+    free(l);
+}
+
 static int bdb_prim_allocdta_int(bdb_state_type *bdb_state, tran_type *tran,
                                  void *dta, int dtalen,
                                  unsigned long long *genid,
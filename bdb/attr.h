@@ -240,6 +240,16 @@ DEF_ATTR(TEMPTABLE_MEM_THRESHOLD, temptable_mem_threshold, QUANTITY, 512,
 DEF_ATTR(TEMPTABLE_CACHESZ, temptable_cachesz, BYTES, 262144,
          "Cache size for temporary tables. Temp tables do not share the "
          "database's main buffer pool.")
+DEF_ATTR(TEMPTABLE_SKIPLIST, temptable_skiplist, BOOLEAN, 1,
+         "Keep SQL ephemeral tables, osql shadow tables and bplog tables in "
+         "an in-memory skiplist until they grow past "
+         "temptable_skiplist_maxsz.")
+DEF_ATTR(TEMPTABLE_SKIPLIST_MAXSZ, temptable_skiplist_maxsz, BYTES, 4194304,
+         "Spill an in-memory skiplist temp table to disk once it uses more "
+         "than this much memory.")
+DEF_ATTR(TEMPTABLE_HASHJOIN_MAXSZ, temptable_hashjoin_maxsz, BYTES, 16777216,
+         "Spill the build side of a hash join to disk once it uses more than "
+         "this much memory.")
 DEF_ATTR(PARTICIPANTID_BITS, participantid_bits, QUANTITY, 0,
          "Number of bits allocated for the participant stripe ID (remaining "
          "bits are used for the update ID).")
@@ -458,8 +468,8 @@ DEF_ATTR(SC_CHECK_LOCKWAITS_SEC, sc_check_lockwaits_sec, QUANTITY, 1,
          "Frequency of checking lockwaits during schemachange (in seconds).")
 DEF_ATTR(SC_USE_NUM_THREADS, sc_use_num_threads, QUANTITY, 0,
          "Start up to this many threads for parallel rebuilding during schema "
-         "change. 0 means use one per dtastripe. Setting is capped at "
-         "dtastripe.")
+         "change. 0 means use one per dtastripe, or one per range with "
+         "sc_stripe_ranges. Setting is capped at the number of ranges.")
 DEF_ATTR(SC_NO_REBUILD_THR_SLEEP, sc_no_rebuild_thr_sleep, QUANTITY, 10,
          "Sleep this many microsec when conversion threads count is at max.")
 DEF_ATTR(SC_FORCE_DELAY, sc_force_delay, BOOLEAN, 0,
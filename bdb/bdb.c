@@ -778,6 +778,13 @@ void bdb_print_stats(const struct berkdb_thread_stats *st, const char *prefix,
                  st->n_memp_pgs, U2M(st->memp_pg_time_us));
         printfn(s, context);
     }
+    if (st->n_pf_pages > 0 || st->n_pf_hits > 0 || st->n_pf_misses > 0) {
+        snprintf(s, sizeof(s),
+                 "%s%u pages prefetched, %u prefetch hits, %u prefetch "
+                 "misses\n",
+                 prefix, st->n_pf_pages, st->n_pf_hits, st->n_pf_misses);
+        printfn(s, context);
+    }
     if (st->n_shallocs > 0 || st->n_shalloc_frees > 0) {
         snprintf(s, sizeof(s),
                  "%s%u shallocs took %u ms, %u shalloc_frees took %u ms\n",
@@ -760,6 +760,25 @@ int bdb_prim_addkey_genid(bdb_state_type *bdb_handle, tran_type *tran,
                           void *ixdta, int ixnum, int rrn,
                           unsigned long long genid, void *dta, int dtalen,
                           int isnull, int *bdberr);
+
+/* bottom-up index builds for readonly schema changes */
+struct bdb_bulk_ix;
+struct bdb_bulk_ix_load;
+struct bdb_bulk_ix *bdb_bulk_ix_open(bdb_state_type *bdb_handle, int ixnum,
+                                     int *bdberr);
+int bdb_bulk_ix_add(struct bdb_bulk_ix *bulk, void *ixdta,
+                    unsigned long long genid, void *dta, int dtalen,
+                    int isnull, int *bdberr);
+void bdb_bulk_ix_close(struct bdb_bulk_ix *bulk);
+struct bdb_bulk_ix_load *bdb_bulk_ix_load_begin(struct bdb_bulk_ix **parts,
+                                                int nparts, int *bdberr);
+int bdb_bulk_ix_load_step(struct bdb_bulk_ix_load *load, tran_type *tran,
+                          int nkeys, int *bdberr);
+int bdb_bulk_ix_load_end(struct bdb_bulk_ix_load *load, tran_type *tran,
+                         int *bdberr);
+long long bdb_bulk_ix_load_count(struct bdb_bulk_ix_load *load);
+void bdb_bulk_ix_load_free(struct bdb_bulk_ix_load *load);
+
 int bdb_prim_delkey_genid(bdb_state_type *bdb_handle, tran_type *tran,
                           void *ixdta, int ixnum, int rrn,
                           unsigned long long genid, int isnull, int *bdberr);
@@ -933,6 +952,16 @@ int bdb_queue_get(bdb_state_type *bdb_state, tran_type *tran, int consumer,
                   size_t *fnddtaoff, struct bdb_queue_cursor *fndcursor,
                   long long *seq, int *bdberr);
 
+/* Like bdb_queue_get(), but return up to maxitems consecutive items in one
+ * cursor pass, stopping early once maxbytes of item data have been found (0
+ * for no limit).  fnd, fndcursor and seq must have room for maxitems entries;
+ * *nfound is set to the number of items returned.  Queuedbs only. */
+int bdb_queue_get_batch(bdb_state_type *bdb_state, tran_type *tran, int consumer,
+                        const struct bdb_queue_cursor *prevcursor, int maxitems,
+                        size_t maxbytes, struct bdb_queue_found **fnd,
+                        struct bdb_queue_cursor *fndcursor, long long *seq,
+                        int *nfound, int *bdberr);
+
 /* Get the genid of a queue item that was retrieved by bdb_queue_get() */
 unsigned long long bdb_queue_item_genid(const struct bdb_queue_found *dta);
 
@@ -1150,6 +1179,8 @@ void bdb_set_odh_options(bdb_state_type *bdb_state, int odh, int compression,
 void bdb_set_queue_odh_options(bdb_state_type *bdb_state, int odh,
                                int compression, int persistseq);
 
+void bdb_set_queue_shards(bdb_state_type *bdb_state, int nshards);
+
 void bdb_get_compr_flags(bdb_state_type *bdb_state, int *odh, int *compr,
                          int *blob_compr);
 
@@ -1195,7 +1226,11 @@ int bdb_add_data_with_rrn(bdb_state_type *bdb_state, void *dta, int rrn,
 int bdb_zap_freerec(bdb_state_type *bdb_handle, int *bdberr);
 
 /* temptables */
-enum { BDB_TEMP_TABLE_DONT_USE_INMEM = 1 };
+enum {
+    BDB_TEMP_TABLE_DONT_USE_INMEM = 1,
+    /* keep the table in an in-memory skiplist while it is small */
+    BDB_TEMP_TABLE_SKIPLIST = 2
+};
 struct temp_table;
 struct temp_cursor;
 struct temp_table *bdb_temp_table_create(bdb_state_type *bdb_state,
@@ -1204,6 +1239,18 @@ struct temp_table *bdb_temp_hashtable_create(bdb_state_type *bdb_state,
                                              int *bdberr);
 struct temp_table *bdb_temp_array_create(bdb_state_type *bdb_state,
                                          int *bdberr);
+struct temp_table *bdb_temp_array_create_flags(bdb_state_type *bdb_state,
+                                               int flags, int *bdberr);
+
+/* hash join build tables: entries are chained by a caller supplied hash;
+   hash 0 is reserved for keys the caller cannot hash */
+struct temp_table *bdb_temp_hashjoin_create(bdb_state_type *bdb_state,
+                                            int *bdberr);
+int bdb_temp_hashjoin_put(bdb_state_type *bdb_state, struct temp_table *tbl,
+                          uint32_t hash, void *key, int keylen, int *bdberr);
+int bdb_temp_hashjoin_find(bdb_state_type *bdb_state, struct temp_cursor *cur,
+                           uint32_t hash, int *bdberr);
+int bdb_is_hashjoin(struct temp_table *);
 struct temp_table *bdb_temp_table_create_flags(bdb_state_type *bdb_state,
                                                int flags, int *bdberr);
 
@@ -1389,6 +1436,12 @@ int bdb_find_oldest_genid(bdb_state_type *bdb_state, tran_type *tran,
 int bdb_find_newest_genid(bdb_state_type *bdb_state, tran_type *tran,
                           int stripe, void *rec, int *reclen, int maxlen,
                           unsigned long long *genid, uint8_t *ver, int *bdberr);
+int bdb_find_newest_genid_upto(bdb_state_type *bdb_state, tran_type *tran,
+                               int stripe, unsigned long long bound,
+                               unsigned long long *genid, int *bdberr);
+int bdb_dtastripe_sample_splits(bdb_state_type *bdb_state, int stripe,
+                                int nsplits, unsigned long long *splits,
+                                int *bdberr);
 
 int bdb_genid_timestamp(unsigned long long genid);
 unsigned long long bdb_recno_to_genid(int recno);
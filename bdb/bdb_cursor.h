@@ -98,6 +98,9 @@ typedef struct bdb_cursor_ifn {
     /* Get pageorder information. */
     int (*getpageorder)(struct bdb_cursor_ifn *cur);
 
+    /* Restrict data stripe traversal to shard, shard + nshards, ... */
+    void (*setstripeshard)(struct bdb_cursor_ifn *cur, int shard, int nshards);
+
     /* Update my shadows. */
     int (*updateshadows)(struct bdb_cursor_ifn *cur, int *bdberr);
     int (*updateshadows_pglogs)(struct bdb_cursor_ifn *cur, unsigned *inpgno,
@@ -602,6 +602,8 @@ struct bdb_cursor_impl_tag {
 
     /* page-order flags */
     int pageorder;       /* mark if the cursor is in page-order */
+    int stripe_shard;    /* first data stripe this cursor visits */
+    int stripe_nshards;  /* visit every stripe_nshards-th stripe; 0: all */
     int discardpages;    /* mark if the pages should be discarded immediately */
     tmptable_t *vs_stab; /* Table of records to skip in the virtual stripe. */
     tmpcursor_t *vs_skip; /* Cursor for vs_stab. */
@@ -995,6 +997,7 @@ struct bdb_state_tag {
     signed char compress;      /* boolean: compress data? */
     signed char compress_blobs; /*boolean: compress blobs? */
     signed char persistent_seq; /* boolean: persistent seq for queue? */
+    signed char queue_shards;   /* shards adds to a queue are spread over */
 
     signed char got_gblcontext;
     signed char need_to_upgrade;
@@ -42,6 +42,11 @@ int bdb_queuedb_get(bdb_state_type *bdb_state, tran_type *tran, int consumer,
                     size_t *fnddtaoff, struct bdb_queue_cursor *fndcursor,
                     long long *seq, int *bdberr);
 
+int bdb_queuedb_get_batch(bdb_state_type *bdb_state, tran_type *tran, int consumer,
+                          const struct bdb_queue_cursor *prevcursor, int maxitems, size_t maxbytes,
+                          struct bdb_queue_found **fnd, struct bdb_queue_cursor *fndcursor,
+                          long long *seq, int *nfound, int *bdberr);
+
 int bdb_queuedb_consume(bdb_state_type *bdb_state, tran_type *tran,
                         int consumer, const struct bdb_queue_found *prevfnd,
                         int *bdberr);
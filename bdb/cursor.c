@@ -211,6 +211,8 @@ static int bdb_cursor_find_last_dup(bdb_cursor_ifn_t *, void *key, int keylen,
                                     int keymax, bias_info *, int *bdberr);
 static int bdb_cursor_close(bdb_cursor_ifn_t *cur, int *bdberr);
 static int bdb_cursor_getpageorder(bdb_cursor_ifn_t *pcur_ifn);
+static void bdb_cursor_setstripeshard(bdb_cursor_ifn_t *pcur_ifn, int shard,
+                                      int nshards);
 static int bdb_cursor_update_shadows(bdb_cursor_ifn_t *pcur_ifn, int *bdberr);
 static void *bdb_cursor_get_shadowtran(bdb_cursor_ifn_t *pcur_ifn);
 static int bdb_cursor_update_shadows_with_pglogs(bdb_cursor_ifn_t *pcur_ifn,
@@ -689,6 +691,7 @@ bdb_cursor_ifn_t *bdb_cursor_open(
     pcur_ifn->lock = bdb_cursor_lock;
     pcur_ifn->set_curtran = bdb_cursor_set_curtran;
     pcur_ifn->getpageorder = bdb_cursor_getpageorder;
+    pcur_ifn->setstripeshard = bdb_cursor_setstripeshard;
 
     pcur_ifn->updateshadows = bdb_cursor_update_shadows;
     pcur_ifn->updateshadows_pglogs = bdb_cursor_update_shadows_with_pglogs;
@@ -3976,6 +3979,61 @@ static int bdb_cursor_getpageorder(bdb_cursor_ifn_t *pcur_ifn)
     return cur->pageorder;
 }
 
+/* A sharded data cursor only walks the stripes congruent to shard modulo
+ * nshards; parallel scans give each worker a different shard.  The virtual
+ * stripe (if any) belongs to shard 0. */
+static void bdb_cursor_setstripeshard(bdb_cursor_ifn_t *pcur_ifn, int shard,
+                                      int nshards)
+{
+    bdb_cursor_impl_t *cur = pcur_ifn->impl;
+    if (cur->type != BDBC_DT || nshards <= 1 ||
+        shard >= cur->state->attr->dtastripe) {
+        cur->stripe_shard = cur->stripe_nshards = 0;
+        return;
+    }
+    cur->stripe_shard = shard;
+    cur->stripe_nshards = nshards;
+}
+
+static inline int stripe_first(bdb_cursor_impl_t *cur)
+{
+    return cur->stripe_shard;
+}
+
+static inline int stripe_last_real(bdb_cursor_impl_t *cur)
+{
+    int last = cur->state->attr->dtastripe - 1;
+    if (cur->stripe_nshards > 1)
+        last -= (last - cur->stripe_shard) % cur->stripe_nshards;
+    return last;
+}
+
+static inline int stripe_last(bdb_cursor_impl_t *cur)
+{
+    if (cur->addcur && cur->stripe_shard == 0)
+        return cur->state->attr->dtastripe;
+    return stripe_last_real(cur);
+}
+
+static inline int stripe_next(bdb_cursor_impl_t *cur, int stripe)
+{
+    if (cur->stripe_nshards <= 1)
+        return stripe + 1;
+    if (stripe + cur->stripe_nshards < cur->state->attr->dtastripe)
+        return stripe + cur->stripe_nshards;
+    /* past the last real stripe: virtual stripe for shard 0, else done */
+    return cur->stripe_shard == 0 ? cur->state->attr->dtastripe : -1;
+}
+
+static inline int stripe_prev(bdb_cursor_impl_t *cur, int stripe)
+{
+    if (cur->stripe_nshards <= 1)
+        return stripe - 1;
+    if (stripe == cur->state->attr->dtastripe) /* virtual stripe */
+        return stripe_last_real(cur);
+    return stripe - cur->stripe_nshards;
+}
+
 static int bdb_cursor_first(bdb_cursor_ifn_t *pcur_ifn, int *bdberr)
 {
     bdb_cursor_impl_t *cur = pcur_ifn->impl;
@@ -6211,9 +6269,7 @@ static int bdb_cursor_move_int(bdb_cursor_impl_t *cur, int how, int *bdberr)
        AND THIS TELLS ME WHICH STRIPE I NEED */
     if (cur->type == BDBC_DT && (how == DB_FIRST || how == DB_LAST)) {
         int switch_stripes = 0;
-        int dtafile =
-            (how == DB_FIRST) ? 0 : (cur->state->attr->dtastripe -
-                                     ((cur->addcur) ? 0 : 1)); /* last stripe */
+        int dtafile = (how == DB_FIRST) ? stripe_first(cur) : stripe_last(cur);
 
         if (cur->data) {
             /* cursor is positioned */
@@ -6286,17 +6342,17 @@ static int bdb_cursor_move_int(bdb_cursor_impl_t *cur, int how, int *bdberr)
         if (rc == IX_PASTEOF || rc == IX_EMPTY || rc == IX_NOTFND) {
             switch (how) {
             case DB_FIRST:
-                nextstripe++;
+                nextstripe = stripe_next(cur, nextstripe);
                 break;
             case DB_NEXT:
-                nextstripe++;
+                nextstripe = stripe_next(cur, nextstripe);
                 crt_how = DB_FIRST;
                 break;
             case DB_LAST:
-                nextstripe--;
+                nextstripe = stripe_prev(cur, nextstripe);
                 break;
             case DB_PREV:
-                nextstripe--;
+                nextstripe = stripe_prev(cur, nextstripe);
                 crt_how = DB_LAST;
                 break;
             default:
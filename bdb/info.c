@@ -48,6 +48,7 @@ extern void bdb_dump_table_dbregs(bdb_state_type *bdb_state);
 extern void __test_last_checkpoint(DB_ENV *dbenv);
 extern void __pgdump(DB_ENV *dbenv, int32_t fileid, uint8_t *ufid, db_pgno_t pgno);
 extern void __pgtrash(DB_ENV *dbenv, int32_t fileid, db_pgno_t pgno);
+extern int __memp_fget_bench(DB_MPOOLFILE *, int, int, int);
 extern void __txn_commit_map_print_info(DB_ENV *dbenv, loglvl lvl, int should_lock);
 
 static void txn_stats(FILE *out, bdb_state_type *bdb_state);
@@ -85,6 +86,14 @@ static void bdb_queue_extent_info(FILE *out, bdb_state_type *bdb_state,
 #define prn_stat(x) logmsgf(LOGMSG_USER, out, #x ": %u\n", (unsigned)stats->x)
 #define prn_lstat(x) logmsgf(LOGMSG_USER, out, #x ": %" PRId64 "\n", (u_int64_t)stats->x)
 #define prn_statstr(x) logmsgf(LOGMSG_USER, out, #x ": %s\n", stats->x)
+#define prn_hist(x, n)                                                         \
+    do {                                                                       \
+        logmsgf(LOGMSG_USER, out, #x ":");                                     \
+        for (int _i = 0; _i < (n); _i++)                                       \
+            logmsgf(LOGMSG_USER, out, " %s%u:%u", _i == (n)-1 ? ">=" : "",     \
+                    1U << _i, (unsigned)stats->x[_i]);                         \
+        logmsgf(LOGMSG_USER, out, "\n");                                       \
+    } while (0)
 
 extern int gbl_namemangle_loglevel;
 extern int __db_dump_freepages(DB *dbp, FILE *out);
@@ -175,6 +184,9 @@ static void log_stats(FILE *out, bdb_state_type *bdb_state)
     prn_stat(st_disk_offset);
     prn_stat(st_maxcommitperflush);
     prn_stat(st_mincommitperflush);
+    prn_stat(st_gc_delays);
+    prn_hist(st_group_hist, DB_LOG_HIST_BUCKETS);
+    prn_hist(st_commit_usec_hist, DB_LOG_HIST_BUCKETS);
     prn_stat(st_regsize);
     prn_stat(st_region_wait);
     prn_stat(st_region_nowait);
@@ -350,7 +362,8 @@ static void rep_stats(FILE *out, bdb_state_type *bdb_state)
     char str[80];
     extern int64_t gbl_rep_trans_parallel, gbl_rep_trans_serial,
         gbl_rep_trans_deadlocked, gbl_rep_trans_inline,
-        gbl_rep_rowlocks_multifile;
+        gbl_rep_rowlocks_multifile, gbl_rep_trans_page_groups,
+        gbl_rep_page_groups;
 
     bdb_state->dbenv->rep_stat(bdb_state->dbenv, &stats, 0);
 
@@ -402,6 +415,8 @@ static void rep_stats(FILE *out, bdb_state_type *bdb_state)
             gbl_rep_trans_inline);
     logmsgf(LOGMSG_USER, out, "txn multifile rowlocks: %" PRId64 "\n",
             gbl_rep_rowlocks_multifile);
+    logmsgf(LOGMSG_USER, out, "txn page groups: %" PRId64 " (%" PRId64
+            " groups)\n", gbl_rep_trans_page_groups, gbl_rep_page_groups);
     logmsgf(LOGMSG_USER, out, "txn deadlocked: %" PRId64 "\n",
             gbl_rep_trans_deadlocked);
     prn_lstat(lc_cache_hits);
@@ -1329,6 +1344,8 @@ void bdb_process_user_command(bdb_state_type *bdb_state, char *line, int lline,
         " freepages      - dump free page counts",
         " lccache        - lsn collection cache commands",
         " temptable      - temptable status", 
+        " mpbench <tbl> [thds] [pgs] [secs] - cache lookup contention "
+        "benchmark",
         "*help           - this",
         "NB '*' means you can run the command via stat e.g.",
         "'send mydb stat bdb cluster'"};
@@ -1900,6 +1917,30 @@ void bdb_process_user_command(bdb_state_type *bdb_state, char *line, int lline,
 
         /* Can probably extend the trap to also accept a ufid. But for now pass a NULL. */
         __pgdump(bdb_state->dbenv, fileid, NULL, pgno);
+    } else if (tokcmp(tok, ltok, "mpbench") == 0) {
+        char table[MAXTABLELEN];
+        bdb_state_type *tbl;
+        int nthreads, npages, secs, rc;
+        tok = segtok(line, lline, &st, &ltok);
+        if (ltok == 0) {
+            logmsg(LOGMSG_USER, "mpbench <tbl> [threads] [pages] [secs]\n");
+            return;
+        }
+        tokcpy0(tok, ltok, table, sizeof(table));
+        tok = segtok(line, lline, &st, &ltok);
+        nthreads = ltok ? toknum(tok, ltok) : 16;
+        tok = segtok(line, lline, &st, &ltok);
+        npages = ltok ? toknum(tok, ltok) : 64;
+        tok = segtok(line, lline, &st, &ltok);
+        secs = ltok ? toknum(tok, ltok) : 5;
+        if ((tbl = bdb_get_table_by_name(bdb_state, table)) == NULL) {
+            logmsg(LOGMSG_ERROR, "mpbench: no table %s\n", table);
+            return;
+        }
+        rc = __memp_fget_bench(tbl->dbp_data[0][0]->mpf, nthreads, npages,
+                               secs);
+        if (rc)
+            logmsg(LOGMSG_ERROR, "mpbench: rc %d\n", rc);
     } else if (tokcmp(tok, ltok, "pgtrash") == 0) {
         int fileid, pgno;
         tok = segtok(line, lline, &st, &ltok);
@@ -0,0 +1,341 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Lock manager microbenchmark for the read path SQL cursors take: page read
+ * locks under read-only lockers, all threads hammering a handful of hot
+ * pages, with an optional writer poking at one of them.  Each configuration
+ * runs once on the normal lock table path and once with lock_fastpath_reads.
+ *
+ * bdb_lock_fastpath_test checks the semantics of the fast path: readers and
+ * writers exclude each other, upgrades wait for fast-path readers, writers
+ * waiting on a fast-path slot show up as waiters to its holders, and a
+ * stale handle can't release a later hold.
+ */
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "bdb_int.h"
+#include <build/db.h>
+#include <gettimeofday_ms.h>
+#include <logmsg.h>
+#include <sys_wrap.h>
+
+#define LOCKBENCH_PAGES 8
+#define LOCKBENCH_MAX_THDS 256
+
+typedef struct {
+    DB_ENV *dbenv;
+    int readonly;
+    db_lockmode_t mode;
+    int pause_us;
+    volatile int *stop;
+    uint64_t count;
+    uint64_t deadlocks;
+    int rc;
+} lockbench_arg;
+
+static void lockbench_obj(DB_LOCK_ILOCK *ilock, DBT *obj, int pg)
+{
+    memset(ilock, 0, sizeof(*ilock));
+    memcpy(ilock->fileid, "lockbench", sizeof("lockbench"));
+    ilock->pgno = pg;
+    ilock->type = DB_PAGE_LOCK;
+    memset(obj, 0, sizeof(*obj));
+    obj->data = ilock;
+    obj->size = sizeof(*ilock);
+}
+
+static void *lockbench_thd(void *_arg)
+{
+    lockbench_arg *arg = _arg;
+    DB_ENV *dbenv = arg->dbenv;
+    DB_LOCK_ILOCK ilock[LOCKBENCH_PAGES];
+    DBT obj[LOCKBENCH_PAGES];
+    DB_LOCK lock;
+    u_int32_t locker;
+    int i, rc;
+
+    for (i = 0; i < LOCKBENCH_PAGES; i++)
+        lockbench_obj(&ilock[i], &obj[i], i);
+
+    rc = dbenv->lock_id_flags(dbenv, &locker,
+                              arg->readonly ? DB_LOCK_ID_READONLY : 0);
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "%s lock_id rc %d\n", __func__, rc);
+        arg->rc = rc;
+        return NULL;
+    }
+
+    for (i = 0; !*arg->stop; i = (i + 1) % LOCKBENCH_PAGES) {
+        rc = dbenv->lock_get(dbenv, locker, 0, &obj[arg->readonly ? i : 0],
+                             arg->mode, &lock);
+        if (rc == DB_LOCK_DEADLOCK) {
+            arg->deadlocks++;
+            continue;
+        }
+        if (rc) {
+            logmsg(LOGMSG_ERROR, "%s lock_get rc %d\n", __func__, rc);
+            arg->rc = rc;
+            break;
+        }
+        if (arg->pause_us)
+            usleep(arg->pause_us);
+        if ((rc = dbenv->lock_put(dbenv, &lock)) != 0) {
+            logmsg(LOGMSG_ERROR, "%s lock_put rc %d\n", __func__, rc);
+            arg->rc = rc;
+            break;
+        }
+        arg->count++;
+    }
+
+    if ((rc = dbenv->lock_id_free(dbenv, locker)) != 0 && arg->rc == 0)
+        arg->rc = rc;
+    return NULL;
+}
+
+static void lockbench_run(DB_ENV *dbenv, int fastpath, int nthds, int secs,
+                          int writer)
+{
+    pthread_t tids[LOCKBENCH_MAX_THDS + 1];
+    lockbench_arg args[LOCKBENCH_MAX_THDS + 1];
+    volatile int stop = 0;
+    uint64_t reads = 0, writes = 0, deadlocks = 0, start, elapsed;
+    int i, n, fail = 0;
+
+    dbenv->attr.lock_fastpath_reads = fastpath;
+
+    n = nthds + (writer ? 1 : 0);
+    memset(args, 0, sizeof(args));
+    start = gettimeofday_ms();
+    for (i = 0; i < n; i++) {
+        args[i].dbenv = dbenv;
+        args[i].stop = &stop;
+        if (i < nthds) {
+            args[i].readonly = 1;
+            args[i].mode = DB_LOCK_READ;
+        } else {
+            args[i].mode = DB_LOCK_WRITE;
+            args[i].pause_us = 1000;
+        }
+        Pthread_create(&tids[i], NULL, lockbench_thd, &args[i]);
+    }
+    sleep(secs);
+    stop = 1;
+    for (i = 0; i < n; i++) {
+        Pthread_join(tids[i], NULL);
+        if (args[i].rc)
+            fail++;
+        if (i < nthds)
+            reads += args[i].count;
+        else
+            writes += args[i].count;
+        deadlocks += args[i].deadlocks;
+    }
+    elapsed = gettimeofday_ms() - start;
+    if (elapsed == 0)
+        elapsed = 1;
+
+    logmsg(LOGMSG_USER,
+           "%-8s threads:%-3d writer:%d reads/sec:%-10" PRIu64
+           " writes:%-6" PRIu64 " deadlocks:%-6" PRIu64 " %s\n",
+           fastpath ? "fastpath" : "locktab", nthds, writer,
+           reads * 1000 / elapsed, writes, deadlocks, fail ? "FAIL" : "pass");
+}
+
+void bdb_lock_fastpath_bench(void *_bdb_state, int nthds, int secs)
+{
+    bdb_state_type *bdb_state = _bdb_state;
+    DB_ENV *dbenv = bdb_state->dbenv;
+    int saved = dbenv->attr.lock_fastpath_reads;
+    int writer;
+
+    if (nthds <= 0)
+        nthds = 16;
+    if (nthds > LOCKBENCH_MAX_THDS)
+        nthds = LOCKBENCH_MAX_THDS;
+    if (secs <= 0)
+        secs = 5;
+
+    for (writer = 0; writer <= 1; writer++) {
+        lockbench_run(dbenv, 0, nthds, secs, writer);
+        lockbench_run(dbenv, 1, nthds, secs, writer);
+    }
+
+    dbenv->attr.lock_fastpath_reads = saved;
+}
+
+typedef struct {
+    DB_ENV *dbenv;
+    u_int32_t locker;
+    DBT *obj;
+    DB_LOCK lock;
+    int rc;
+} locktest_writer_arg;
+
+static void *lockfast_writer_thd(void *_arg)
+{
+    locktest_writer_arg *arg = _arg;
+
+    arg->rc = arg->dbenv->lock_get(arg->dbenv, arg->locker, 0, arg->obj,
+                                   DB_LOCK_WRITE, &arg->lock);
+    return NULL;
+}
+
+#define LOCKFAST_CHECK(cond, ...)                                              \
+    do {                                                                       \
+        if (!(cond)) {                                                         \
+            logmsg(LOGMSG_ERROR, "%s:%d ", __func__, __LINE__);                \
+            logmsg(LOGMSG_ERROR, __VA_ARGS__);                                 \
+            rc = -1;                                                           \
+            goto out;                                                          \
+        }                                                                      \
+    } while (0)
+
+static int lockfast_put_all(DB_ENV *dbenv, u_int32_t locker)
+{
+    DB_LOCKREQ req = {0};
+    req.op = DB_LOCK_PUT_ALL;
+    return dbenv->lock_vec(dbenv, locker, 0, &req, 1, NULL);
+}
+
+int bdb_lock_fastpath_test(void *_bdb_state)
+{
+    bdb_state_type *bdb_state = _bdb_state;
+    DB_ENV *dbenv = bdb_state->dbenv;
+    int saved = dbenv->attr.lock_fastpath_reads;
+    int saved_wait = dbenv->attr.lock_fastpath_max_wait;
+    DB_LOCK_ILOCK ilock[3];
+    DBT obj[3];
+    DB_LOCK rlock, rlock2, wlock, ulock;
+    locktest_writer_arg warg;
+    pthread_t tid;
+    u_int32_t reader = 0, writer = 0, upgrader = 0;
+    int i, rc, waiters, joined = 1;
+
+    for (i = 0; i < 3; i++)
+        lockbench_obj(&ilock[i], &obj[i], 1000 + i);
+
+    dbenv->attr.lock_fastpath_reads = 1;
+    if ((rc = dbenv->lock_id_flags(dbenv, &reader, DB_LOCK_ID_READONLY)) ||
+        (rc = dbenv->lock_id(dbenv, &writer)) ||
+        (rc = dbenv->lock_id(dbenv, &upgrader))) {
+        logmsg(LOGMSG_ERROR, "%s lock_id rc %d\n", __func__, rc);
+        goto out;
+    }
+
+    /* the first read caches the locker for the fast path */
+    rc = dbenv->lock_get(dbenv, reader, 0, &obj[2], DB_LOCK_READ, &rlock);
+    LOCKFAST_CHECK(rc == 0, "warm-up read rc %d\n", rc);
+    dbenv->lock_put(dbenv, &rlock);
+
+    /* a fast-path reader keeps writers out */
+    rc = dbenv->lock_get(dbenv, reader, 0, &obj[0], DB_LOCK_READ, &rlock);
+    LOCKFAST_CHECK(rc == 0, "read rc %d\n", rc);
+    rc = dbenv->lock_get(dbenv, writer, DB_LOCK_NOWAIT, &obj[0],
+                         DB_LOCK_WRITE, &wlock);
+    LOCKFAST_CHECK(rc == DB_LOCK_NOTGRANTED,
+                   "write granted under a read, rc %d\n", rc);
+    rc = dbenv->lock_id_has_waiters(dbenv, reader);
+    LOCKFAST_CHECK(rc == 0, "waiters before anyone waited, rc %d\n", rc);
+
+    /* a blocked writer shows up as a waiter to the fast-path holder */
+    dbenv->attr.lock_fastpath_max_wait = 10 * 1000 * 1000;
+    memset(&warg, 0, sizeof(warg));
+    warg.dbenv = dbenv;
+    warg.locker = writer;
+    warg.obj = &obj[0];
+    warg.rc = -1;
+    Pthread_create(&tid, NULL, lockfast_writer_thd, &warg);
+    joined = 0;
+    for (i = 0, waiters = 0; i < 1000 && !waiters; i++) {
+        waiters = dbenv->lock_id_has_waiters(dbenv, reader) == 1;
+        if (!waiters)
+            usleep(1000);
+    }
+    LOCKFAST_CHECK(waiters, "fast-path holder never saw the writer\n");
+    rc = lockfast_put_all(dbenv, reader);
+    LOCKFAST_CHECK(rc == 0, "put_all rc %d\n", rc);
+    Pthread_join(tid, NULL);
+    joined = 1;
+    LOCKFAST_CHECK(warg.rc == 0, "writer rc %d after reader left\n", warg.rc);
+    dbenv->lock_put(dbenv, &rlock); /* stale after put_all, must be a no-op */
+
+    /* and a held write keeps readers out, fast path or not */
+    rc = dbenv->lock_get(dbenv, reader, DB_LOCK_NOWAIT, &obj[0], DB_LOCK_READ,
+                         &rlock);
+    LOCKFAST_CHECK(rc == DB_LOCK_NOTGRANTED,
+                   "read granted under a write, rc %d\n", rc);
+    dbenv->lock_put(dbenv, &warg.lock);
+    rc = dbenv->lock_get(dbenv, reader, DB_LOCK_NOWAIT, &obj[0], DB_LOCK_READ,
+                         &rlock);
+    LOCKFAST_CHECK(rc == 0, "read after the write went away rc %d\n", rc);
+    dbenv->lock_put(dbenv, &rlock);
+
+    /* upgrading a table read to a write waits for fast-path readers */
+    rc = dbenv->lock_get(dbenv, upgrader, 0, &obj[1], DB_LOCK_READ, &ulock);
+    LOCKFAST_CHECK(rc == 0, "upgrader read rc %d\n", rc);
+    rc = dbenv->lock_get(dbenv, reader, 0, &obj[1], DB_LOCK_READ, &rlock);
+    LOCKFAST_CHECK(rc == 0, "read next to upgrader rc %d\n", rc);
+    rc = dbenv->lock_get(dbenv, upgrader, DB_LOCK_UPGRADE | DB_LOCK_NOWAIT,
+                         &obj[1], DB_LOCK_WRITE, &ulock);
+    LOCKFAST_CHECK(rc == DB_LOCK_NOTGRANTED,
+                   "upgrade granted under a read, rc %d\n", rc);
+
+    /* a stale handle must not release a later hold on the same slot */
+    rc = lockfast_put_all(dbenv, reader);
+    LOCKFAST_CHECK(rc == 0, "put_all rc %d\n", rc);
+    rc = dbenv->lock_get(dbenv, reader, 0, &obj[1], DB_LOCK_READ, &rlock2);
+    LOCKFAST_CHECK(rc == 0, "second read rc %d\n", rc);
+    dbenv->lock_put(dbenv, &rlock);
+    rc = dbenv->lock_get(dbenv, upgrader, DB_LOCK_UPGRADE | DB_LOCK_NOWAIT,
+                         &obj[1], DB_LOCK_WRITE, &ulock);
+    LOCKFAST_CHECK(rc == DB_LOCK_NOTGRANTED,
+                   "stale put released a live hold, rc %d\n", rc);
+    dbenv->lock_put(dbenv, &rlock2);
+    rc = dbenv->lock_get(dbenv, upgrader, DB_LOCK_UPGRADE | DB_LOCK_NOWAIT,
+                         &obj[1], DB_LOCK_WRITE, &ulock);
+    LOCKFAST_CHECK(rc == 0, "upgrade after readers left rc %d\n", rc);
+    rc = dbenv->lock_get(dbenv, reader, DB_LOCK_NOWAIT, &obj[1], DB_LOCK_READ,
+                         &rlock);
+    LOCKFAST_CHECK(rc == DB_LOCK_NOTGRANTED,
+                   "read granted under an upgraded lock, rc %d\n", rc);
+    rc = 0;
+
+out:
+    if (!joined)
+        Pthread_join(tid, NULL);
+    if (reader) {
+        lockfast_put_all(dbenv, reader);
+        dbenv->lock_id_free(dbenv, reader);
+    }
+    if (writer) {
+        lockfast_put_all(dbenv, writer);
+        dbenv->lock_id_free(dbenv, writer);
+    }
+    if (upgrader) {
+        lockfast_put_all(dbenv, upgrader);
+        dbenv->lock_id_free(dbenv, upgrader);
+    }
+    dbenv->attr.lock_fastpath_reads = saved;
+    dbenv->attr.lock_fastpath_max_wait = saved_wait;
+    logmsg(LOGMSG_USER, "lock fastpath test %s\n", rc ? "FAILED" : "passed");
+    return rc;
+}
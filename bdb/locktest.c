@@ -1006,3 +1006,159 @@ void bdb_locktest(void *_bdb_state)
             (double)diff / 1000.0);
     return BDB5RET;
 }
+
+#ifndef MYBDB5
+/*
+ * Deadlock cycles: each of n lockers takes its own write lock and then asks
+ * for its neighbour's, so every round is one cycle of length n.  The
+ * detector has to break every cycle while the lockers are blocked; a round
+ * that doesn't finish before the watchdog fires failed to detect it.
+ */
+#define DEADLOCK_MAX_CYCLE 16
+#define DEADLOCK_WATCHDOG_MS 10000
+
+typedef struct {
+    int idx;
+    int n;
+    int64_t timestamp;
+    DBT *obj;
+    pthread_barrier_t *barrier;
+    int deadlocked;
+    int rc;
+    int done;
+} DeadlockArg;
+
+static void *test_deadlock_thd(void *_arg)
+{
+    DeadlockArg *arg = _arg;
+    DB_LOCKREQ put_all = {0};
+    DB_LOCK mine, next;
+    u_int32_t locker;
+    int rc;
+
+    put_all.op = DB_LOCK_PUT_ALL;
+    if ((rc = dbenv->lock_id(dbenv, &locker)) != 0) {
+        arg->rc = rc;
+        pthread_barrier_wait(arg->barrier);
+        goto out;
+    }
+    if (arg->timestamp)
+        dbenv->locker_set_timestamp(dbenv, locker, arg->timestamp);
+
+    rc = dbenv->lock_get(dbenv, locker, 0, &arg->obj[arg->idx], DB_LOCK_WRITE,
+                         &mine);
+    pthread_barrier_wait(arg->barrier);
+    if (rc) {
+        arg->rc = rc;
+        goto free;
+    }
+    rc = dbenv->lock_get(dbenv, locker, 0,
+                         &arg->obj[(arg->idx + 1) % arg->n], DB_LOCK_WRITE,
+                         &next);
+    if (rc == DB_LOCK_DEADLOCK)
+        arg->deadlocked = 1;
+    else if (rc)
+        arg->rc = rc;
+
+free:
+    if ((rc = dbenv->lock_vec(dbenv, locker, 0, &put_all, 1, NULL)) != 0 &&
+        arg->rc == 0)
+        arg->rc = rc;
+    dbenv->lock_id_free(dbenv, locker);
+out:
+    __atomic_store_n(&arg->done, 1, __ATOMIC_SEQ_CST);
+    return NULL;
+}
+
+static int test_deadlock_cycle(int n, int with_timestamp)
+{
+    pthread_t t[DEADLOCK_MAX_CYCLE];
+    DeadlockArg arg[DEADLOCK_MAX_CYCLE];
+    Block28 datas[DEADLOCK_MAX_CYCLE];
+    DBT objs[DEADLOCK_MAX_CYCLE];
+    pthread_barrier_t barrier;
+    uint64_t start;
+    int i, done, deadlocks = 0, fail = 0;
+
+    bzero(datas, sizeof(datas));
+    bzero(objs, sizeof(objs));
+    for (i = 0; i < n; ++i) {
+        memcpy(&datas[i], "deadlocktest", sizeof("deadlocktest"));
+        *(int *)&datas[i].fluff[20] = i;
+        objs[i].data = &datas[i];
+        objs[i].size = sizeof(datas[i]);
+    }
+
+    pthread_barrier_init(&barrier, NULL, n);
+    for (i = 0; i < n; ++i) {
+        memset(&arg[i], 0, sizeof(arg[i]));
+        arg[i].idx = i;
+        arg[i].n = n;
+        arg[i].obj = objs;
+        arg[i].barrier = &barrier;
+        /* one locker in the cycle uses a wait-die timestamp */
+        if (with_timestamp && i == 0)
+            arg[i].timestamp = gettimeofday_ms();
+        Pthread_create(&t[i], NULL, test_deadlock_thd, &arg[i]);
+    }
+
+    start = gettimeofday_ms();
+    do {
+        for (i = 0, done = 0; i < n; ++i)
+            done += __atomic_load_n(&arg[i].done, __ATOMIC_SEQ_CST);
+        if (done < n)
+            usleep(1000);
+    } while (done < n && gettimeofday_ms() - start < DEADLOCK_WATCHDOG_MS);
+
+    if (done < n) {
+        /* unstick the round so that the threads can be joined */
+        int aborted = 0;
+        u_int32_t policy;
+        logmsg(LOGMSG_ERROR, "cycle of %d%s not detected after %dms\n", n,
+               with_timestamp ? " with timestamp" : "", DEADLOCK_WATCHDOG_MS);
+        dbenv->get_lk_detect(dbenv, &policy);
+        while (done < n) {
+            dbenv->lock_detect(dbenv, 0, policy, &aborted);
+            usleep(10000);
+            for (i = 0, done = 0; i < n; ++i)
+                done += __atomic_load_n(&arg[i].done, __ATOMIC_SEQ_CST);
+        }
+        fail = 1;
+    }
+
+    for (i = 0; i < n; ++i) {
+        Pthread_join(t[i], NULL);
+        deadlocks += arg[i].deadlocked;
+        if (arg[i].rc) {
+            logmsg(LOGMSG_ERROR, "cycle of %d locker %d rc %d\n", n, i,
+                   arg[i].rc);
+            fail = 1;
+        }
+    }
+    pthread_barrier_destroy(&barrier);
+
+    if (deadlocks == 0) {
+        logmsg(LOGMSG_ERROR, "cycle of %d finished without a victim\n", n);
+        fail = 1;
+    }
+    return fail;
+}
+
+int bdb_deadlocktest(void *_bdb_state, int rounds)
+{
+    bdb_state_type *bdb_state = _bdb_state;
+    int fail = 0, i, n, ts;
+
+    dbenv = bdb_state->dbenv;
+    if (rounds <= 0)
+        rounds = 10;
+
+    for (i = 0; i < rounds; ++i)
+        for (n = 2; n <= DEADLOCK_MAX_CYCLE; n *= 2)
+            for (ts = 0; ts <= 1; ++ts)
+                fail += test_deadlock_cycle(n, ts);
+
+    logmsg(LOGMSG_USER, "deadlock test %s\n", fail ? "FAILED" : "passed");
+    return fail;
+}
+#endif
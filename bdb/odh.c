@@ -1316,6 +1316,12 @@ void bdb_set_queue_odh_options(bdb_state_type *bdb_state, int odh,
     bdb_state->persistent_seq = persistseq;
 }
 
+void bdb_set_queue_shards(bdb_state_type *bdb_state, int nshards)
+{
+    print(bdb_state, "BDB queue shards set: %d\n", nshards);
+    bdb_state->queue_shards = nshards;
+}
+
 void bdb_set_odh_options(bdb_state_type *bdb_state, int odh, int compression,
                          int blob_compression)
 {
@@ -1737,6 +1737,28 @@ int bdb_queue_get(bdb_state_type *bdb_state, tran_type *tran, int consumer,
     return rc;
 }
 
+int bdb_queue_get_batch(bdb_state_type *bdb_state, tran_type *tran, int consumer,
+                        const struct bdb_queue_cursor *prevcursor, int maxitems,
+                        size_t maxbytes, struct bdb_queue_found **fnd,
+                        struct bdb_queue_cursor *fndcursor, long long *seq,
+                        int *nfound, int *bdberr)
+{
+    int rc;
+
+    if (bdb_state->bdbtype != BDBTYPE_QUEUEDB) {
+        *nfound = 0;
+        *bdberr = BDBERR_BADARGS;
+        return -1;
+    }
+
+    BDB_READLOCK("bdb_queue_get_batch");
+    rc = bdb_queuedb_get_batch(bdb_state, tran, consumer, prevcursor, maxitems,
+                               maxbytes, fnd, fndcursor, seq, nfound, bdberr);
+    BDB_RELLOCK();
+
+    return rc;
+}
+
 static int bdb_queue_consume_int(bdb_state_type *bdb_state, tran_type *intran,
                                  int consumer, const void *prevfnd, int *bdberr)
 {
@@ -56,6 +56,14 @@ int get_queue_sequence_tran(const char *name, long long *seq, tran_type *);
 struct bdb_queue_priv {
     uint64_t genid;
     struct bdb_queue_stats stats;
+
+    /* Sharded layout state, loaded by queuedb_shard_init() once per
+     * generation and kept current by writers under shard_lk */
+    pthread_mutex_t shard_lk;
+    int shard_init;
+    uint32_t shard_gen;
+    int nshards;         /* one past the highest shard that was written to */
+    long long shard_seq; /* last sequence number handed out */
 };
 
 struct queuedb_key {
@@ -65,6 +73,17 @@ struct queuedb_key {
 
 enum { QUEUEDB_KEY_LEN = 4 + 8 };
 
+/* A queue can be split into shards so that concurrent writers don't all append
+ * to the same right-most page.  The shard lives in the high bits of the key's
+ * consumer field, so every (shard, consumer) pair is its own range of the
+ * btree.  Shard 0 is the original layout. */
+#define QUEUEDB_MAX_SHARDS 16
+#define QUEUEDB_SHARD_SHIFT 16
+#define QUEUEDB_CONSUMER_MASK ((1 << QUEUEDB_SHARD_SHIFT) - 1)
+#define QUEUEDB_KEY_CONSUMER(shard, consumer)                                  \
+    (((shard) << QUEUEDB_SHARD_SHIFT) | (consumer))
+#define QUEUEDB_KEY_SHARD(keyconsumer) ((keyconsumer) >> QUEUEDB_SHARD_SHIFT)
+
 int gbl_debug_queuedb = 0;
 
 static uint8_t *queuedb_key_get(struct queuedb_key *p_queuedb_key,
@@ -92,6 +111,192 @@ static uint8_t *queuedb_key_put(struct queuedb_key *p_queuedb_key,
     return p_buf;
 }
 
+/* Shard an add goes to.  Hashing the writer keeps all of its events in one
+ * shard, so they stay in genid order for consumers.  Only queues created with
+ * shards (init_with_queue_shards) are sharded. */
+static int queuedb_writer_shard(bdb_state_type *bdb_state)
+{
+    int nshards = bdb_state->queue_shards;
+    if (nshards <= 1)
+        return 0;
+    if (nshards > QUEUEDB_MAX_SHARDS)
+        nshards = QUEUEDB_MAX_SHARDS;
+    uint64_t h = (uint64_t)(uintptr_t)pthread_self() * 0x9e3779b97f4a7c15ULL;
+    return (int)((h >> 32) % nshards);
+}
+
+/* Walk the newest record of every non-empty shard of db, highest shard first,
+ * to find how many shards are in use and the highest sequence number. */
+static int queuedb_scan_shards(bdb_state_type *bdb_state, tran_type *tran,
+                               DB *db, int *nshards, long long *maxseq)
+{
+    struct queuedb_key k;
+    struct bdb_queue_found_seq qfnd_odh;
+    uint8_t key[QUEUEDB_KEY_LEN];
+    DBT dbt_key = {0}, dbt_data = {0};
+    DBC *dbcp = NULL;
+    uint8_t ver = 0;
+    int rc;
+
+    rc = db->cursor(db, NULL, &dbcp, 0);
+    if (rc)
+        return rc;
+    if (tran)
+        dbcp->c_replace_lockid(dbcp, tran->tid->txnid);
+
+    dbt_key.data = key;
+    dbt_key.ulen = QUEUEDB_KEY_LEN;
+    dbt_key.flags = DB_DBT_USERMEM;
+    dbt_data.flags = DB_DBT_REALLOC;
+
+    rc = bdb_cget_unpack(bdb_state, dbcp, &dbt_key, &dbt_data, &ver, DB_LAST);
+    while (rc == 0) {
+        if (queuedb_key_get(&k, key, key + dbt_key.size) == NULL) {
+            rc = -1;
+            break;
+        }
+        int shard = QUEUEDB_KEY_SHARD(k.consumer);
+        if (shard >= *nshards)
+            *nshards = shard + 1;
+        if (bdb_state->ondisk_header &&
+            queue_found_seq_get(&qfnd_odh, dbt_data.data,
+                                (uint8_t *)dbt_data.data + dbt_data.size) &&
+            qfnd_odh.seq > *maxseq)
+            *maxseq = qfnd_odh.seq;
+        if (shard == 0)
+            break;
+
+        /* step back from the first record of this shard */
+        k.consumer = QUEUEDB_KEY_CONSUMER(shard, 0);
+        k.genid = 0;
+        queuedb_key_put(&k, key, key + sizeof(key));
+        dbt_key.size = QUEUEDB_KEY_LEN;
+        rc = bdb_cget_unpack(bdb_state, dbcp, &dbt_key, &dbt_data, &ver,
+                             DB_SET_RANGE);
+        if (rc == 0)
+            rc = bdb_cget_unpack(bdb_state, dbcp, &dbt_key, &dbt_data, &ver,
+                                 DB_PREV);
+    }
+    if (rc == DB_NOTFOUND)
+        rc = 0;
+
+    int crc = dbcp->c_close(dbcp);
+    if (crc && rc == 0)
+        rc = crc;
+    free(dbt_data.data);
+    return rc;
+}
+
+/* Load the sharded layout state the first time the queue is used in this
+ * generation. */
+static int queuedb_shard_init(bdb_state_type *bdb_state, tran_type *tran,
+                              int *bdberr)
+{
+    struct bdb_queue_priv *qstate = bdb_state->qpriv;
+    uint32_t gen = bdb_get_rep_gen(bdb_state);
+    int nshards = 1;
+    long long seq = 0;
+    int loaded;
+
+    Pthread_mutex_lock(&qstate->shard_lk);
+    loaded = qstate->shard_init && qstate->shard_gen == gen;
+    Pthread_mutex_unlock(&qstate->shard_lk);
+    if (loaded)
+        return 0;
+
+    for (int i = 0; i < BDB_QUEUEDB_MAX_FILES; i++) {
+        DB *db = bdb_state->dbp_data[i][0];
+        if (db == NULL)
+            continue;
+        int rc = queuedb_scan_shards(bdb_state, tran, db, &nshards, &seq);
+        if (rc == DB_LOCK_DEADLOCK) {
+            *bdberr = BDBERR_DEADLOCK;
+            return -1;
+        } else if (rc) {
+            logmsg(LOGMSG_ERROR, "%s: queuedb %s scan rc %d\n", __func__,
+                   bdb_state->name, rc);
+            *bdberr = BDBERR_MISC;
+            return -1;
+        }
+    }
+    if (bdb_state->ondisk_header && bdb_state->persistent_seq) {
+        long long pseq = 0;
+        get_queue_sequence_tran(bdb_state->name, &pseq, tran);
+        if (pseq > seq)
+            seq = pseq;
+    }
+
+    Pthread_mutex_lock(&qstate->shard_lk);
+    if (!qstate->shard_init || qstate->shard_gen != gen) {
+        qstate->shard_init = 1;
+        qstate->shard_gen = gen;
+        qstate->nshards = nshards;
+        qstate->shard_seq = seq;
+    }
+    Pthread_mutex_unlock(&qstate->shard_lk);
+    return 0;
+}
+
+static int queuedb_nshards(struct bdb_queue_priv *qstate)
+{
+    Pthread_mutex_lock(&qstate->shard_lk);
+    int nshards = qstate->nshards;
+    Pthread_mutex_unlock(&qstate->shard_lk);
+    return nshards;
+}
+
+/* Genid and sequence number for an add to a sharded queue.  Both are taken
+ * under shard_lk, so sequence numbers increase in genid order, the order
+ * consumers merge the shards in. */
+static long long queuedb_shard_next_seq(bdb_state_type *bdb_state,
+                                        struct bdb_queue_priv *qstate,
+                                        int shard, unsigned long long *genid)
+{
+    Pthread_mutex_lock(&qstate->shard_lk);
+    if (shard >= qstate->nshards)
+        qstate->nshards = shard + 1;
+    *genid = get_genid(bdb_state, 0);
+    long long seq = ++qstate->shard_seq;
+    Pthread_mutex_unlock(&qstate->shard_lk);
+    return seq;
+}
+
+/* Unsharded adds still advance the counter, in case the queue gets sharded
+ * later in this generation */
+static void queuedb_shard_seq_seen(struct bdb_queue_priv *qstate,
+                                   long long seq)
+{
+    Pthread_mutex_lock(&qstate->shard_lk);
+    if (seq > qstate->shard_seq)
+        qstate->shard_seq = seq;
+    Pthread_mutex_unlock(&qstate->shard_lk);
+}
+
+/* Lock the page a writer will append to in its shard, ie. the page holding
+ * the newest record of the shard, and leave the cursor on that record. */
+static int queuedb_lock_shard_last(bdb_state_type *bdb_state, DBC *dbcp,
+                                   int shard, DBT *dbt_key, DBT *dbt_data,
+                                   uint8_t *ver)
+{
+    struct queuedb_key k = {.consumer = QUEUEDB_KEY_CONSUMER(shard + 1, 0),
+                            .genid = 0};
+    queuedb_key_put(&k, dbt_key->data, (uint8_t *)dbt_key->data + dbt_key->ulen);
+    dbt_key->size = QUEUEDB_KEY_LEN;
+    int rc = bdb_cget_unpack(bdb_state, dbcp, dbt_key, dbt_data, ver,
+                             DB_SET_RANGE | DB_RMW);
+    if (rc == 0) {
+        free(dbt_data->data);
+        dbt_data->data = NULL;
+        return bdb_cget_unpack(bdb_state, dbcp, dbt_key, dbt_data, ver,
+                               DB_PREV | DB_RMW);
+    }
+    if (rc == DB_NOTFOUND)
+        return bdb_cget_unpack(bdb_state, dbcp, dbt_key, dbt_data, ver,
+                               DB_LAST | DB_RMW);
+    return rc;
+}
+
+/* Looks at the whole file, so this covers every shard */
 static int bdb_queuedb_is_db_empty(DB *db, tran_type *tran)
 {
     int rc;
@@ -308,6 +513,7 @@ void bdb_queuedb_init_priv(bdb_state_type *bdb_state)
     if (gbl_debug_queuedb)
         logmsg(LOGMSG_USER, ">>> bdb_queuedb_init_priv %s\n", bdb_state->name);
     bdb_state->qpriv = calloc(1, sizeof(struct bdb_queue_priv));
+    Pthread_mutex_init(&bdb_state->qpriv->shard_lk, NULL);
     /* read max, use? use genids, with guarantee they'll never decrement? */
     // bdb_state->qstate->genid = 0; /* CALLOC'd */
 }
@@ -358,6 +564,14 @@ int bdb_queuedb_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
     if (gbl_debug_queuedb)
         logmsg(LOGMSG_USER, ">>> bdb_queuedb_add %s\n", bdb_state->name);
 
+    if (queuedb_shard_init(bdb_state, tran, bdberr)) {
+        if (*bdberr == BDBERR_DEADLOCK)
+            qstate->stats.n_add_deadlocks++;
+        return -1;
+    }
+    int shard = queuedb_writer_shard(bdb_state);
+    int sharded = (bdb_state->queue_shards > 1) || (queuedb_nshards(qstate) > 1);
+
     databuf = malloc(dtalen + sizeof(struct bdb_queue_found_seq));
 
     int usingDbpOne = 0;
@@ -384,8 +598,12 @@ int bdb_queuedb_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
     dbt_data.flags = DB_DBT_MALLOC;
 
     /* Lock last page */
-    rc = bdb_cget_unpack(bdb_state, dbcp1, &dbt_key, &dbt_data, &ver,
-                         DB_LAST | DB_RMW);
+    if (sharded)
+        rc = queuedb_lock_shard_last(bdb_state, dbcp1, shard, &dbt_key,
+                                     &dbt_data, &ver);
+    else
+        rc = bdb_cget_unpack(bdb_state, dbcp1, &dbt_key, &dbt_data, &ver,
+                             DB_LAST | DB_RMW);
 
     if (rc == 0) {
         freeme1 = dbt_data.data;
@@ -403,7 +621,15 @@ int bdb_queuedb_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
 
     /* DB_RMW holds a writelock on rightmost btree page */
     if (bdb_state->ondisk_header) {
-        genid = qfnd_odh.genid = get_genid(bdb_state, 0);
+        if (sharded) {
+            /* shards don't have a single last record to take the sequence
+             * from, use the counter loaded by queuedb_shard_init() */
+            qfnd_odh.seq =
+                queuedb_shard_next_seq(bdb_state, qstate, shard, &genid);
+        } else {
+            genid = get_genid(bdb_state, 0);
+        }
+        qfnd_odh.genid = genid;
         qfnd_odh.data_len = dtalen;
         qfnd_odh.data_offset = sizeof(struct bdb_queue_found_seq);
         qfnd_odh.trans.tid = tran->tid->txnid;
@@ -413,71 +639,78 @@ int bdb_queuedb_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
             qfnd_odh.epoch = tran->trigger_epoch = comdb2_time_epoch();
         }
 
-        prev_seq.seq = 0;
+        if (!sharded) {
+            prev_seq.seq = 0;
 
-        if (rc == 0) {
-            p_buf = dbt_data.data;
-            p_buf_end = p_buf + dbt_data.size;
-            p_buf = (uint8_t *)queue_found_seq_get(&prev_seq, p_buf, p_buf_end);
-            if (p_buf == NULL) {
-                logmsg(LOGMSG_ERROR, "%s failed to decode prev seq for %s\n",
-                       __func__, bdb_state->name);
-                *bdberr = BDBERR_MISC;
-                rc = -1;
-                goto done;
-            }
-        } else if (usingDbpOne) {
-            int rc2;
-            assert(db == db2);
-
-            rc2 = db1->cursor(db1, tran->tid, &dbcp2, 0);
-            if (rc2 != 0) {
-                *bdberr = BDBERR_MISC;
-                rc = -1;
-                goto done;
-            }
-
-            dbt_key.data = key;
-            dbt_key.ulen = QUEUEDB_KEY_LEN;
-            dbt_key.flags = DB_DBT_USERMEM;
-
-            dbt_data.data = NULL;
-            dbt_data.flags = DB_DBT_MALLOC;
-
-            rc2 = bdb_cget_unpack(bdb_state, dbcp2, &dbt_key, &dbt_data, &ver,
-                                  DB_LAST);
-
-            if (rc2 == 0) {
-                freeme2 = dbt_data.data;
+            if (rc == 0) {
                 p_buf = dbt_data.data;
                 p_buf_end = p_buf + dbt_data.size;
                 p_buf = (uint8_t *)queue_found_seq_get(&prev_seq, p_buf,
                                                        p_buf_end);
                 if (p_buf == NULL) {
                     logmsg(LOGMSG_ERROR,
-                           "%s failed to decode prev seq for %s\n",
-                           __func__, bdb_state->name);
+                           "%s failed to decode prev seq for %s\n", __func__,
+                           bdb_state->name);
                     *bdberr = BDBERR_MISC;
                     rc = -1;
                     goto done;
                 }
-            } else if (rc2 == DB_LOCK_DEADLOCK) {
-                *bdberr = BDBERR_DEADLOCK;
-                rc = -1;
-                goto done;
-            } else if (rc2 != DB_NOTFOUND) {
-                logmsg(LOGMSG_ERROR, "%s bad rc2 %d retrieving seq for %s\n",
-                       __func__, rc2, bdb_state->name);
-                *bdberr = BDBERR_MISC;
-                rc = -1;
-                goto done;
+            } else if (usingDbpOne) {
+                int rc2;
+                assert(db == db2);
+
+                rc2 = db1->cursor(db1, tran->tid, &dbcp2, 0);
+                if (rc2 != 0) {
+                    *bdberr = BDBERR_MISC;
+                    rc = -1;
+                    goto done;
+                }
+
+                dbt_key.data = key;
+                dbt_key.ulen = QUEUEDB_KEY_LEN;
+                dbt_key.flags = DB_DBT_USERMEM;
+
+                dbt_data.data = NULL;
+                dbt_data.flags = DB_DBT_MALLOC;
+
+                rc2 = bdb_cget_unpack(bdb_state, dbcp2, &dbt_key, &dbt_data,
+                                      &ver, DB_LAST);
+
+                if (rc2 == 0) {
+                    freeme2 = dbt_data.data;
+                    p_buf = dbt_data.data;
+                    p_buf_end = p_buf + dbt_data.size;
+                    p_buf = (uint8_t *)queue_found_seq_get(&prev_seq, p_buf,
+                                                           p_buf_end);
+                    if (p_buf == NULL) {
+                        logmsg(LOGMSG_ERROR,
+                               "%s failed to decode prev seq for %s\n",
+                               __func__, bdb_state->name);
+                        *bdberr = BDBERR_MISC;
+                        rc = -1;
+                        goto done;
+                    }
+                } else if (rc2 == DB_LOCK_DEADLOCK) {
+                    *bdberr = BDBERR_DEADLOCK;
+                    rc = -1;
+                    goto done;
+                } else if (rc2 != DB_NOTFOUND) {
+                    logmsg(LOGMSG_ERROR,
+                           "%s bad rc2 %d retrieving seq for %s\n", __func__,
+                           rc2, bdb_state->name);
+                    *bdberr = BDBERR_MISC;
+                    rc = -1;
+                    goto done;
+                } else if (bdb_state->persistent_seq) {
+                    get_queue_sequence_tran(bdb_state->name, &prev_seq.seq,
+                                            tran);
+                }
             } else if (bdb_state->persistent_seq) {
                 get_queue_sequence_tran(bdb_state->name, &prev_seq.seq, tran);
             }
-        } else if (bdb_state->persistent_seq) {
-            get_queue_sequence_tran(bdb_state->name, &prev_seq.seq, tran);
+            qfnd_odh.seq = (prev_seq.seq + 1);
+            queuedb_shard_seq_seen(qstate, qfnd_odh.seq);
         }
-        qfnd_odh.seq = (prev_seq.seq + 1);
 
         dbt_key.flags = dbt_data.flags = 0;
         dbt_key.ulen = dbt_data.ulen = 0;
@@ -486,7 +719,11 @@ int bdb_queuedb_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
         p_buf_end = p_buf + dtalen + sizeof(struct bdb_queue_found_seq);
         p_buf = queue_found_seq_put(&qfnd_odh, p_buf, p_buf_end);
     } else {
-        genid = qfnd.genid = get_genid(bdb_state, 0);
+        if (sharded)
+            queuedb_shard_next_seq(bdb_state, qstate, shard, &genid);
+        else
+            genid = get_genid(bdb_state, 0);
+        qfnd.genid = genid;
         qfnd.data_len = dtalen;
         qfnd.data_offset = sizeof(struct bdb_queue_found);
         qfnd.trans.tid = tran->tid->txnid;
@@ -523,7 +760,7 @@ int bdb_queuedb_add(bdb_state_type *bdb_state, tran_type *tran, const void *dta,
             uint8_t *p_buf, *p_buf_end;
             p_buf = key;
             p_buf_end = key + sizeof(key);
-            k.consumer = i;
+            k.consumer = QUEUEDB_KEY_CONSUMER(shard, i);
             k.genid = genid;
             p_buf = queuedb_key_put(&k, p_buf, p_buf_end);
             if (p_buf == NULL) {
@@ -614,6 +851,94 @@ done:
     return rc;
 }
 
+struct queuedb_shard_stats {
+    int nrecs;
+    long long first_seq, last_seq;
+    unsigned int epoch;
+    size_t item_length;
+};
+
+static void queuedb_stats_note(struct queuedb_shard_stats *st, DBT *dbt_data,
+                               int first)
+{
+    struct bdb_queue_found_seq qfnd_odh;
+    uint8_t *p_buf = dbt_data->data;
+    uint8_t *p_buf_end = p_buf + dbt_data->size;
+    if (queue_found_seq_get(&qfnd_odh, p_buf, p_buf_end) == NULL)
+        return;
+    if (first && (st->nrecs == 0 || qfnd_odh.seq < st->first_seq)) {
+        st->first_seq = qfnd_odh.seq;
+        st->epoch = qfnd_odh.epoch;
+        st->item_length = dbt_data->size;
+    }
+    if (!first && (st->nrecs == 0 || qfnd_odh.seq > st->last_seq))
+        st->last_seq = qfnd_odh.seq;
+    if (!first)
+        st->nrecs++;
+}
+
+/* Oldest and newest item of each shard of db.  Unsharded files have just
+ * shard 0, whose oldest and newest items are the first and last records. */
+static int queuedb_stats_shards(bdb_state_type *bdb_state, DB *db,
+                                tran_type *tran, struct queuedb_shard_stats *st)
+{
+    struct queuedb_key k;
+    uint8_t key[QUEUEDB_KEY_LEN];
+    DBT dbt_key = {0}, dbt_data = {0};
+    DBC *dbcp = NULL;
+    uint8_t ver = 0;
+    int rc;
+
+    rc = db->cursor(db, tran ? tran->tid : NULL, &dbcp, 0);
+    if (rc)
+        return rc;
+
+    dbt_key.data = key;
+    dbt_key.ulen = QUEUEDB_KEY_LEN;
+    dbt_key.flags = DB_DBT_USERMEM;
+    dbt_data.flags = DB_DBT_REALLOC;
+
+    rc = bdb_cget_unpack(bdb_state, dbcp, &dbt_key, &dbt_data, &ver, DB_FIRST);
+    while (rc == 0) {
+        if (queuedb_key_get(&k, key, key + dbt_key.size) == NULL) {
+            rc = -1;
+            break;
+        }
+        queuedb_stats_note(st, &dbt_data, 1);
+
+        /* last record of this shard is just before the next one */
+        k.consumer = QUEUEDB_KEY_CONSUMER(QUEUEDB_KEY_SHARD(k.consumer) + 1, 0);
+        k.genid = 0;
+        queuedb_key_put(&k, key, key + sizeof(key));
+        dbt_key.size = QUEUEDB_KEY_LEN;
+        rc = bdb_cget_unpack(bdb_state, dbcp, &dbt_key, &dbt_data, &ver,
+                             DB_SET_RANGE);
+        if (rc == DB_NOTFOUND) {
+            rc = bdb_cget_unpack(bdb_state, dbcp, &dbt_key, &dbt_data, &ver,
+                                 DB_LAST);
+            if (rc == 0)
+                queuedb_stats_note(st, &dbt_data, 0);
+            break;
+        } else if (rc == 0) {
+            rc = bdb_cget_unpack(bdb_state, dbcp, &dbt_key, &dbt_data, &ver,
+                                 DB_PREV);
+            if (rc == 0) {
+                queuedb_stats_note(st, &dbt_data, 0);
+                rc = bdb_cget_unpack(bdb_state, dbcp, &dbt_key, &dbt_data,
+                                     &ver, DB_NEXT);
+            }
+        }
+    }
+    if (rc == DB_NOTFOUND)
+        rc = 0;
+
+    int crc = dbcp->c_close(dbcp);
+    if (crc && rc == 0)
+        rc = crc;
+    free(dbt_data.data);
+    return rc;
+}
+
 int bdb_queuedb_stats(bdb_state_type *bdb_state,
                       bdb_queue_stats_callback_t callback, tran_type *tran,
                       void *userptr, int *bdberr)
@@ -629,145 +954,37 @@ int bdb_queuedb_stats(bdb_state_type *bdb_state,
         return -1;
     }
 
-    DBT dbt_key = {0}, dbt_data = {0};
-    DBC *dbcp1 = NULL;
-    DBC *dbcp2 = NULL;
-    uint8_t ver = 0;
-    size_t item_length = 0;
-    unsigned int epoch = 0, first_seq = 0, last_seq = 0;
-    struct bdb_queue_found_seq qfnd_odh;
-    uint8_t *p_buf, *p_buf_end;
+    struct queuedb_shard_stats st = {0};
     int consumern = 0;
 
     assert(bdb_state->ondisk_header);
     if (gbl_debug_queuedb)
         logmsg(LOGMSG_USER, ">>> bdb_queuedb_stats %s\n", bdb_state->name);
 
-    dbt_key.flags = dbt_data.flags = DB_DBT_REALLOC;
-
-    DB *db1 = BDB_QUEUEDB_GET_DBP_ZERO(bdb_state);
-    rc = db1->cursor(db1, tran ? tran->tid : NULL, &dbcp1, 0);
-
-    if (rc != 0) {
-        *bdberr = BDBERR_MISC;
-        goto done;
-    }
-
-    DB *db2 = BDB_QUEUEDB_GET_DBP_ONE(bdb_state);
-    if (db2 != NULL) {
-        rc = db2->cursor(db2, tran ? tran->tid : NULL, &dbcp2, 0);
-
-        if (rc != 0) {
-            *bdberr = BDBERR_MISC;
-            goto done;
-        }
-    } else {
-        dbcp2 = dbcp1; /* no second file, use same cursor */
-    }
-
-    rc = bdb_cget_unpack(bdb_state, dbcp1, &dbt_key, &dbt_data, &ver, DB_FIRST);
-
-    int did_dbcp2_first = 0;
-chk_db_first_rc:
-    if (rc) {
-        if (rc == DB_LOCK_DEADLOCK) {
-            *bdberr = BDBERR_DEADLOCK;
-            rc = -1;
-            goto done;
-        } else if (rc == DB_NOTFOUND) {
-            if (!did_dbcp2_first && (dbcp2 != dbcp1)) {
-                rc = bdb_cget_unpack(bdb_state, dbcp2, &dbt_key, &dbt_data, &ver,
-                                     DB_FIRST);
-                did_dbcp2_first = 1; goto chk_db_first_rc;
-            } else {
-                /* EOF */
-                rc = 0;
-                goto done;
-            }
-        } else {
-            logmsg(LOGMSG_ERROR, "%s first berk rc %d\n", __func__, rc);
-            *bdberr = BDBERR_MISC;
-            assert(rc != 0);
-            goto done;
-        }
-    }
-
-    p_buf = dbt_data.data;
-    p_buf_end = p_buf + dbt_data.size;
-    p_buf = (uint8_t *)queue_found_seq_get(&qfnd_odh, p_buf, p_buf_end);
-    first_seq = qfnd_odh.seq;
-    epoch = qfnd_odh.epoch;
-    item_length = dbt_data.size;
-
-    rc = bdb_cget_unpack(bdb_state, dbcp2, &dbt_key, &dbt_data, &ver, DB_LAST);
-
-    int did_dbcp2_last = 0;
-chk_db_last_rc:
-    if (rc) {
+    /* The layout is read off the files rather than from qpriv, which is only
+     * kept current on the master */
+    for (int i = 0; i < BDB_QUEUEDB_MAX_FILES; i++) {
+        DB *db = bdb_state->dbp_data[i][0];
+        if (db == NULL)
+            continue;
+        rc = queuedb_stats_shards(bdb_state, db, tran, &st);
         if (rc == DB_LOCK_DEADLOCK) {
             *bdberr = BDBERR_DEADLOCK;
-            rc = -1;
-            goto done;
-        } else if (rc == DB_NOTFOUND) {
-            if (!did_dbcp2_last && (dbcp2 != dbcp1)) {
-                rc = bdb_cget_unpack(bdb_state, dbcp1, &dbt_key, &dbt_data, &ver,
-                                     DB_LAST);
-                did_dbcp2_last = 1; goto chk_db_last_rc;
-            } else {
-                /* EOF */
-                rc = 0;
-                goto done;
-            }
-        } else {
-            logmsg(LOGMSG_ERROR, "%s last berk rc %d\n", __func__, rc);
+            return -1;
+        } else if (rc) {
+            logmsg(LOGMSG_ERROR, "%s first/last berk rc %d\n", __func__, rc);
             *bdberr = BDBERR_MISC;
-            assert(rc != 0);
-            goto done;
+            return -1;
         }
     }
 
-    p_buf = dbt_data.data;
-    p_buf_end = p_buf + dbt_data.size;
-    p_buf = (uint8_t *)queue_found_seq_get(&qfnd_odh, p_buf, p_buf_end);
-    last_seq = qfnd_odh.seq;
-
-    if (last_seq >= first_seq)
-        callback(consumern, item_length, epoch, (last_seq - first_seq) + 1,
-                 userptr);
-
-done:
-    if (dbcp2 && (dbcp2 != dbcp1)) {
-        int crc;
-        crc = dbcp2->c_close(dbcp2);
-        if (crc == DB_LOCK_DEADLOCK) {
-            logmsg(LOGMSG_ERROR, "%s: c_close berk rc %d\n", __func__, crc);
-            *bdberr = BDBERR_DEADLOCK;
-            rc = -1;
-        } else if (crc) {
-            logmsg(LOGMSG_ERROR, "%s: c_close berk rc %d\n", __func__, crc);
-            *bdberr = BDBERR_MISC;
-            rc = -1;
-        }
-    }
-    if (dbcp1) {
-        int crc;
-        crc = dbcp1->c_close(dbcp1);
-        if (crc == DB_LOCK_DEADLOCK) {
-            logmsg(LOGMSG_ERROR, "%s: c_close berk rc %d\n", __func__, crc);
-            *bdberr = BDBERR_DEADLOCK;
-            rc = -1;
-        } else if (crc) {
-            logmsg(LOGMSG_ERROR, "%s: c_close berk rc %d\n", __func__, crc);
-            *bdberr = BDBERR_MISC;
-            rc = -1;
-        }
-    }
-    if (dbt_key.data)
-        free(dbt_key.data);
-    if (dbt_data.data)
-        free(dbt_data.data);
+    /* The depth is the span of sequence numbers.  An aborted add to a
+     * sharded queue leaves a gap in them, so there it is an upper bound. */
+    if (st.nrecs > 0 && st.last_seq >= st.first_seq)
+        callback(consumern, st.item_length, st.epoch,
+                 (st.last_seq - st.first_seq) + 1, userptr);
 
-    return rc;
+    return 0;
 }
 
 int bdb_queuedb_walk(bdb_state_type *bdb_state, int flags, void *lastitem,
@@ -798,6 +1015,8 @@ int bdb_queuedb_walk(bdb_state_type *bdb_state, int flags, void *lastitem,
     if (gbl_debug_queuedb)
         logmsg(LOGMSG_USER, ">>> bdb_queuedb_walk %s\n", bdb_state->name);
 
+    /* This is a scan in key order, so in a sharded queue it goes through the
+     * shards one after the other rather than in genid order */
     for (int i = 0; i < sizeof(dbs)/sizeof(dbs[0]); i++) {
         if (dbcp) {
             int crc2;
@@ -942,7 +1161,7 @@ int bdb_queuedb_trigger_unpack(bdb_state_type *bdb_state, DBT *dbt_key, DBT *dbt
     }
 
     if (consumer)
-        *consumer = fndk.consumer;
+        *consumer = fndk.consumer & QUEUEDB_CONSUMER_MASK;
     if (genid)
         *genid = fndk.genid;
 
@@ -982,6 +1201,38 @@ int bdb_queuedb_trigger_unpack(bdb_state_type *bdb_state, DBT *dbt_key, DBT *dbt
     return 0;
 }
 
+/* Decode the on-disk header of a found queue item in place */
+static int queuedb_found_unpack(bdb_state_type *bdb_state, DBT *dbt_data, size_t *data_offset, long long *seq)
+{
+    uint8_t *p_buf = dbt_data->data;
+    uint8_t *p_buf_end = p_buf + dbt_data->size;
+
+    if (dbt_data->size < sizeof(struct bdb_queue_found)) {
+        logmsg(LOGMSG_ERROR, "%s: invalid queue entry size %d in queue %s\n",
+                __func__, dbt_data->size, bdb_state->name);
+        return -1;
+    }
+
+    if (bdb_state->ondisk_header) {
+        struct bdb_queue_found_seq qfnd_odh;
+        p_buf = (uint8_t *)queue_found_seq_get(&qfnd_odh, p_buf, p_buf_end);
+        memcpy(dbt_data->data, &qfnd_odh, sizeof(qfnd_odh));
+        *seq = qfnd_odh.seq;
+        *data_offset = qfnd_odh.data_offset;
+    } else {
+        struct bdb_queue_found qfnd;
+        p_buf = (uint8_t *)queue_found_get(&qfnd, p_buf, p_buf_end);
+        memcpy(dbt_data->data, &qfnd, sizeof(qfnd));
+        *data_offset = qfnd.data_offset;
+    }
+    if (p_buf == NULL) {
+        logmsg(LOGMSG_ERROR, "%s: can't decode header size %u in queue %s\n",
+               __func__, dbt_data->size, bdb_state->name);
+        return -1;
+    }
+    return 0;
+}
+
 static int bdb_queuedb_get_int(bdb_state_type *bdb_state, tran_type *tran, DB *db, int consumer,
                                const struct bdb_queue_cursor *prevcursor, struct bdb_queue_found **fnd,
                                size_t *fnddtalen, size_t *fnddtaoff, struct bdb_queue_cursor *fndcursor,
@@ -1154,31 +1405,7 @@ static int bdb_queuedb_get_int(bdb_state_type *bdb_state, tran_type *tran, DB *d
     }
 
     /* made this far? massage the data and return it. */
-    p_buf = dbt_data.data;
-    p_buf_end = p_buf + dbt_data.size;
-    if (dbt_data.size < sizeof(struct bdb_queue_found)) {
-        logmsg(LOGMSG_ERROR, "%s: invalid queue entry size %d in queue %s\n",
-                __func__, dbt_data.size, bdb_state->name);
-        *bdberr = BDBERR_MISC; /* ... */
-        rc = -1;
-        goto done;
-    }
-
-    if (bdb_state->ondisk_header) {
-        struct bdb_queue_found_seq qfnd_odh;
-        p_buf = (uint8_t *)queue_found_seq_get(&qfnd_odh, p_buf, p_buf_end);
-        memcpy(dbt_data.data, &qfnd_odh, sizeof(qfnd_odh));
-        sequence = qfnd_odh.seq;
-        data_offset = qfnd_odh.data_offset;
-    } else {
-        struct bdb_queue_found qfnd;
-        p_buf = (uint8_t *)queue_found_get(&qfnd, p_buf, p_buf_end);
-        memcpy(dbt_data.data, &qfnd, sizeof(qfnd));
-        data_offset = qfnd.data_offset;
-    }
-    if (p_buf == NULL) {
-        logmsg(LOGMSG_ERROR, "%s: can't decode header size %u in queue %s\n",
-               __func__, dbt_data.size, bdb_state->name);
+    if (queuedb_found_unpack(bdb_state, &dbt_data, &data_offset, &sequence)) {
         *bdberr = BDBERR_MISC; /* ... */
         rc = -1;
         goto done;
@@ -1225,6 +1452,184 @@ done:
     return rc;
 }
 
+struct queuedb_shard_cursor {
+    DBC *dbcp;
+    DBT key, data;
+    uint8_t keybuf[QUEUEDB_KEY_LEN];
+    int keyconsumer;
+};
+
+/* Is the cursor still on a record of its (shard, consumer) range? */
+static int queuedb_shard_cursor_valid(struct queuedb_shard_cursor *c)
+{
+    struct queuedb_key k;
+    if (queuedb_key_get(&k, c->keybuf, c->keybuf + c->key.size) == NULL)
+        return 0;
+    return k.consumer == c->keyconsumer;
+}
+
+/* Min-heap on the genid part of the key, which is also btree order */
+static void queuedb_heap_down(struct queuedb_shard_cursor **heap, int n, int i)
+{
+    for (;;) {
+        int l = 2 * i + 1, r = l + 1, m = i;
+        if (l < n && memcmp(heap[l]->keybuf + 4, heap[m]->keybuf + 4, 8) < 0)
+            m = l;
+        if (r < n && memcmp(heap[r]->keybuf + 4, heap[m]->keybuf + 4, 8) < 0)
+            m = r;
+        if (m == i)
+            return;
+        struct queuedb_shard_cursor *tmp = heap[i];
+        heap[i] = heap[m];
+        heap[m] = tmp;
+        i = m;
+    }
+}
+
+/* Sharded counterpart of bdb_queuedb_get_batch_int(): open a cursor on the
+ * first item after prevcursor in each shard and merge them in genid order.
+ * fnddtalen, fnddtaoff, fndcursor and seq may be NULL. */
+static int bdb_queuedb_get_merge_int(bdb_state_type *bdb_state, tran_type *tran, DB *db, int nshards, int consumer,
+                                     const struct bdb_queue_cursor *prevcursor, int maxitems, size_t maxbytes,
+                                     struct bdb_queue_found **fnd, size_t *fnddtalen, size_t *fnddtaoff,
+                                     struct bdb_queue_cursor *fndcursor, long long *seq, int *nfound, int *bdberr)
+{
+    struct queuedb_shard_cursor cur[QUEUEDB_MAX_SHARDS] = {{0}};
+    struct queuedb_shard_cursor *heap[QUEUEDB_MAX_SHARDS];
+    struct bdb_queue_priv *qstate = bdb_state->qpriv;
+    struct queuedb_key k;
+    uint8_t ver = 0;
+    size_t data_offset, bytes = 0;
+    long long sequence;
+    int rc = 0, n = 0, nheap = 0;
+
+    *nfound = 0;
+    if (db == NULL) { // trigger dropped?
+        *bdberr = BDBERR_BADARGS;
+        return -1;
+    }
+    if (nshards > QUEUEDB_MAX_SHARDS)
+        nshards = QUEUEDB_MAX_SHARDS;
+
+    for (int s = 0; s < nshards; s++) {
+        struct queuedb_shard_cursor *c = &cur[s];
+        uint8_t start[QUEUEDB_KEY_LEN];
+
+        rc = db->cursor(db, NULL, &c->dbcp, 0);
+        if (rc) {
+            c->dbcp = NULL;
+            *bdberr = BDBERR_MISC;
+            rc = -1;
+            goto done;
+        }
+        if (tran)
+            c->dbcp->c_replace_lockid(c->dbcp, tran->tid->txnid);
+
+        c->keyconsumer = k.consumer = QUEUEDB_KEY_CONSUMER(s, consumer);
+        k.genid = prevcursor ? prevcursor->genid : 0;
+        queuedb_key_put(&k, start, start + sizeof(start));
+        memcpy(c->keybuf, start, sizeof(start));
+        c->key.data = c->keybuf;
+        c->key.size = c->key.ulen = QUEUEDB_KEY_LEN;
+        c->key.flags = DB_DBT_USERMEM;
+        c->data.flags = DB_DBT_REALLOC;
+
+        qstate->stats.n_physical_gets++;
+        rc = bdb_cget_unpack(bdb_state, c->dbcp, &c->key, &c->data, &ver, DB_SET_RANGE);
+
+        /* Step over the previous, not yet consumed, record */
+        if (rc == 0 && k.genid != 0 && memcmp(c->keybuf, start, sizeof(start)) == 0)
+            rc = bdb_cget_unpack(bdb_state, c->dbcp, &c->key, &c->data, &ver, DB_NEXT);
+        if (rc == DB_NOTFOUND) {
+            rc = 0;
+            continue;
+        } else if (rc) {
+            goto out;
+        }
+        if (queuedb_shard_cursor_valid(c))
+            heap[nheap++] = c;
+    }
+    for (int i = nheap / 2 - 1; i >= 0; i--)
+        queuedb_heap_down(heap, nheap, i);
+
+    while (nheap > 0) {
+        struct queuedb_shard_cursor *c = heap[0];
+
+        sequence = 0;
+        if (queuedb_found_unpack(bdb_state, &c->data, &data_offset, &sequence) ||
+            queuedb_key_get(&k, c->keybuf, c->keybuf + c->key.size) == NULL) {
+            *bdberr = BDBERR_MISC;
+            rc = -1;
+            goto done;
+        }
+        fnd[n] = c->data.data;
+        if (fnddtalen)
+            fnddtalen[n] = c->data.size;
+        if (fnddtaoff)
+            fnddtaoff[n] = data_offset;
+        if (seq)
+            seq[n] = sequence;
+        if (fndcursor) {
+            fndcursor[n].genid = k.genid;
+            fndcursor[n].recno = 0;
+            fndcursor[n].reserved = 0;
+        }
+        bytes += c->data.size;
+        c->data.data = NULL;
+        c->data.size = 0;
+        if (++n == maxitems || (maxbytes && bytes >= maxbytes))
+            break;
+
+        rc = bdb_cget_unpack(bdb_state, c->dbcp, &c->key, &c->data, &ver, DB_NEXT);
+        if (rc == 0 && queuedb_shard_cursor_valid(c)) {
+            queuedb_heap_down(heap, nheap, 0);
+        } else if (rc == 0 || rc == DB_NOTFOUND) {
+            rc = 0;
+            heap[0] = heap[--nheap];
+            queuedb_heap_down(heap, nheap, 0);
+        } else {
+            break;
+        }
+    }
+
+out:
+    if (rc == DB_LOCK_DEADLOCK) {
+        *bdberr = BDBERR_DEADLOCK;
+        qstate->stats.n_get_deadlocks++;
+        rc = -1;
+    } else if (rc != 0) {
+        logmsg(LOGMSG_ERROR, "%s %s get rc %d\n", __func__, bdb_state->name, rc);
+        *bdberr = BDBERR_MISC;
+        rc = -1;
+    } else if (n == 0) {
+        qstate->stats.n_get_not_founds++;
+        *bdberr = BDBERR_FETCH_DTA;
+        rc = -1;
+    } else {
+        *bdberr = BDBERR_NOERROR;
+    }
+
+done:
+    for (int s = 0; s < nshards; s++) {
+        struct queuedb_shard_cursor *c = &cur[s];
+        if (c->dbcp) {
+            int crc = c->dbcp->c_close(c->dbcp);
+            if (crc) {
+                logmsg(LOGMSG_ERROR, "%s: c_close berk rc %d\n", __func__, crc);
+                *bdberr = (crc == DB_LOCK_DEADLOCK) ? BDBERR_DEADLOCK : BDBERR_MISC;
+                rc = -1;
+            }
+        }
+        free(c->data.data);
+    }
+    if (rc) {
+        while (n > 0)
+            free(fnd[--n]);
+    }
+    *nfound = n;
+    return rc;
+}
+
 int bdb_queuedb_get(bdb_state_type *bdb_state, tran_type *tran, int consumer,
                     const struct bdb_queue_cursor *prevcursor,
                     struct bdb_queue_found **fnd, size_t *fnddtalen,
@@ -1248,6 +1653,26 @@ int bdb_queuedb_get(bdb_state_type *bdb_state, tran_type *tran, int consumer,
     assert(db != NULL);
     *bdberr = 0;
 
+    if (queuedb_shard_init(bdb_state, tran, bdberr))
+        return -1;
+    int nshards = queuedb_nshards(bdb_state->qpriv);
+    if (nshards > 1) {
+        int n;
+        rc = bdb_queuedb_get_merge_int(bdb_state, tran, db, nshards, consumer,
+                                       prevcursor, 1, 0, fnd, fnddtalen,
+                                       fnddtaoff, fndcursor, seq, &n, bdberr);
+        if ((rc == -1) && (*bdberr == BDBERR_FETCH_DTA)) {
+            db = BDB_QUEUEDB_GET_DBP_ONE(bdb_state);
+            if (db != NULL) {
+                *bdberr = 0;
+                rc = bdb_queuedb_get_merge_int(
+                    bdb_state, tran, db, nshards, consumer, prevcursor, 1, 0,
+                    fnd, fnddtalen, fnddtaoff, fndcursor, seq, &n, bdberr);
+            }
+        }
+        return rc;
+    }
+
     rc = bdb_queuedb_get_int(bdb_state, tran, db, consumer, prevcursor,
                              fnd, fnddtalen, fnddtaoff, fndcursor,
                              seq, bdberr);
@@ -1265,13 +1690,189 @@ int bdb_queuedb_get(bdb_state_type *bdb_state, tran_type *tran, int consumer,
     return rc;
 }
 
+/* Like bdb_queuedb_get_int, but keeps walking the same cursor to collect up to
+ * maxitems items for this consumer, stopping early once maxbytes of item data
+ * have been collected (0 for no limit). */
+static int bdb_queuedb_get_batch_int(bdb_state_type *bdb_state, tran_type *tran, DB *db, int consumer,
+                                     const struct bdb_queue_cursor *prevcursor, int maxitems, size_t maxbytes,
+                                     struct bdb_queue_found **fnd, struct bdb_queue_cursor *fndcursor,
+                                     long long *seq, int *nfound, int *bdberr)
+{
+    if (db == NULL) { // trigger dropped?
+        *bdberr = BDBERR_BADARGS;
+        return -1;
+    }
+
+    struct queuedb_key k, fndk;
+    DBT dbt_key = {0}, dbt_data = {0};
+    DBC *dbcp = NULL;
+    uint8_t ver = 0;
+    uint8_t key[QUEUEDB_KEY_LEN] = {0};
+    size_t data_offset, bytes = 0;
+    long long sequence;
+    int rc, n = 0;
+    struct bdb_queue_priv *qstate = bdb_state->qpriv;
+
+    dbt_key.flags = dbt_data.flags = DB_DBT_REALLOC;
+
+    rc = db->cursor(db, NULL, &dbcp, 0);
+    if (rc) {
+        *bdberr = BDBERR_MISC;
+        goto done;
+    }
+
+    if (tran) {
+        dbcp->c_replace_lockid(dbcp, tran->tid->txnid);
+    }
+
+    k.consumer = consumer;
+    k.genid = prevcursor ? prevcursor->genid : 0;
+    if (queuedb_key_put(&k, key, key + QUEUEDB_KEY_LEN) == NULL) {
+        logmsg(LOGMSG_ERROR, "%s:%d failed to encode key for queue %s consumer %d\n",
+                __func__, __LINE__, bdb_state->name, consumer);
+        *bdberr = BDBERR_MISC;
+        rc = -1;
+        goto done;
+    }
+    dbt_key.data = key;
+    dbt_key.size = QUEUEDB_KEY_LEN;
+
+    qstate->stats.n_physical_gets++;
+    rc = bdb_cget_unpack(bdb_state, dbcp, &dbt_key, &dbt_data, &ver, DB_SET_RANGE);
+
+    /* Step over the previous, not yet consumed, record */
+    if (rc == 0 && k.genid != 0 && dbt_key.size == QUEUEDB_KEY_LEN &&
+        memcmp(dbt_key.data, key, QUEUEDB_KEY_LEN) == 0) {
+        rc = bdb_cget_unpack(bdb_state, dbcp, &dbt_key, &dbt_data, &ver, DB_NEXT);
+    }
+
+    while (rc == 0) {
+        if (queuedb_key_get(&fndk, dbt_key.data, (uint8_t *)dbt_key.data + dbt_key.size) == NULL) {
+            logmsg(LOGMSG_ERROR, "%s:%d failed to decode found key for queue %s consumer %d\n",
+                   __func__, __LINE__, bdb_state->name, consumer);
+            *bdberr = BDBERR_MISC;
+            rc = -1;
+            goto done;
+        }
+        /* The rest of the file belongs to other consumers */
+        if (fndk.consumer != consumer)
+            break;
+
+        sequence = 0;
+        if (queuedb_found_unpack(bdb_state, &dbt_data, &data_offset, &sequence)) {
+            *bdberr = BDBERR_MISC;
+            rc = -1;
+            goto done;
+        }
+        fnd[n] = dbt_data.data;
+        seq[n] = sequence;
+        fndcursor[n].genid = fndk.genid;
+        fndcursor[n].recno = 0;
+        fndcursor[n].reserved = 0;
+        bytes += dbt_data.size;
+        dbt_data.data = NULL;
+        if (++n == maxitems || (maxbytes && bytes >= maxbytes))
+            break;
+
+        rc = bdb_cget_unpack(bdb_state, dbcp, &dbt_key, &dbt_data, &ver, DB_NEXT);
+    }
+
+    if (rc == DB_LOCK_DEADLOCK) {
+        *bdberr = BDBERR_DEADLOCK;
+        qstate->stats.n_get_deadlocks++;
+        rc = -1;
+    } else if (rc != 0 && rc != DB_NOTFOUND) {
+        logmsg(LOGMSG_ERROR, "%s %s get rc %d\n", __func__, bdb_state->name, rc);
+        *bdberr = BDBERR_MISC;
+        rc = -1;
+    } else if (n == 0) {
+        qstate->stats.n_get_not_founds++;
+        *bdberr = BDBERR_FETCH_DTA;
+        rc = -1;
+    } else {
+        *bdberr = BDBERR_NOERROR;
+        rc = 0;
+    }
+
+done:
+    if (dbcp) {
+        int crc = dbcp->c_close(dbcp);
+        if (crc) {
+            logmsg(LOGMSG_ERROR, "%s: c_close berk rc %d\n", __func__, crc);
+            *bdberr = (crc == DB_LOCK_DEADLOCK) ? BDBERR_DEADLOCK : BDBERR_MISC;
+            rc = -1;
+        }
+    }
+    if (rc) {
+        while (n > 0)
+            free(fnd[--n]);
+    }
+    *nfound = n;
+    if (dbt_key.data && dbt_key.data != key)
+        free(dbt_key.data);
+    if (dbt_data.data)
+        free(dbt_data.data);
+
+    return rc;
+}
+
+int bdb_queuedb_get_batch(bdb_state_type *bdb_state, tran_type *tran, int consumer,
+                          const struct bdb_queue_cursor *prevcursor, int maxitems, size_t maxbytes,
+                          struct bdb_queue_found **fnd, struct bdb_queue_cursor *fndcursor,
+                          long long *seq, int *nfound, int *bdberr)
+{
+    *nfound = 0;
+    int rc = bdb_lock_table_read(bdb_state, tran);
+    if (rc == DB_LOCK_DEADLOCK) {
+        *bdberr = BDBERR_DEADLOCK;
+        struct bdb_queue_priv *qstate = bdb_state->qpriv;
+        qstate->stats.n_get_deadlocks++;
+        return -1;
+    } else if (rc != 0) {
+        logmsg(LOGMSG_ERROR, "%s: queuedb %s error getting tablelock %d\n",
+               __func__, bdb_state->name, rc);
+        *bdberr = BDBERR_MISC;
+        return -1;
+    }
+
+    DB *db = BDB_QUEUEDB_GET_DBP_ZERO(bdb_state);
+    assert(db != NULL);
+    *bdberr = 0;
+
+    if (queuedb_shard_init(bdb_state, tran, bdberr))
+        return -1;
+    int nshards = queuedb_nshards(bdb_state->qpriv);
+
+    if (nshards > 1)
+        rc = bdb_queuedb_get_merge_int(bdb_state, tran, db, nshards, consumer, prevcursor, maxitems, maxbytes,
+                                       fnd, NULL, NULL, fndcursor, seq, nfound, bdberr);
+    else
+        rc = bdb_queuedb_get_batch_int(bdb_state, tran, db, consumer, prevcursor, maxitems, maxbytes, fnd,
+                                       fndcursor, seq, nfound, bdberr);
+    if ((rc == -1) && (*bdberr == BDBERR_FETCH_DTA)) { /* EMPTY FILE #0? */
+        db = BDB_QUEUEDB_GET_DBP_ONE(bdb_state);
+
+        if (db != NULL) {
+            *bdberr = 0;
+
+            if (nshards > 1)
+                rc = bdb_queuedb_get_merge_int(bdb_state, tran, db, nshards, consumer, prevcursor, maxitems,
+                                               maxbytes, fnd, NULL, NULL, fndcursor, seq, nfound, bdberr);
+            else
+                rc = bdb_queuedb_get_batch_int(bdb_state, tran, db, consumer, prevcursor, maxitems, maxbytes,
+                                               fnd, fndcursor, seq, nfound, bdberr);
+        }
+    }
+    return rc;
+}
+
 static int bdb_queuedb_consume_int(bdb_state_type *bdb_state, DB *db,
-                                   tran_type *tran, int consumer,
+                                   tran_type *tran, int shard, int consumer,
                                    const struct bdb_queue_found *fnd,
                                    int put_seq, int *bdberr)
 {
     struct queuedb_key k = {
-        .consumer = consumer,
+        .consumer = QUEUEDB_KEY_CONSUMER(shard, consumer),
         .genid = fnd->genid
     };
     uint8_t ver = 0;
@@ -1344,9 +1945,16 @@ static int bdb_queuedb_consume_int(bdb_state_type *bdb_state, DB *db,
         /* If none add this sequence to meta */
         if (rc == DB_NOTFOUND) {
             struct bdb_queue_found_seq qfnd;
+            struct bdb_queue_priv *qstate = bdb_state->qpriv;
             uint8_t *p_buf = (uint8_t *)val.data;
             uint8_t *p_buf_end = p_buf + sizeof(struct bdb_queue_found_seq);
             p_buf = (uint8_t *)queue_found_seq_get(&qfnd, p_buf, p_buf_end);
+            /* in a sharded queue the record at the end of the file need not
+             * be the newest one */
+            Pthread_mutex_lock(&qstate->shard_lk);
+            if (qstate->nshards > 1 && qstate->shard_seq > qfnd.seq)
+                qfnd.seq = qstate->shard_seq;
+            Pthread_mutex_unlock(&qstate->shard_lk);
             rc = put_queue_sequence(bdb_state->name, tran, qfnd.seq);
             if (rc == DB_LOCK_DEADLOCK) {
                 *bdberr = BDBERR_DEADLOCK;
@@ -1417,14 +2025,25 @@ int bdb_queuedb_consume(bdb_state_type *bdb_state, tran_type *tran,
 
     *bdberr = 0;
 
-    rc = bdb_queuedb_consume_int(bdb_state, db1, tran, consumer,
-                                 fnd, put_seq, bdberr);
-    if ((rc == -1) && (*bdberr == BDBERR_DELNOTFOUND)) { /* EMPTY FILE #0? */
-        if (db2 != NULL) {
+    if (queuedb_shard_init(bdb_state, tran, bdberr))
+        return -1;
+    int nshards = queuedb_nshards(bdb_state->qpriv);
+
+    /* the item's shard isn't known here, look for it in each one */
+    for (int shard = 0; shard < nshards; shard++) {
+        *bdberr = 0;
+        rc = bdb_queuedb_consume_int(bdb_state, db1, tran, shard, consumer,
+                                     fnd, put_seq, bdberr);
+        if ((rc != -1) || (*bdberr != BDBERR_DELNOTFOUND))
+            return rc;
+    }
+    if (db2 != NULL) { /* EMPTY FILE #0? */
+        for (int shard = 0; shard < nshards; shard++) {
             *bdberr = 0;
-
-            rc = bdb_queuedb_consume_int(bdb_state, db2, tran, consumer,
-                                         fnd, 1, bdberr);
+            rc = bdb_queuedb_consume_int(bdb_state, db2, tran, shard,
+                                         consumer, fnd, 1, bdberr);
+            if ((rc != -1) || (*bdberr != BDBERR_DELNOTFOUND))
+                return rc;
         }
     }
     return rc;
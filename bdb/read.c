@@ -223,3 +223,114 @@ int bdb_find_newest_genid(bdb_state_type *bdb_state, tran_type *tran,
     BDB_RELLOCK();
     return rc;
 }
+
+/* position cur on the last record whose genid is not past *genid and return
+ * that genid in *genid */
+static int genid_at_or_before(DBC *cur, unsigned long long *genid)
+{
+    DBT dbt_key = {0}, dbt_data = {0};
+    unsigned long long bound = *genid;
+    int rc;
+
+    dbt_key.data = genid;
+    dbt_key.size = sizeof(unsigned long long);
+    dbt_key.ulen = sizeof(unsigned long long);
+    dbt_key.flags = DB_DBT_USERMEM;
+    dbt_data.flags = DB_DBT_PARTIAL;
+
+    rc = cur->c_get(cur, &dbt_key, &dbt_data, DB_SET_RANGE);
+    if (rc == 0 && *genid == bound)
+        return 0;
+    if (rc == 0)
+        rc = cur->c_get(cur, &dbt_key, &dbt_data, DB_PREV);
+    else if (rc == DB_NOTFOUND)
+        rc = cur->c_get(cur, &dbt_key, &dbt_data, DB_LAST);
+    return rc;
+}
+
+static int find_genid_upto_int(bdb_state_type *bdb_state, tran_type *tran,
+                               int stripe, unsigned long long bound,
+                               unsigned long long *genid, int *bdberr)
+{
+    DBC *cur;
+    int rc, ixrc;
+
+    rc = bdb_state->dbp_data[0][stripe]->cursor(
+        bdb_state->dbp_data[0][stripe], tran ? tran->tid : NULL, &cur, 0);
+    if (rc) {
+        *bdberr = (rc == DB_LOCK_DEADLOCK) ? BDBERR_DEADLOCK : rc;
+        return -1;
+    }
+    *genid = bound;
+    ixrc = genid_at_or_before(cur, genid);
+    rc = cur->c_close(cur);
+    if (rc) {
+        *bdberr = (rc == DB_LOCK_DEADLOCK) ? BDBERR_DEADLOCK : rc;
+        return -1;
+    }
+    if (ixrc == 0)
+        return 0;
+    if (ixrc == DB_NOTFOUND)
+        return 1;
+    *bdberr = (ixrc == DB_LOCK_DEADLOCK) ? BDBERR_DEADLOCK : ixrc;
+    return -1;
+}
+
+/* finds the newest genid in a stripe that is not past bound, returns 1 if there
+ * is none */
+int bdb_find_newest_genid_upto(bdb_state_type *bdb_state, tran_type *tran,
+                               int stripe, unsigned long long bound,
+                               unsigned long long *genid, int *bdberr)
+{
+    int rc;
+
+    BDB_READLOCK("bdb_find_newest_genid_upto");
+    *bdberr = BDBERR_NOERROR;
+    rc = find_genid_upto_int(bdb_state, tran, stripe, bound, genid, bdberr);
+    BDB_RELLOCK();
+    return rc;
+}
+
+extern int __bam_sample_splits(DB *, u_int32_t, u_int8_t *, u_int32_t,
+                               u_int32_t *);
+
+/* Pick up to nsplits genids that cut a data stripe into ranges holding about
+ * the same number of records.  Each genid is the last record of its range and
+ * the list is ascending.  Returns how many were found, or -1 on error. */
+int bdb_dtastripe_sample_splits(bdb_state_type *bdb_state, int stripe,
+                                int nsplits, unsigned long long *splits,
+                                int *bdberr)
+{
+    unsigned long long keys[nsplits > 0 ? nsplits : 1], genid;
+    u_int32_t nkeys = 0;
+    int rc, i, n = 0;
+
+    *bdberr = BDBERR_NOERROR;
+    if (nsplits <= 0)
+        return 0;
+
+    BDB_READLOCK("bdb_dtastripe_sample_splits");
+    rc = __bam_sample_splits(bdb_state->dbp_data[0][stripe], nsplits,
+                             (u_int8_t *)keys, sizeof(keys[0]), &nkeys);
+    if (rc) {
+        *bdberr = (rc == DB_LOCK_DEADLOCK) ? BDBERR_DEADLOCK : rc;
+        BDB_RELLOCK();
+        return -1;
+    }
+    for (i = 0; i < nkeys; i++) {
+        rc = find_genid_upto_int(bdb_state, NULL, stripe, keys[i], &genid,
+                                 bdberr);
+        if (rc < 0) {
+            BDB_RELLOCK();
+            return -1;
+        }
+        if (rc == 1)
+            continue;
+        /* separators of an internal level may resolve to the same record */
+        if (n > 0 && bdb_cmp_genids(genid, splits[n - 1]) <= 0)
+            continue;
+        splits[n++] = genid;
+    }
+    BDB_RELLOCK();
+    return n;
+}
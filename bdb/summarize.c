@@ -26,6 +26,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
+#include <math.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <stdarg.h>
@@ -270,13 +271,283 @@ int sampler_close(sampler_t *sampler)
 }
 
 int gbl_debug_sleep_in_summarize = 0;
+int gbl_analyze_block_sampling = 0;
+int gbl_analyze_block_sample_min_pages = 1000;
+double gbl_analyze_block_sample_rse = 0.01;
+
+/* Verify, decrypt and byteswap-normalize a page read straight from the file.
+   Returns the number of entries on the page if it is a usable leaf page, or
+   -1 if it should be skipped. */
+static int summarize_leaf(DB_ENV *dbenv, DB *dbp, PAGE *page, int pgsz)
+{
+    int is_hmac = CRYPTO_ON(dbenv);
+    int ret;
+
+    /* If it is not a leaf page, continue reading the file. */
+    if (!ISLEAF(page))
+        return -1;
+
+    if (gbl_debug_sleep_in_summarize) {
+        sleep(1);
+    }
+
+    uint8_t *chksum = NULL;
+    /* If we have checksums, use them to verify we don't have
+       a partial page. If the checksum doesn't match,
+       just skip the page. This should be rare
+       (only happen for pagesizes larger than default). */
+    size_t sumlen = 0;
+    if (F_ISSET(dbp, DB_AM_CHKSUM)) {
+        chksum_t algo = IS_CRC32C(page) ? algo_crc32c : algo_hash4;
+        switch (TYPE(page)) {
+        case P_HASHMETA:
+        case P_BTREEMETA:
+        case P_QAMMETA:
+            chksum = ((BTMETA *)page)->chksum;
+            sumlen = DBMETASIZE;
+            break;
+        default:
+            chksum = P_CHKSUM(dbp, page);
+            sumlen = pgsz;
+            break;
+        }
+        if (F_ISSET(dbp, DB_AM_SWAP))
+            P_32_SWAP(chksum);
+        if ((ret = __db_check_chksum_algo(dbenv, dbenv->crypto_handle,
+                                          (void *)chksum, page, sumlen,
+                                          is_hmac, algo)) != 0) {
+            logmsg(LOGMSG_ERROR, "pgno %u invalid checksum\n",
+                   F_ISSET(dbp, DB_AM_SWAP) ? flibc_intflip(page->pgno)
+                                            : page->pgno);
+            return -1;
+        }
+    }
+
+    if (is_hmac) {
+        DB_CIPHER *db_cipher = dbenv->crypto_handle;
+        void *iv = P_IV(dbp, page);
+        size_t skip = P_OVERHEAD(dbp);
+        uint8_t *ciphertext = (uint8_t *)page + skip;
+        if ((ret = db_cipher->decrypt(dbenv, db_cipher->data, iv,
+                                      ciphertext, sumlen - skip)) != 0) {
+            logmsg(LOGMSG_ERROR, "pgno %u decryption failed\n", page->pgno);
+            return -1;
+        }
+    }
+
+    if (IS_PREFIX(page) && F_ISSET(dbp, DB_AM_SWAP))
+        prefix_tocpu(dbp, page);
+
+    db_indx_t n = NUM_ENT(page);
+    if (F_ISSET(dbp, DB_AM_SWAP))
+        n = flibc_shortflip(n);
+
+    return n;
+}
+
+/* Check disk space, schema changes, analyze abort request etc.
+   Returns non-zero if summarize should give up. */
+static int summarize_should_stop(bdb_state_type *bdb_state, int *last,
+                                 int *bdberr)
+{
+    int now = comdb2_time_epoch();
+    if (now - *last >= 10) {
+        *last = now;
+        int rc = check_free_space(bdb_state->dir);
+        if (rc != BDBERR_NOERROR) {
+            *bdberr = rc;
+            return -1;
+        }
+    }
+
+    int inprogress;
+    if ((inprogress = get_schema_change_in_progress(__func__, __LINE__)) ||
+        get_analyze_abort_requested() || db_is_exiting()) {
+        if (inprogress)
+            logmsg(LOGMSG_ERROR, "%s: Aborting Analyze because "
+                    "schema_change_in_progress\n", __func__);
+        if (get_analyze_abort_requested())
+            logmsg(LOGMSG_ERROR, "%s: Aborting Analyze because "
+                    "of send analyze abort\n", __func__);
+        if (db_is_exiting())
+            logmsg(LOGMSG_ERROR, "%s: Aborting Analyze because "
+                    "db is exiting\n", __func__);
+        return -1;
+    }
+    return 0;
+}
+
+/* Save a leaf page with `n' entries in the sampler's temptable,
+   keyed on the 1st key on the page. */
+static int summarize_save_leaf(bdb_state_type *bdb_state, DB *dbp,
+                               sampler_t *sampler, PAGE *page, int pgsz,
+                               db_indx_t n, int *bdberr)
+{
+    uint8_t pfxbuf[KEYBUF];
+#ifndef NDEBUG
+    uint8_t *max = (uint8_t *)page + pgsz;
+#endif
+
+    NUM_ENT(page) = n;
+
+    db_indx_t *inp = P_INP(dbp, page);
+    /* Remember the value before byteswap.
+       We need to reset inp[0] before
+       saving the page to the temptable. */
+    db_indx_t originp = inp[0];
+    if (F_ISSET(dbp, DB_AM_SWAP))
+        inp[0] = flibc_shortflip(inp[0]);
+    BKEYDATA *data = GET_BKEYDATA(dbp, page, 0);
+    assert((uint8_t *)data < max);
+    /* skip deleted */
+    if (B_DISSET(data))
+        return 0;
+    if (B_TYPE(data) != B_KEYDATA)
+        return 0;
+
+    /* Remember the values before byteswap.
+       We need to reset 1st entry before
+       saving the page to the temptable. */
+    BKEYDATA *origdta = data;
+    db_indx_t origdlen = data->len;
+    if (F_ISSET(dbp, DB_AM_SWAP))
+        data->len = flibc_shortflip(data->len);
+    db_indx_t len;
+    ASSIGN_ALIGN(db_indx_t, len, data->len);
+    assert(((uint8_t *)data + len) < max);
+    if (bk_decompress(dbp, page, &data, pfxbuf, sizeof(pfxbuf)) != 0) {
+        logmsg(LOGMSG_ERROR,
+               "\ndecompress failed page:%d indx:0 total:%d\n", page->pgno,
+               n);
+        return 0;
+    }
+    ASSIGN_ALIGN(db_indx_t, len, data->len);
+
+    /* Reset the 1st index and entry. */
+    inp[0] = originp;
+    origdta->len = origdlen;
+
+    /* Save the entire page:
+       key is the 1st key on the page;
+       data is the page itself. */
+    return bdb_temp_table_put(bdb_state->parent, sampler->tmptbl, data->data,
+                              len, page, pgsz, NULL, bdberr);
+}
+
+static inline uint64_t bitrev(uint64_t v, int bits)
+{
+    uint64_t r = 0;
+    for (int i = 0; i < bits; ++i, v >>= 1)
+        r = (r << 1) | (v & 1);
+    return r;
+}
+
+/* Block sampling: instead of streaming the whole file, split it into
+   comp_pct% as many strata as there are pages and pread one random page
+   from each. Strata are visited in bit-reversed order so that any prefix
+   of the walk is spread evenly over the file, which lets us stop as soon
+   as the row count estimate is within gbl_analyze_block_sample_rse of
+   its standard error. */
+static int summarize_blocks(bdb_state_type *bdb_state, DB *dbp, int fd,
+                            int comp_pct, sampler_t *sampler, PAGE *page,
+                            unsigned long long *outrecs,
+                            unsigned long long *cmprecs, int *bdberr)
+{
+    int pgsz = dbp->pgsize;
+    struct stat st;
+    int last = comdb2_time_epoch();
+    int rc = 0;
+
+    *outrecs = 0;
+    *cmprecs = 0;
+
+    if (fstat(fd, &st) != 0) {
+        logmsg(LOGMSG_ERROR, "can't stat index file: %d %s\n", errno,
+               strerror(errno));
+        return -1;
+    }
+
+    /* page 0 is the meta page */
+    uint64_t npages = st.st_size / pgsz;
+    if (npages <= 1)
+        return 0;
+    --npages;
+
+    uint64_t nstrata = (npages * comp_pct + 99) / 100;
+    if (nstrata < (uint64_t)gbl_analyze_block_sample_min_pages)
+        nstrata = gbl_analyze_block_sample_min_pages;
+    if (nstrata > npages)
+        nstrata = npages;
+    double stride = (double)npages / nstrata;
+
+    int bits = 0;
+    while ((1ULL << bits) < nstrata)
+        ++bits;
+
+#ifdef POSIX_FADV_RANDOM
+    (void)posix_fadvise(fd, 0, 0, POSIX_FADV_RANDOM);
+#endif
+
+    uint64_t nsampled = 0;
+    double sum = 0, sumsq = 0, rse = -1;
+    for (uint64_t i = 0; i < (1ULL << bits); ++i) {
+        uint64_t stratum = bitrev(i, bits);
+        if (stratum >= nstrata)
+            continue;
+        uint64_t pgno =
+            1 + (uint64_t)((stratum + rand() / (RAND_MAX + 1.0)) * stride);
+        if (pgno > npages)
+            pgno = npages;
+
+        ssize_t nr = pread(fd, page, pgsz, (off_t)pgno * pgsz);
+        if (nr != pgsz) {
+            logmsg(LOGMSG_ERROR, "can't read page %" PRIu64 ": %d %s\n", pgno,
+                   errno, strerror(errno));
+            return -1;
+        }
+
+        /* A non-leaf page holds no keys; it still counts towards the mean. */
+        int n = summarize_leaf(bdb_state->dbenv, dbp, page, pgsz);
+        double y = (n > 0) ? (n >> 1) : 0;
+        ++nsampled;
+        sum += y;
+        sumsq += y * y;
+
+        if (n > 0) {
+            if (summarize_should_stop(bdb_state, &last, bdberr))
+                return -1;
+            *outrecs += (n >> 1);
+            rc = summarize_save_leaf(bdb_state, dbp, sampler, page, pgsz, n,
+                                     bdberr);
+            if (rc)
+                return rc;
+        }
+
+        if (nsampled >= (uint64_t)gbl_analyze_block_sample_min_pages &&
+            (nsampled % 64) == 0 && sum > 0) {
+            double mean = sum / nsampled;
+            double var = (sumsq - nsampled * mean * mean) / (nsampled - 1);
+            rse = (var > 0) ? sqrt(var / nsampled) / mean : 0;
+            if (rse <= gbl_analyze_block_sample_rse)
+                break;
+        }
+    }
+
+    if (nsampled > 0)
+        *cmprecs = (unsigned long long)(sum / nsampled * npages + 0.5);
+
+    logmsg(LOGMSG_INFO,
+           "summarize sampled %" PRIu64 " of %" PRIu64 " pages (%" PRIu64
+           " strata), rse %f\n",
+           nsampled, npages, nstrata, rse);
+    return 0;
+}
+
 int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
                         sampler_t **samplerp, unsigned long long *outrecs,
                         unsigned long long *cmprecs, int *bdberr)
 {
     DB_ENV *dbenv = bdb_state->dbenv;
-    int is_hmac = CRYPTO_ON(dbenv);
-    uint8_t pfxbuf[KEYBUF];
     char tmpname[PATH_MAX];
     char tran_tmpname[PATH_MAX];
     int rc = 0;
@@ -288,7 +559,7 @@ int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
     unsigned long long nrecs = 0;
     unsigned long long recs_looked_at = 0;
     int fd = -1;
-    int last, now;
+    int last;
 #ifdef POSIX_FADV_SEQUENTIAL
     /* Release page cache every FADVISE_THRESH many pages. We could make it
        a tunable, but for now, leave it hardcoded. */
@@ -364,15 +635,20 @@ int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
     }
     pgsz = dbp->pgsize;
     page = malloc(pgsz);
-#ifndef NDEBUG
-    uint8_t *max = (uint8_t *)page + pgsz;
-#endif
     rc = lseek(fd, 0, SEEK_SET);
     if (rc) {
         logmsg(LOGMSG_ERROR, "can't rewind to start of file\n");
         goto done;
     }
 
+    if (gbl_analyze_block_sampling && comp_pct < 100) {
+        rc = summarize_blocks(bdb_state, dbp, fd, comp_pct, sampler, page,
+                              &nrecs, &recs_looked_at, bdberr);
+        if (rc)
+            goto done;
+        goto summarized;
+    }
+
 #ifdef POSIX_FADV_SEQUENTIAL
     // inform kernel that we will be accessing file sequentially
     (void)posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
@@ -387,67 +663,8 @@ int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
         if (usedio && ((++nread) % FADVISE_THRESH) == 0)
             (void)posix_fadvise(fd, (nread - FADVISE_THRESH) * pgsz, FADVISE_THRESH * pgsz, POSIX_FADV_DONTNEED);
 #endif
-        /* If it is not a leaf page, continue reading the file. */
-        if (!ISLEAF(page))
-            continue;
-
-        if (gbl_debug_sleep_in_summarize) {
-            sleep(1);
-        }
-
-        int ret;
-        uint8_t *chksum = NULL;
-        /* If we have checksums, use them to verify we don't have
-           a partial page. If the checksum doesn't match,
-           just skip the page. This should be rare
-           (only happen for pagesizes larger than default). */
-        size_t sumlen = 0;
-        if (F_ISSET(dbp, DB_AM_CHKSUM)) {
-            chksum_t algo = IS_CRC32C(page) ? algo_crc32c : algo_hash4;
-            switch (TYPE(page)) {
-            case P_HASHMETA:
-            case P_BTREEMETA:
-            case P_QAMMETA:
-                chksum = ((BTMETA *)page)->chksum;
-                sumlen = DBMETASIZE;
-                break;
-            default:
-                chksum = P_CHKSUM(dbp, page);
-                sumlen = pgsz;
-                break;
-            }
-            if (F_ISSET(dbp, DB_AM_SWAP))
-                P_32_SWAP(chksum);
-            if ((ret = __db_check_chksum_algo(dbenv, dbenv->crypto_handle,
-                                              (void *)chksum, page, sumlen,
-                                              is_hmac, algo)) != 0) {
-                logmsg(LOGMSG_ERROR, "pgno %u invalid checksum\n",
-                       F_ISSET(dbp, DB_AM_SWAP) ? flibc_intflip(page->pgno)
-                                                : page->pgno);
-                continue;
-            }
-        }
-
-        if (is_hmac) {
-            DB_CIPHER *db_cipher = dbenv->crypto_handle;
-            void *iv = P_IV(dbp, page);
-            size_t skip = P_OVERHEAD(dbp);
-            uint8_t *ciphertext = (uint8_t *)page + skip;
-            if ((ret = db_cipher->decrypt(dbenv, db_cipher->data, iv,
-                                          ciphertext, sumlen - skip)) != 0) {
-                logmsg(LOGMSG_ERROR, "pgno %u decryption failed\n", page->pgno);
-                continue;
-            }
-        }
-
-        if (IS_PREFIX(page) && F_ISSET(dbp, DB_AM_SWAP))
-            prefix_tocpu(dbp, page);
-
-        db_indx_t n = NUM_ENT(page);
-        if (F_ISSET(dbp, DB_AM_SWAP))
-            n = flibc_shortflip(n);
-
-        if (n == 0)
+        int n = summarize_leaf(dbenv, dbp, page, pgsz);
+        if (n <= 0)
             continue;
 
         /* We only care about the key so we take half entries
@@ -461,79 +678,15 @@ int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
         recs_looked_at += (n >> 1);
         if (rand() % 100 >= comp_pct)
             continue;
-        NUM_ENT(page) = n;
         nrecs += (n >> 1);
 
-        /* Check disk space, schema changes, analyze abort request etc. */
-        now = comdb2_time_epoch();
-        if (now - last >= 10) {
-            last = now;
-            rc = check_free_space(bdb_state->dir);
-            if (rc != BDBERR_NOERROR) {
-                *bdberr = rc;
-                rc = -1;
-                goto done;
-            }
-        }
-
-        int inprogress;
-        if ((inprogress = get_schema_change_in_progress(__func__, __LINE__)) ||
-            get_analyze_abort_requested() || db_is_exiting()) {
-            if (inprogress)
-                logmsg(LOGMSG_ERROR, "%s: Aborting Analyze because "
-                        "schema_change_in_progress\n", __func__);
-            if (get_analyze_abort_requested())
-                logmsg(LOGMSG_ERROR, "%s: Aborting Analyze because "
-                        "of send analyze abort\n", __func__);
-            if (db_is_exiting())
-                logmsg(LOGMSG_ERROR, "%s: Aborting Analyze because "
-                        "db is exiting\n", __func__);
+        if (summarize_should_stop(bdb_state, &last, bdberr)) {
             rc = -1;
             goto done;
         }
 
-        db_indx_t *inp = P_INP(dbp, page);
-        /* Remember the value before byteswap.
-           We need to reset inp[0] before
-           saving the page to the temptable. */
-        db_indx_t originp = inp[0];
-        if (F_ISSET(dbp, DB_AM_SWAP))
-            inp[0] = flibc_shortflip(inp[0]);
-        BKEYDATA *data = GET_BKEYDATA(dbp, page, 0);
-        assert((uint8_t *)data < max);
-        /* skip deleted */
-        if (B_DISSET(data))
-            continue;
-        if (B_TYPE(data) != B_KEYDATA)
-            continue;
-
-        /* Remember the values before byteswap.
-           We need to reset 1st entry before
-           saving the page to the temptable. */
-        BKEYDATA *origdta = data;
-        db_indx_t origdlen = data->len;
-        if (F_ISSET(dbp, DB_AM_SWAP))
-            data->len = flibc_shortflip(data->len);
-        db_indx_t len;
-        ASSIGN_ALIGN(db_indx_t, len, data->len);
-        assert(((uint8_t *)data + len) < max);
-        if (bk_decompress(dbp, page, &data, pfxbuf, sizeof(pfxbuf)) != 0) {
-            logmsg(LOGMSG_ERROR,
-                   "\ndecompress failed page:%d indx:0 total:%d\n", page->pgno,
-                   n);
-            continue;
-        }
-        ASSIGN_ALIGN(db_indx_t, len, data->len);
-
-        /* Reset the 1st index and entry. */
-        inp[0] = originp;
-        origdta->len = origdlen;
-
-        /* Save the entire page:
-           key is the 1st key on the page;
-           data is the page itself. */
-        rc = bdb_temp_table_put(bdb_state->parent, sampler->tmptbl, data->data,
-                                len, page, pgsz, NULL, bdberr);
+        rc = summarize_save_leaf(bdb_state, dbp, sampler, page, pgsz, n,
+                                 bdberr);
         if (rc)
             goto done;
     }
@@ -545,6 +698,7 @@ int bdb_summarize_table(bdb_state_type *bdb_state, int ixnum, int comp_pct,
         goto done;
     }
 
+summarized:
     logmsg(LOGMSG_INFO, "summarize added %llu records, traversed %llu\n", nrecs,
            recs_looked_at);
 done:
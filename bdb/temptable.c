@@ -24,6 +24,7 @@
 #include <strings.h>
 #include <unistd.h>
 #include <assert.h>
+#include <arpa/inet.h>
 #include <openssl/rand.h>
 
 #include <build/db.h> /* berk db.h */
@@ -143,6 +144,14 @@ struct temp_cursor {
     int ind;
     int keymalloclen;
     int datamalloclen;
+    struct skip_node *node;
+    int node_deleted;
+    int parked; /* CUR_PARKED_*: was parked by a delete when the table spilled */
+    struct hj_entry *hj_ent;
+    uint32_t hj_hash;  /* probe hash; chain 0 is walked after it */
+    uint32_t hj_chain; /* chain the cursor is on */
+    int hj_mode;
+    void *hj_buf; /* spilled hash join key, hash prefixed */
 };
 
 typedef struct arr_elem {
@@ -185,13 +194,70 @@ typedef struct arr_elem {
    or the in-memory data size exceeds a pre-configured cache size,
    a temparray will fall back to a temptable.
    A temparray is more efficient than a temptable. Besides, it uses far
-   less memory than a temptable for small and medium-sized requests. */
+   less memory than a temptable for small and medium-sized requests.
+
+   A skiplist temptable keeps its entries ordered by the table's comparator
+   in an in-memory skiplist, and is copied into a berkdb temptable once the
+   memory backing it exceeds temptable_skiplist_maxsz. Small tables never
+   touch a berkdb environment, mpool or page latches. Nodes are carved out
+   of arena blocks which are only released on truncate (or spill), so a
+   cursor parked on a deleted node never dangles.
+
+   A hash join temptable holds the build side of a hash join. Keys are
+   chained off a plhash by a 32 bit hash the caller computes, so a probe
+   only looks at the entries sharing its hash (the caller weeds out
+   collisions). Hash 0 collects keys the caller could not hash, and every
+   probe walks that chain too. Entries come from the same arena as skiplist
+   nodes. Past temptable_hashjoin_maxsz they move into a berkdb btree keyed
+   on the big-endian hash followed by the key, which keeps every chain
+   contiguous, and a probe becomes a short range scan. */
 enum {
     TEMP_TABLE_TYPE_BTREE,
     TEMP_TABLE_TYPE_HASH,
-    TEMP_TABLE_TYPE_ARRAY
+    TEMP_TABLE_TYPE_ARRAY,
+    TEMP_TABLE_TYPE_SKIPLIST,
+    TEMP_TABLE_TYPE_HASHJOIN
 };
 
+#define SKIPLIST_MAXLEVEL 16
+#define SKIPLIST_ARENA_BLKSZ (64 * 1024)
+
+/* where a berkdb cursor stands for a skiplist cursor parked by a delete */
+enum {
+    CUR_PARKED_NONE = 0,
+    CUR_PARKED_PREV = 1, /* on the entry preceding the deleted one */
+    CUR_PARKED_HEAD = 2  /* unpositioned; the deleted entry was the first */
+};
+
+typedef struct skip_node {
+    int keylen;
+    int dtalen;
+    int dtacap;
+    int level;
+    uint8_t *dta;
+    struct skip_node *prev; /* level 0 only; the head for the first node */
+    struct skip_node *next[/*level*/];
+    /* key follows next[level] */
+} skip_node_t;
+
+#define SKIP_KEY(n) ((uint8_t *)&(n)->next[(n)->level])
+
+typedef struct hj_entry {
+    uint32_t hash;
+    int keylen;
+    struct hj_entry *next;
+    uint8_t key[/*keylen*/];
+} hj_entry_t;
+
+enum { HJ_NONE, HJ_CHAIN, HJ_SCAN };
+
+typedef struct arena_blk {
+    struct arena_blk *next;
+    size_t size;
+    size_t used;
+    uint8_t mem[/*size*/];
+} arena_blk_t;
+
 struct temp_table {
     DB_ENV *dbenv_temp;
 
@@ -214,6 +280,16 @@ struct temp_table {
     unsigned long long inmemsz;
     unsigned long long cachesz;
     arr_elem_t *elements;
+
+    skip_node_t *skip_head;
+    int skip_level;
+    uint32_t skip_seed;
+    arena_blk_t *arena;
+    unsigned long long skiplist_maxsz;
+
+    hash_t *hj_hash;
+    int hj_spilled;
+    unsigned long long hashjoin_maxsz;
 };
 
 enum { TMPTBL_PRIORITY, TMPTBL_WAIT };
@@ -235,7 +311,7 @@ static int temp_table_compare(DB *db, const DBT *dbt1, const DBT *dbt2);
 /* refactored both insert and put code paths here */
 static int bdb_temp_table_insert_put(bdb_state_type *, struct temp_table *,
                                      void *key, int keylen, void *data,
-                                     int dtalen, int *bdberr);
+                                     int dtalen, void *unpacked, int *bdberr);
 
 void *bdb_temp_table_get_cur(struct temp_cursor *skippy) { return skippy->cur; }
 
@@ -477,6 +553,500 @@ static void bdb_temp_table_reset(struct temp_table *tbl)
 static int bdb_temp_table_reset_cursors( bdb_state_type *bdb_state, struct temp_table *tbl, int *bdberr);
 static int bdb_temp_table_reset_cursor(bdb_state_type *bdb_state, struct temp_cursor *cur, int *bdberr);
 
+static void *skiplist_arena_alloc(struct temp_table *tbl, size_t sz)
+{
+    arena_blk_t *blk = tbl->arena;
+    void *p;
+
+    sz = (sz + 7) & ~(size_t)7;
+    if (blk == NULL || blk->size - blk->used < sz) {
+        size_t blksz = (sz > SKIPLIST_ARENA_BLKSZ) ? sz : SKIPLIST_ARENA_BLKSZ;
+        blk = malloc(offsetof(arena_blk_t, mem) + blksz);
+        if (blk == NULL)
+            return NULL;
+        blk->size = blksz;
+        blk->used = 0;
+        /* Oversized requests get a block of their own; keep bumping from
+           the current block afterwards. */
+        if (sz > SKIPLIST_ARENA_BLKSZ / 2 && tbl->arena) {
+            blk->next = tbl->arena->next;
+            tbl->arena->next = blk;
+        } else {
+            blk->next = tbl->arena;
+            tbl->arena = blk;
+        }
+        tbl->inmemsz += blksz;
+    }
+    p = blk->mem + blk->used;
+    blk->used += sz;
+    return p;
+}
+
+static void arena_clear(struct temp_table *tbl)
+{
+    arena_blk_t *blk, *next;
+
+    for (blk = tbl->arena; blk; blk = next) {
+        next = blk->next;
+        free(blk);
+    }
+    tbl->arena = NULL;
+    tbl->inmemsz = 0;
+}
+
+static void skiplist_clear(struct temp_table *tbl)
+{
+    arena_clear(tbl);
+    if (tbl->skip_head)
+        memset(tbl->skip_head->next, 0,
+               SKIPLIST_MAXLEVEL * sizeof(skip_node_t *));
+    tbl->skip_level = 1;
+}
+
+static int skiplist_random_level(struct temp_table *tbl)
+{
+    /* xorshift32, branching factor of 4 */
+    uint32_t x = tbl->skip_seed;
+    int level = 1;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    tbl->skip_seed = x;
+
+    while ((x & 3) == 0 && level < SKIPLIST_MAXLEVEL) {
+        ++level;
+        x >>= 2;
+    }
+    return level;
+}
+
+static inline int skiplist_cmp(struct temp_table *tbl, skip_node_t *n,
+                               const void *key, int keylen, void *unpacked)
+{
+    /* same argument conventions as temp_table_compare() */
+    if (unpacked)
+        return tbl->cmpfunc(NULL, n->keylen, SKIP_KEY(n), -1, unpacked);
+    return tbl->cmpfunc(tbl->usermem, n->keylen, SKIP_KEY(n), keylen, key);
+}
+
+/* Return the first node not less than `key', or NULL. If `update' is not
+   NULL, it receives the rightmost node visited on every level. */
+static skip_node_t *skiplist_seek(struct temp_table *tbl, const void *key,
+                                  int keylen, void *unpacked,
+                                  skip_node_t **update)
+{
+    skip_node_t *x = tbl->skip_head;
+    int i;
+
+    for (i = tbl->skip_level - 1; i >= 0; --i) {
+        while (x->next[i] &&
+               skiplist_cmp(tbl, x->next[i], key, keylen, unpacked) < 0)
+            x = x->next[i];
+        if (update)
+            update[i] = x;
+    }
+    return x->next[0];
+}
+
+static skip_node_t *skiplist_last(struct temp_table *tbl)
+{
+    skip_node_t *x = tbl->skip_head;
+    int i;
+
+    for (i = tbl->skip_level - 1; i >= 0; --i) {
+        while (x->next[i])
+            x = x->next[i];
+    }
+    return (x == tbl->skip_head) ? NULL : x;
+}
+
+static int skiplist_set_data(struct temp_table *tbl, skip_node_t *n,
+                             const void *data, int dtalen)
+{
+    if (dtalen > n->dtacap) {
+        uint8_t *dta = skiplist_arena_alloc(tbl, dtalen);
+        if (dta == NULL)
+            return -1;
+        n->dta = dta;
+        n->dtacap = dtalen;
+    }
+    memcpy(n->dta, data, dtalen);
+    n->dtalen = dtalen;
+    return 0;
+}
+
+static skip_node_t *skiplist_insert(struct temp_table *tbl, const void *key,
+                                    int keylen, const void *data, int dtalen,
+                                    void *unpacked)
+{
+    skip_node_t *update[SKIPLIST_MAXLEVEL];
+    skip_node_t *x;
+    int i, level;
+
+    x = skiplist_seek(tbl, key, keylen, unpacked, update);
+    if (x && skiplist_cmp(tbl, x, key, keylen, unpacked) == 0) {
+        /* Same as a put into a berkdb btree without DB_DUP. */
+        return skiplist_set_data(tbl, x, data, dtalen) ? NULL : x;
+    }
+
+    level = skiplist_random_level(tbl);
+    x = skiplist_arena_alloc(tbl, offsetof(skip_node_t, next) +
+                                      level * sizeof(skip_node_t *) + keylen +
+                                      dtalen);
+    if (x == NULL)
+        return NULL;
+
+    if (level > tbl->skip_level) {
+        for (i = tbl->skip_level; i < level; ++i)
+            update[i] = tbl->skip_head;
+        tbl->skip_level = level;
+    }
+
+    x->level = level;
+    x->keylen = keylen;
+    x->dtalen = x->dtacap = dtalen;
+    x->dta = SKIP_KEY(x) + keylen;
+    memcpy(SKIP_KEY(x), key, keylen);
+    memcpy(x->dta, data, dtalen);
+
+    for (i = 0; i < level; ++i) {
+        x->next[i] = update[i]->next[i];
+        update[i]->next[i] = x;
+    }
+    x->prev = update[0];
+    if (x->next[0])
+        x->next[0]->prev = x;
+
+    ++tbl->num_mem_entries;
+    return x;
+}
+
+static void skiplist_unlink(struct temp_table *tbl, skip_node_t *n)
+{
+    skip_node_t *update[SKIPLIST_MAXLEVEL];
+    skip_node_t *x;
+    int i;
+
+    skiplist_seek(tbl, SKIP_KEY(n), n->keylen, NULL, update);
+    for (i = 0; i < n->level; ++i) {
+        for (x = update[i]; x->next[i] != n; x = x->next[i])
+            ;
+        x->next[i] = n->next[i];
+    }
+    if (n->next[0])
+        n->next[0]->prev = n->prev;
+
+    while (tbl->skip_level > 1 &&
+           tbl->skip_head->next[tbl->skip_level - 1] == NULL)
+        --tbl->skip_level;
+
+    --tbl->num_mem_entries;
+}
+
+static int skiplist_copy_to_cur(struct temp_cursor *cur, skip_node_t *n)
+{
+    if (cur->key == NULL || cur->keymalloclen < n->keylen) {
+        cur->key = malloc_resize(cur->key, n->keylen);
+        cur->keymalloclen = n->keylen;
+    }
+    if (cur->data == NULL || cur->datamalloclen < n->dtalen) {
+        cur->data = malloc_resize(cur->data, n->dtalen);
+        cur->datamalloclen = n->dtalen;
+    }
+    if (cur->key == NULL || cur->data == NULL) {
+        cur->valid = 0;
+        return -1;
+    }
+    memcpy(cur->key, SKIP_KEY(n), n->keylen);
+    memcpy(cur->data, n->dta, n->dtalen);
+    cur->keylen = n->keylen;
+    cur->datalen = n->dtalen;
+    cur->node = n;
+    cur->node_deleted = 0;
+    cur->valid = 1;
+    return 0;
+}
+
+static int bdb_skiplist_copy_to_temp_db(bdb_state_type *bdb_state,
+                                        struct temp_table *tbl, int *bdberr)
+{
+    int rc = 0;
+    DBT dbt_key, dbt_data;
+    struct temp_cursor *cur;
+    skip_node_t *n;
+    unsigned long long nents = tbl->num_mem_entries;
+    unsigned long long rowid = tbl->rowid;
+
+    /* creating the env resets the table; the rowids handed out so far are
+       already keys in the skiplist */
+    if (tbl->dbenv_temp == NULL &&
+        (rc = create_temp_db_env(bdb_state, tbl, bdberr)) != 0) {
+        logmsg(LOGMSG_ERROR, "%s: create_temp_db_env rc %d\n", __func__, rc);
+        return rc;
+    }
+    tbl->rowid = rowid;
+
+    bzero(&dbt_key, sizeof(DBT));
+    bzero(&dbt_data, sizeof(DBT));
+    dbt_key.flags = dbt_data.flags = DB_DBT_USERMEM;
+
+    /* entries come out in order, so this only ever appends */
+    for (n = tbl->skip_head->next[0]; n; n = n->next[0]) {
+        dbt_key.ulen = dbt_key.size = n->keylen;
+        dbt_key.data = SKIP_KEY(n);
+        dbt_data.ulen = dbt_data.size = n->dtalen;
+        dbt_data.data = n->dta;
+
+        rc = tbl->tmpdb->put(tbl->tmpdb, NULL, &dbt_key, &dbt_data, 0);
+        if (rc) {
+            logmsg(LOGMSG_ERROR, "%s:%d put rc %d\n", __FILE__, __LINE__, rc);
+            *bdberr = rc;
+            return rc;
+        }
+    }
+
+    /* Move every open cursor onto a berkdb cursor at the same entry. A
+       cursor parked after a delete is put on the entry preceding the deleted
+       one and remembers it is parked: next moves on from there, prev returns
+       that entry itself. */
+    LISTC_FOR_EACH(&tbl->cursors, cur, lnk)
+    {
+        rc = tbl->tmpdb->cursor(tbl->tmpdb, NULL, &cur->cur, 0);
+        if (rc) {
+            cur->cur = NULL;
+            logmsg(LOGMSG_ERROR, "%s:%d cursor rc %d\n", __FILE__, __LINE__,
+                   rc);
+            *bdberr = rc;
+            return rc;
+        }
+
+        if (cur->node_deleted)
+            cur->parked = (cur->node == tbl->skip_head) ? CUR_PARKED_HEAD
+                                                        : CUR_PARKED_PREV;
+        if (cur->valid && cur->node && cur->node != tbl->skip_head) {
+            bzero(&dbt_key, sizeof(DBT));
+            bzero(&dbt_data, sizeof(DBT));
+            dbt_key.data = SKIP_KEY(cur->node);
+            dbt_key.size = cur->node->keylen;
+            dbt_data.flags = DB_DBT_USERMEM | DB_DBT_PARTIAL;
+
+            rc = cur->cur->c_get(cur->cur, &dbt_key, &dbt_data, DB_SET);
+            if (rc) {
+                logmsg(LOGMSG_ERROR, "%s:%d c_get rc %d\n", __FILE__, __LINE__,
+                       rc);
+                *bdberr = rc;
+                return rc;
+            }
+        }
+        cur->node = NULL;
+        cur->node_deleted = 0;
+    }
+
+    skiplist_clear(tbl);
+    tbl->num_mem_entries = nents;
+
+    /* its now a btree! */
+    tbl->temp_table_type = TEMP_TABLE_TYPE_BTREE;
+    return 0;
+}
+
+static inline void hashjoin_put_hash(uint8_t *buf, uint32_t hash)
+{
+    buf[0] = hash >> 24;
+    buf[1] = hash >> 16;
+    buf[2] = hash >> 8;
+    buf[3] = hash;
+}
+
+static inline uint32_t hashjoin_get_hash(const uint8_t *buf)
+{
+    return ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16) |
+           ((uint32_t)buf[2] << 8) | buf[3];
+}
+
+static int hashjoin_spill_put(struct temp_table *tbl, uint32_t hash,
+                              const void *key, int keylen, int *bdberr)
+{
+    DBT dbt_key, dbt_data;
+    uint8_t *buf;
+    int rc;
+
+    buf = malloc(sizeof(uint32_t) + keylen);
+    if (buf == NULL) {
+        *bdberr = BDBERR_MALLOC;
+        return -1;
+    }
+    hashjoin_put_hash(buf, hash);
+    memcpy(buf + sizeof(uint32_t), key, keylen);
+
+    bzero(&dbt_key, sizeof(DBT));
+    bzero(&dbt_data, sizeof(DBT));
+    dbt_key.data = buf;
+    dbt_key.size = sizeof(uint32_t) + keylen;
+
+    rc = tbl->tmpdb->put(tbl->tmpdb, NULL, &dbt_key, &dbt_data, 0);
+    free(buf);
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "%s:%d put rc %d\n", __FILE__, __LINE__, rc);
+        *bdberr = rc;
+        return -1;
+    }
+    return 0;
+}
+
+static int bdb_hashjoin_copy_to_temp_db(bdb_state_type *bdb_state,
+                                        struct temp_table *tbl, int *bdberr)
+{
+    int rc;
+    void *ent;
+    unsigned int bkt;
+    hj_entry_t *head, *e;
+    unsigned long long nents = tbl->num_mem_entries;
+
+    if (tbl->dbenv_temp == NULL &&
+        (rc = create_temp_db_env(bdb_state, tbl, bdberr)) != 0) {
+        logmsg(LOGMSG_ERROR, "%s: create_temp_db_env rc %d\n", __func__, rc);
+        return rc;
+    }
+
+    /* The build side is done before anything probes it, but drop whatever
+       the cursors point at: the arena is going away. */
+    rc = bdb_temp_table_reset_cursors(bdb_state, tbl, bdberr);
+    if (rc)
+        return rc;
+
+    for (head = hash_first(tbl->hj_hash, &ent, &bkt); head;
+         head = hash_next(tbl->hj_hash, &ent, &bkt)) {
+        for (e = head; e; e = e->next) {
+            rc = hashjoin_spill_put(tbl, e->hash, e->key, e->keylen, bdberr);
+            if (rc)
+                return rc;
+        }
+    }
+
+    hash_clear(tbl->hj_hash);
+    arena_clear(tbl);
+    tbl->num_mem_entries = nents;
+    tbl->hj_spilled = 1;
+    return 0;
+}
+
+static int hashjoin_set_cur(struct temp_cursor *cur, hj_entry_t *e)
+{
+    cur->hj_ent = e;
+    if (e == NULL) {
+        cur->valid = 0;
+        return IX_PASTEOF;
+    }
+    cur->key = e->key;
+    cur->keylen = e->keylen;
+    cur->data = NULL;
+    cur->datalen = 0;
+    cur->hj_chain = e->hash;
+    cur->valid = 1;
+    return IX_FND;
+}
+
+/* Step the berkdb cursor of a spilled hash join table (DB_SET_RANGE on a
+   hash prefix, DB_FIRST or DB_NEXT). In chain mode an entry with a
+   different hash ends the chain. */
+static int hashjoin_spill_get(struct temp_cursor *cur, uint32_t hash, int how,
+                              int *bdberr)
+{
+    DBT dkey, ddata;
+    int rc;
+
+    REOPEN_CURSOR(cur);
+
+    bzero(&dkey, sizeof(DBT));
+    bzero(&ddata, sizeof(DBT));
+    dkey.flags = DB_DBT_REALLOC;
+    ddata.flags = DB_DBT_USERMEM | DB_DBT_PARTIAL;
+
+    if (how == DB_SET_RANGE) {
+        void *buf = realloc(cur->hj_buf, sizeof(uint32_t));
+        if (buf == NULL) {
+            *bdberr = BDBERR_MALLOC;
+            return -1;
+        }
+        cur->hj_buf = buf;
+        hashjoin_put_hash(buf, hash);
+        dkey.size = sizeof(uint32_t);
+    }
+    dkey.data = cur->hj_buf;
+
+    cur->valid = 0;
+    rc = cur->cur->c_get(cur->cur, &dkey, &ddata, how);
+    cur->hj_buf = dkey.data;
+    if (rc == DB_NOTFOUND)
+        return IX_PASTEOF;
+    if (rc) {
+        *bdberr = rc;
+        return -1;
+    }
+
+    if (cur->hj_mode == HJ_CHAIN && hashjoin_get_hash(cur->hj_buf) != hash)
+        return IX_PASTEOF;
+    cur->hj_chain = hashjoin_get_hash(cur->hj_buf);
+
+    cur->key = (uint8_t *)cur->hj_buf + sizeof(uint32_t);
+    cur->keylen = dkey.size - sizeof(uint32_t);
+    cur->data = NULL;
+    cur->datalen = 0;
+    cur->valid = 1;
+    return IX_FND;
+}
+
+static int hashjoin_seek_chain(struct temp_cursor *cur, uint32_t hash,
+                               int *bdberr)
+{
+    if (cur->tbl->hj_spilled)
+        return hashjoin_spill_get(cur, hash, DB_SET_RANGE, bdberr);
+    return hashjoin_set_cur(cur, hash_find(cur->tbl->hj_hash, &hash));
+}
+
+static int hashjoin_first(struct temp_cursor *cur, int *bdberr)
+{
+    struct temp_table *tbl = cur->tbl;
+
+    cur->hj_mode = HJ_SCAN;
+    if (tbl->num_mem_entries == 0) {
+        cur->valid = 0;
+        return IX_EMPTY;
+    }
+    if (tbl->hj_spilled)
+        return hashjoin_spill_get(cur, 0, DB_FIRST, bdberr);
+    return hashjoin_set_cur(
+        cur, hash_first(tbl->hj_hash, &cur->hash_cur, &cur->hash_cur_buk));
+}
+
+static int hashjoin_next(struct temp_cursor *cur, int *bdberr)
+{
+    struct temp_table *tbl = cur->tbl;
+    hj_entry_t *e;
+    int rc;
+
+    if (cur->hj_mode == HJ_SCAN) {
+        if (tbl->hj_spilled)
+            return hashjoin_spill_get(cur, 0, DB_NEXT, bdberr);
+        e = cur->hj_ent->next;
+        if (e == NULL)
+            e = hash_next(tbl->hj_hash, &cur->hash_cur, &cur->hash_cur_buk);
+        return hashjoin_set_cur(cur, e);
+    }
+
+    if (tbl->hj_spilled)
+        rc = hashjoin_spill_get(cur, cur->hj_chain, DB_NEXT, bdberr);
+    else
+        rc = hashjoin_set_cur(cur, cur->hj_ent->next);
+
+    /* done with the probe's chain; the unhashed keys are left */
+    if (rc == IX_PASTEOF && cur->hj_chain == cur->hj_hash && cur->hj_hash != 0)
+        rc = hashjoin_seek_chain(cur, 0, bdberr);
+    return rc;
+}
+
 static int bdb_temp_table_init_temp_db(bdb_state_type *bdb_state,
                                        struct temp_table *tbl, int *bdberr)
 {
@@ -779,6 +1349,32 @@ static struct temp_table *bdb_temp_table_create_type(bdb_state_type *bdb_state,
                 }
             }
             break;
+        case TEMP_TABLE_TYPE_SKIPLIST:
+            if (table->skip_head == NULL) {
+                table->skip_head =
+                    calloc(1, offsetof(skip_node_t, next) +
+                                  SKIPLIST_MAXLEVEL * sizeof(skip_node_t *));
+                if (table->skip_head == NULL) {
+                    bdb_temp_table_destroy_pool_wrapper(table, bdb_state);
+                    return NULL;
+                }
+                table->skip_head->level = SKIPLIST_MAXLEVEL;
+                table->skip_seed = (table->tblid * 2654435761U) | 1;
+            }
+            table->skip_level = 1;
+            table->skiplist_maxsz = bdb_state->attr->temptable_skiplist_maxsz;
+            break;
+        case TEMP_TABLE_TYPE_HASHJOIN:
+            if (table->hj_hash == NULL) {
+                table->hj_hash = hash_init_i4(offsetof(hj_entry_t, hash));
+                if (table->hj_hash == NULL) {
+                    bdb_temp_table_destroy_pool_wrapper(table, bdb_state);
+                    return NULL;
+                }
+            }
+            table->hj_spilled = 0;
+            table->hashjoin_maxsz = bdb_state->attr->temptable_hashjoin_maxsz;
+            break;
         }
 
         table->num_mem_entries = 0;
@@ -794,7 +1390,10 @@ struct temp_table *bdb_temp_table_create_flags(bdb_state_type *bdb_state,
 {
     int temptype;
 
-    temptype = TEMP_TABLE_TYPE_BTREE;
+    if ((flags & BDB_TEMP_TABLE_SKIPLIST) && bdb_state->attr->temptable_skiplist)
+        temptype = TEMP_TABLE_TYPE_SKIPLIST;
+    else
+        temptype = TEMP_TABLE_TYPE_BTREE;
 
     return bdb_temp_table_create_type(bdb_state, temptype, bdberr);
 }
@@ -810,11 +1409,30 @@ struct temp_table *bdb_temp_hashtable_create(bdb_state_type *bdb_state,
     return bdb_temp_table_create_type(bdb_state, TEMP_TABLE_TYPE_HASH, bdberr);
 }
 
+struct temp_table *bdb_temp_hashjoin_create(bdb_state_type *bdb_state,
+                                            int *bdberr)
+{
+    return bdb_temp_table_create_type(bdb_state, TEMP_TABLE_TYPE_HASHJOIN,
+                                      bdberr);
+}
+
 struct temp_table *bdb_temp_array_create(bdb_state_type *bdb_state, int *bdberr)
 {
     return bdb_temp_table_create_type(bdb_state, TEMP_TABLE_TYPE_ARRAY, bdberr);
 }
 
+/* Like bdb_temp_array_create, but BDB_TEMP_TABLE_SKIPLIST asks for a
+   skiplist instead. Only for users whose keys are unique: an array keeps
+   every duplicate until it spills, a skiplist replaces the data. */
+struct temp_table *bdb_temp_array_create_flags(bdb_state_type *bdb_state,
+                                               int flags, int *bdberr)
+{
+    if ((flags & BDB_TEMP_TABLE_SKIPLIST) && bdb_state->attr->temptable_skiplist)
+        return bdb_temp_table_create_type(bdb_state, TEMP_TABLE_TYPE_SKIPLIST,
+                                          bdberr);
+    return bdb_temp_array_create(bdb_state, bdberr);
+}
+
 struct temp_cursor *bdb_temp_table_cursor(bdb_state_type *bdb_state,
                                           struct temp_table *tbl, void *usermem,
                                           int *bdberr)
@@ -842,6 +1460,17 @@ struct temp_cursor *bdb_temp_table_cursor(bdb_state_type *bdb_state,
     case TEMP_TABLE_TYPE_ARRAY:
         cur->ind = 0;
         break;
+
+    case TEMP_TABLE_TYPE_SKIPLIST:
+        cur->node = NULL;
+        cur->node_deleted = 0;
+        break;
+
+    case TEMP_TABLE_TYPE_HASHJOIN:
+        /* a spilled table gets its berkdb cursor on first use */
+        cur->hj_ent = NULL;
+        cur->hj_mode = HJ_NONE;
+        break;
     }
 
     if (rc) {
@@ -875,11 +1504,12 @@ int bdb_temp_table_insert(bdb_state_type *bdb_state, struct temp_cursor *cur,
     struct temp_table *tbl = cur->tbl;
 
     int rc = bdb_temp_table_insert_put(bdb_state, tbl, key, keylen, data,
-                                       dtalen, bdberr);
+                                       dtalen, NULL, bdberr);
     if (rc <= 0)
         goto done;
 
     REOPEN_CURSOR(cur);
+    cur->parked = CUR_PARKED_NONE;
 
     /*Pthread_setspecific(cur->tbl->curkey, cur);*/
     memset(&dkey, 0, sizeof(DBT));
@@ -914,13 +1544,29 @@ int bdb_temp_table_update(bdb_state_type *bdb_state, struct temp_cursor *cur,
     arr_elem_t *elem;
     uint8_t *keycopy, *dtacopy;
 
-    if (cur->tbl->temp_table_type != TEMP_TABLE_TYPE_BTREE &&
-        cur->tbl->temp_table_type != TEMP_TABLE_TYPE_ARRAY) {
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_HASHJOIN) {
+        logmsg(LOGMSG_ERROR, "%s: operation not supported for hash join "
+                             "tables\n", __func__);
+        return -1;
+    }
+
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_HASH) {
         logmsg(LOGMSG_ERROR, "bdb_temp_table_update operation "
-                             "only supported for btree or array.\n");
+                             "not supported for hash.\n");
         return -1;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_SKIPLIST) {
+        /* like DB_CURRENT, replace the data and keep the key */
+        if (!cur->valid || cur->node_deleted)
+            return -1;
+        if (skiplist_set_data(cur->tbl, cur->node, data, dtalen)) {
+            *bdberr = BDBERR_MALLOC;
+            return -1;
+        }
+        return 0;
+    }
+
     if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_ARRAY) {
         if (!cur->valid)
             return -1;
@@ -946,6 +1592,9 @@ int bdb_temp_table_update(bdb_state_type *bdb_state, struct temp_cursor *cur,
         cur->tbl->inmemsz += (elem->keylen + elem->dtalen);
     }
 
+    if (cur->parked != CUR_PARKED_NONE)
+        return -1;
+
     REOPEN_CURSOR(cur);
 
     /*Pthread_setspecific(cur->tbl->curkey, cur);*/
@@ -996,9 +1645,18 @@ unsigned long long bdb_temp_table_new_rowid(struct temp_table *tbl)
         if (tbl->num_mem_entries == 0)
             tbl->rowid = 0;
         break;
+    case TEMP_TABLE_TYPE_SKIPLIST:
+        if (tbl->skip_head->next[0] == NULL)
+            tbl->rowid = 0;
+        break;
     case TEMP_TABLE_TYPE_HASH:
         if (hash_first(tbl->temp_hash_tbl, &ent, &bkt) == NULL)
             tbl->rowid = 0;
+        break;
+    case TEMP_TABLE_TYPE_HASHJOIN:
+        if (tbl->num_mem_entries == 0)
+            tbl->rowid = 0;
+        break;
     }
 
     return ++tbl->rowid;
@@ -1011,30 +1669,106 @@ int bdb_temp_table_put(bdb_state_type *bdb_state, struct temp_table *tbl,
     DBT dkey, ddata;
 
     int rc = bdb_temp_table_insert_put(bdb_state, tbl, key, keylen, data,
-                                       dtalen, bdberr);
+                                       dtalen, unpacked, bdberr);
     if (rc <= 0)
         goto done;
 
-    memset(&dkey, 0, sizeof(DBT));
-    memset(&ddata, 0, sizeof(DBT));
-    dkey.flags = ddata.flags = DB_DBT_USERMEM;
-    dkey.ulen = dkey.size = keylen;
-    ddata.ulen = ddata.size = dtalen;
-    ddata.data = data;
-    dkey.data = key;
-    dkey.app_data = unpacked;
+    memset(&dkey, 0, sizeof(DBT));
+    memset(&ddata, 0, sizeof(DBT));
+    dkey.flags = ddata.flags = DB_DBT_USERMEM;
+    dkey.ulen = dkey.size = keylen;
+    ddata.ulen = ddata.size = dtalen;
+    ddata.data = data;
+    dkey.data = key;
+    dkey.app_data = unpacked;
+
+    rc = tbl->tmpdb->put(tbl->tmpdb, NULL, &dkey, &ddata, 0);
+    if (rc) {
+        *bdberr = rc;
+        rc = -1;
+        goto done;
+    }
+
+done:
+    dbghexdump(3, key, keylen);
+    dbgtrace(3, "temp_table_insert = %d\n", rc);
+    return rc;
+}
+
+int bdb_temp_hashjoin_put(bdb_state_type *bdb_state, struct temp_table *tbl,
+                          uint32_t hash, void *key, int keylen, int *bdberr)
+{
+    hj_entry_t *e, *head;
+    int rc;
+
+    if (tbl->temp_table_type != TEMP_TABLE_TYPE_HASHJOIN) {
+        logmsg(LOGMSG_ERROR, "%s: not a hash join table\n", __func__);
+        *bdberr = BDBERR_BADARGS;
+        return -1;
+    }
+
+    if (tbl->hj_spilled) {
+        rc = hashjoin_spill_put(tbl, hash, key, keylen, bdberr);
+        if (rc == 0)
+            tbl->num_mem_entries++;
+        return rc;
+    }
+
+    e = skiplist_arena_alloc(tbl, offsetof(hj_entry_t, key) + keylen);
+    if (e == NULL) {
+        *bdberr = BDBERR_MALLOC;
+        return -1;
+    }
+    e->hash = hash;
+    e->keylen = keylen;
+    e->next = NULL;
+    memcpy(e->key, key, keylen);
+
+    /* order within a chain does not matter, keep the head where it is */
+    if ((head = hash_find(tbl->hj_hash, &hash)) != NULL) {
+        e->next = head->next;
+        head->next = e;
+    } else if (hash_add(tbl->hj_hash, e) != 0) {
+        *bdberr = BDBERR_MALLOC;
+        return -1;
+    }
+    tbl->num_mem_entries++;
+
+    if (tbl->inmemsz > tbl->hashjoin_maxsz) {
+        gbl_temptable_spills++;
+        rc = bdb_hashjoin_copy_to_temp_db(bdb_state, tbl, bdberr);
+        if (unlikely(rc)) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* Position on the first entry hashed to `hash'; a following next returns
+   the rest of the chain, then the unhashed keys. Returns IX_NOTFND if there
+   are none. */
+int bdb_temp_hashjoin_find(bdb_state_type *bdb_state, struct temp_cursor *cur,
+                           uint32_t hash, int *bdberr)
+{
+    int rc;
 
-    rc = tbl->tmpdb->put(tbl->tmpdb, NULL, &dkey, &ddata, 0);
-    if (rc) {
-        *bdberr = rc;
-        rc = -1;
-        goto done;
+    if (cur->tbl->temp_table_type != TEMP_TABLE_TYPE_HASHJOIN) {
+        logmsg(LOGMSG_ERROR, "%s: not a hash join table\n", __func__);
+        *bdberr = BDBERR_BADARGS;
+        return -1;
     }
 
-done:
-    dbghexdump(3, key, keylen);
-    dbgtrace(3, "temp_table_insert = %d\n", rc);
-    return rc;
+    cur->valid = 0;
+    if (cur->tbl->num_mem_entries == 0)
+        return IX_EMPTY;
+
+    cur->hj_mode = HJ_CHAIN;
+    cur->hj_hash = hash;
+    rc = hashjoin_seek_chain(cur, hash, bdberr);
+    if (rc == IX_PASTEOF && hash != 0)
+        rc = hashjoin_seek_chain(cur, 0, bdberr);
+    return (rc == IX_PASTEOF) ? IX_NOTFND : rc;
 }
 
 static int bdb_temp_table_first_last(bdb_state_type *bdb_state,
@@ -1068,6 +1802,15 @@ static int bdb_temp_table_first_last(bdb_state_type *bdb_state,
         return 0;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_HASHJOIN) {
+        if (how != DB_FIRST) {
+            logmsg(LOGMSG_ERROR, "%s: operation not supported for hash join "
+                                 "tables\n", __func__);
+            return -1;
+        }
+        return hashjoin_first(cur, bdberr);
+    }
+
     if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_ARRAY) {
         arrlen = cur->tbl->num_mem_entries;
         if (arrlen == 0) {
@@ -1080,7 +1823,20 @@ static int bdb_temp_table_first_last(bdb_state_type *bdb_state,
         return 0;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_SKIPLIST) {
+        skip_node_t *n = (how == DB_LAST) ? skiplist_last(cur->tbl)
+                                          : cur->tbl->skip_head->next[0];
+        cur->node = NULL;
+        cur->node_deleted = 0;
+        if (n == NULL) {
+            cur->valid = 0;
+            return IX_EMPTY;
+        }
+        return skiplist_copy_to_cur(cur, n);
+    }
+
     REOPEN_CURSOR(cur);
+    cur->parked = CUR_PARKED_NONE;
 
     /*Pthread_setspecific(cur->tbl->curkey, cur);*/
 
@@ -1151,6 +1907,15 @@ static int bdb_temp_table_next_prev_norewind(bdb_state_type *bdb_state,
         return 0;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_HASHJOIN) {
+        if (how != DB_NEXT) {
+            logmsg(LOGMSG_ERROR, "%s: operation not supported for hash join "
+                                 "tables\n", __func__);
+            return -1;
+        }
+        return hashjoin_next(cur, bdberr);
+    }
+
     if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_ARRAY) {
         if ((how == DB_NEXT && ++cur->ind >= cur->tbl->num_mem_entries) ||
             (how == DB_PREV && --cur->ind < 0)) {
@@ -1162,8 +1927,32 @@ static int bdb_temp_table_next_prev_norewind(bdb_state_type *bdb_state,
         return 0;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_SKIPLIST) {
+        skip_node_t *n;
+        /* A parked cursor sits on the node preceding a deleted one. */
+        if (how == DB_NEXT)
+            n = cur->node->next[0];
+        else
+            n = cur->node_deleted ? cur->node : cur->node->prev;
+        if (n == NULL || n == cur->tbl->skip_head)
+            return IX_PASTEOF;
+        return skiplist_copy_to_cur(cur, n);
+    }
+
     REOPEN_CURSOR(cur);
 
+    /* The berkdb cursor of a cursor parked before the spill stands on the
+       entry preceding the deleted one, or nowhere if there was none. */
+    if (cur->parked != CUR_PARKED_NONE) {
+        int parked = cur->parked;
+        cur->parked = CUR_PARKED_NONE;
+        if (how == DB_PREV) {
+            if (parked == CUR_PARKED_HEAD)
+                return IX_PASTEOF;
+            how = DB_CURRENT;
+        }
+    }
+
     /*Pthread_setspecific(cur->tbl->curkey, cur);*/
 
     memset(&dkey, 0, sizeof(DBT));
@@ -1430,6 +2219,28 @@ int bdb_temp_table_truncate(bdb_state_type *bdb_state, struct temp_table *tbl,
         tbl->num_mem_entries = 0;
         break;
 
+    case TEMP_TABLE_TYPE_SKIPLIST:
+        rc = bdb_temp_table_reset_cursors(bdb_state, tbl, bdberr);
+        skiplist_clear(tbl);
+        if (rc) {
+            rc = -1;
+            goto done;
+        }
+        break;
+
+    case TEMP_TABLE_TYPE_HASHJOIN:
+        rc = bdb_temp_table_reset_cursors(bdb_state, tbl, bdberr);
+        hash_clear(tbl->hj_hash);
+        arena_clear(tbl);
+        if (rc == 0 && tbl->hj_spilled)
+            rc = bdb_temp_table_init_temp_db(bdb_state, tbl, bdberr);
+        tbl->hj_spilled = 0;
+        if (rc) {
+            rc = -1;
+            goto done;
+        }
+        break;
+
     case TEMP_TABLE_TYPE_BTREE:
         rc = tbl->tmpdb->size(tbl->tmpdb, &sz);
         if (tbl->num_mem_entries < 100 && (rc == 0 && sz < gbl_temptable_recreate_size))
@@ -1663,13 +2474,25 @@ int bdb_temp_table_destroy_lru(struct temp_table *tbl,
         }
         break;
 
+    case TEMP_TABLE_TYPE_SKIPLIST:
+        skiplist_clear(tbl);
+        break;
+
+    case TEMP_TABLE_TYPE_HASHJOIN:
+        hash_clear(tbl->hj_hash);
+        arena_clear(tbl);
+        break;
+
     case TEMP_TABLE_TYPE_BTREE:
         break;
     }
 
     if (tbl->temp_hash_tbl != NULL)
         hash_free(tbl->temp_hash_tbl);
+    if (tbl->hj_hash != NULL)
+        hash_free(tbl->hj_hash);
     free(tbl->elements);
+    free(tbl->skip_head);
 
     /* close the environments*/
     if (tbl->dbenv_temp != NULL)
@@ -1715,6 +2538,12 @@ int bdb_temp_table_delete(bdb_state_type *bdb_state, struct temp_cursor *cur,
         goto done;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_HASHJOIN) {
+        logmsg(LOGMSG_ERROR, "%s: operation not supported for hash join "
+                             "tables\n", __func__);
+        return -1;
+    }
+
     if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_HASH) {
         // AZ: address of data returned by hash_find: cur->key - sizeof(int)
         rc = hash_del(cur->tbl->temp_hash_tbl, cur->key - sizeof(int));
@@ -1740,6 +2569,36 @@ int bdb_temp_table_delete(bdb_state_type *bdb_state, struct temp_cursor *cur,
         goto done;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_SKIPLIST) {
+        skip_node_t *n = cur->node;
+        if (cur->node_deleted) {
+            *bdberr = DB_KEYEMPTY;
+            return -1;
+        }
+        /* not on an entry, e.g. after a search that missed */
+        if (n == NULL || n == cur->tbl->skip_head) {
+            *bdberr = DB_NOTFOUND;
+            return -1;
+        }
+        skiplist_unlink(cur->tbl, n);
+        /* Park every cursor on the deleted node on its predecessor; the
+           node memory stays valid until the arena is released. */
+        LISTC_FOR_EACH(&cur->tbl->cursors, opencur, lnk)
+        {
+            if (opencur->node == n) {
+                opencur->node = n->prev;
+                opencur->node_deleted = 1;
+            }
+        }
+        rc = 0;
+        goto done;
+    }
+
+    if (cur->parked != CUR_PARKED_NONE) {
+        *bdberr = DB_KEYEMPTY;
+        return -1;
+    }
+
     REOPEN_CURSOR(cur);
 
     rc = cur->cur->c_del(cur->cur, 0);
@@ -1758,6 +2617,9 @@ done:
 
 void bdb_temp_table_set_cmp_func(struct temp_table *tbl, tmptbl_cmp cmpfunc)
 {
+    /* spilled hash join keys are hash prefixed, they sort by memcmp */
+    if (tbl->temp_table_type == TEMP_TABLE_TYPE_HASHJOIN)
+        return;
     tbl->cmpfunc = cmpfunc;
     /* default to memcmp semantics (for keys) */
     if (tbl->cmpfunc == NULL)
@@ -1839,6 +2701,12 @@ int bdb_temp_table_find(bdb_state_type *bdb_state, struct temp_cursor *cur,
     arr_elem_t *elem;
     DBT dkey, ddata;
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_HASHJOIN) {
+        logmsg(LOGMSG_ERROR, "%s: operation not supported for hash join "
+                             "tables\n", __func__);
+        return -1;
+    }
+
     if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_HASH) {
         return bdb_temp_table_find_hash(cur, key, keylen);
     }
@@ -1886,7 +2754,23 @@ int bdb_temp_table_find(bdb_state_type *bdb_state, struct temp_cursor *cur,
         return 0;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_SKIPLIST) {
+        skip_node_t *n;
+        cur->valid = 0;
+        cur->node = NULL;
+        cur->node_deleted = 0;
+        if (cur->tbl->skip_head->next[0] == NULL)
+            return IX_EMPTY;
+        n = skiplist_seek(cur->tbl, key, keylen, unpacked, NULL);
+        /* find anything at all if possible, same as the btree */
+        if (n == NULL)
+            n = skiplist_last(cur->tbl);
+        rc = skiplist_copy_to_cur(cur, n);
+        goto done;
+    }
+
     REOPEN_CURSOR(cur);
+    cur->parked = CUR_PARKED_NONE;
 
     /*Pthread_setspecific(cur->tbl->curkey, cur);*/
 
@@ -1989,6 +2873,12 @@ int bdb_temp_table_find_exact(bdb_state_type *bdb_state,
     arr_elem_t *elem;
     void *keydup;
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_HASHJOIN) {
+        logmsg(LOGMSG_ERROR, "%s: operation not supported for hash join "
+                             "tables\n", __func__);
+        return -1;
+    }
+
     if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_HASH) {
         return bdb_temp_table_find_exact_hash(cur, key, keylen);
     }
@@ -2032,7 +2922,19 @@ int bdb_temp_table_find_exact(bdb_state_type *bdb_state,
         return 0;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_SKIPLIST) {
+        skip_node_t *n = skiplist_seek(cur->tbl, key, keylen, NULL, NULL);
+        cur->node = NULL;
+        cur->node_deleted = 0;
+        if (n == NULL || skiplist_cmp(cur->tbl, n, key, keylen, NULL) != 0) {
+            cur->valid = 0;
+            return IX_NOTFND;
+        }
+        return skiplist_copy_to_cur(cur, n) ? -1 : IX_FND;
+    }
+
     REOPEN_CURSOR(cur);
+    cur->parked = CUR_PARKED_NONE;
 
     /* Make a copy of the user key */
     if ((keydup = malloc(keylen)) == NULL)
@@ -2112,7 +3014,8 @@ static int bdb_temp_table_reset_cursor(bdb_state_type *bdb_state, struct temp_cu
     tbl = cur->tbl;
 
     if (tbl->temp_table_type == TEMP_TABLE_TYPE_BTREE ||
-        tbl->temp_table_type == TEMP_TABLE_TYPE_ARRAY) {
+        tbl->temp_table_type == TEMP_TABLE_TYPE_ARRAY ||
+        tbl->temp_table_type == TEMP_TABLE_TYPE_SKIPLIST) {
         if (cur->key) {
             free(cur->key);
             cur->key = NULL;
@@ -2123,7 +3026,36 @@ static int bdb_temp_table_reset_cursor(bdb_state_type *bdb_state, struct temp_cu
             cur->data = NULL;
         }
 
+        cur->keymalloclen = cur->datamalloclen = 0;
+
+        /* The skiplist nodes are about to go away. */
+        if (tbl->temp_table_type == TEMP_TABLE_TYPE_SKIPLIST) {
+            cur->node = NULL;
+            cur->node_deleted = 0;
+            cur->valid = 0;
+        }
+
+        cur->parked = CUR_PARKED_NONE;
+
         /* A cursor on a temparray will not have `cur'. */
+        if (cur->cur) {
+            rc = cur->cur->c_close(cur->cur);
+            if (rc) {
+                *bdberr = rc;
+                rc = -1;
+            }
+            cur->cur = NULL;
+        }
+    } else if (tbl->temp_table_type == TEMP_TABLE_TYPE_HASHJOIN) {
+        /* the key points into the arena or hj_buf */
+        cur->key = NULL;
+        cur->keylen = 0;
+        cur->valid = 0;
+        cur->hj_ent = NULL;
+        cur->hj_mode = HJ_NONE;
+        free(cur->hj_buf);
+        cur->hj_buf = NULL;
+
         if (cur->cur) {
             rc = cur->cur->c_close(cur->cur);
             if (rc) {
@@ -2216,6 +3148,11 @@ inline int bdb_is_hashtable(struct temp_table *tt)
     return (tt->temp_table_type == TEMP_TABLE_TYPE_HASH);
 }
 
+inline int bdb_is_hashjoin(struct temp_table *tt)
+{
+    return (tt->temp_table_type == TEMP_TABLE_TYPE_HASHJOIN);
+}
+
 int bdb_temp_table_maybe_set_priority_thread(bdb_state_type *bdb_state)
 {
     int rc = TMPTBL_WAIT;
@@ -2280,13 +3217,20 @@ int bdb_temp_table_maybe_reset_priority_thread(bdb_state_type *bdb_state,
 static int bdb_temp_table_insert_put(bdb_state_type *bdb_state,
                                      struct temp_table *tbl, void *key,
                                      int keylen, void *data, int dtalen,
-                                     int *bdberr)
+                                     void *unpacked, int *bdberr)
 {
     int rc, cmp, lo, hi, mid;
     tmptbl_cmp cmpfn;
     arr_elem_t *elem;
     uint8_t *keycopy, *dtacopy;
 
+    if (tbl->temp_table_type == TEMP_TABLE_TYPE_HASHJOIN) {
+        logmsg(LOGMSG_ERROR, "%s: use bdb_temp_hashjoin_put on hash join "
+                             "tables\n", __func__);
+        *bdberr = BDBERR_BADARGS;
+        return -1;
+    }
+
     if (tbl->temp_table_type == TEMP_TABLE_TYPE_HASH) {
         void *hash_data;
         void *old;
@@ -2375,6 +3319,24 @@ static int bdb_temp_table_insert_put(bdb_state_type *bdb_state,
         return 0;
     }
 
+    if (tbl->temp_table_type == TEMP_TABLE_TYPE_SKIPLIST) {
+        if (skiplist_insert(tbl, key, keylen, data, dtalen, unpacked) ==
+            NULL) {
+            *bdberr = BDBERR_MALLOC;
+            return -1;
+        }
+
+        if (tbl->inmemsz > tbl->skiplist_maxsz) {
+            gbl_temptable_spills++;
+            rc = bdb_skiplist_copy_to_temp_db(bdb_state, tbl, bdberr);
+            if (unlikely(rc)) {
+                return -1;
+            }
+        }
+
+        return 0;
+    }
+
     assert (tbl->temp_table_type == TEMP_TABLE_TYPE_BTREE);
     tbl->num_mem_entries++;
 
@@ -2457,17 +3419,27 @@ int bdb_temp_table_stat(bdb_state_type *bdb_state, DB_MPOOL_STAT **gspp)
 
 
 
-int bdb_temp_table_insert_test(bdb_state_type *bdb_state, int recsz, int maxins)
+static double temp_table_elapsed(struct timeval *t1, struct timeval *t2)
 {
-    bdb_state_type *parent;
-    if (bdb_state->parent)
-        parent = bdb_state->parent;
-    else
-        parent = bdb_state;
+    return (double)((t2->tv_sec - t1->tv_sec) * 1000000 +
+                    (t2->tv_usec - t1->tv_usec)) /
+           1000000;
+}
 
-    //create
-    int bdberr = 0;
-    struct temp_table *db = bdb_temp_table_create(parent, &bdberr);
+/* Time inserts, a full scan and a point lookup of every key against one
+   temp table engine. Both engines are fed the same keys. */
+static int bdb_temp_table_insert_test_type(bdb_state_type *parent,
+                                           int temp_table_type,
+                                           const char *name, uint8_t *rkey,
+                                           int recsz, int maxins)
+{
+    int rc, bdberr = 0;
+    unsigned int seed;
+    struct timeval t1, t2, t3, t4;
+    int64_t spills = gbl_temptable_spills;
+
+    struct temp_table *db =
+        bdb_temp_table_create_type(parent, temp_table_type, &bdberr);
     if (!db || bdberr) {
         logmsg(LOGMSG_ERROR, "%s: failed to create temp table bdberr=%d\n",
                __func__, bdberr);
@@ -2478,37 +3450,16 @@ int bdb_temp_table_insert_test(bdb_state_type *bdb_state, int recsz, int maxins)
     if (!cur) {
         logmsg(LOGMSG_ERROR, "%s: failed to create cursor bdberr=%d\n",
                __func__, bdberr);
+        bdb_temp_table_close(parent, db, &bdberr);
         return -1;
     }
 
-    if (recsz < 16) recsz = 16; //force it to be min 16 bytes
-    if (maxins > 10000000 || recsz * maxins > 100000000) {
-        logmsg(LOGMSG_USER, "Too much data to write %d records\n", maxins);
-        return -1; // limit the temptbl size
-    }
-
-    //read one random string into key, note that reading from urandom is
-    //slow so we get one full record from urandom, then override the first 
-    //4 byte from random()
-    int rc;
-    FILE *urandom;
-    if ((urandom = fopen("/dev/urandom", "r")) == NULL) {
-        logmsgperror("fopen");
-        return -2;
-    }
-
-    uint8_t rkey[recsz];
-    if ((rc = fread(rkey, sizeof(rkey), 1, urandom)) != 1 && ferror(urandom)) {
-        logmsgperror("fread");
-    }
-    fclose(urandom);
-
-    struct timeval t1;
     gettimeofday(&t1, NULL);
 
     //insert: replace first 4 bytes with a new random value, payload is same val
+    seed = 1;
     for (int cnt = 0; cnt < maxins; cnt++) {
-        int x = rand();
+        int x = rand_r(&seed);
         ((int *)rkey)[0] = 123456789;
         ((int *)rkey)[1] = 123456789;
         ((int *)rkey)[2] = 123456789;
@@ -2518,8 +3469,8 @@ int bdb_temp_table_insert_test(bdb_state_type *bdb_state, int recsz, int maxins)
          * rc = bdb_temp_table_put(parent, db, &rkey, sizeof(rkey),
          *                         &x, sizeof(x), NULL, &bdberr);
          */
-        rc = bdb_temp_table_insert(parent, cur, &rkey, sizeof(rkey),
-                                   &x, sizeof(x), &bdberr);
+        rc = bdb_temp_table_insert(parent, cur, rkey, recsz, &x, sizeof(x),
+                                   &bdberr);
         if (rc) {
             logmsg(LOGMSG_ERROR, 
                     "%s: fail to put into temp tbl rc=%d bdberr=%d\n",
@@ -2528,31 +3479,195 @@ int bdb_temp_table_insert_test(bdb_state_type *bdb_state, int recsz, int maxins)
         }
     }
 
+    gettimeofday(&t2, NULL);
+
     rc = bdb_temp_table_first(parent, cur, &bdberr);
     if (rc) {
         logmsg(LOGMSG_ERROR, "%s: first error bdberr=%d\n",
                __func__, bdberr);
-        return -1;
+        goto done;
     }
 
     while (rc == IX_OK) {
         uint8_t *keyp = bdb_temp_table_key(cur);
         uint8_t *datap = bdb_temp_table_data(cur);
-        if (((int *)keyp)[3] != *(int *)datap)
-            abort();
+        if (((int *)keyp)[3] != *(int *)datap) {
+            logmsg(LOGMSG_ERROR, "%s: %s scan returned mismatched data\n",
+                   __func__, name);
+            rc = -1;
+            goto done;
+        }
         rc = bdb_temp_table_next(parent, cur, &bdberr);
     }
 
-    struct timeval t2;
-    gettimeofday(&t2, NULL);
+    gettimeofday(&t3, NULL);
+
+    seed = 1;
+    for (int cnt = 0; cnt < maxins; cnt++) {
+        int x = rand_r(&seed);
+        ((int *)rkey)[3] = x;
+        rc = bdb_temp_table_find_exact(parent, cur, rkey, recsz, &bdberr);
+        if (rc != IX_FND || *(int *)bdb_temp_table_data(cur) != x) {
+            logmsg(LOGMSG_ERROR, "%s: %s lookup of record %d failed rc=%d\n",
+                   __func__, name, cnt, rc);
+            rc = -1;
+            goto done;
+        }
+    }
+
+    gettimeofday(&t4, NULL);
+
+    logmsg(LOGMSG_USER,
+           "%s: wrote %d records in %f sec, scanned in %f sec, "
+           "found in %f sec%s\n",
+           name, maxins, temp_table_elapsed(&t1, &t2),
+           temp_table_elapsed(&t2, &t3), temp_table_elapsed(&t3, &t4),
+           (gbl_temptable_spills != spills) ? " (spilled)" : "");
 
-    int sec = (t2.tv_sec - t1.tv_sec) * 1000000;
-    int msec = (t2.tv_usec - t1.tv_usec);
-    logmsg(LOGMSG_USER, "Wrote %d records in %f sec\n", maxins,
-           (float)(sec + msec) / 1000000);
+    /* the truncated table must come back empty and take new records */
+    rc = bdb_temp_table_truncate(parent, db, &bdberr);
+    if (rc == 0 && bdb_temp_table_first(parent, cur, &bdberr) != IX_EMPTY)
+        rc = -1;
+    for (int cnt = 0; rc == 0 && cnt < maxins; cnt++) {
+        ((int *)rkey)[3] = cnt;
+        rc = bdb_temp_table_insert(parent, cur, rkey, recsz, &cnt, sizeof(cnt),
+                                   &bdberr);
+    }
+    if (rc == 0) {
+        int cnt = 0;
+        for (rc = bdb_temp_table_first(parent, cur, &bdberr); rc == IX_OK;
+             rc = bdb_temp_table_next(parent, cur, &bdberr))
+            ++cnt;
+        rc = (rc == IX_PASTEOF && cnt == maxins) ? 0 : -1;
+    }
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "%s: %s truncate and reuse failed bdberr=%d\n",
+               __func__, name, bdberr);
+        goto done;
+    }
 
+done:
     //cleanup
-    rc = bdb_temp_table_close_cursor(parent, cur, &bdberr);
-    rc = bdb_temp_table_close(parent, db, &bdberr);
+    bdb_temp_table_close_cursor(parent, cur, &bdberr);
+    bdb_temp_table_close(parent, db, &bdberr);
+    return rc;
+}
+
+static int parked_test_key(struct temp_cursor *cur)
+{
+    return ntohl(*(int *)bdb_temp_table_key(cur));
+}
+
+/* Park cursors with deletes, spill the skiplist under them and check that
+   they move like berkdb cursors on a deleted entry, and that rowids keep
+   counting up across the spill. */
+static int bdb_temp_table_skiplist_spill_test(bdb_state_type *parent)
+{
+    struct temp_table *db;
+    struct temp_cursor *cur[4] = {0};
+    unsigned long long rowid;
+    int rc = -1, bdberr = 0, i, key;
+
+    db = bdb_temp_table_create_type(parent, TEMP_TABLE_TYPE_SKIPLIST, &bdberr);
+    if (db == NULL)
+        return -1;
+    for (i = 0; i < 4; i++) {
+        if ((cur[i] = bdb_temp_table_cursor(parent, db, NULL, &bdberr)) == NULL)
+            goto done;
+    }
+
+    for (i = 0; i < 100; i++) {
+        key = htonl(i);
+        if (bdb_temp_table_put(parent, db, &key, sizeof(key), &i, sizeof(i),
+                               NULL, &bdberr))
+            goto done;
+        bdb_temp_table_new_rowid(db);
+    }
+    rowid = bdb_temp_table_new_rowid(db);
+
+    /* cur[0..1] are parked on 49, cur[2..3] ahead of the first entry */
+    key = htonl(50);
+    if (bdb_temp_table_find_exact(parent, cur[0], &key, sizeof(key), &bdberr) !=
+            IX_FND ||
+        bdb_temp_table_find_exact(parent, cur[1], &key, sizeof(key), &bdberr) !=
+            IX_FND ||
+        bdb_temp_table_delete(parent, cur[0], &bdberr))
+        goto done;
+    key = htonl(0);
+    if (bdb_temp_table_find_exact(parent, cur[2], &key, sizeof(key), &bdberr) !=
+            IX_FND ||
+        bdb_temp_table_find_exact(parent, cur[3], &key, sizeof(key), &bdberr) !=
+            IX_FND ||
+        bdb_temp_table_delete(parent, cur[2], &bdberr))
+        goto done;
+
+    if (bdb_skiplist_copy_to_temp_db(parent, db, &bdberr))
+        goto done;
+
+    if (bdb_temp_table_new_rowid(db) != rowid + 1) {
+        logmsg(LOGMSG_ERROR, "%s: rowid restarted after spill\n", __func__);
+        goto done;
+    }
+    if (bdb_temp_table_prev(parent, cur[0], &bdberr) != IX_OK ||
+        parked_test_key(cur[0]) != 49 ||
+        bdb_temp_table_next(parent, cur[1], &bdberr) != IX_OK ||
+        parked_test_key(cur[1]) != 51 ||
+        bdb_temp_table_prev(parent, cur[2], &bdberr) != IX_PASTEOF ||
+        bdb_temp_table_next(parent, cur[3], &bdberr) != IX_OK ||
+        parked_test_key(cur[3]) != 1) {
+        logmsg(LOGMSG_ERROR, "%s: parked cursor moved wrong after spill\n",
+               __func__);
+        goto done;
+    }
+    rc = 0;
+
+done:
+    for (i = 0; i < 4; i++) {
+        if (cur[i])
+            bdb_temp_table_close_cursor(parent, cur[i], &bdberr);
+    }
+    bdb_temp_table_close(parent, db, &bdberr);
+    logmsg(LOGMSG_USER, "skiplist: parked cursor spill test %s\n",
+           rc ? "failed" : "passed");
+    return rc;
+}
+
+int bdb_temp_table_insert_test(bdb_state_type *bdb_state, int recsz, int maxins)
+{
+    bdb_state_type *parent;
+    if (bdb_state->parent)
+        parent = bdb_state->parent;
+    else
+        parent = bdb_state;
+
+    if (recsz < 16) recsz = 16; //force it to be min 16 bytes
+    if (maxins > 10000000 || recsz * maxins > 100000000) {
+        logmsg(LOGMSG_USER, "Too much data to write %d records\n", maxins);
+        return -1; // limit the temptbl size
+    }
+
+    //read one random string into key, note that reading from urandom is
+    //slow so we get one full record from urandom, then override the first 
+    //4 byte from random()
+    int rc;
+    FILE *urandom;
+    if ((urandom = fopen("/dev/urandom", "r")) == NULL) {
+        logmsgperror("fopen");
+        return -2;
+    }
+
+    uint8_t rkey[recsz];
+    if ((rc = fread(rkey, sizeof(rkey), 1, urandom)) != 1 && ferror(urandom)) {
+        logmsgperror("fread");
+    }
+    fclose(urandom);
+
+    rc = bdb_temp_table_insert_test_type(parent, TEMP_TABLE_TYPE_BTREE,
+                                         "btree", rkey, recsz, maxins);
+    if (rc == 0)
+        rc = bdb_temp_table_insert_test_type(parent, TEMP_TABLE_TYPE_SKIPLIST,
+                                             "skiplist", rkey, recsz, maxins);
+    if (rc == 0)
+        rc = bdb_temp_table_skiplist_spill_test(parent);
     return rc;
 }
@@ -0,0 +1,526 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Bottom-up btree loader.
+ *
+ * Keys are handed to __bam_bulk_put in strictly ascending order.  Leaf
+ * pages are packed in private buffers; whenever one fills up it is written
+ * to its mpool page with a single __bam_bulkpg log record and its first key
+ * is pushed into the level above, which is built the same way.  Nothing is
+ * reachable until __bam_bulk_finish copies the single page left at the top
+ * level over the (empty) root, so a load that is abandoned halfway leaves
+ * the tree exactly as it found it, minus some allocated pages.
+ *
+ * Compared with inserting the same keys through DB->put this writes every
+ * page once, never splits, and logs one record per page instead of one per
+ * key plus a split image per page.
+ */
+
+#include "db_config.h"
+
+#ifndef NO_SYSTEM_INCLUDES
+#include <sys/types.h>
+
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+#include "db_int.h"
+#include "dbinc/db_page.h"
+#include "dbinc/db_shash.h"
+#include "dbinc/btree.h"
+#include "dbinc/lock.h"
+#include "dbinc/log.h"
+#include "dbinc/mp.h"
+
+#include <btree/bt_cache.h>
+#include "logmsg.h"
+
+struct __bam_bulk_level {
+	PAGE *h;		/* Private image of the page being filled. */
+	DBT first;		/* First key on h; its separator in the parent. */
+	u_int32_t firstalloc;
+};
+
+struct __bam_bulk {
+	DB *dbp;
+	db_pgno_t root;
+	u_int32_t ovflsize;
+	int nlevels;
+	struct __bam_bulk_level lvl[MAXBTREELEVEL];
+	DBT last;		/* Last key added, for the ordering check. */
+	u_int32_t lastalloc;
+	u_int64_t nkeys;
+	u_int64_t npages;
+};
+
+static int
+__bam_bulk_savekey(DB_ENV *dbenv, DBT *dst, u_int32_t *allocp, const DBT *src)
+{
+	int ret;
+
+	if (src->size > *allocp) {
+		if ((ret = __os_realloc(dbenv, src->size, &dst->data)) != 0)
+			return (ret);
+		*allocp = src->size;
+	}
+	memcpy(dst->data, src->data, src->size);
+	dst->size = src->size;
+	return (0);
+}
+
+/*
+ * Append an item to a private page image.  Items always go at the end, so
+ * this is __db_pitem without the shuffling.
+ */
+static void
+__bam_bulk_append(DB *dbp, PAGE *h, u_int32_t nbytes,
+    const void *hdr, u_int32_t hdrlen, const DBT *data)
+{
+	db_indx_t *inp;
+	u_int8_t *p;
+
+	inp = P_INP(dbp, h);
+	HOFFSET(h) -= nbytes;
+	inp[NUM_ENT(h)] = HOFFSET(h);
+	p = P_ENTRY(dbp, h, NUM_ENT(h));
+	++NUM_ENT(h);
+
+	memcpy(p, hdr, hdrlen);
+	if (data != NULL)
+		memcpy(p + hdrlen, data->data, data->size);
+}
+
+/*
+ * Allocate the next page of a level and start a fresh private image for it,
+ * chained after prev.
+ */
+static int
+__bam_bulk_newpage(BAM_BULK *bulk, DBC *dbc, int level, db_pgno_t prev)
+{
+	struct __bam_bulk_level *l;
+	DB *dbp;
+	PAGE *h;
+	u_int32_t type;
+	int ret;
+
+	dbp = bulk->dbp;
+	l = &bulk->lvl[level];
+	type = level == 0 ? P_LBTREE : P_IBTREE;
+
+	if ((ret = __db_new(dbc, type, &h)) != 0)
+		return (ret);
+
+	if (l->h == NULL &&
+	    (ret = __os_malloc(dbp->dbenv, dbp->pgsize, &l->h)) != 0) {
+		(void)__memp_fput(dbp->mpf, h, DB_MPOOL_DIRTY);
+		return (ret);
+	}
+	memset(l->h, 0, dbp->pgsize);
+	P_INIT(l->h, dbp->pgsize, PGNO(h), prev, PGNO_INVALID,
+	    level + LEAFLEVEL, type);
+
+	if ((ret = __memp_fput(dbp->mpf, h, DB_MPOOL_DIRTY)) != 0)
+		return (ret);
+
+	if (level >= bulk->nlevels)
+		bulk->nlevels = level + 1;
+	++bulk->npages;
+	return (0);
+}
+
+/*
+ * Copy a finished private image onto mpool page pgno, logging the whole
+ * image so that recovery and replicants can do the same.
+ */
+static int
+__bam_bulk_write(BAM_BULK *bulk, DBC *dbc, PAGE *img, db_pgno_t pgno)
+{
+	DB *dbp;
+	DB_MPOOLFILE *mpf;
+	DBT opg, pg;
+	PAGE *h;
+	int ret, t_ret;
+
+	dbp = bulk->dbp;
+	mpf = dbp->mpf;
+
+	if ((ret = __memp_fget(mpf, &pgno, 0, &h)) != 0)
+		return (__db_pgerr(dbp, pgno, ret));
+
+	PGNO(img) = pgno;
+	if (DBC_LOGGING(dbc)) {
+		memset(&opg, 0, sizeof(opg));
+		opg.data = h;
+		/*
+		 * Log the whole old page: undo has to put back every byte,
+		 * not just a header over the new image.
+		 */
+		opg.size = dbp->pgsize;
+		memset(&pg, 0, sizeof(pg));
+		pg.data = img;
+		pg.size = dbp->pgsize;
+		if ((ret = __bam_bulkpg_log(dbp, dbc->txn, &LSN(img), 0,
+		    pgno, &LSN(h), &opg, &pg)) != 0)
+			goto err;
+	} else
+		LSN_NOT_LOGGED(LSN(img));
+
+	memcpy(h, img, dbp->pgsize);
+	++GET_BH_GEN(h);
+
+err:	if ((t_ret = __memp_fput(mpf, h,
+	    ret == 0 ? DB_MPOOL_DIRTY : 0)) != 0 && ret == 0)
+		ret = t_ret;
+	return (ret);
+}
+
+static int __bam_bulk_push __P((BAM_BULK *, DBC *, int, const DBT *,
+    db_pgno_t));
+
+/*
+ * The current page of a level is full: chain a new page after it, write it
+ * out and hand its separator to the parent level.
+ */
+static int
+__bam_bulk_spill(BAM_BULK *bulk, DBC *dbc, int level)
+{
+	struct __bam_bulk_level *l;
+	DBT sep;
+	PAGE *img;
+	db_pgno_t pgno;
+	int ret;
+
+	l = &bulk->lvl[level];
+	if ((ret = __os_malloc(bulk->dbp->dbenv,
+	    bulk->dbp->pgsize, &img)) != 0)
+		return (ret);
+	memcpy(img, l->h, bulk->dbp->pgsize);
+	pgno = PGNO(img);
+
+	/* Swap the separator out before the new page overwrites it. */
+	sep = l->first;
+	l->first.data = NULL;
+	l->first.size = 0;
+	l->firstalloc = 0;
+
+	if ((ret = __bam_bulk_newpage(bulk, dbc, level, pgno)) != 0)
+		goto err;
+	NEXT_PGNO(img) = PGNO(l->h);
+
+	if ((ret = __bam_bulk_write(bulk, dbc, img, pgno)) != 0)
+		goto err;
+	ret = __bam_bulk_push(bulk, dbc, level + 1, &sep, pgno);
+
+err:	__os_free(bulk->dbp->dbenv, img);
+	if (sep.data != NULL)
+		__os_free(bulk->dbp->dbenv, sep.data);
+	return (ret);
+}
+
+/* Add the separator for child page pgno to the given internal level. */
+static int
+__bam_bulk_push(BAM_BULK *bulk, DBC *dbc, int level, const DBT *key,
+    db_pgno_t pgno)
+{
+	struct __bam_bulk_level *l;
+	BINTERNAL bi;
+	DB *dbp;
+	DBT empty;
+	const DBT *k;
+	int ret;
+
+	dbp = bulk->dbp;
+	if (level >= MAXBTREELEVEL) {
+		__db_err(dbp->dbenv, "bulk load exceeded %d levels",
+		    MAXBTREELEVEL);
+		return (EINVAL);
+	}
+	l = &bulk->lvl[level];
+
+	if (l->h == NULL &&
+	    (ret = __bam_bulk_newpage(bulk, dbc, level, PGNO_INVALID)) != 0)
+		return (ret);
+
+	/* The first key of the leftmost page on a level is never compared. */
+	k = key;
+	if (NUM_ENT(l->h) == 0 && PREV_PGNO(l->h) == PGNO_INVALID) {
+		memset(&empty, 0, sizeof(empty));
+		k = &empty;
+	}
+
+	if (P_FREESPACE(dbp, l->h) < BINTERNAL_PSIZE(k->size)) {
+		if ((ret = __bam_bulk_spill(bulk, dbc, level)) != 0)
+			return (ret);
+		k = key;
+	}
+
+	if (NUM_ENT(l->h) == 0 && (ret = __bam_bulk_savekey(dbp->dbenv,
+	    &l->first, &l->firstalloc, key)) != 0)
+		return (ret);
+
+	memset(&bi, 0, sizeof(bi));
+	bi.len = k->size;
+	B_TSET(&bi, B_KEYDATA, 0, 0, 0);
+	bi.pgno = pgno;
+	__bam_bulk_append(dbp, l->h, BINTERNAL_SIZE(k->size),
+	    &bi, SSZA(BINTERNAL, data), k);
+	return (0);
+}
+
+/*
+ * __bam_bulk_maxkey --
+ *	Largest key the bulk loader can place on a page of this database.
+ *	Longer keys would need overflow separators, which it does not build.
+ *
+ * PUBLIC: u_int32_t __bam_bulk_maxkey __P((DB *));
+ */
+u_int32_t
+__bam_bulk_maxkey(dbp)
+	DB *dbp;
+{
+	BTREE *t;
+
+	t = dbp->bt_internal;
+	return (B_MINKEY_TO_OVFLSIZE(dbp, t->bt_minkey, dbp->pgsize));
+}
+
+/*
+ * __bam_bulk_begin --
+ *	Start a bottom-up load of an empty btree.
+ *
+ * PUBLIC: int __bam_bulk_begin __P((DB *, BAM_BULK **));
+ */
+int
+__bam_bulk_begin(dbp, bulkp)
+	DB *dbp;
+	BAM_BULK **bulkp;
+{
+	BAM_BULK *bulk;
+	BTREE *t;
+	PAGE *h;
+	db_pgno_t root;
+	int empty, ret;
+
+	*bulkp = NULL;
+	if (dbp->type != DB_BTREE ||
+	    F_ISSET(dbp, DB_AM_DUP | DB_AM_RECNUM)) {
+		__db_err(dbp->dbenv,
+		    "bulk load requires a plain btree without duplicates");
+		return (EINVAL);
+	}
+
+	t = dbp->bt_internal;
+	root = t->bt_root;
+	if ((ret = __memp_fget(dbp->mpf, &root, 0, &h)) != 0)
+		return (__db_pgerr(dbp, root, ret));
+	empty = TYPE(h) == P_LBTREE && NUM_ENT(h) == 0;
+	(void)__memp_fput(dbp->mpf, h, 0);
+	if (!empty) {
+		__db_err(dbp->dbenv, "bulk load requires an empty btree");
+		return (EINVAL);
+	}
+
+	if ((ret = __os_calloc(dbp->dbenv, 1, sizeof(*bulk), &bulk)) != 0)
+		return (ret);
+	bulk->dbp = dbp;
+	bulk->root = root;
+	bulk->ovflsize = __bam_bulk_maxkey(dbp);
+	*bulkp = bulk;
+	return (0);
+}
+
+/*
+ * __bam_bulk_put --
+ *	Append a key/data pair.  Keys must be unique and strictly ascending.
+ *
+ * PUBLIC: int __bam_bulk_put __P((BAM_BULK *, DB_TXN *, DBT *, DBT *));
+ */
+int
+__bam_bulk_put(bulk, txn, key, data)
+	BAM_BULK *bulk;
+	DB_TXN *txn;
+	DBT *key, *data;
+{
+	struct __bam_bulk_level *l;
+	BKEYDATA bk;
+	BOVERFLOW bo;
+	BTREE *t;
+	DB *dbp;
+	DBC *dbc;
+	u_int32_t need;
+	int cmp, ret, t_ret;
+
+	dbp = bulk->dbp;
+	t = dbp->bt_internal;
+	l = &bulk->lvl[0];
+
+	if (key->size > bulk->ovflsize) {
+		__db_err(dbp->dbenv, "bulk load key of %u bytes is too large",
+		    key->size);
+		return (EINVAL);
+	}
+	if (bulk->nkeys > 0) {
+		cmp = t->bt_compare(dbp, key, &bulk->last);
+		if (cmp <= 0) {
+			__db_err(dbp->dbenv, "bulk load keys out of order");
+			return (EINVAL);
+		}
+	}
+
+	if ((ret = __db_cursor(dbp, txn, &dbc, DB_WRITELOCK)) != 0)
+		return (ret);
+
+	memset(&bo, 0, sizeof(bo));
+	if (data->size > bulk->ovflsize) {
+		B_TSET(&bo, B_OVERFLOW, 0, 0, 0);
+		bo.tlen = data->size;
+		if ((ret = __db_poff(dbc, data, &bo.pgno)) != 0)
+			goto err;
+		need = BKEYDATA_PSIZE(key->size) + BOVERFLOW_PSIZE;
+	} else
+		need = BKEYDATA_PSIZE(key->size) + BKEYDATA_PSIZE(data->size);
+
+	if (l->h == NULL)
+		ret = __bam_bulk_newpage(bulk, dbc, 0, PGNO_INVALID);
+	else if (P_FREESPACE(dbp, l->h) < need)
+		ret = __bam_bulk_spill(bulk, dbc, 0);
+	if (ret != 0)
+		goto err;
+
+	if (NUM_ENT(l->h) == 0 && (ret = __bam_bulk_savekey(dbp->dbenv,
+	    &l->first, &l->firstalloc, key)) != 0)
+		goto err;
+
+	memset(&bk, 0, sizeof(bk));
+	B_TSET(&bk, B_KEYDATA, 0, 0, 0);
+	bk.len = key->size;
+	__bam_bulk_append(dbp, l->h, BKEYDATA_SIZE(key->size),
+	    &bk, SSZA(BKEYDATA, data), key);
+	if (bo.tlen != 0)
+		__bam_bulk_append(dbp, l->h, BOVERFLOW_SIZE,
+		    &bo, BOVERFLOW_SIZE, NULL);
+	else {
+		bk.len = data->size;
+		__bam_bulk_append(dbp, l->h, BKEYDATA_SIZE(data->size),
+		    &bk, SSZA(BKEYDATA, data), data);
+	}
+
+	if ((ret = __bam_bulk_savekey(dbp->dbenv,
+	    &bulk->last, &bulk->lastalloc, key)) != 0)
+		goto err;
+	++bulk->nkeys;
+
+err:	if ((t_ret = __db_c_close(dbc)) != 0 && ret == 0)
+		ret = t_ret;
+	return (ret);
+}
+
+/*
+ * __bam_bulk_finish --
+ *	Write out the partially filled page on every level and publish the
+ *	tree by overwriting the root.
+ *
+ * PUBLIC: int __bam_bulk_finish __P((BAM_BULK *, DB_TXN *));
+ */
+int
+__bam_bulk_finish(bulk, txn)
+	BAM_BULK *bulk;
+	DB_TXN *txn;
+{
+	struct __bam_bulk_level *l;
+	BTREE *t;
+	DB *dbp;
+	DBC *dbc;
+	DB_LOCK rootlock;
+	PAGE *h;
+	db_pgno_t pgno;
+	int level, ret, t_ret;
+
+	dbp = bulk->dbp;
+	t = dbp->bt_internal;
+	if (bulk->nkeys == 0)
+		return (0);
+
+	if ((ret = __db_cursor(dbp, txn, &dbc, DB_WRITELOCK)) != 0)
+		return (ret);
+
+	/*
+	 * Every level but the top has exactly one unwritten page; pushing its
+	 * separator may in turn fill the level above, so re-check nlevels.
+	 */
+	for (level = 0; level < bulk->nlevels - 1; ++level) {
+		l = &bulk->lvl[level];
+		pgno = PGNO(l->h);
+		if ((ret = __bam_bulk_write(bulk, dbc, l->h, pgno)) != 0 ||
+		    (ret = __bam_bulk_push(bulk, dbc, level + 1,
+		    &l->first, pgno)) != 0)
+			goto err;
+	}
+
+	/* The top page becomes the root; release the page it was given. */
+	l = &bulk->lvl[bulk->nlevels - 1];
+	pgno = PGNO(l->h);
+	if ((ret = __db_lget(dbc,
+	    0, bulk->root, DB_LOCK_WRITE, 0, &rootlock)) != 0)
+		goto err;
+	if ((ret = __bam_bulk_write(bulk, dbc, l->h, bulk->root)) != 0)
+		goto err;
+	if ((ret = __memp_fget(dbp->mpf, &pgno, 0, &h)) != 0) {
+		ret = __db_pgerr(dbp, pgno, ret);
+		goto err;
+	}
+	if ((ret = __db_free(dbc, h)) != 0)
+		goto err;
+	--bulk->npages;
+	t->bt_lpgno = PGNO_INVALID;
+
+	logmsg(LOGMSG_DEBUG, "%s: %s %llu keys, %llu pages, %d levels\n",
+	    __func__, dbp->fname ? dbp->fname : "", (unsigned long long)bulk->nkeys,
+	    (unsigned long long)bulk->npages, bulk->nlevels);
+
+err:	if ((t_ret = __db_c_close(dbc)) != 0 && ret == 0)
+		ret = t_ret;
+	return (ret);
+}
+
+/*
+ * __bam_bulk_free --
+ *	Release a loader, finished or not.
+ *
+ * PUBLIC: void __bam_bulk_free __P((BAM_BULK *));
+ */
+void
+__bam_bulk_free(bulk)
+	BAM_BULK *bulk;
+{
+	DB_ENV *dbenv;
+	int i;
+
+	if (bulk == NULL)
+		return;
+	dbenv = bulk->dbp->dbenv;
+	for (i = 0; i < MAXBTREELEVEL; ++i) {
+		if (bulk->lvl[i].h != NULL)
+			__os_free(dbenv, bulk->lvl[i].h);
+		if (bulk->lvl[i].first.data != NULL)
+			__os_free(dbenv, bulk->lvl[i].first.data);
+	}
+	if (bulk->last.data != NULL)
+		__os_free(dbenv, bulk->last.data);
+	__os_free(dbenv, bulk);
+}
@@ -18,9 +18,16 @@
 
 #include "dbinc/btree.h"
 #include "logmsg.h"
+#include "thread_stats.h"
 
 extern struct thdpool *gbl_udppfault_thdpool;
 
+/*
+ * Set when a cursor with read ahead in flight steps onto its next leaf;
+ * __memp_fget counts a prefetch miss if that page still has to be read.
+ */
+__thread int gbl_btpf_expect_page;
+
 static inline int chk_forward(DBC *dbc);
 static inline int chk_backward(DBC *dbc);
 static inline int adj_wndw(DBC *dbc, btpf * f);
@@ -161,6 +168,19 @@ btpf_cnt_rst(btpf * pf)
 	pf->rdr_pg_cnt = 0;
 }
 
+/*
+ * A long enough run of in-order reads makes the cursor sequential again,
+ * whatever it did before.
+ */
+static inline void
+trk_run(DBC *dbc)
+{
+	btpf *pf = PFX(dbc);
+
+	if (++pf->run >= SEQ_MIN(dbc))
+		pf->short_runs = 0;
+}
+
 int
 crsr_nxt(DBC *dbc)
 {
@@ -170,6 +190,7 @@ crsr_nxt(DBC *dbc)
 	TEST_STOP(dbc);
 	if (!PFX(dbc)->on)
 		return 100;
+	trk_run(dbc);
 	if (PFX(dbc)->status == LOADED_ALL)
 		return 0;
 	if (PFX(dbc)->direction == BACKWARD) {
@@ -196,6 +217,7 @@ crsr_prv(DBC *dbc)
 	TEST_STOP(dbc);
 	if (!PFX(dbc)->on)
 		return 100;
+	trk_run(dbc);
 	if (PFX(dbc)->status == LOADED_ALL)
 		return 0;
 	if (PFX(dbc)->direction == FORWARD) {
@@ -223,6 +245,7 @@ crsr_pf_nxt(DBC *dbc)
 	TEST_STOP(dbc);
 	if (!PFX(dbc)->on)
 		return 100;
+	trk_run(dbc);
 	if (PFX(dbc)->status == LOADED_ALL)
 		return 0;
 	if (PFX(dbc)->direction == BACKWARD) {
@@ -235,6 +258,7 @@ crsr_pf_nxt(DBC *dbc)
 		PFX(dbc)->rdr_pg_cnt++;
 		PFX(dbc)->rdr_rec_cnt++;
 		ret = chk_forward(dbc);
+		gbl_btpf_expect_page = PFX(dbc)->status == PF;
 	}
 #if BTPF_DEBUG 
 	fprintf(stderr, "Moving to next page ");
@@ -252,6 +276,7 @@ crsr_pf_prv(DBC *dbc)
 	TEST_STOP(dbc);
 	if (!PFX(dbc)->on)
 		return 100;
+	trk_run(dbc);
 	if (PFX(dbc)->status == LOADED_ALL)
 		return 0;
 	if (PFX(dbc)->direction == FORWARD) {
@@ -267,6 +292,7 @@ crsr_pf_prv(DBC *dbc)
 		PFX(dbc)->rdr_pg_cnt++;
 		PFX(dbc)->rdr_rec_cnt++;
 		ret = chk_backward(dbc);
+		gbl_btpf_expect_page = PFX(dbc)->status == PF;
 	}
 #if BTPF_DEBUG 
 	fprintf(stderr, "Moving to previous page");
@@ -278,10 +304,24 @@ crsr_pf_prv(DBC *dbc)
 int
 crsr_jump(DBC *dbc)
 {
-	if (!PFX(dbc))
+	btpf *pf = PFX(dbc);
+
+	if (!pf)
 		return 0;
 	TEST_STOP(dbc)
-	    btpf_rst(PFX(dbc));
+
+	/*
+	 * Repositioning after only a few records is what a random access
+	 * pattern looks like; enough of those in a row and we stop reading
+	 * ahead until the cursor settles into a real scan again.
+	 */
+	if (pf->run < SEQ_MIN(dbc)) {
+		if (pf->short_runs < RANDOM_SCANS(dbc))
+			pf->short_runs++;
+	} else
+		pf->short_runs = 0;
+	pf->run = 0;
+	btpf_rst(pf);
 
 	return (0);
 }
@@ -295,7 +335,7 @@ chk_forward(DBC *dbc)
 	int rst = 0;
 	int32_t th;
 
-	if (f->status == LOADED_ALL)
+	if (f->status == LOADED_ALL || BTPF_RANDOM(dbc, f))
 		return rst;
 
 	th = f->wndw - f->rdr_pg_cnt - CU_GAP(dbc);  
@@ -326,7 +366,7 @@ chk_backward(DBC *dbc)
 	int rst = 0;
 	int32_t th;
 
-	if (f->status == LOADED_ALL)
+	if (f->status == LOADED_ALL || BTPF_RANDOM(dbc, f))
 		return rst;    
         
 	th = f->wndw - f->rdr_pg_cnt - CU_GAP(dbc);
@@ -428,6 +468,7 @@ start_loading(DBC *dbc)
 	job->dirty = PFX(dbc)->status == PF || PFX(dbc)->status == LOADED_ALL;	// TODO it cannot be on LOADED_ALL when it runs asynchronously
 	job->lid = dbc->lid;
 	job->locker = dbc->locker;
+	bb_berkdb_get_thread_stats()->n_pf_pages += job->npages;
 #if BTPF_SAME_THREAD
 	start_loading_async_cb(job);
 #else
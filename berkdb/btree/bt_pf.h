@@ -17,6 +17,12 @@
 #define WNDW_INC(dbc) dbc->dbp->dbenv->attr.btpf_wndw_inc
 #define WNDW_MAX(dbc) dbc->dbp->dbenv->attr.btpf_wndw_max
 #define MIN_TH(dbc)   dbc->dbp->dbenv->attr.btpf_min_th
+#define SEQ_MIN(dbc)  dbc->dbp->dbenv->attr.btpf_seq_min
+#define RANDOM_SCANS(dbc) dbc->dbp->dbenv->attr.btpf_random_scans
+
+/* The cursor keeps repositioning without reading far: don't read ahead. */
+#define BTPF_RANDOM(dbc, f)                                                 \
+    ((f)->short_runs >= RANDOM_SCANS(dbc) && (f)->run < SEQ_MIN(dbc))
 
 typedef enum {
 	INIT,
@@ -56,6 +62,8 @@ typedef struct {
 	u_int32_t   rdr_pg_cnt; // pages read by the cursor to catch up
 	u_int32_t   wndw;
 	u_int32_t   on; // pre-faulting is on/off
+	u_int32_t   run; // records read in order since the last jump
+	u_int32_t   short_runs; // consecutive jumps after short runs
    
 	db_pgno_t curlf[RMBR_LVL];	// the chain of pages to reach the cursor 
 	db_indx_t curindx[RMBR_LVL];	// current entry per level
@@ -1769,3 +1769,95 @@ out:
 			ret = t_ret;
 	REC_CLOSE;
 }
+
+/*
+ * __bam_bulkpg_redo --
+ *
+ * Redo a page written by the bulk loader.
+ *
+ * PUBLIC: void __bam_bulkpg_redo
+ * PUBLIC:   __P((PAGE *, __bam_bulkpg_args *, DB_LSN *));
+ */
+void __bam_bulkpg_redo(PAGE *pagep, __bam_bulkpg_args *argp, DB_LSN *lsnp)
+{
+	memcpy(pagep, argp->pg.data, argp->pg.size);
+	pagep->lsn = *lsnp;
+}
+
+/*
+ * __bam_bulkpg_undo --
+ *
+ * Undo a page written by the bulk loader by putting back the old image.
+ *
+ * PUBLIC: void __bam_bulkpg_undo
+ * PUBLIC:   __P((PAGE *, __bam_bulkpg_args *));
+ */
+void __bam_bulkpg_undo(PAGE *pagep, __bam_bulkpg_args *argp)
+{
+	memcpy(pagep, argp->opg.data, argp->opg.size);
+	/* Never leave pieces of the new image behind a short old image. */
+	if (argp->opg.size < argp->pg.size)
+		memset((u_int8_t *)pagep + argp->opg.size, 0,
+		    argp->pg.size - argp->opg.size);
+	pagep->lsn = argp->lsn;
+}
+
+/*
+ * __bam_bulkpg_recover --
+ *	Recovery function for bulkpg.
+ *
+ * PUBLIC: int __bam_bulkpg_recover
+ * PUBLIC:   __P((DB_ENV *, DBT *, DB_LSN *, db_recops, void *));
+ */
+int
+__bam_bulkpg_recover(dbenv, dbtp, lsnp, op, info)
+	DB_ENV *dbenv;
+	DBT *dbtp;
+	DB_LSN *lsnp;
+	db_recops op;
+	void *info;
+{
+	__bam_bulkpg_args *argp;
+	DB *file_dbp;
+	DBC *dbc;
+	DB_MPOOLFILE *mpf;
+	PAGE *pagep = NULL;
+	int cmp_n, cmp_p, modified, ret;
+
+	COMPQUIET(info, NULL);
+
+	REC_PRINT(__bam_bulkpg_print);
+	REC_INTRO(__bam_bulkpg_read, 1);
+
+	if ((ret = __memp_fget(mpf, &argp->pgno, 0, &pagep)) != 0) {
+		/* The page may never have made it to disk. */
+		if (DB_UNDO(op))
+			goto done;
+		ret = __db_pgerr(file_dbp, argp->pgno, ret);
+		goto out;
+	}
+
+	modified = 0;
+	cmp_n = log_compare(lsnp, &LSN(pagep));
+	cmp_p = log_compare(&LSN(pagep), &argp->lsn);
+	CHECK_LSN(op, cmp_p, &LSN(pagep), &argp->lsn, lsnp, argp->fileid,
+	    argp->pgno);
+	if (cmp_p == 0 && DB_REDO(op)) {
+		__bam_bulkpg_redo(pagep, argp, lsnp);
+		modified = DB_MPOOL_DIRTY;
+	} else if (cmp_n == 0 && DB_UNDO(op)) {
+		__bam_bulkpg_undo(pagep, argp);
+		modified = DB_MPOOL_DIRTY;
+	}
+
+	if ((ret = __memp_fput(mpf, pagep, modified)) != 0)
+		goto out;
+	pagep = NULL;
+
+done:	*lsnp = argp->prev_lsn;
+	ret = 0;
+
+out:	if (pagep != NULL)
+		__memp_fput(mpf, pagep, 0);
+	REC_CLOSE;
+}
@@ -29,6 +29,7 @@ static const char revid[] = "$Id: bt_rec.c,v 11.64 2003/09/13 18:48:58 bostic Ex
 
 extern int __bam_repl_undo(DB *, DB_ENV *, DBC *, BKEYDATA *bk, PAGE *, __bam_repl_args *);
 extern int __bam_prefix_undo(DB_ENV *, DBC *, PAGE *, __bam_prefix_args *);
+extern void __bam_bulkpg_undo(PAGE *, __bam_bulkpg_args *);
 extern void __bam_cdel_undo(DB *, PAGE *, __bam_cdel_args *, int);
 
 extern void __bam_cadjust_undo(DB *file_dbp, PAGE *pagep, __bam_cadjust_args *argp);
@@ -294,3 +295,37 @@ out:
 done:
 	REC_CLOSE;
 }
+
+/*
+ * __bam_bulkpg_snap_recover --
+ *	Recovery function for bulkpg.
+ *
+ * PUBLIC: int __bam_bulkpg_snap_recover
+ * PUBLIC:   __P((DB_ENV *, DBT *, DB_LSN *, db_recops, PAGE *));
+ */
+int
+__bam_bulkpg_snap_recover(dbenv, dbtp, lsnp, op, pagep)
+	DB_ENV *dbenv;
+	DBT *dbtp;
+	DB_LSN *lsnp;
+	db_recops op;
+	PAGE *pagep;
+{
+	__bam_bulkpg_args *argp;
+	DB *file_dbp;
+	DBC *dbc;
+	DB_MPOOLFILE *mpf;
+	int ret = 0;
+	REC_INTRO_PANIC(__bam_bulkpg_read, 1);
+
+	if (PGNO(pagep) != argp->pgno) {
+		logmsg(LOGMSG_ERROR, "%s:[%d:%d] Page %d is not a valid recovery target\n", __func__, lsnp->file, lsnp->offset, PGNO(pagep));
+		ret = 1;
+		goto out;
+	}
+	__bam_bulkpg_undo(pagep, argp);
+
+out:
+done:
+	REC_CLOSE;
+}
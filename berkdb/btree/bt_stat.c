@@ -473,3 +473,127 @@ __bam_key_range(dbc, dbt, kp, flags)
 
 	return (0);
 }
+
+/*
+ * __bam_sample_splits --
+ *	Pick up to nsplits keys that cut a btree into pieces of roughly equal
+ *	size.  Every entry on an internal level heads a subtree of about the
+ *	same size, so the keys are taken at even intervals from the highest
+ *	internal level with enough entries to choose from.  Keys are copied
+ *	into consecutive keylen byte slots of keys, truncated or zero padded,
+ *	and are strictly ascending.  Pages are not held between levels, so the
+ *	result is only a hint when the tree is being modified.
+ *
+ * PUBLIC: int __bam_sample_splits __P((DB *, u_int32_t, u_int8_t *,
+ * PUBLIC:     u_int32_t, u_int32_t *));
+ */
+int
+__bam_sample_splits(dbp, nsplits, keys, keylen, nkeysp)
+	DB *dbp;
+	u_int32_t nsplits;
+	u_int8_t *keys;
+	u_int32_t keylen;
+	u_int32_t *nkeysp;
+{
+	BINTERNAL *bi;
+	DBC *dbc;
+	DB_ENV *dbenv;
+	DB_LOCK lock;
+	DB_MPOOLFILE *mpf;
+	PAGE *h;
+	db_pgno_t *level, *next, pgno;
+	u_int8_t *cand, *kp, *prev;
+	u_int32_t i, j, len, nlevel, nnext, ncand, maxpages, want;
+	db_indx_t indx;
+	int leaves, ret, t_ret;
+
+	dbenv = dbp->dbenv;
+	mpf = dbp->mpf;
+	level = next = NULL;
+	cand = NULL;
+	*nkeysp = 0;
+	maxpages = 4096;
+	/* Enough separators that the chosen ones fall near even intervals. */
+	want = 8 * (nsplits + 1);
+
+	if (nsplits == 0 || keylen == 0)
+		return (0);
+	if ((ret = __db_cursor(dbp, NULL, &dbc, 0)) != 0)
+		return (ret);
+	if ((ret = __os_malloc(dbenv, maxpages * sizeof(db_pgno_t),
+	    &level)) != 0 || (ret = __os_malloc(dbenv,
+	    maxpages * sizeof(db_pgno_t), &next)) != 0)
+		goto err;
+	level[0] = ((BTREE_CURSOR *)dbc->internal)->root;
+	nlevel = 1;
+
+	for (;;) {
+		/* Collect the children and separators of this level. */
+		nnext = ncand = 0;
+		leaves = 0;
+		for (i = 0; i < nlevel; i++) {
+			pgno = level[i];
+			if ((ret = __db_lget(dbc,
+			    0, pgno, DB_LOCK_READ, 0, &lock)) != 0)
+				goto err;
+			if ((ret = PAGEGET(dbc, mpf, &pgno, 0, &h)) != 0) {
+				__LPUT(dbc, lock);
+				goto err;
+			}
+			if (TYPE(h) != P_IBTREE) {
+				ret = PAGEPUT(dbc, mpf, h, 0);
+				__LPUT(dbc, lock);
+				/* The root is a leaf, or the tree changed. */
+				goto err;
+			}
+			if (LEVEL(h) == LEAFLEVEL + 1)
+				leaves = 1;
+			if ((ret = __os_realloc(dbenv,
+			    (ncand + NUM_ENT(h)) * keylen, &cand)) != 0) {
+				(void)(PAGEPUT(dbc, mpf, h, 0));
+				__LPUT(dbc, lock);
+				goto err;
+			}
+			for (indx = 0; indx < NUM_ENT(h); indx += O_INDX) {
+				bi = GET_BINTERNAL(dbp, h, indx);
+				if (nnext < maxpages)
+					next[nnext++] = bi->pgno;
+				if (B_TYPE(bi) != B_KEYDATA || bi->len == 0)
+					continue;
+				len = bi->len < keylen ? bi->len : keylen;
+				kp = cand + ncand * keylen;
+				memcpy(kp, bi->data, len);
+				memset(kp + len, 0, keylen - len);
+				ncand++;
+			}
+			ret = PAGEPUT(dbc, mpf, h, 0);
+			__LPUT(dbc, lock);
+			if (ret != 0)
+				goto err;
+		}
+		if (leaves || ncand >= want || nnext >= maxpages)
+			break;
+		memcpy(level, next, nnext * sizeof(db_pgno_t));
+		nlevel = nnext;
+	}
+
+	for (i = 1, prev = NULL; i <= nsplits && ncand != 0; i++) {
+		j = (u_int32_t)(((u_int64_t)i * ncand) / (nsplits + 1));
+		kp = cand + j * keylen;
+		if (prev != NULL && memcmp(kp, prev, keylen) <= 0)
+			continue;
+		memcpy(keys + *nkeysp * keylen, kp, keylen);
+		prev = keys + *nkeysp * keylen;
+		(*nkeysp)++;
+	}
+
+err:	if (cand != NULL)
+		__os_free(dbenv, cand);
+	if (next != NULL)
+		__os_free(dbenv, next);
+	if (level != NULL)
+		__os_free(dbenv, level);
+	if ((t_ret = __db_c_close(dbc)) != 0 && ret == 0)
+		ret = t_ret;
+	return (ret);
+}
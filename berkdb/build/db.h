@@ -694,6 +694,7 @@ struct __db_log_cursor {
 };
 
 /* Log statistics structure. */
+#define	DB_LOG_HIST_BUCKETS	16	/* [2^i, 2^(i+1)); last is open */
 struct __db_log_stat {
 	u_int32_t st_magic;		/* Log file magic number. */
 	u_int32_t st_version;		/* Log file version number. */
@@ -729,6 +730,11 @@ struct __db_log_stat {
 	u_int32_t st_ondisk_get;	/* On-disk log_get. */
 	u_int32_t st_inmem_trav;	/* Mem-log steps for partial reads. */
 	u_int32_t st_wrap_copy;		/* Count of wrapped copies. */
+	u_int32_t st_gc_delays;		/* Group commit delays taken. */
+					/* Commits per flush, log2 buckets. */
+	u_int32_t st_group_hist[DB_LOG_HIST_BUCKETS];
+					/* Commit flush usecs, log2 buckets. */
+	u_int32_t st_commit_usec_hist[DB_LOG_HIST_BUCKETS];
 };
 
 /*******************************************************
@@ -185,6 +185,8 @@ optostr(int op)
 		return "DB___bam_curadj";
 	case DB___bam_rcuradj:
 		return "DB___bam_rcuradj";
+	case DB___bam_bulkpg:
+		return "DB___bam_bulkpg";
 	case DB___crdel_metasub:
 		return "DB___crdel_metasub";
 	case DB___db_addrem:
@@ -320,6 +322,7 @@ ufid_for_recovery_record(DB_ENV *env, DB_LSN *lsn, int rectype,
 	case DB___bam_curadj:
 	case DB___bam_rcuradj:
 	case DB___bam_pgcompact:
+	case DB___bam_bulkpg:
 	case DB___crdel_metasub:
 	case DB___db_ovref:
 	case DB___db_pg_free:
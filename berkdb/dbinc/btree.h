@@ -52,6 +52,7 @@ struct __recno;		typedef struct __recno RECNO;
 /* comdb2 addition */
 struct __cursor_pause;	typedef struct __cursor_pause BTREE_CURSOR_PAUSE;
 struct __cursor_ser;	typedef struct __cursor_ser BTREE_CURSOR_SER;
+struct __bam_bulk;	typedef struct __bam_bulk BAM_BULK;
 
 #define	DEFMINKEYPAGE	 (2)
 
@@ -29,10 +29,12 @@ BERK_DEF_ATTR(sgio_max, "Max scatter gather I/O to do at one time", BERK_ATTR_TY
 BERK_DEF_ATTR(btpf_enabled, "Enables index pages read ahead", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(btpf_wndw_min, "Minimum number of pages read ahead", BERK_ATTR_TYPE_INTEGER, 100 )
 BERK_DEF_ATTR(btpf_wndw_max, "Maximum number of pages read ahead", BERK_ATTR_TYPE_INTEGER, 1000 )
-BERK_DEF_ATTR(btpf_wndw_inc, "Increment factor for the number of pages read ahead", BERK_ATTR_TYPE_INTEGER, 1)
+BERK_DEF_ATTR(btpf_wndw_inc, "Increment factor for the number of pages read ahead", BERK_ATTR_TYPE_INTEGER, 2)
 BERK_DEF_ATTR(btpf_pg_gap, "Min. number of records to the page limit before read ahead", BERK_ATTR_TYPE_INTEGER, 0)
 BERK_DEF_ATTR(btpf_cu_gap, "How close a cursor should be (pages) to the prefaulted limit before prefaulting again", BERK_ATTR_TYPE_INTEGER, 5)
 BERK_DEF_ATTR(btpf_min_th, "Preload pages only if the tree has heigth less than this parameter", BERK_ATTR_TYPE_INTEGER, 1)
+BERK_DEF_ATTR(btpf_seq_min, "Records a cursor must read in order before its scan counts as sequential", BERK_ATTR_TYPE_INTEGER, 16)
+BERK_DEF_ATTR(btpf_random_scans, "Stop reading ahead after this many consecutive short scans", BERK_ATTR_TYPE_INTEGER, 3)
 BERK_DEF_ATTR(recovery_verify, "After recovery, run a full pass to make sure everything is applied", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(recovery_verify_fatal, "Abort if recovery_verify is set, and fails.", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(cache_lc, "Collect logs into LSN_COLLECTIONs as they come in", BERK_ATTR_TYPE_BOOLEAN, 0)
@@ -45,6 +47,8 @@ BERK_DEF_ATTR(cache_lc_memlimit, "Limit total memory used by LC cache (0 = unlim
 BERK_DEF_ATTR(cache_lc_memlimit_tran, "Limit per transaction memory used by LC cache", BERK_ATTR_TYPE_INTEGER, 1048576)
 BERK_DEF_ATTR(commit_map_debug, "Produce debug output in commit lsn map", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(consolidate_dbreg_ranges, "Combine adjacent dbreg ranges for same file", BERK_ATTR_TYPE_BOOLEAN, 1)
+BERK_DEF_ATTR(deadlock_incremental_detect, "Keep a waits-for graph up to date as lockers block and only run the deadlock detector when a new edge may close a cycle", BERK_ATTR_TYPE_BOOLEAN, 0)
+BERK_DEF_ATTR(deadlock_incremental_max_visit, "Run the full deadlock detector if an incremental cycle search visits more than this many lockers", BERK_ATTR_TYPE_INTEGER, 1024)
 BERK_DEF_ATTR(max_latch, "Size of latch array", BERK_ATTR_TYPE_INTEGER, 200000)
 BERK_DEF_ATTR(max_latch_lockerid, "Size of latch lockerid array", BERK_ATTR_TYPE_INTEGER, 10000)
 BERK_DEF_ATTR(lockerid_node_step, "Stepup for preallocated lids", BERK_ATTR_TYPE_INTEGER, 128)
@@ -55,8 +59,13 @@ BERK_DEF_ATTR(latch_max_wait, "Block at most this many microseconds before retur
 BERK_DEF_ATTR(latch_poll_us, "Poll latch this many microseconds before retrying", BERK_ATTR_TYPE_INTEGER, 1000)
 BERK_DEF_ATTR(latch_max_poll, "Poll latch this many times before returning deadlock", BERK_ATTR_TYPE_INTEGER, 5)
 BERK_DEF_ATTR(latch_timed_mutex, "Use a timed mutex", BERK_ATTR_TYPE_BOOLEAN, 1)
+BERK_DEF_ATTR(lock_fastpath_reads, "Grant uncontended page read locks of read-only lockers without taking the lock-table mutexes (needs lock_fastpath_slots)", BERK_ATTR_TYPE_BOOLEAN, 0)
+BERK_DEF_ATTR(lock_fastpath_slots, "Number of fast-path lock counter slots, set at startup; 0 leaves writers out of fast-path bookkeeping", BERK_ATTR_TYPE_INTEGER, 0)
+BERK_DEF_ATTR(lock_fastpath_max_wait, "Wait at most this many microseconds for fast-path readers to drain before returning deadlock", BERK_ATTR_TYPE_INTEGER, 10000)
 BERK_DEF_ATTR(log_cursor_cache, "Cache log cursors", BERK_ATTR_TYPE_BOOLEAN, 0)
 BERK_DEF_ATTR(recovery_processor_poll_interval_us, "Recovery processor wakes this often to check workers", BERK_ATTR_TYPE_INTEGER, 1000)
+BERK_DEF_ATTR(rep_apply_page_groups, "Split a replicated transaction's per-table apply queues into groups of records that share no page", BERK_ATTR_TYPE_BOOLEAN, 0)
+BERK_DEF_ATTR(rep_apply_page_groups_min, "Only split transactions with at least this many log records into page groups", BERK_ATTR_TYPE_INTEGER, 64)
 BERK_DEF_ATTR(lsnerr_logflush, "Flush log on lsn error", BERK_ATTR_TYPE_BOOLEAN, 1)
 BERK_DEF_ATTR(tracked_locklist_init, "Initial allocation count for tracked locks", BERK_ATTR_TYPE_INTEGER, 10)
 /* This is a placeholder for now */
@@ -38,6 +38,8 @@ extern int DB_LOCK_MAXID;
 #define	LOCK_INVALID		INVALID_ROFF
 #define LATCH_OFFSET		-1
 #define LOCK_ISLATCH(lock)	((lock).off == LATCH_OFFSET)
+#define FASTPATH_OFFSET		-2
+#define LOCK_ISFASTPATH(lock)	((lock).off == FASTPATH_OFFSET)
 #define	LOCK_ISSET(lock)	((lock).off != LOCK_INVALID)
 #define	LOCK_INIT(lock)		((lock).off = LOCK_INVALID)
 
@@ -112,6 +114,24 @@ typedef struct
 BB_COMPILE_TIME_ASSERT(lockfluff_not_192, sizeof(PthreadMutexWithFluff) == 192);
 #endif
 
+/*
+ * Fast-path read lock slots.  Page objects hash onto a slot; 'strong' counts
+ * lock structures on those objects whose mode conflicts with a read, and
+ * 'readers' counts read locks granted without touching the lock table.  A
+ * reader may only take the fast path while 'strong' is zero, and a writer
+ * waits for 'readers' to drain before it goes through the normal path.
+ * 'wanted' counts writers doing that wait; holders see it as waiters.
+ */
+typedef struct __db_lock_fastpath_slot {
+	u_int32_t	strong;
+	u_int32_t	readers;
+	u_int32_t	wanted;
+	u_int8_t	fluff[52];
+} DB_LOCK_FASTPATH_SLOT;
+
+/* Fast-path holds a single locker may have outstanding. */
+#define	DB_LOCKER_FASTPATH_HOLDS	8
+
 typedef SH_TAILQ_HEAD(LockerTab, __db_locker) LockerTab;
 typedef SH_TAILQ_HEAD(ObjTab, __db_lockobj) ObjTab;
 
@@ -175,6 +195,10 @@ typedef struct __db_lockregion {
 	struct __db_lockerid_latch_node	*lockerid_node_head;
 	pthread_mutex_t 	db_lock_lsn_lk;
 	SH_LIST_HEAD(_regionlsns, __db_lock_lsn) db_lock_lsn_head;
+
+	/* Fast-path read locks */
+	u_int32_t		fastpath_nslots;
+	DB_LOCK_FASTPATH_SLOT	*fastpath_slots;
 } DB_LOCKREGION;
 
 typedef struct __sh_dbt {
@@ -299,6 +323,12 @@ typedef struct __db_locker {
 	u_int8_t has_pglk_lsn;
 	u_int8_t wstatus;  /* master locker waiting, for deadlock detection */
 	int64_t timestamp;  /* wait-die timestamp */
+	/*
+	 * Fast-path read locks: (slot + 1) << 32 | gen << 16 | count, 0 if
+	 * unused.  gen comes from fastpath_gen when the entry is taken.
+	 */
+	u_int64_t fastpath_holds[DB_LOCKER_FASTPATH_HOLDS];
+	u_int32_t fastpath_gen;
 } DB_LOCKER;
 
 /*
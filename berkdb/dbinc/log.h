@@ -260,6 +260,7 @@ struct __log {
 	u_int32_t ncommit;		/* Number of txns waiting to commit. */
 
 	DB_LSN	  t_lsn;		/* LSN of first commit */
+	u_int32_t gc_last_group;	/* Commits synced by the last flush. */
 	SH_TAILQ_HEAD(__commit, __db_commit) commits;/* list of txns waiting to commit. */
 	SH_TAILQ_HEAD(__free, __db_commit) free_commits;/* free list of commit structs. */
 
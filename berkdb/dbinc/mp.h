@@ -179,8 +179,79 @@ struct __db_mpool_hash {
 	HashTab 	hash_bucket;	/* Head of bucket. */
 	uint32_t 	hash_page_dirty;/* Count of dirty pages. */
 	u_int32_t	hash_priority;	/* Minimum priority of bucket buffer. */
+	u_int32_t	hash_seq;	/* Odd while the bucket is locked. */
+	u_int32_t	hash_readers;	/* Lockless lookups in progress. */
 };
 
+/*
+ * The hash bucket lock is a seqlock for lockless readers (see
+ * __memp_fget_lockless): every holder makes hash_seq odd for as long as it
+ * holds the bucket, so a reader that sees the same even hash_seq before and
+ * after pinning a buffer knows nobody touched the bucket in between.  A
+ * reader that pins a buffer and only then checks hash_seq is ordered
+ * against a holder that bumps hash_seq and only then looks at the buffer's
+ * reference count: one of them sees the other.
+ *
+ * Buffer reference counts are changed atomically everywhere, since lockless
+ * readers pin and unpin without the bucket lock.
+ */
+#define	MP_HASH_LOCK(dbenv, hp) do {					\
+	MUTEX_LOCK(dbenv, &(hp)->hash_mutex);				\
+	(void)__atomic_add_fetch(&(hp)->hash_seq, 1, __ATOMIC_SEQ_CST);	\
+} while (0)
+#define	MP_HASH_UNLOCK(dbenv, hp) do {					\
+	(void)__atomic_add_fetch(&(hp)->hash_seq, 1, __ATOMIC_RELEASE);	\
+	MUTEX_UNLOCK(dbenv, &(hp)->hash_mutex);				\
+} while (0)
+
+/*
+ * Buffers leave a bucket with the bucket locked (hash_seq odd, so no new
+ * lockless reader can start); wait out the readers that started before
+ * that, as they may still be about to pin or unpin the buffer.
+ */
+#define	MP_HASH_WAIT_SPINS	1024
+#if defined(__x86_64__) || defined(__i386__)
+#define	MP_CPU_PAUSE()	__asm__ __volatile__("pause" ::: "memory")
+#elif defined(__aarch64__)
+#define	MP_CPU_PAUSE()	__asm__ __volatile__("yield" ::: "memory")
+#else
+#define	MP_CPU_PAUSE()	__asm__ __volatile__("" ::: "memory")
+#endif
+/*
+ * Readers only hold the count for a short bucket walk, so pause-spin for a
+ * while; if one got descheduled mid-walk, give up the CPU instead of
+ * burning it with the bucket mutex held.
+ */
+#define	MP_HASH_WAIT_READERS(hp) do {					\
+	int __spins = 0;						\
+	while (__atomic_load_n(&(hp)->hash_readers, __ATOMIC_SEQ_CST)) {\
+		if (++__spins < MP_HASH_WAIT_SPINS)			\
+			MP_CPU_PAUSE();					\
+		else							\
+			sched_yield();					\
+	}								\
+} while (0)
+
+/*
+ * Per-file hit counters and the buffer's fget count are bumped from the
+ * lockless path as well as under the bucket mutex; keep them atomic.
+ */
+#define	MP_STAT_INCR(v)	(void)__atomic_add_fetch(&(v), 1, __ATOMIC_RELAXED)
+#define	BH_FGET_INCR(bhp) do {						\
+	u_int32_t __cnt = __atomic_load_n(&(bhp)->fget_count,		\
+	    __ATOMIC_RELAXED);						\
+	while (__cnt < UINT_MAX &&					\
+	    !__atomic_compare_exchange_n(&(bhp)->fget_count, &__cnt,	\
+	    __cnt + 1, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED))		\
+		;							\
+} while (0)
+
+#define	BH_REF(bhp)	__atomic_load_n(&(bhp)->ref, __ATOMIC_SEQ_CST)
+#define	BH_REF_INCR(bhp)						\
+	__atomic_add_fetch(&(bhp)->ref, 1, __ATOMIC_SEQ_CST)
+#define	BH_REF_DECR(bhp)						\
+	__atomic_sub_fetch(&(bhp)->ref, 1, __ATOMIC_SEQ_CST)
+
 /*
  * The base mpool priority is 1/4th of the name space, or just under 2^30.
  * When the LRU counter wraps, we shift everybody down to a base-relative
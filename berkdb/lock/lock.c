@@ -85,6 +85,7 @@ __P((DB_LOCKTAB *, u_int32_t, DB_LOCKER *,
 static int __lock_getobj
 __P((DB_LOCKTAB *, const DBT *, u_int32_t, u_int32_t,
 	int, DB_LOCKOBJ **));
+static int __lock_fastpath_wanted __P((DB_LOCKTAB *, DB_LOCKER *));
 static int __lock_inherit_locks __P((DB_LOCKTAB *, u_int32_t, u_int32_t));
 static int __lock_is_parent __P((DB_LOCKTAB *, u_int32_t, DB_LOCKER *));
 static int __lock_put_internal
@@ -422,7 +423,7 @@ __lock_id_has_waiters(dbenv, id)
 		return EINVAL;
 	}
 
-	if (sh_locker->has_waiters)
+	if (sh_locker->has_waiters || __lock_fastpath_wanted(lt, sh_locker))
 		ret = 1;
 	else
 		ret = 0;
@@ -886,6 +887,355 @@ init_latches(dbenv, lt)
 	return 0;
 }
 
+/*
+ * Fast-path read locks.
+ *
+ * SQL cursors take their page read locks under read-only lockers, and on a
+ * hot btree all of those requests queue on the same object and locker
+ * partition mutexes even though they never conflict with one another.  With
+ * lock_fastpath_reads set such a request is granted by bumping a reader
+ * count in the page's fast-path slot instead, provided no lock on any page
+ * hashing to that slot is held or wanted in a mode that conflicts with a
+ * read.  A conflicting request raises the slot's strong count before going
+ * to the lock table, which keeps new fast-path readers out, and then waits
+ * for the ones already in to drain.  Fast-path holds are invisible to the
+ * deadlock detector, so as with page latches that wait is bounded and ends
+ * in DB_LOCK_DEADLOCK.  While it waits the writer is counted in the slot's
+ * 'wanted', and lock_id_has_waiters reports that to every locker holding
+ * the slot, so SQL cursors give their locks up as they would for a waiter
+ * in the lock table.
+ *
+ * Each hold is also recorded in its locker so that DB_LOCK_PUT_ALL and
+ * freeing the locker release anything the cursor code didn't put.  A hold
+ * entry gets a new generation each time it is taken, and a DB_LOCK only
+ * releases the entry of its own generation, so a stale handle can't drop a
+ * later hold on the same slot.
+ *
+ * Writers do this bookkeeping whether or not lock_fastpath_reads is on, since
+ * it can be turned on at any time; lock_fastpath_slots defaults to 0, which
+ * leaves all of it out.
+ */
+#define	FASTPATH_POLL_US	100
+#define	FASTPATH_HOLD_SLOT(w)	((u_int32_t)((w) >> 32))
+#define	FASTPATH_HOLD_GEN(w)	((u_int32_t)((w) >> 16) & 0xffff)
+#define	FASTPATH_HOLD_COUNT(w)	((u_int32_t)(w) & 0xffff)
+#define	FASTPATH_HOLD_MAXCOUNT	0xffff
+
+static __thread DB_LOCKER *fastpath_locker;
+
+int
+init_fastpath(dbenv, lt)
+	DB_ENV *dbenv;
+	DB_LOCKTAB *lt;
+{
+	DB_LOCKREGION *region = lt->reginfo.primary;
+	int ret;
+
+	region->fastpath_nslots = 0;
+	region->fastpath_slots = NULL;
+	if (dbenv->attr.lock_fastpath_slots <= 0)
+		return 0;
+
+	if ((ret = __os_calloc(dbenv, dbenv->attr.lock_fastpath_slots,
+		    sizeof(DB_LOCK_FASTPATH_SLOT),
+		    &region->fastpath_slots)) != 0)
+		return ret;
+	region->fastpath_nslots = dbenv->attr.lock_fastpath_slots;
+	return 0;
+}
+
+static inline int
+is_fastpath_pageobj(obj)
+	const DBT *obj;
+{
+	return (obj != NULL && obj->size == sizeof(DB_LOCK_ILOCK) &&
+	    ((DB_LOCK_ILOCK *)obj->data)->type == DB_PAGE_LOCK);
+}
+
+/* Adjust the strong count for a lock structure entering or leaving mode. */
+static inline void
+__lock_fastpath_strong(lt, sh_obj, mode, delta)
+	DB_LOCKTAB *lt;
+	DB_LOCKOBJ *sh_obj;
+	db_lockmode_t mode;
+	int delta;
+{
+	DB_LOCKREGION *region = lt->reginfo.primary;
+	DB_LOCK_FASTPATH_SLOT *fp;
+
+	if (region->fastpath_nslots == 0 || !is_pagelock(sh_obj) ||
+	    !CONFLICTS(lt, region, DB_LOCK_READ, mode))
+		return;
+	fp = &region->fastpath_slots[sh_obj->index % region->fastpath_nslots];
+	(void)__atomic_add_fetch(&fp->strong, delta, __ATOMIC_SEQ_CST);
+}
+
+/*
+ * Record a fast-path hold on slot in the locker; returns its index or -1,
+ * and the generation of the entry in *genp.
+ */
+static int
+__lock_fastpath_hold(sh_locker, slot, genp)
+	DB_LOCKER *sh_locker;
+	u_int32_t slot;
+	u_int32_t *genp;
+{
+	u_int64_t *holds, w;
+	u_int32_t gen;
+	int i, freeidx, retry;
+
+	holds = sh_locker->fastpath_holds;
+	for (retry = 0; retry < 4; retry++) {
+		freeidx = -1;
+		for (i = 0; i < DB_LOCKER_FASTPATH_HOLDS; i++) {
+			w = __atomic_load_n(&holds[i], __ATOMIC_SEQ_CST);
+			if (w != 0 && FASTPATH_HOLD_SLOT(w) == slot + 1) {
+				if (FASTPATH_HOLD_COUNT(w) ==
+				    FASTPATH_HOLD_MAXCOUNT)
+					return -1;
+				if (__atomic_compare_exchange_n(&holds[i], &w,
+					w + 1, 0, __ATOMIC_SEQ_CST,
+					__ATOMIC_SEQ_CST)) {
+					*genp = FASTPATH_HOLD_GEN(w);
+					return i;
+				}
+				break;
+			}
+			if (w == 0 && freeidx < 0)
+				freeidx = i;
+		}
+		if (i < DB_LOCKER_FASTPATH_HOLDS)
+			continue;
+		if (freeidx < 0)
+			return -1;
+		gen = __atomic_add_fetch(&sh_locker->fastpath_gen, 1,
+		    __ATOMIC_SEQ_CST) & 0xffff;
+		w = 0;
+		if (__atomic_compare_exchange_n(&holds[freeidx], &w,
+			((u_int64_t)(slot + 1) << 32) | (gen << 16) | 1, 0,
+			__ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+			*genp = gen;
+			return freeidx;
+		}
+	}
+	return -1;
+}
+
+/*
+ * __lock_fastpath_get --
+ *	Try to grant a page read lock without the lock table.  Returns
+ *	DB_LOCK_NOTGRANTED if the caller has to take the normal path.
+ */
+static int
+__lock_fastpath_get(lt, locker, obj, lock)
+	DB_LOCKTAB *lt;
+	u_int32_t locker;
+	const DBT *obj;
+	DB_LOCK *lock;
+{
+	DB_LOCKREGION *region;
+	DB_LOCK_FASTPATH_SLOT *fp;
+	DB_LOCKER *sh_locker;
+	u_int32_t gen, ndx, partition, slot;
+	int i;
+
+	region = lt->reginfo.primary;
+
+	/*
+	 * Lockers are recycled through the free list but never released,
+	 * so the cached pointer is always safe to read; use it only while
+	 * it still describes the locker we were asked about.
+	 */
+	sh_locker = fastpath_locker;
+	if (sh_locker == NULL || sh_locker->id != locker ||
+	    !F_ISSET(sh_locker, DB_LOCKER_READONLY) ||
+	    F_ISSET(sh_locker, DB_LOCKER_DELETED | DB_LOCKER_TRACK) ||
+	    sh_locker->parent_locker != INVALID_ROFF)
+		return (DB_LOCK_NOTGRANTED);
+
+	OBJECT_INDX(lt, region, obj, ndx, partition);
+	COMPQUIET(partition, 0);
+	slot = ndx % region->fastpath_nslots;
+	fp = &region->fastpath_slots[slot];
+
+	if (__atomic_load_n(&fp->strong, __ATOMIC_SEQ_CST) != 0)
+		return (DB_LOCK_NOTGRANTED);
+	(void)__atomic_add_fetch(&fp->readers, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&fp->strong, __ATOMIC_SEQ_CST) != 0 ||
+	    (i = __lock_fastpath_hold(sh_locker, slot, &gen)) < 0) {
+		(void)__atomic_sub_fetch(&fp->readers, 1, __ATOMIC_SEQ_CST);
+		return (DB_LOCK_NOTGRANTED);
+	}
+
+	lock->off = FASTPATH_OFFSET;
+	lock->ilock_latch = sh_locker;
+	lock->ndx = i;
+	lock->partition = slot;
+	lock->gen = gen;
+	lock->mode = DB_LOCK_READ;
+	lock->owner = locker;
+	return (0);
+}
+
+static int
+__lock_fastpath_put(lt, lock)
+	DB_LOCKTAB *lt;
+	DB_LOCK *lock;
+{
+	DB_LOCKREGION *region;
+	DB_LOCKER *sh_locker;
+	u_int64_t *hold, w, nw;
+
+	region = lt->reginfo.primary;
+	sh_locker = lock->ilock_latch;
+	hold = &sh_locker->fastpath_holds[lock->ndx];
+
+	w = __atomic_load_n(hold, __ATOMIC_SEQ_CST);
+	do {
+		/*
+		 * Already released by DB_LOCK_PUT_ALL or lock_id_free, and
+		 * possibly taken again since by a later request.
+		 */
+		if (w == 0 || FASTPATH_HOLD_SLOT(w) != lock->partition + 1 ||
+		    FASTPATH_HOLD_GEN(w) != lock->gen)
+			goto out;
+		nw = FASTPATH_HOLD_COUNT(w) == 1 ? 0 : w - 1;
+	} while (!__atomic_compare_exchange_n(hold, &w, nw, 0,
+		__ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST));
+	(void)__atomic_sub_fetch(&region->fastpath_slots[lock->partition].readers,
+	    1, __ATOMIC_SEQ_CST);
+
+out:	LOCK_INIT(*lock);
+	return (0);
+}
+
+/* Release every fast-path hold of a locker. */
+static void
+__lock_fastpath_release_all(lt, sh_locker)
+	DB_LOCKTAB *lt;
+	DB_LOCKER *sh_locker;
+{
+	DB_LOCKREGION *region;
+	u_int64_t w;
+	int i;
+
+	region = lt->reginfo.primary;
+	for (i = 0; i < DB_LOCKER_FASTPATH_HOLDS; i++) {
+		if (__atomic_load_n(&sh_locker->fastpath_holds[i],
+			__ATOMIC_SEQ_CST) == 0)
+			continue;
+		w = __atomic_exchange_n(&sh_locker->fastpath_holds[i], 0,
+		    __ATOMIC_SEQ_CST);
+		if (w == 0)
+			continue;
+		(void)__atomic_sub_fetch(
+		    &region->fastpath_slots[FASTPATH_HOLD_SLOT(w) - 1].readers,
+		    FASTPATH_HOLD_COUNT(w), __ATOMIC_SEQ_CST);
+	}
+}
+
+/*
+ * __lock_fastpath_writer --
+ *	A request in a mode that conflicts with a read on a page.  Close the
+ *	page's slot to new fast-path readers and wait for the current ones to
+ *	go away.  On success the caller owns a strong reference on *fpp which
+ *	it drops once the request has been resolved in the lock table.
+ */
+static int
+__lock_fastpath_writer(lt, flags, obj, lock, fpp)
+	DB_LOCKTAB *lt;
+	u_int32_t flags;
+	const DBT *obj;
+	DB_LOCK *lock;
+	DB_LOCK_FASTPATH_SLOT **fpp;
+{
+	DB_ENV *dbenv;
+	DB_LOCKREGION *region;
+	DB_LOCK_FASTPATH_SLOT *fp;
+	DB_LOCKOBJ *sh_obj;
+	struct __db_lock *lp;
+	u_int32_t ndx, partition;
+	int ret, wanted, waited;
+
+	dbenv = lt->dbenv;
+	region = lt->reginfo.primary;
+	*fpp = NULL;
+
+	if (obj != NULL) {
+		if (!is_fastpath_pageobj(obj))
+			return (0);
+		OBJECT_INDX(lt, region, obj, ndx, partition);
+		COMPQUIET(partition, 0);
+	} else {
+		/* Upgrading a lock we already hold. */
+		if (!LOCK_ISSET(*lock) || LOCK_ISFASTPATH(*lock))
+			return (0);
+		lp = (struct __db_lock *)R_ADDR(&lt->reginfo, lock->off);
+		sh_obj = lp->lockobj;
+		if (!is_pagelock(sh_obj))
+			return (0);
+		ndx = sh_obj->index;
+	}
+	fp = &region->fastpath_slots[ndx % region->fastpath_nslots];
+
+	(void)__atomic_add_fetch(&fp->strong, 1, __ATOMIC_SEQ_CST);
+	ret = wanted = 0;
+	for (waited = 0;
+	    __atomic_load_n(&fp->readers, __ATOMIC_SEQ_CST) != 0;
+	    waited += FASTPATH_POLL_US) {
+		if (LF_ISSET(DB_LOCK_NOWAIT)) {
+			ret = DB_LOCK_NOTGRANTED;
+			break;
+		}
+		if (waited >= dbenv->attr.lock_fastpath_max_wait) {
+			ret = DB_LOCK_DEADLOCK;
+			break;
+		}
+		/* Let the holders know, so cursors release what they have. */
+		if (!wanted) {
+			(void)__atomic_add_fetch(&fp->wanted, 1,
+			    __ATOMIC_SEQ_CST);
+			wanted = 1;
+		}
+		usleep(FASTPATH_POLL_US);
+	}
+	if (wanted)
+		(void)__atomic_sub_fetch(&fp->wanted, 1, __ATOMIC_SEQ_CST);
+	if (ret != 0) {
+		(void)__atomic_sub_fetch(&fp->strong, 1, __ATOMIC_SEQ_CST);
+		return (ret);
+	}
+	*fpp = fp;
+	return (0);
+}
+
+/*
+ * Does a writer wait on a fast-path slot this locker holds?  Called with
+ * the locker's partition locked.
+ */
+static int
+__lock_fastpath_wanted(lt, sh_locker)
+	DB_LOCKTAB *lt;
+	DB_LOCKER *sh_locker;
+{
+	DB_LOCKREGION *region;
+	u_int64_t w;
+	int i;
+
+	region = lt->reginfo.primary;
+	if (region->fastpath_nslots == 0)
+		return (0);
+	for (i = 0; i < DB_LOCKER_FASTPATH_HOLDS; i++) {
+		w = __atomic_load_n(&sh_locker->fastpath_holds[i],
+		    __ATOMIC_SEQ_CST);
+		if (w != 0 && __atomic_load_n(
+		    &region->fastpath_slots[FASTPATH_HOLD_SLOT(w) - 1].wanted,
+		    __ATOMIC_SEQ_CST) != 0)
+			return (1);
+	}
+	return (0);
+}
+
 int __get_lockerid_from_lock(DB_ENV *dbenv, u_int32_t locker)
 {
 	DB_LOCKTAB *lt = dbenv->lk_handle;
@@ -1558,6 +1908,10 @@ __lock_vec(dbenv, locker, flags, list, nlist, elistp)
 			if (list[i].op != DB_LOCK_PREPARE && sh_locker)
 				F_SET(sh_locker, DB_LOCKER_DELETED);
 
+			if (sh_locker && (list[i].op == DB_LOCK_PUT_ALL ||
+			    list[i].op == DB_LOCK_PUT_READ))
+				__lock_fastpath_release_all(lt, sh_locker);
+
 			/* Now traverse the locks, releasing each one. */
 			lp = sh_locker ? SH_LIST_FIRST(&sh_locker->heldby, __db_lock) : NULL;
 			for ( ; lp != NULL; lp = next_lock) {
@@ -2165,6 +2519,67 @@ void comdb2_dump_blockers(DB_ENV *dbenv)
 		holdarr[holdix++] = x;                                         \
 	} while (0)
 
+#define	WFG_MAX_HOLDERS	64
+
+static inline u_int32_t
+__lock_master_id(lt, sh_locker)
+	DB_LOCKTAB *lt;
+	DB_LOCKER *sh_locker;
+{
+	if (sh_locker->master_locker == INVALID_ROFF)
+		return (sh_locker->id);
+	return (((DB_LOCKER *)R_ADDR(&lt->reginfo,
+		    sh_locker->master_locker))->id);
+}
+
+/*
+ * __lock_wfg_waiter --
+ *	Hand the holders of sh_obj, which is what the deadlock detector
+ *	considers waiter lp to be waiting for, to the incremental waits-for
+ *	graph.  The object partition must be locked.  Returns non-zero if the
+ *	regular detector should run.
+ */
+static int
+__lock_wfg_waiter(lt, sh_obj, lp, refresh)
+	DB_LOCKTAB *lt;
+	DB_LOCKOBJ *sh_obj;
+	struct __db_lock *lp;
+	int refresh;
+{
+	struct __db_lock *hp;
+	u_int32_t holders[WFG_MAX_HOLDERS], id, nholders, waiter;
+	int force;
+
+	/*
+	 * Always record the wait, even when we already know the detector has
+	 * to run: the node's wait count has to match the unblock that comes
+	 * when the waiter wakes, and later searches need the edges.
+	 */
+	waiter = __lock_master_id(lt, lp->holderp);
+	nholders = 0;
+	force = 0;
+	for (hp = SH_TAILQ_FIRST(&sh_obj->holders, __db_lock); hp != NULL;
+	    hp = SH_TAILQ_NEXT(hp, links, __db_lock)) {
+		if (hp->status != DB_LSTAT_HELD)
+			continue;
+		id = __lock_master_id(lt, hp->holderp);
+		if (id == waiter) {
+			/* The detector treats this as a deadlock unless first. */
+			if (SH_TAILQ_FIRST(&sh_obj->waiters, __db_lock) != lp)
+				force = 1;
+			continue;
+		}
+		if (nholders == WFG_MAX_HOLDERS) {
+			force = 1;
+			break;
+		}
+		holders[nholders++] = id;
+	}
+	if (__lock_wfg_block(lt->dbenv, waiter, holders, nholders, refresh))
+		force = 1;
+	return (force);
+}
+
 /*
  * __lock_get_internal --
  *
@@ -2684,6 +3099,7 @@ __lock_get_internal_int(lt, locker, in_locker, flags, obj, lock_mode, timeout,
 		newl->refcount = 1;
 		newl->mode = lock_mode;
 		newl->lockobj = sh_obj;
+		__lock_fastpath_strong(lt, sh_obj, lock_mode, 1);
 
 		/*
 		 * Now, insert the lock onto its locker's list.
@@ -2729,6 +3145,8 @@ upgrade:
 			    lock->off);
 		if (IS_WRITELOCK(lock_mode) && !IS_WRITELOCK(lp->mode))
 			sh_locker->nwrites++;
+		__lock_fastpath_strong(lt, sh_obj, lp->mode, -1);
+		__lock_fastpath_strong(lt, sh_obj, lock_mode, 1);
 		lp->mode = lock_mode;
 		if (is_pagelock(sh_obj) &&
 		    IS_WRITELOCK(lock_mode) &&
@@ -2841,7 +3259,8 @@ upgrade:
 			}
 		}
 
-		region->need_dd = 1;
+		if (!dbenv->attr.deadlock_incremental_detect)
+			region->need_dd = 1;
 
 		/*
 		 * First check to see if this txn has expired.
@@ -2886,6 +3305,22 @@ upgrade:
 			    &sh_locker->lk_expire)))
 			region->next_timeout = sh_locker->lk_expire;
 
+		/*
+		 * With the incremental detector, only run the full one if our
+		 * new edges might close a cycle.  Every waiter records its
+		 * edges, so that later searches see them, but lock timeouts
+		 * and wait-die timestamps are still resolved by full passes.
+		 */
+		if (dbenv->attr.deadlock_incremental_detect) {
+			if (__lock_wfg_waiter(lt, sh_obj, newl, 0) ||
+			    sh_locker->timestamp != 0 ||
+			    LOCK_TIME_ISVALID(&region->next_timeout)) {
+				region->need_dd = 1;
+				no_dd = 0;
+			} else
+				no_dd = 1;
+		}
+
 		/* set waiting status for master_locker */
 		if (sh_locker->master_locker == INVALID_ROFF)
 			sh_locker->wstatus = 1;
@@ -2911,6 +3346,7 @@ upgrade:
 		if (LF_ISSET(DB_LOCK_SWITCH) &&
 		    (ret = __lock_put_nolock(dbenv,
 			    lock, &ihold, DB_LOCK_NOWAITERS)) != 0) {
+			__lock_wfg_unblock(dbenv, __lock_master_id(lt, sh_locker));
 			lock_locker_partition(region, lpartition);
 			lock_obj_partition(region, partition);
 			__lock_remove_waiter(lt, sh_obj, newl, DB_LSTAT_FREE);
@@ -2986,6 +3422,8 @@ upgrade:
 			}
 		}
 
+		__lock_wfg_unblock(dbenv, __lock_master_id(lt, sh_locker));
+
 		LOCKREGION(dbenv, (DB_LOCKTAB *)dbenv->lk_handle);
 		lock_locker_partition(region, lpartition);
 		lock_obj_partition(region, partition);
@@ -3243,6 +3681,8 @@ __lock_get_internal(lt, locker, sh_locker, flags, obj, lock_mode, timeout, lock)
 	db_timeout_t timeout;
 	DB_LOCK *lock;
 {
+	DB_LOCKREGION *region = lt->reginfo.primary;
+	DB_LOCK_FASTPATH_SLOT *fp = NULL;
 	int rc, use_latch = 0;
 
 	if (use_page_latches(lt->dbenv)) {
@@ -3261,9 +3701,38 @@ __lock_get_internal(lt, locker, sh_locker, flags, obj, lock_mode, timeout, lock)
 
 	if (use_latch) {
 		rc = __get_page_latch(lt, locker, flags, obj, lock_mode, lock);
+	} else if (region->fastpath_nslots == 0) {
+		rc = __lock_get_internal_int(lt, locker, &sh_locker, flags, obj,
+		    lock_mode, timeout, lock);
 	} else {
+		if (LOCK_ISFASTPATH(*lock) &&
+		    LF_ISSET(DB_LOCK_UPGRADE | DB_LOCK_SWITCH)) {
+			/* Nothing in the lock table to convert; start over. */
+			if (obj == NULL)
+				return (EINVAL);
+			__lock_fastpath_put(lt, lock);
+			LF_CLR(DB_LOCK_UPGRADE | DB_LOCK_SWITCH);
+		}
+		if (lock_mode == DB_LOCK_READ) {
+			if (lt->dbenv->attr.lock_fastpath_reads &&
+			    !LF_ISSET(~DB_LOCK_NOWAIT) &&
+			    is_fastpath_pageobj(obj) &&
+			    __lock_fastpath_get(lt, locker, obj, lock) == 0)
+				return (0);
+		} else if (CONFLICTS(lt, region, DB_LOCK_READ, lock_mode) &&
+		    (rc = __lock_fastpath_writer(lt, flags, obj, lock,
+		    &fp)) != 0)
+			return (rc);
+
 		rc = __lock_get_internal_int(lt, locker, &sh_locker, flags, obj,
 		    lock_mode, timeout, lock);
+
+		if (fp != NULL)
+			(void)__atomic_sub_fetch(&fp->strong, 1,
+			    __ATOMIC_SEQ_CST);
+		if (rc == 0 && lock_mode == DB_LOCK_READ && sh_locker &&
+		    F_ISSET(sh_locker, DB_LOCKER_READONLY))
+			fastpath_locker = sh_locker;
 	}
 
 	if (sh_locker && F_ISSET(sh_locker, DB_LOCKER_TRACK)) {
@@ -3492,6 +3961,12 @@ __lock_put_nolock(dbenv, lock, runp, flags)
 		return ret;
 	}
 
+	if (LOCK_ISFASTPATH(*lock)) {
+		if (runp)
+			*runp = 0;
+		return __lock_fastpath_put(dbenv->lk_handle, lock);
+	}
+
 	lt = dbenv->lk_handle;
 	region = lt->reginfo.primary;
 
@@ -3559,6 +4034,10 @@ __lock_downgrade(dbenv, lock, new_mode, flags)
 	if (F_ISSET(dbenv, DB_ENV_NOLOCKING))
 		return (0);
 
+	/* Fast-path locks are reads, there is nothing to downgrade. */
+	if (LOCK_ISFASTPATH(*lock))
+		return (0);
+
 	lt = dbenv->lk_handle;
 	region = lt->reginfo.primary;
 	partition = lock->partition;
@@ -3582,6 +4061,8 @@ __lock_downgrade(dbenv, lock, new_mode, flags)
 	if (new_mode == DB_LOCK_WWRITE)
 		F_SET(sh_locker, DB_LOCKER_DIRTY);
 
+	__lock_fastpath_strong(lt, lockp->lockobj, lockp->mode, -1);
+	__lock_fastpath_strong(lt, lockp->lockobj, new_mode, 1);
 	lockp->mode = new_mode;
 	lock->mode = new_mode;
 
@@ -3731,7 +4212,8 @@ __lock_put_internal(lt, lockp, lock, obj_ndx, need_dd, flags)
 	 * If we did not promote anyone; we need to run the deadlock
 	 * detector again.
 	 */
-	if (state_changed == 0 || region->need_dd) {
+	if ((state_changed == 0 && !dbenv->attr.deadlock_incremental_detect) ||
+	    region->need_dd) {
 		*need_dd = 1;
 	}
 
@@ -3796,6 +4278,7 @@ __lock_freelock(lt, lockp, sh_locker, flags)
 			abort();
 		}
 #endif
+		__lock_fastpath_strong(lt, lockp->lockobj, lockp->mode, -1);
 		lockp->status = DB_LSTAT_FREE;
 		Pthread_mutex_lock(&lockp->lsns_mtx);
 		for (lp_lsn = SH_LIST_FIRST(&lockp->lsns, __db_lock_lsn);
@@ -4108,6 +4591,8 @@ __lock_freelocker(lt, region, sh_locker, indx)
 	if (F_ISSET(sh_locker, DB_LOCKER_TRACK))
 		logmsg(LOGMSG_USER, "LOCKID %u FREED\n", sh_locker->id);
 
+	__lock_fastpath_release_all(lt, sh_locker);
+
 	sh_locker->has_pglk_lsn = 0;
 	sh_locker->ntrackedlocks = 0;
 	sh_locker->maxtrackedlocks = 0;
@@ -4357,6 +4842,8 @@ __lock_getlocker_int(lt, locker, indx, partition, create, prop, retp,
 		sh_locker->nhandlelocks = 0;
 		sh_locker->nwrites = 0;
 		sh_locker->has_waiters = 0;
+		memset(sh_locker->fastpath_holds, 0,
+		    sizeof(sh_locker->fastpath_holds));
 		sh_locker->priority = prop ? prop->priority : 0;
 		sh_locker->num_retries = prop ? prop->retries : 0;
 		if (prop && prop->flags & DB_LOCK_ID_LOWPRI)
@@ -4854,6 +5341,16 @@ __lock_promote(lt, obj, changed, flags)
 		state_changed = 1;
 	}
 
+	/* The remaining waiters now wait for a different set of holders. */
+	if (had_waiters && lt->dbenv->attr.deadlock_incremental_detect) {
+		for (lp_w = SH_TAILQ_FIRST(&obj->waiters, __db_lock);
+		    lp_w != NULL; lp_w = SH_TAILQ_NEXT(lp_w, links, __db_lock)) {
+			if (lp_w->status == DB_LSTAT_WAITING &&
+			    __lock_wfg_waiter(lt, obj, lp_w, 1))
+				region->need_dd = 1;
+		}
+	}
+
 	/*
 	 * If this object had waiters and doesn't any more, then we need
 	 * to remove it from the dd_obj list.
@@ -5040,6 +5537,11 @@ __lock_trade(dbenv, lock, new_locker, create)
 		return __latch_trade(dbenv, lnode->latch, new_locker);
 	}
 
+	if (LOCK_ISFASTPATH(*lock)) {
+		__db_err(dbenv, "Cannot trade a fast-path lock");
+		return (EINVAL);
+	}
+
 
 	/* Make sure that we can get new locker and add this lock to it. */
 	LOCKER_INDX(lt, region, new_locker, locker_ndx);
@@ -6730,6 +7232,11 @@ __lock_to_dbt_unlocked(dbenv, lock, dbt)
 	u_int8_t *lockdata;
 	int rc = 0;
 
+	if (LOCK_ISFASTPATH(*lock)) {
+		__db_err(dbenv, "DB_LOCK->lock_to_dbt: fast-path lock");
+		return (EINVAL);
+	}
+
 	lockp = (struct __db_lock *)R_ADDR(&lt->reginfo, lock->off);
 	if (lock->gen != lockp->gen) {
 		__db_err(dbenv, __db_lock_invalid, "DB_LOCK->lock_put");
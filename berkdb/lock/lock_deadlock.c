@@ -2587,3 +2587,183 @@ berkdb_register_deadlock_callback(void (*callback) (struct berkdb_deadlock_info
 {
 	berkdb_deadlock_callback = callback;
 }
+
+/*
+ * Incremental waits-for graph.
+ *
+ * __dd_build rebuilds the whole waits-for map from the lock region on every
+ * detector pass.  With deadlock_incremental_detect set, lock.c instead
+ * records the master lockers holding an object as a master locker blocks on
+ * it, and refreshes those edges whenever the object's holders change.  A
+ * new or changed set of edges can only close a cycle through the waiter it
+ * belongs to, so a search from that waiter is all that's needed to decide
+ * whether the regular detector has to run.  When it does, victim selection
+ * is the regular detector's, and the periodic detector thread still makes
+ * full passes as a backstop for edges the graph didn't see.
+ *
+ * The graph is kept under the single wfg_lk.  A search follows edges across
+ * every lock partition, so partitioning the graph would mean taking several
+ * partition locks per search in some order, and the full pass this replaces
+ * already locks the whole region and every locker partition.  wfg_lk is
+ * only taken by a locker that is about to sleep on a lock, by a promotion
+ * on an object that still has waiters, and by a waiter waking up, never on
+ * an uncontended lock_get or lock_put; a lookup or a search bounded by
+ * deadlock_incremental_max_visit is short next to the wait that follows.
+ */
+typedef struct wfg_node {
+	u_int32_t	id;		/* Waiting master locker. */
+	u_int32_t	nwaits;		/* Blocked lockers in its family. */
+	u_int32_t	nedges;
+	u_int32_t	aedges;
+	u_int32_t	*edges;		/* Master lockers it waits for. */
+	u_int32_t	mark;		/* Search generation. */
+} wfg_node_t;
+
+static pthread_mutex_t wfg_lk = PTHREAD_MUTEX_INITIALIZER;
+static hash_t *wfg_nodes = NULL;
+static wfg_node_t **wfg_stack = NULL;
+static u_int32_t wfg_stacksz = 0;
+static u_int32_t wfg_mark = 0;
+static u_int32_t wfg_count = 0;
+
+static int
+wfg_clear_mark(void *obj, void *arg)
+{
+	((wfg_node_t *)obj)->mark = 0;
+	return 0;
+}
+
+/*
+ * __lock_wfg_block --
+ *	Record that master locker waiter waits for holders.  With refresh set
+ *	the holders replace the edges from an earlier call rather than a new
+ *	wait being counted.  Returns non-zero if the new edges may have closed
+ *	a cycle.
+ *
+ * PUBLIC: int __lock_wfg_block __P((DB_ENV *, u_int32_t, u_int32_t *,
+ * PUBLIC:     u_int32_t, int));
+ */
+int
+__lock_wfg_block(dbenv, waiter, holders, nholders, refresh)
+	DB_ENV *dbenv;
+	u_int32_t waiter;
+	u_int32_t *holders;
+	u_int32_t nholders;
+	int refresh;
+{
+	wfg_node_t *n, *c, *t;
+	u_int32_t i, j, sp, visited;
+	int cycle = 0;
+
+	Pthread_mutex_lock(&wfg_lk);
+	if (wfg_nodes == NULL)
+		wfg_nodes = hash_init_o(offsetof(wfg_node_t, id),
+		    sizeof(u_int32_t));
+
+	if ((n = hash_find(wfg_nodes, &waiter)) == NULL) {
+		if (refresh && nholders == 0)
+			goto out;
+		if (__os_calloc(dbenv, 1, sizeof(*n), &n) != 0) {
+			cycle = 1;
+			goto out;
+		}
+		n->id = waiter;
+		hash_add(wfg_nodes, n);
+		wfg_count++;
+	}
+	if (!refresh)
+		n->nwaits++;
+	else if (n->nwaits <= 1)
+		n->nedges = 0;
+
+	if (n->nedges + nholders > n->aedges) {
+		u_int32_t aedges = n->nedges + nholders + 8;
+		if (__os_realloc(dbenv, aedges * sizeof(u_int32_t),
+			&n->edges) != 0) {
+			cycle = 1;
+			goto out;
+		}
+		n->aedges = aedges;
+	}
+	for (i = 0; i < nholders; i++) {
+		for (j = 0; j < n->nedges; j++)
+			if (n->edges[j] == holders[i])
+				break;
+		if (j == n->nedges)
+			n->edges[n->nedges++] = holders[i];
+	}
+	if (nholders == 0)
+		goto out;
+
+	if (wfg_stacksz < wfg_count) {
+		if (__os_realloc(dbenv, wfg_count * sizeof(wfg_node_t *),
+			&wfg_stack) != 0) {
+			cycle = 1;
+			goto out;
+		}
+		wfg_stacksz = wfg_count;
+	}
+	if (++wfg_mark == 0) {
+		hash_for(wfg_nodes, wfg_clear_mark, NULL);
+		wfg_mark = 1;
+	}
+
+	/* Every node is pushed at most once, so the stack can't overflow. */
+	visited = 0;
+	sp = 0;
+	n->mark = wfg_mark;
+	wfg_stack[sp++] = n;
+	while (sp > 0) {
+		c = wfg_stack[--sp];
+		for (i = 0; i < c->nedges; i++) {
+			if (c->edges[i] == waiter) {
+				cycle = 1;
+				goto out;
+			}
+			if ((t = hash_find(wfg_nodes, &c->edges[i])) == NULL ||
+			    t->mark == wfg_mark)
+				continue;
+			if (++visited >
+			    (u_int32_t)dbenv->attr.deadlock_incremental_max_visit) {
+				cycle = 1;
+				goto out;
+			}
+			t->mark = wfg_mark;
+			wfg_stack[sp++] = t;
+		}
+	}
+
+out:	Pthread_mutex_unlock(&wfg_lk);
+	return (cycle);
+}
+
+/*
+ * __lock_wfg_unblock --
+ *	A locker in master locker waiter's family stopped waiting.
+ *
+ * PUBLIC: void __lock_wfg_unblock __P((DB_ENV *, u_int32_t));
+ */
+void
+__lock_wfg_unblock(dbenv, waiter)
+	DB_ENV *dbenv;
+	u_int32_t waiter;
+{
+	wfg_node_t *n;
+
+	if (__atomic_load_n(&wfg_count, __ATOMIC_RELAXED) == 0)
+		return;
+
+	Pthread_mutex_lock(&wfg_lk);
+	if ((n = hash_find(wfg_nodes, &waiter)) != NULL) {
+		if (n->nwaits > 0)
+			n->nwaits--;
+		if (n->nwaits == 0) {
+			hash_del(wfg_nodes, n);
+			if (n->edges)
+				__os_free(dbenv, n->edges);
+			__os_free(dbenv, n);
+			wfg_count--;
+		}
+	}
+	Pthread_mutex_unlock(&wfg_lk);
+}
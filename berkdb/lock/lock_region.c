@@ -192,6 +192,7 @@ add_to_lock_partition(DB_ENV *dbenv, DB_LOCKTAB *lt,
 }
 
 int init_latches(DB_ENV *, DB_LOCKTAB *);
+int init_fastpath(DB_ENV *, DB_LOCKTAB *);
 
 /*
  * __lock_init --
@@ -425,6 +426,9 @@ mem_err:		__db_err(dbenv,
 
 	init_latches(dbenv, lt);
 
+	if ((ret = init_fastpath(dbenv, lt)) != 0)
+		return (ret);
+
 	return (0);
 }
 
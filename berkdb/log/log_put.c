@@ -44,6 +44,7 @@ static const char revid[] = "$Id: log_put.c,v 11.145 2003/09/13 19:20:39 bostic
 #include <netinet/in.h>
 
 #include "logmsg.h"
+#include <epochlib.h>
 #include <sys_wrap.h>
 #include <poll.h>
 
@@ -61,6 +62,7 @@ static int __log_fill __P((DB_LOG *, DB_LSN *, void *, u_int32_t));
 static int __log_fill_segments __P((DB_LOG *, DB_LSN *, DB_LSN *, void *,
 	u_int32_t));
 static int __log_flush_commit __P((DB_ENV *, const DB_LSN *, u_int32_t));
+static int __log_flush_group __P((DB_LOG *, const DB_LSN *, int));
 static int __log_newfh __P((DB_LOG *));
 static int __log_put_next __P((DB_ENV *,
 	DB_LSN *, u_int64_t *, DBT *, const DBT *, HDR *, DB_LSN *, int,
@@ -90,6 +92,9 @@ int gbl_abort_on_illegal_log_put = 0;
 
 extern int gbl_wal_osync;
 
+/* Let a commit flush wait this long for concurrent committers to join it */
+int gbl_log_group_commit_usec = 0;
+
 extern char *gbl_physrep_source_dbname;
 
 /*
@@ -1335,6 +1340,17 @@ __log_lwr_lsn(dblp)
 	}
 }
 
+static inline int
+__log_hist_bucket(v)
+	u_int64_t v;
+{
+	int b;
+
+	for (b = 0; v > 1 && b < DB_LOG_HIST_BUCKETS - 1; b++)
+		v >>= 1;
+	return (b);
+}
+
 /*
  * __log_flush_int --
  *	Write all records less than or equal to the specified LSN; internal
@@ -1347,6 +1363,37 @@ __log_flush_int(dblp, lsnp, release)
 	DB_LOG *dblp;
 	const DB_LSN *lsnp;
 	int release;
+{
+	LOG *lp;
+	u_int64_t start;
+	int ret;
+
+	/* Only committers (release set) are accounted for. */
+	if (!release)
+		return (__log_flush_group(dblp, lsnp, release));
+
+	lp = dblp->reginfo.primary;
+	start = comdb2_time_epochus();
+	ret = __log_flush_group(dblp, lsnp, release);
+
+	/* The region is locked again on return. */
+	lp->stat.st_commit_usec_hist[
+	    __log_hist_bucket(comdb2_time_epochus() - start)]++;
+	return (ret);
+}
+
+/*
+ * __log_flush_group --
+ *	Group commit.  The first committer to arrive flushes; the ones that
+ *	arrive while a flush is in progress queue on lp->commits and are
+ *	released by the flush that covers their LSN.  If none does, the first
+ *	of them is elected to flush for all of the rest.
+ */
+static int
+__log_flush_group(dblp, lsnp, release)
+	DB_LOG *dblp;
+	const DB_LSN *lsnp;
+	int release;
 {
 	struct __db_commit *commit, *tcommit;
 
@@ -1495,6 +1542,22 @@ __log_flush_int(dblp, lsnp, release)
 			return (0);
 	}
 
+	/*
+	 * If the last flush covered more than one commit, commits are
+	 * arriving concurrently: hold off for a bit so the ones right
+	 * behind us can queue up (in_flush is raised) and share our fsync.
+	 */
+	if (release && gbl_log_group_commit_usec > 0 && lp->gc_last_group > 1) {
+		lp->in_flush++;
+		R_UNLOCK(dbenv, &dblp->reginfo);
+		__os_sleep(dbenv, 0, gbl_log_group_commit_usec);
+		R_LOCK(dbenv, &dblp->reginfo);
+		lp->in_flush--;
+		if (log_compare(&flush_lsn, &lp->t_lsn) < 0)
+			flush_lsn = lp->t_lsn;
+		++lp->stat.st_gc_delays;
+	}
+
 	/*
 	 * Protect flushing with its own mutex so we can release
 	 * the region lock except during file switches.
@@ -1697,6 +1760,10 @@ done:	listcnt = 0;
 			}
 		}
 	}
+	if (ncommit != 0) {
+		lp->gc_last_group = ncommit;
+		lp->stat.st_group_hist[__log_hist_bucket(ncommit)]++;
+	}
 	if (lp->stat.st_maxcommitperflush < ncommit)
 		lp->stat.st_maxcommitperflush = ncommit;
 	if (lp->stat.st_mincommitperflush > ncommit ||
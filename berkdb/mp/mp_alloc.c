@@ -49,7 +49,6 @@ __memp_dump_bufferpool_info(dbenv, f)
 {
 	BH *bhp;
 	DB_MPOOL_HASH *dbht, *hp;
-	DB_MUTEX *mutexp;
 	REGINFO *memreg;
 	MPOOL *mp, *c_mp;
 	DB_MPOOL *dbmp;
@@ -75,14 +74,13 @@ __memp_dump_bufferpool_info(dbenv, f)
 			hp = &dbht[count];
 
 
-			mutexp = &hp->hash_mutex;
-			MUTEX_LOCK(dbenv, mutexp);
+			MP_HASH_LOCK(dbenv, hp);
 
 			if ((bhp =
 				SH_TAILQ_FIRST(&hp->hash_bucket,
 				    __bh)) == NULL) {
 				/*fprintf(f, " (empty)\n"); */
-				MUTEX_UNLOCK(dbenv, mutexp);
+				MP_HASH_UNLOCK(dbenv, hp);
 				continue;
 			}
 
@@ -98,7 +96,7 @@ __memp_dump_bufferpool_info(dbenv, f)
 
 			logmsgf(LOGMSG_USER, f, "\n");
 
-			MUTEX_UNLOCK(dbenv, mutexp);
+			MP_HASH_UNLOCK(dbenv, hp);
 		}
 		logmsgf(LOGMSG_USER, f, "LRU_COUNT = %d\n", c_mp->lru_count);
 		logmsgf(LOGMSG_USER, f, "\n");
@@ -246,7 +244,6 @@ __memp_alloc_flags(dbmp, memreg, mfp, len, offsetp, flags, retp)
 	BH *bhp;
 	DB_ENV *dbenv;
 	DB_MPOOL_HASH *dbht, *hp, *hp_end, *hp_tmp;
-	DB_MUTEX *mutexp;
 	MPOOL *c_mp;
 	MPOOLFILE *bh_mfp;
 	size_t freed_space;
@@ -478,8 +475,7 @@ found:		if (offsetp != NULL)
 
 		/* Unlock the region and lock the hash bucket. */
 		R_UNLOCK(dbenv, memreg);
-		mutexp = &hp->hash_mutex;
-		MUTEX_LOCK(dbenv, mutexp);
+		MP_HASH_LOCK(dbenv, hp);
 
 #ifdef DIAGNOSTIC
 		__memp_check_order(hp);
@@ -495,7 +491,7 @@ found:		if (offsetp != NULL)
 		 */
 		if ((bhp =
 			SH_TAILQ_FIRST(&hp->hash_bucket,
-			    __bh)) == NULL ||bhp->ref != 0 ||
+			    __bh)) == NULL ||BH_REF(bhp) != 0 ||
 		    bhp->priority > priority)
 			goto next_hb;
 
@@ -522,9 +518,9 @@ found:		if (offsetp != NULL)
 				goto next_hb;
 			}
 
-			++bhp->ref;
+			(void)BH_REF_INCR(bhp);
 			ret = __memp_bhwrite(dbmp, hp, bh_mfp, bhp, 0);
-			--bhp->ref;
+			(void)BH_REF_DECR(bhp);
 			if (ret == 0) {
 				++c_mp->stat.st_rw_evict;
 				if(ISLEAF(bhp->buf)) ++c_mp->stat.st_rw_levict;
@@ -545,7 +541,7 @@ found:		if (offsetp != NULL)
 		 * something to allocate, avoid selecting this buffer again
 		 * by making it the bucket's least-desirable buffer.
 		 */
-		if (ret != 0 || bhp->ref != 0) {
+		if (ret != 0 || BH_REF(bhp) != 0) {
 			if (ret != 0 && aggressive)
 				__memp_bad_buffer(hp);
 			goto next_hb;
@@ -575,7 +571,7 @@ found:		if (offsetp != NULL)
 		 * hash bucket lock has already been discarded.
 		 */
 		if (0) {
-next_hb:		MUTEX_UNLOCK(dbenv, mutexp);
+next_hb:		MP_HASH_UNLOCK(dbenv, hp);
 		}
 		R_LOCK(dbenv, memreg);
 
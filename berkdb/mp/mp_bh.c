@@ -17,6 +17,7 @@ static const char revid[] = "$Id: mp_bh.c,v 11.86 2003/07/02 20:02:37 mjc Exp $"
 #include <sys/types.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <sched.h>
 
 #include <string.h>
 #endif
@@ -411,11 +412,9 @@ __memp_pgread(dbmfp, hp, bhp, can_create, is_recovery_page)
 {
 	DB_ENV *dbenv;
 	MPOOLFILE *mfp;
-	DB_MUTEX *mutexp;
 	size_t len, nr, pagesize;
 	int ret, try_recover;
 
-	mutexp = &hp->hash_mutex;
 	dbenv = dbmfp->dbenv;
 	mfp = dbmfp->mfp;
 	pagesize = mfp->stat.st_pagesize;
@@ -427,7 +426,7 @@ __memp_pgread(dbmfp, hp, bhp, can_create, is_recovery_page)
 	/* Lock the buffer and swap the hash bucket lock for the buffer lock. */
 	F_SET(bhp, BH_LOCKED | BH_TRASH);
 	MUTEX_LOCK(dbenv, &bhp->mutex);
-	MUTEX_UNLOCK(dbenv, mutexp);
+	MP_HASH_UNLOCK(dbenv, hp);
 
 	/*
 	 * Temporary files may not yet have been created.  We don't create
@@ -505,7 +504,7 @@ recover_page:
 
 	/* Unlock the buffer and reacquire the hash bucket lock. */
 err:	MUTEX_UNLOCK(dbenv, &bhp->mutex);
-	MUTEX_LOCK(dbenv, mutexp);
+	MP_HASH_LOCK(dbenv, hp);
 
 	/*
 	 * If no errors occurred, the data is now valid, clear the BH_TRASH
@@ -780,7 +779,7 @@ __memp_pgwrite_multi(dbenv, dbmfp, hps, bhps, numpages, wrrec)
 		if (!F_ISSET(bhp, BH_LOCKED)) {
 			F_SET(bhp, BH_LOCKED);
 			MUTEX_LOCK(dbenv, &bhp->mutex);
-			MUTEX_UNLOCK(dbenv, &hp->hash_mutex);
+			MP_HASH_UNLOCK(dbenv, hp);
 		}
 	}
 
@@ -1009,7 +1008,7 @@ file_dead:
 		hp = hps[i];
 
 		MUTEX_UNLOCK(dbenv, &bhp->mutex);
-		MUTEX_LOCK(dbenv, &hp->hash_mutex);
+		MP_HASH_LOCK(dbenv, hp);
 
 		/*
 		 * If we rewrote the page, it will need processing by the pgin
@@ -1197,11 +1196,14 @@ __memp_bhfree(dbmp, hp, bhp, free_mem)
 		    SH_TAILQ_FIRST(&hp->hash_bucket, __bh) == NULL ?
 		    0 : SH_TAILQ_FIRST(&hp->hash_bucket, __bh)->priority;
 
+	/* Lockless readers may still be looking at the buffer. */
+	MP_HASH_WAIT_READERS(hp);
+
 	/*
 	 * Discard the hash bucket's mutex, it's no longer needed, and
 	 * we don't want to be holding it when acquiring other locks.
 	 */
-	MUTEX_UNLOCK(dbenv, &hp->hash_mutex);
+	MP_HASH_UNLOCK(dbenv, hp);
 
 	/*
 	 * Find the underlying MPOOLFILE and decrement its reference count.
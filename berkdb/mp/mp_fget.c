@@ -52,6 +52,7 @@ typedef struct bdb_state_tag bdb_state_type;
 extern int gbl_prefault_udp;
 extern __thread int send_prefault_udp;
 extern __thread DB *prefault_dbp;
+extern __thread int gbl_btpf_expect_page;
 
 extern int db_is_exiting(void);
 void udp_prefault_all(bdb_state_type * bdb_state, unsigned int fileid,
@@ -212,6 +213,105 @@ __memp_falloc_len(mfp, offset, len)
 	}
 }
 
+int gbl_mp_lockless_fget = 0;
+
+/*
+ * Bound on the buffers a lockless lookup walks: a chain that is being
+ * reorganized under us can loop, the sequence check catches it on the next
+ * step but only if we keep taking steps.
+ */
+#define	MP_LOCKLESS_MAXSEARCH	64
+
+/*
+ * __memp_fget_lockless --
+ *	Find and pin a resident, ready buffer without the hash bucket lock.
+ *	Returns DB_NOTFOUND if the caller must take the locked path: the
+ *	bucket was locked or changed under us, the page isn't in the cache,
+ *	the buffer is being read, written or converted, or this is the first
+ *	use of a prefetched page (which is accounted under the lock).
+ *
+ *	We don't touch the buffer's priority or its place in the bucket;
+ *	those are refreshed when the last reference is returned.
+ */
+static int
+__memp_fget_lockless(dbmfp, pgno, addrp)
+	DB_MPOOLFILE *dbmfp;
+	db_pgno_t pgno;
+	void *addrp;
+{
+	BH *bhp;
+	DB_MPOOL *dbmp;
+	DB_MPOOL_HASH *hp;
+	MPOOL *c_mp, *mp;
+	MPOOLFILE *mfp;
+	u_int32_t n_cache, seq, st_hsearch;
+	int ret;
+
+	dbmp = dbmfp->dbenv->mp_handle;
+	mp = dbmp->reginfo[0].primary;
+	mfp = dbmfp->mfp;
+
+	n_cache = NCACHE(mp, mfp, pgno);
+	c_mp = dbmp->reginfo[n_cache].primary;
+	hp = R_ADDR(&dbmp->reginfo[n_cache], c_mp->htab);
+	hp = &hp[NBUCKET(c_mp, mfp, pgno)];
+
+	seq = __atomic_load_n(&hp->hash_seq, __ATOMIC_SEQ_CST);
+	if (seq & 1)
+		return (DB_NOTFOUND);
+
+	/*
+	 * Announce ourselves before looking at any buffer: once the count is
+	 * up, nobody frees a buffer out of this bucket until we're gone.
+	 */
+	(void)__atomic_add_fetch(&hp->hash_readers, 1, __ATOMIC_SEQ_CST);
+
+	ret = DB_NOTFOUND;
+	st_hsearch = 0;
+	for (bhp = SH_TAILQ_FIRST(&hp->hash_bucket, __bh);
+	    bhp != NULL; bhp = SH_TAILQ_NEXT(bhp, hq, __bh)) {
+		if (__atomic_load_n(&hp->hash_seq, __ATOMIC_SEQ_CST) != seq ||
+		    ++st_hsearch > MP_LOCKLESS_MAXSEARCH)
+			break;
+		if (bhp->pgno != pgno || bhp->mpf != mfp)
+			continue;
+
+		/* Leave the overflow check to the locked path. */
+		if (BH_REF(bhp) >= UINT16_T_MAX / 2)
+			break;
+
+		/*
+		 * Pin the buffer, then make sure nobody locked the bucket in
+		 * the meantime; anyone who did will see our reference.
+		 */
+		(void)BH_REF_INCR(bhp);
+		if (F_ISSET(bhp,
+		    BH_LOCKED | BH_TRASH | BH_CALLPGIN | BH_PREFAULT) ||
+		    __atomic_load_n(&hp->hash_seq, __ATOMIC_SEQ_CST) != seq) {
+			(void)BH_REF_DECR(bhp);
+			break;
+		}
+		ret = 0;
+		break;
+	}
+
+	(void)__atomic_sub_fetch(&hp->hash_readers, 1, __ATOMIC_SEQ_CST);
+
+	if (ret != 0)
+		return (ret);
+
+	/* Layer violation */
+	if (ISINTERNAL(bhp->buf))
+		MP_STAT_INCR(mfp->stat.st_cache_ihit);
+	else if (ISLEAF(bhp->buf))
+		MP_STAT_INCR(mfp->stat.st_cache_lhit);
+	MP_STAT_INCR(mfp->stat.st_cache_hit);
+
+	*(void **)addrp = bhp->buf;
+	BH_FGET_INCR(bhp);
+	return (0);
+}
+
 u_int64_t gbl_memp_pgreads = 0;
 
 /*
@@ -235,7 +335,7 @@ __memp_fget_internal(dbmfp, pgnoaddr, flags, addrp, did_io)
 	MPOOL *c_mp, *mp;
 	MPOOLFILE *mfp;
 	u_int32_t n_cache, st_hsearch, alloc_flags;
-	int b_incr, extending, first, ret, is_recovery_page;
+	int b_incr, extending, first, ret, is_recovery_page, pf_hit, pgread;
 	db_pgno_t falloc_off, falloc_len;
 
 	uint64_t start_time_us = 0;
@@ -257,7 +357,7 @@ __memp_fget_internal(dbmfp, pgnoaddr, flags, addrp, did_io)
 	mfp = dbmfp->mfp;
 	alloc_bhp = bhp = NULL;
 	hp = NULL;
-	b_incr = extending = ret = is_recovery_page = 0;
+	b_incr = extending = ret = is_recovery_page = pf_hit = pgread = 0;
 
 	switch (flags) {
 	case DB_MPOOL_LAST:
@@ -315,6 +415,22 @@ __memp_fget_internal(dbmfp, pgnoaddr, flags, addrp, did_io)
 		return (0);
 	}
 
+	/*
+	 * Plain lookups of resident pages can usually skip the bucket lock.
+	 */
+	if (gbl_mp_lockless_fget && (flags & ~DB_MPOOL_COMPACT) == 0 &&
+	    __memp_fget_lockless(dbmfp, *pgnoaddr, addrp) == 0) {
+		gbl_btpf_expect_page = 0;
+#ifdef DIAGNOSTIC
+		R_LOCK(dbenv, dbmp->reginfo);
+		++dbmfp->pinref;
+		R_UNLOCK(dbenv, dbmp->reginfo);
+#endif
+		if (gbl_bb_berkdb_enable_memp_timing)
+			bb_memp_hit(start_time_us);
+		return (0);
+	}
+
 hb_search:
 	/*
 	 * Determine the cache and hash bucket where this page lives and get
@@ -328,7 +444,7 @@ hb_search:
 
 	/* Search the hash chain for the page. */
 retry:	st_hsearch = 0;
-	MUTEX_LOCK(dbenv, &hp->hash_mutex);
+	MP_HASH_LOCK(dbenv, hp);
 	for (bhp = SH_TAILQ_FIRST(&hp->hash_bucket, __bh);
 	    bhp != NULL; bhp = SH_TAILQ_NEXT(bhp, hq, __bh)) {
 		++st_hsearch;
@@ -341,15 +457,15 @@ retry:	st_hsearch = 0;
 		 * need to ensure it doesn't move and its contents remain
 		 * unchanged.
 		 */
-		if (bhp->ref == UINT16_T_MAX) {
+		if (BH_REF(bhp) == UINT16_T_MAX) {
 			__db_err(dbenv,
 			    "%s: page %lu: reference count overflow",
 			    __memp_fn(dbmfp), (u_long)bhp->pgno);
 			ret = EINVAL;
-			MUTEX_UNLOCK(dbenv, &hp->hash_mutex);
+			MP_HASH_UNLOCK(dbenv, hp);
 			goto err;
 		}
-		++bhp->ref;
+		(void)BH_REF_INCR(bhp);
 		b_incr = 1;
 
 		/*
@@ -367,14 +483,14 @@ retry:	st_hsearch = 0;
 			 * and try again.
 			 */
 			if (!first && bhp->ref_sync != 0) {
-				--bhp->ref;
+				(void)BH_REF_DECR(bhp);
 				b_incr = 0;
-				MUTEX_UNLOCK(dbenv, &hp->hash_mutex);
+				MP_HASH_UNLOCK(dbenv, hp);
 				__os_yield(dbenv, 1);
 				goto retry;
 			}
 
-			MUTEX_UNLOCK(dbenv, &hp->hash_mutex);
+			MP_HASH_UNLOCK(dbenv, hp);
 			/*
 			 * Explicitly yield the processor if not the first pass
 			 * through this loop -- if we don't, we might run to the
@@ -387,19 +503,24 @@ retry:	st_hsearch = 0;
 			MUTEX_LOCK(dbenv, &bhp->mutex);
 			/* Wait for I/O to finish... */
 			MUTEX_UNLOCK(dbenv, &bhp->mutex);
-			MUTEX_LOCK(dbenv, &hp->hash_mutex);
+			MP_HASH_LOCK(dbenv, hp);
 		}
 
 		/* Layer violation */
 		if (ISINTERNAL(bhp->buf))
-			++mfp->stat.st_cache_ihit;
+			MP_STAT_INCR(mfp->stat.st_cache_ihit);
 		else if (ISLEAF(bhp->buf))
-			++mfp->stat.st_cache_lhit;
+			MP_STAT_INCR(mfp->stat.st_cache_lhit);
 
-		++mfp->stat.st_cache_hit;
+		MP_STAT_INCR(mfp->stat.st_cache_hit);
 
         if (LF_ISSET(DB_MPOOL_PFGET))
             ++c_mp->stat.st_page_pf_in_late;
+		else if (F_ISSET(bhp, BH_PREFAULT)) {
+			/* First use of a page the prefetcher brought in. */
+			F_CLR(bhp, BH_PREFAULT);
+			pf_hit = 1;
+		}
 
 		break;
 	}
@@ -449,7 +570,7 @@ retry:	st_hsearch = 0;
 		 * if the page exists, and allocate structures so we can add
 		 * the page to the buffer pool.
 		 */
-		MUTEX_UNLOCK(dbenv, &hp->hash_mutex);
+		MP_HASH_UNLOCK(dbenv, hp);
 
 alloc:		/*
 		 * If DB_MPOOL_NEW is set, we have to allocate a page number.
@@ -610,7 +731,7 @@ alloc:		/*
 		 * lock, we have to release the hash bucket and re-acquire it.
 		 * That's OK, because we have the buffer pinned down.
 		 */
-		MUTEX_UNLOCK(dbenv, &hp->hash_mutex);
+		MP_HASH_UNLOCK(dbenv, hp);
 		R_LOCK(dbenv, &dbmp->reginfo[n_cache]);
 		__db_shalloc_free(dbmp->reginfo[n_cache].addr, alloc_bhp);
 		c_mp->stat.st_pages--;
@@ -626,13 +747,13 @@ alloc:		/*
 		 * another one.
 		 */
 		if (flags == DB_MPOOL_NEW) {
-			--bhp->ref;
+			(void)BH_REF_DECR(bhp);
 			b_incr = 0;
 			goto alloc;
 		}
 
 		/* We can use the page -- get the bucket lock. */
-		MUTEX_LOCK(dbenv, &hp->hash_mutex);
+		MP_HASH_LOCK(dbenv, hp);
 		break;
 	case SECOND_MISS:
 		/*
@@ -730,6 +851,7 @@ alloc:		/*
 			}
 
 			gbl_memp_pgreads++;
+			pgread = 1;
 			if (did_io != NULL)
 				*did_io = 1;
 		}
@@ -750,7 +872,7 @@ alloc:		/*
 			goto err;
 	}
 
-	DB_ASSERT(bhp->ref != 0);
+	DB_ASSERT(BH_REF(bhp) != 0);
 
 	/*
 	 * If we're the only reference, update buffer and bucket priorities.
@@ -760,7 +882,7 @@ alloc:		/*
 	 */
 
 	/* from patch */
-	if (state != SECOND_MISS && bhp->ref == 1) {
+	if (state != SECOND_MISS && BH_REF(bhp) == 1) {
 		bhp->priority = UINT32_T_MAX;
 		if (SH_TAILQ_FIRST(&hp->hash_bucket, __bh) !=
 		    SH_TAILQ_LAST(&hp->hash_bucket, HashTab)) {
@@ -771,7 +893,7 @@ alloc:		/*
 		    SH_TAILQ_FIRST(&hp->hash_bucket, __bh)->priority;
 	}
 #if 0
-	if (state != SECOND_MISS && bhp->ref == 1) {
+	if (state != SECOND_MISS && BH_REF(bhp) == 1) {
 		bhp->priority = UINT32_T_MAX;
 		SH_TAILQ_REMOVE(&hp->hash_bucket, bhp, hq, __bh);
 		SH_TAILQ_INSERT_TAIL(&hp->hash_bucket, bhp, hq);
@@ -822,7 +944,7 @@ alloc:		/*
 		F_CLR(bhp, BH_CALLPGIN);
 	}
 
-	MUTEX_UNLOCK(dbenv, &hp->hash_mutex);
+	MP_HASH_UNLOCK(dbenv, hp);
 
 #ifdef DIAGNOSTIC
 	/* Update the file's pinned reference count. */
@@ -839,8 +961,19 @@ alloc:		/*
 #endif
 
 	*(void **)addrp = bhp->buf;
-	if (bhp->fget_count < UINT_MAX)
-			bhp->fget_count++;
+	BH_FGET_INCR(bhp);
+
+	/*
+	 * Readahead accounting: a hit is the first use of a prefetched page,
+	 * a miss is a page a prefetching scan stepped onto and had to read.
+	 */
+	if (!LF_ISSET(DB_MPOOL_PFGET)) {
+		if (pf_hit)
+			bb_berkdb_get_thread_stats()->n_pf_hits++;
+		else if (pgread && gbl_btpf_expect_page)
+			bb_berkdb_get_thread_stats()->n_pf_misses++;
+		gbl_btpf_expect_page = 0;
+	}
 
 	if (gbl_bb_berkdb_enable_memp_timing)
 		bb_memp_hit(start_time_us);
@@ -852,11 +985,11 @@ err:	/*
 	 * also still holding the hash bucket mutex.
 	 */
 	if (b_incr) {
-		if (bhp->ref == 1)
+		if (BH_REF(bhp) == 1)
 			(void)__memp_bhfree(dbmp, hp, bhp, 1);
 		else {
-			--bhp->ref;
-			MUTEX_UNLOCK(dbenv, &hp->hash_mutex);
+			(void)BH_REF_DECR(bhp);
+			MP_HASH_UNLOCK(dbenv, hp);
 		}
 	}
 
@@ -1221,3 +1354,113 @@ out:
 
 	return ret;
 }
+
+struct memp_fget_bench {
+	DB_MPOOLFILE *dbmfp;
+	db_pgno_t npages;
+	int id;
+	int stop;
+	int ret;
+	u_int64_t ops;
+};
+
+static void *
+__memp_fget_bench_thd(arg)
+	void *arg;
+{
+	struct memp_fget_bench *b;
+	db_pgno_t pgno;
+	u_int64_t ops;
+	void *pg;
+	int ret;
+
+	b = arg;
+	ops = 0;
+	pgno = b->id % b->npages;
+	while (!__atomic_load_n(&b->stop, __ATOMIC_RELAXED)) {
+		if ((ret = __memp_fget(b->dbmfp, &pgno, 0, &pg)) != 0 ||
+		    (ret = __memp_fput(b->dbmfp, pg, 0)) != 0) {
+			b->ret = ret;
+			break;
+		}
+		++ops;
+		if (++pgno == b->npages)
+			pgno = 0;
+	}
+	b->ops = ops;
+	return (NULL);
+}
+
+/*
+ * __memp_fget_bench --
+ *	Read contention benchmark: nthreads threads get and put the first
+ *	npages pages of a file for secs seconds, through the locked lookup
+ *	and then through the lockless one.
+ *
+ * PUBLIC: int __memp_fget_bench __P((DB_MPOOLFILE *, int, int, int));
+ */
+int
+__memp_fget_bench(dbmfp, nthreads, npages, secs)
+	DB_MPOOLFILE *dbmfp;
+	int nthreads, npages, secs;
+{
+	struct memp_fget_bench *b;
+	pthread_t *tids;
+	db_pgno_t pgno;
+	u_int64_t ops;
+	void *pg;
+	int i, lockless, ret, save;
+
+	if (nthreads <= 0 || npages <= 0 || secs <= 0)
+		return (EINVAL);
+
+	/* Make the pages resident, and stop at the end of the file. */
+	for (pgno = 0; pgno < (db_pgno_t)npages; ++pgno) {
+		if ((ret = __memp_fget(dbmfp, &pgno, 0, &pg)) != 0)
+			break;
+		(void)__memp_fput(dbmfp, pg, 0);
+	}
+	if (pgno == 0)
+		return (ret);
+	npages = pgno;
+
+	if ((ret = __os_calloc(dbmfp->dbenv,
+	    nthreads, sizeof(*b), &b)) != 0)
+		return (ret);
+	if ((ret = __os_calloc(dbmfp->dbenv,
+	    nthreads, sizeof(*tids), &tids)) != 0) {
+		__os_free(dbmfp->dbenv, b);
+		return (ret);
+	}
+
+	save = gbl_mp_lockless_fget;
+	for (lockless = 0; lockless <= 1 && ret == 0; ++lockless) {
+		gbl_mp_lockless_fget = lockless;
+		for (i = 0; i < nthreads; ++i) {
+			memset(&b[i], 0, sizeof(b[i]));
+			b[i].dbmfp = dbmfp;
+			b[i].npages = npages;
+			b[i].id = i;
+			Pthread_create(&tids[i], NULL, __memp_fget_bench_thd,
+			    &b[i]);
+		}
+		(void)__os_sleep(dbmfp->dbenv, secs, 0);
+		for (i = 0; i < nthreads; ++i)
+			__atomic_store_n(&b[i].stop, 1, __ATOMIC_RELAXED);
+		for (ops = 0, i = 0; i < nthreads; ++i) {
+			Pthread_join(tids[i], NULL);
+			ops += b[i].ops;
+			if (b[i].ret != 0)
+				ret = b[i].ret;
+		}
+		logmsg(LOGMSG_USER,
+		    "%s: %s lookups, %d threads, %d pages: %llu gets/sec\n",
+		    __memp_fn(dbmfp), lockless ? "lockless" : "locked",
+		    nthreads, npages, (unsigned long long)(ops / secs));
+	}
+	gbl_mp_lockless_fget = save;
+
+	__os_free(dbmfp->dbenv, tids);
+	__os_free(dbmfp->dbenv, b);
+	return (ret);
+}
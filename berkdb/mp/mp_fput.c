@@ -25,6 +25,7 @@ static const char revid[] = "$Id: mp_fput.c,v 11.48 2003/09/30 17:12:00 sue Exp
 #include "comdb2_atomic.h"
 
 extern int gbl_enable_cache_internal_nodes;
+extern int gbl_mp_lockless_fget;
 
 static void __memp_reset_lru __P((DB_ENV *, REGINFO *));
 
@@ -71,6 +72,7 @@ __memp_fput_internal(dbmfp, pgaddr, flags, pgorder)
 	DB_MPOOL_HASH *hp;
 	MPOOL *c_mp;
 	u_int32_t n_cache;
+	u_int16_t ref;
 	int adjust, ret, incr_count = 1;
 
 	dbenv = dbmfp->dbenv;
@@ -152,7 +154,19 @@ __memp_fput_internal(dbmfp, pgaddr, flags, pgorder)
 	hp = R_ADDR(&dbmp->reginfo[n_cache], c_mp->htab);
 	hp = &hp[NBUCKET(c_mp, bhp->mpf, bhp->pgno)];
 
-	MUTEX_LOCK(dbenv, &hp->hash_mutex);
+	/*
+	 * Returning a clean page somebody else still has pinned only drops
+	 * the reference count; don't bother with the bucket lock.
+	 */
+	if (gbl_mp_lockless_fget && flags == 0) {
+		ref = BH_REF(bhp);
+		while (ref > 2)
+			if (__atomic_compare_exchange_n(&bhp->ref, &ref,
+			    ref - 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+				return (0);
+	}
+
+	MP_HASH_LOCK(dbenv, hp);
 
 	/* Set/clear the page bits. */
 	if (LF_ISSET(DB_MPOOL_CLEAN) &&
@@ -177,10 +191,10 @@ __memp_fput_internal(dbmfp, pgaddr, flags, pgorder)
 	 * Check for a reference count going to zero.  This can happen if the
 	 * application returns a page twice.
 	 */
-	if (bhp->ref == 0) {
+	if (BH_REF(bhp) == 0) {
 		__db_err(dbenv, "%s: page %lu: unpinned page returned",
 		    __memp_fn(dbmfp), (u_long)bhp->pgno);
-		MUTEX_UNLOCK(dbenv, &hp->hash_mutex);
+		MP_HASH_UNLOCK(dbenv, hp);
 		return (EINVAL);
 	}
 
@@ -192,7 +206,8 @@ __memp_fput_internal(dbmfp, pgaddr, flags, pgorder)
 	 * thread waiting to flush the buffer to disk, we're done.  Ignore the
 	 * discard flags (for now) and leave the buffer's priority alone.
 	 */
-	if (--bhp->ref > 1 || (bhp->ref == 1 && !F_ISSET(bhp, BH_LOCKED))) {
+	if ((ref = BH_REF_DECR(bhp)) > 1 ||
+	    (ref == 1 && !F_ISSET(bhp, BH_LOCKED))) {
 #ifdef REF_SYNC_TEST
 		if (F_ISSET(bhp, BH_LOCKED) && bhp->ref_sync) {
 			fprintf(stderr,
@@ -201,7 +216,7 @@ __memp_fput_internal(dbmfp, pgaddr, flags, pgorder)
 			    bhp->ref_sync);
 		}
 #endif
-		MUTEX_UNLOCK(dbenv, &hp->hash_mutex);
+		MP_HASH_UNLOCK(dbenv, hp);
 		return (0);
 	}
 
@@ -306,7 +321,7 @@ done:
 	if (F_ISSET(bhp, BH_LOCKED) && bhp->ref_sync != 0)
 		--bhp->ref_sync;
 
-	MUTEX_UNLOCK(dbenv, &hp->hash_mutex);
+	MP_HASH_UNLOCK(dbenv, hp);
 
 	/*
 	 * On every buffer put we update the buffer generation number and check
@@ -375,12 +390,12 @@ __memp_reset_lru(dbenv, memreg)
 		if (SH_TAILQ_FIRST(&hp->hash_bucket, __bh) == NULL)
 			continue;
 
-		MUTEX_LOCK(dbenv, &hp->hash_mutex);
+		MP_HASH_LOCK(dbenv, hp);
 		for (bhp = SH_TAILQ_FIRST(&hp->hash_bucket, __bh);
 		    bhp != NULL; bhp = SH_TAILQ_NEXT(bhp, hq, __bh))
 			if (bhp->priority != UINT32_T_MAX &&
 			    bhp->priority > MPOOL_BASE_DECREMENT)
 				bhp->priority -= MPOOL_BASE_DECREMENT;
-		MUTEX_UNLOCK(dbenv, &hp->hash_mutex);
+		MP_HASH_UNLOCK(dbenv, hp);
 	}
 }
@@ -97,7 +97,7 @@ __memp_fset(dbmfp, pgaddr, flags)
 	hp = R_ADDR(&dbmp->reginfo[n_cache], c_mp->htab);
 	hp = &hp[NBUCKET(c_mp, bhp->mpf, bhp->pgno)];
 
-	MUTEX_LOCK(dbenv, &hp->hash_mutex);
+	MP_HASH_LOCK(dbenv, hp);
 
 	/* Set/clear the page bits. */
 	if (LF_ISSET(DB_MPOOL_CLEAN) &&
@@ -118,6 +118,6 @@ __memp_fset(dbmfp, pgaddr, flags)
 	if (LF_ISSET(DB_MPOOL_DISCARD))
 		F_SET(bhp, BH_DISCARD);
 
-	MUTEX_UNLOCK(dbenv, &hp->hash_mutex);
+	MP_HASH_UNLOCK(dbenv, hp);
 	return (0);
 }
@@ -271,6 +271,8 @@ __mpool_init(dbenv, dbmp, reginfo_off, htab_buckets)
 		SH_TAILQ_INIT(&htab[i].hash_bucket);
 		htab[i].hash_priority = 0;
 		htab[i].hash_page_dirty = 0;
+		htab[i].hash_seq = 0;
+		htab[i].hash_readers = 0;
 	}
 	mp->htab_buckets = mp->stat.st_hash_buckets = htab_buckets;
 
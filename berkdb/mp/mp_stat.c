@@ -444,14 +444,14 @@ __memp_dumpcache(dbenv, dbmp, reginfo, fmap, fp, flags)
 
 		for (hp = R_ADDR(reginfo, c_mp->htab),
 		    bucket = 0; bucket < c_mp->htab_buckets; ++hp, ++bucket) {
-			MUTEX_LOCK(dbenv, &hp->hash_mutex);
+			MP_HASH_LOCK(dbenv, hp);
 			if ((bhp =
 			    SH_TAILQ_FIRST(&hp->hash_bucket, __bh)) != NULL)
 				(void)logmsgf(LOGMSG_USER, fp, "%lu (%u):\n",
 				    (u_long)bucket, hp->hash_priority);
 			for (; bhp != NULL; bhp = SH_TAILQ_NEXT(bhp, hq, __bh))
 				__memp_pbh(dbmp, bhp, fmap, fp);
-			MUTEX_UNLOCK(dbenv, &hp->hash_mutex);
+			MP_HASH_UNLOCK(dbenv, hp);
 		}
 	}
 
@@ -581,7 +581,6 @@ trickle_do_work(struct thdpool *thdpool, void *work, void *thddata, int thd_op)
 	DB_MPOOL *dbmp;
 	DB_MPOOL_HASH *hp;
 	DB_MPOOL_HASH **hparray;
-	DB_MUTEX *mutexp;
 	MPOOLFILE *mfp;
 	u_int32_t txnarray[MAX_TXNARRAY];
 	int txncnt = 0;
@@ -651,8 +650,8 @@ trickle_do_work(struct thdpool *thdpool, void *work, void *thddata, int thd_op)
 				bhparray[j]->ref_sync = 0;
 
 				/* Discard our reference and unlock the bucket*/
-				--bhparray[j]->ref;
-				MUTEX_UNLOCK(dbenv, &hparray[j]->hash_mutex);
+				(void)BH_REF_DECR(bhparray[j]);
+				MP_HASH_UNLOCK(dbenv, hparray[j]);
 			}
 
 			/* 
@@ -673,8 +672,7 @@ trickle_do_work(struct thdpool *thdpool, void *work, void *thddata, int thd_op)
 			continue;
 
 		/* Lock the hash bucket and find the buffer. */
-		mutexp = &hp->hash_mutex;
-		MUTEX_LOCK(dbenv, mutexp);
+		MP_HASH_LOCK(dbenv, hp);
 		for (bhp = SH_TAILQ_FIRST(&hp->hash_bucket, __bh);
 		    bhp != NULL; bhp = SH_TAILQ_NEXT(bhp, hq, __bh))
 			if (bhp->pgno == bharray[i].track_pgno &&
@@ -688,8 +686,8 @@ trickle_do_work(struct thdpool *thdpool, void *work, void *thddata, int thd_op)
 		 * If the buffer isn't pinned or dirty, we're done, there's
 		 * no work needed.
 		 */
-		if (bhp == NULL || (bhp->ref == 0 && !F_ISSET(bhp, BH_DIRTY))) {
-			MUTEX_UNLOCK(dbenv, mutexp);
+		if (bhp == NULL || (BH_REF(bhp) == 0 && !F_ISSET(bhp, BH_DIRTY))) {
+			MP_HASH_UNLOCK(dbenv, hp);
 			--remaining;
 			bharray[i].track_hp = NULL;
 			continue;
@@ -706,8 +704,8 @@ trickle_do_work(struct thdpool *thdpool, void *work, void *thddata, int thd_op)
 		 * In either case, skip the buffer if we're not required to
 		 * write it.
 		 */
-		if (F_ISSET(bhp, BH_LOCKED) || (bhp->ref != 0 && pass < 2)) {
-			MUTEX_UNLOCK(dbenv, mutexp);
+		if (F_ISSET(bhp, BH_LOCKED) || (BH_REF(bhp) != 0 && pass < 2)) {
+			MP_HASH_UNLOCK(dbenv, hp);
 			if (op != DB_SYNC_CACHE && op != DB_SYNC_FILE) {
 				--remaining;
 				bharray[i].track_hp = NULL;
@@ -721,10 +719,10 @@ trickle_do_work(struct thdpool *thdpool, void *work, void *thddata, int thd_op)
 		 * Set the sync wait-for count, used to count down outstanding
 		 * references to this buffer as they are returned to the cache.
 		 */
-		bhp->ref_sync = bhp->ref;
+		bhp->ref_sync = BH_REF(bhp);
 
 		/* Pin the buffer into memory and lock it. */
-		++bhp->ref;
+		(void)BH_REF_INCR(bhp);
 		F_SET(bhp, BH_LOCKED);
 		MUTEX_LOCK(dbenv, &bhp->mutex);
 
@@ -741,7 +739,7 @@ trickle_do_work(struct thdpool *thdpool, void *work, void *thddata, int thd_op)
 		 * If, when the wait-for count goes to 0, the buffer is found
 		 * to be dirty, write it.
 		 */
-		MUTEX_UNLOCK(dbenv, mutexp);
+		MP_HASH_UNLOCK(dbenv, hp);
 
 		int rs_iters = gbl_ref_sync_iterations;
 		int rs_pollms = gbl_ref_sync_pollms;
@@ -754,7 +752,7 @@ trickle_do_work(struct thdpool *thdpool, void *work, void *thddata, int thd_op)
 			poll(NULL, 0, rs_pollms);
  		}
 
-		MUTEX_LOCK(dbenv, mutexp);
+		MP_HASH_LOCK(dbenv, hp);
 		hb_lock = 1;
 
 		/*
@@ -779,7 +777,7 @@ trickle_do_work(struct thdpool *thdpool, void *work, void *thddata, int thd_op)
 		 */
 		if (bhp->ref_sync == 0 && F_ISSET(bhp, BH_DIRTY)) {
 			hb_lock = 0;
-			MUTEX_UNLOCK(dbenv, mutexp);
+			MP_HASH_UNLOCK(dbenv, hp);
 
 			/*
 			 * If the following buffer is in sequence, we can
@@ -908,8 +906,8 @@ trickle_do_work(struct thdpool *thdpool, void *work, void *thddata, int thd_op)
 
 				/* Discard our reference and unlock
 				 * the bucket. */
-				--bhparray[j]->ref;
-				MUTEX_UNLOCK(dbenv, &hparray[j]->hash_mutex);
+				(void)BH_REF_DECR(bhparray[j]);
+				MP_HASH_UNLOCK(dbenv, hparray[j]);
 			}
 
 			/* 
@@ -967,7 +965,7 @@ trickle_do_work(struct thdpool *thdpool, void *work, void *thddata, int thd_op)
 				MUTEX_UNLOCK(dbenv, &bhp->mutex);
 
 				if (!hb_lock)
-					MUTEX_LOCK(dbenv, mutexp);
+					MP_HASH_LOCK(dbenv, hp);
 			}
 
 			/*
@@ -978,8 +976,8 @@ trickle_do_work(struct thdpool *thdpool, void *work, void *thddata, int thd_op)
 			bhp->ref_sync = 0;
 
 			/* Discard our reference and unlock the bucket. */
-			--bhp->ref;
-			MUTEX_UNLOCK(dbenv, mutexp);
+			(void)BH_REF_DECR(bhp);
+			MP_HASH_UNLOCK(dbenv, hp);
 		}
 
 		if (ret != 0)
@@ -1042,8 +1040,8 @@ trickle_do_work(struct thdpool *thdpool, void *work, void *thddata, int thd_op)
 		bhparray[j]->ref_sync = 0;
 
 		/* Discard our reference and unlock the bucket. */
-		--bhparray[j]->ref;
-		MUTEX_UNLOCK(dbenv, &hparray[j]->hash_mutex);
+		(void)BH_REF_DECR(bhparray[j]);
+		MP_HASH_UNLOCK(dbenv, hparray[j]);
 	}
 
 	Pthread_mutex_lock(&range->t->lk);
@@ -1234,11 +1232,11 @@ __memp_sync_int(dbenv, dbmfp, trickle_max, op, wrotep, restartable,
 			if (SH_TAILQ_FIRST(&hp->hash_bucket, __bh) == NULL)
 				continue;
 
-			MUTEX_LOCK(dbenv, &hp->hash_mutex);
+			MP_HASH_LOCK(dbenv, hp);
 			for (bhp = SH_TAILQ_FIRST(&hp->hash_bucket, __bh);
 			    bhp != NULL; bhp = SH_TAILQ_NEXT(bhp, hq, __bh)) {
 				/* Always ignore unreferenced, clean pages. */
-				if (bhp->ref == 0 && !F_ISSET(bhp, BH_DIRTY))
+				if (BH_REF(bhp) == 0 && !F_ISSET(bhp, BH_DIRTY))
 					continue;
 
 				/*
@@ -1327,7 +1325,7 @@ __memp_sync_int(dbenv, dbmfp, trickle_max, op, wrotep, restartable,
 					ar_max *= 2;
 				}
 			}
-			MUTEX_UNLOCK(dbenv, &hp->hash_mutex);
+			MP_HASH_UNLOCK(dbenv, hp);
 
 			if (ret != 0)
 				goto err;
@@ -2294,7 +2292,7 @@ __memp_dump(dbenv, s, max_pages, pagecount)
 			if (SH_TAILQ_FIRST(&hp->hash_bucket, __bh) == NULL)
 				continue;
 
-			MUTEX_LOCK(dbenv, &hp->hash_mutex);
+			MP_HASH_LOCK(dbenv, hp);
 			for (bhp = SH_TAILQ_FIRST(&hp->hash_bucket, __bh);
 				bhp != NULL; bhp = SH_TAILQ_NEXT(bhp, hq, __bh)) {
 
@@ -2308,7 +2306,7 @@ __memp_dump(dbenv, s, max_pages, pagecount)
 
 				if ((ret = add_fileid_page(dbenv, fileid_pages, &pagearray,
 								fileid, bhp->pgno, bhp->fget_count)) != 0) {
-					MUTEX_UNLOCK(dbenv, &hp->hash_mutex);
+					MP_HASH_UNLOCK(dbenv, hp);
 					destroy_fileid_page_hash(dbenv, fileid_pages);
 					__os_free(dbenv, pagearray.pagearray);
 					logmsg(LOGMSG_ERROR, "%s error adding fileid page to hash "
@@ -2316,7 +2314,7 @@ __memp_dump(dbenv, s, max_pages, pagecount)
 					return ret;
 				}
 			}
-			MUTEX_UNLOCK(dbenv, &hp->hash_mutex);
+			MP_HASH_UNLOCK(dbenv, hp);
 		}
 	}
 
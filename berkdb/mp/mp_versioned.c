@@ -136,6 +136,9 @@ static int __mempv_read_log_record(void *data, recovery_func_t *apply, u_int64_t
 		case DB___bam_prefix:
 		   *apply = __bam_prefix_snap_recover;
 		   break;
+		case DB___bam_bulkpg:
+		   *apply = __bam_bulkpg_snap_recover;
+		   break;
 		case DB___db_pg_freedata:
 		   *apply = __db_pg_freedata_snap_recover;
 		   break;
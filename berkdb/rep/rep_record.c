@@ -148,7 +148,8 @@ extern int get_commit_lsn_map_switch_value();
 
 int64_t gbl_rep_trans_parallel = 0, gbl_rep_trans_serial =
 	0, gbl_rep_trans_deadlocked = 0, gbl_rep_trans_inline =
-	0, gbl_rep_rowlocks_multifile = 0;
+	0, gbl_rep_rowlocks_multifile = 0, gbl_rep_trans_page_groups =
+	0, gbl_rep_page_groups = 0;
 
 static inline int wait_for_running_transactions(DB_ENV *dbenv);
 
@@ -4288,12 +4289,182 @@ fuid_hash_free(void *obj, void *unused)
 	return 0;
 }
 
+/*
+ * Page groups --
+ *	With rep_apply_page_groups set, the records a transaction logs against
+ *	one file are split further into groups that share no page, and every
+ *	group gets its own worker queue.  Records that touch a common page
+ *	(a split touches several) are unioned into one group, which keeps them
+ *	in log order, so each page still sees its records in order.  A file
+ *	with any record we can't map to pages (logical and user records) stays
+ *	in one queue, as does queue 0 (begin, commit, dbreg).
+ */
+#define	PG_NOSPLIT	1
+#define	PG_SEEN		2
+
+struct page_owner {
+	struct {
+		int32_t fid;
+		db_pgno_t pgno;
+	} key;
+	int rec;
+};
+
+struct page_groups {
+	hash_t *owners;		/* (fid, pgno) -> first record to touch it */
+	int *parent;		/* union-find over record indexes */
+	int *fileid;		/* file queue of each record */
+	u_int8_t *nosplit;	/* PG_NOSPLIT: file queue has to stay whole */
+	int nfileids;
+	TXN_RECS t;
+};
+
+static int
+page_group_find(struct page_groups *pg, int rec)
+{
+	while (pg->parent[rec] != rec) {
+		pg->parent[rec] = pg->parent[pg->parent[rec]];
+		rec = pg->parent[rec];
+	}
+	return rec;
+}
+
+static int
+page_groups_init(DB_ENV *dbenv, struct page_groups *pg, int nrecs)
+{
+	memset(pg, 0, sizeof(*pg));
+	pg->owners = hash_init(sizeof(((struct page_owner *)0)->key));
+	pg->parent = malloc(nrecs * sizeof(int));
+	pg->fileid = malloc(nrecs * sizeof(int));
+	if (pg->owners == NULL || pg->parent == NULL || pg->fileid == NULL)
+		return (ENOMEM);
+	return (0);
+}
+
+static void
+page_groups_destroy(DB_ENV *dbenv, struct page_groups *pg)
+{
+	if (pg->owners) {
+		hash_for(pg->owners, fuid_hash_free, NULL);
+		hash_clear(pg->owners);
+		hash_free(pg->owners);
+	}
+	free(pg->parent);
+	free(pg->fileid);
+	free(pg->nosplit);
+	if (pg->t.array)
+		__os_free(dbenv, pg->t.array);
+	memset(pg, 0, sizeof(*pg));
+}
+
+/* Note which pages record rec of file queue fileid touches. */
+static void
+page_groups_add(DB_ENV *dbenv, struct page_groups *pg, int rec, int fileid,
+	DBT *dbt, DB_LSN *lsnp)
+{
+	struct page_owner *owner, key;
+	int i, r1, r2;
+
+	pg->parent[rec] = rec;
+	pg->fileid[rec] = fileid;
+	if (fileid == 0)
+		return;
+
+	if (fileid >= pg->nfileids) {
+		u_int8_t *n = realloc(pg->nosplit, fileid + 1);
+		if (n == NULL) {
+			/* Can't track it: apply everything per file. */
+			for (i = 0; i < pg->nfileids; i++)
+				pg->nosplit[i] = PG_NOSPLIT;
+			return;
+		}
+		memset(n + pg->nfileids, 0, fileid + 1 - pg->nfileids);
+		pg->nosplit = n;
+		pg->nfileids = fileid + 1;
+	}
+	if (pg->nosplit[fileid])
+		return;
+
+	pg->t.npages = 0;
+	if (__db_dispatch(dbenv, dbenv->pgnos_dtab, dbenv->pgnos_dtab_size,
+		dbt, lsnp, DB_TXN_GETALLPGNOS, &pg->t) != 0 ||
+		pg->t.npages == 0) {
+		pg->nosplit[fileid] = PG_NOSPLIT;
+		return;
+	}
+
+	memset(&key, 0, sizeof(key));
+	for (i = 0; i < pg->t.npages; i++) {
+		key.key.fid = pg->t.array[i].fid;
+		key.key.pgno = pg->t.array[i].pgdesc.pgno;
+		if ((owner = hash_find(pg->owners, &key.key)) == NULL) {
+			if ((owner = malloc(sizeof(*owner))) == NULL) {
+				pg->nosplit[fileid] = PG_NOSPLIT;
+				return;
+			}
+			*owner = key;
+			owner->rec = rec;
+			hash_add(pg->owners, owner);
+			continue;
+		}
+		/* The earliest record stays the root of its group. */
+		r1 = page_group_find(pg, owner->rec);
+		r2 = page_group_find(pg, rec);
+		if (r1 < r2)
+			pg->parent[r2] = r1;
+		else if (r2 < r1)
+			pg->parent[r1] = r2;
+	}
+}
+
+/* Append a record to its worker queue, creating the queue if needed. */
+static void
+recovery_enqueue(struct __recovery_processor *rp, void *queues, int fileid,
+	struct logrecord *lr)
+{
+	struct __recovery_record *rr;
+	int j;
+
+	if (fileid >= rp->num_fileids) {
+		rp->recovery_queues =
+			realloc(rp->recovery_queues,
+			(fileid + 1) * sizeof(struct __recovery_queue *));
+		for (j = rp->num_fileids; j <= fileid; j++) {
+			rp->recovery_queues[j] = NULL;
+		}
+		rp->num_fileids = fileid + 1;
+	}
+	if (rp->recovery_queues[fileid] == NULL) {
+		rp->recovery_queues[fileid] =
+			malloc(sizeof(struct __recovery_queue));
+		rp->recovery_queues[fileid]->fileid = fileid;
+		rp->recovery_queues[fileid]->processor = rp;
+		rp->recovery_queues[fileid]->used = 0;
+		listc_init(&rp->recovery_queues[fileid]->records,
+			offsetof(struct __recovery_record, lnk));
+	}
+	if (!rp->recovery_queues[fileid]->used) {
+		rp->recovery_queues[fileid]->used = 1;
+		rp->num_busy_workers++;
+		listc_abl(queues, rp->recovery_queues[fileid]);
+	}
+
+	rr = pool_getablk(rp->recpool);
+	if (lr->rec.data)
+		rr->logdbt = lr->rec;
+	else
+		rr->logdbt.data = NULL;
+	rr->lsn = lr->lsn;
+	rr->fileid = fileid;
+
+	listc_abl(&rp->recovery_queues[fileid]->records, rr);
+}
+
 static void
 processor_thd(struct thdpool *pool, void *work, void *thddata, int op)
 {
 	struct __recovery_processor *rp;
 	struct __recovery_queue *rq;
-	struct __recovery_record *rr;
 	hash_t *fuid_hash = NULL;
 	u_int8_t fuid[DB_FILE_ID_LEN] = {0};
 	DBT data_dbt, lock_prev_lsn_dbt;
@@ -4301,12 +4472,13 @@ processor_thd(struct thdpool *pool, void *work, void *thddata, int op)
 	int i;
 	int inline_worker;
 	int polltm;
+	struct page_groups pg;
+	int split_pages = 0;
 	int commit_lsn_map = get_commit_lsn_map_switch_value();
 	DB_LOGC *logc = NULL;
 	DB_ENV *dbenv;
 	int ret, t_ret = 0, last_fileid = -1;
 	DB_LSN *lsnp;
-	int j;
 	LISTC_T(struct __recovery_queue) queues;
 
 	DB_REP *db_rep;
@@ -4399,8 +4571,17 @@ processor_thd(struct thdpool *pool, void *work, void *thddata, int op)
 	int fileid = 0;
 	int max_fileid = 0;
 
+	if (dbenv->attr.rep_apply_page_groups &&
+		rp->lc.nlsns >= dbenv->attr.rep_apply_page_groups_min) {
+		if (page_groups_init(dbenv, &pg, rp->lc.nlsns) == 0)
+			split_pages = 1;
+		else
+			page_groups_destroy(dbenv, &pg);
+	}
+
 	for (i = 0; i < rp->lc.nlsns; i++) {
 		u_int32_t rectype;
+		DBT *recdbt;
 
 		lsnp = &rp->lc.array[i].lsn;
 
@@ -4414,18 +4595,13 @@ processor_thd(struct thdpool *pool, void *work, void *thddata, int op)
 					(u_long)lsnp->file, (u_long)lsnp->offset);
 				goto err;
 			}
-			LOGCOPY_32(&rectype, data_dbt.data);
-			int utxnid_logged = normalize_rectype(&rectype);
-			found_ufid =
-				(int)ufid_for_recovery_record(dbenv, NULL,
-				rectype, fuid, &data_dbt, utxnid_logged);
-		} else {
-			LOGCOPY_32(&rectype, rp->lc.array[i].rec.data);
-			int utxnid_logged = normalize_rectype(&rectype);
-			found_ufid =
-				(int)ufid_for_recovery_record(dbenv, NULL,
-				rectype, fuid, &rp->lc.array[i].rec, utxnid_logged);
-		}
+			recdbt = &data_dbt;
+		} else
+			recdbt = &rp->lc.array[i].rec;
+		LOGCOPY_32(&rectype, recdbt->data);
+		int utxnid_logged = normalize_rectype(&rectype);
+		found_ufid = (int)ufid_for_recovery_record(dbenv, NULL,
+			rectype, fuid, recdbt, utxnid_logged);
 		if (found_ufid) {
 			if (!fuid_hash)
 				fuid_hash = hash_init(DB_FILE_ID_LEN);
@@ -4457,39 +4633,52 @@ processor_thd(struct thdpool *pool, void *work, void *thddata, int op)
 			fileid = 0;
 		}
 
-		if (fileid >= rp->num_fileids) {
-			rp->recovery_queues =
-				realloc(rp->recovery_queues,
-				(fileid + 1) * sizeof(struct __recovery_queue *));
-			for (j = rp->num_fileids; j <= fileid; j++) {
-				rp->recovery_queues[j] = NULL;
-			}
-			rp->num_fileids = fileid + 1;
-		}
-		if (rp->recovery_queues[fileid] == NULL) {
-			rp->recovery_queues[fileid] =
-				malloc(sizeof(struct __recovery_queue));
-			rp->recovery_queues[fileid]->fileid = fileid;
-			rp->recovery_queues[fileid]->processor = rp;
-			rp->recovery_queues[fileid]->used = 0;
-			listc_init(&rp->recovery_queues[fileid]->records,
-				offsetof(struct __recovery_record, lnk));
-		}
-		if (!rp->recovery_queues[fileid]->used) {
-			rp->recovery_queues[fileid]->used = 1;
-			rp->num_busy_workers++;
-			listc_abl(&queues, rp->recovery_queues[fileid]);
+		/* Queue once every record's pages are known. */
+		if (split_pages) {
+			page_groups_add(dbenv, &pg, i, fileid, recdbt, lsnp);
+			continue;
 		}
 
-		rr = pool_getablk(rp->recpool);
-		if (rp->lc.array[i].rec.data)
-			rr->logdbt = rp->lc.array[i].rec;
-		else
-			rr->logdbt.data = NULL;
-		rr->lsn = *lsnp;
-		rr->fileid = fileid;
+		recovery_enqueue(rp, &queues, fileid, &rp->lc.array[i]);
+	}
 
-		listc_abl(&rp->recovery_queues[fileid]->records, rr);
+	/*
+	 * Group queues are numbered after the file queues.  A group's root is
+	 * its first record, so its fileid slot is free to hold the group queue
+	 * by the time later members look it up.
+	 */
+	if (split_pages) {
+		int *group, ngroups = 0, nsplit = 0, nextq = max_fileid + 1;
+
+		group = pg.fileid;
+		for (i = 0; i < rp->lc.nlsns; i++) {
+			int root;
+
+			fileid = pg.fileid[i];
+			if (fileid == 0 || fileid >= pg.nfileids ||
+				pg.nosplit[fileid] == PG_NOSPLIT) {
+				recovery_enqueue(rp, &queues, fileid,
+					&rp->lc.array[i]);
+				continue;
+			}
+			if (pg.nosplit[fileid] == 0) {
+				pg.nosplit[fileid] = PG_SEEN;
+				nsplit++;
+			}
+			root = page_group_find(&pg, i);
+			if (root == i) {
+				/* First record of a new group. */
+				group[i] = nextq++;
+				ngroups++;
+			}
+			recovery_enqueue(rp, &queues, group[root],
+				&rp->lc.array[i]);
+		}
+		if (ngroups > nsplit) {
+			gbl_rep_trans_page_groups++;
+			gbl_rep_page_groups += ngroups;
+		}
+		page_groups_destroy(dbenv, &pg);
 	}
 
 	if (fuid_hash) {
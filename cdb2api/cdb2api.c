@@ -108,6 +108,10 @@ static int CDB2_AUTO_CONSUME_TIMEOUT_MS = CDB2_AUTO_CONSUME_TIMEOUT_MS_DEFAULT;
 #define CDB2_MAX_AUTO_CONSUME_ROWS_DEFAULT 10
 static int CDB2_MAX_AUTO_CONSUME_ROWS = CDB2_MAX_AUTO_CONSUME_ROWS_DEFAULT;
 
+/* Ask the server to pack several rows into each response */
+#define CDB2_ROW_BATCH_DEFAULT 0
+static int CDB2_ROW_BATCH = CDB2_ROW_BATCH_DEFAULT;
+
 #define COMDB2DB_TIMEOUT_DEFAULT 2000
 static int COMDB2DB_TIMEOUT = COMDB2DB_TIMEOUT_DEFAULT;
 
@@ -167,6 +171,7 @@ static cdb2_ssl_sess *cdb2_get_ssl_sessions(cdb2_hndl_tp *hndl);
 static int cdb2_set_ssl_sessions(cdb2_hndl_tp *hndl,
                                  cdb2_ssl_sess *sessions);
 static int cdb2_add_ssl_session(cdb2_hndl_tp *hndl);
+static void async_free_all(cdb2_hndl_tp *hndl);
 
 static pthread_mutex_t cdb2_cfg_lock = PTHREAD_MUTEX_INITIALIZER;
 
@@ -316,6 +321,7 @@ static void reset_the_configuration(void)
     CDB2_POLL_TIMEOUT = CDB2_POLL_TIMEOUT_DEFAULT;
     CDB2_AUTO_CONSUME_TIMEOUT_MS = CDB2_AUTO_CONSUME_TIMEOUT_MS_DEFAULT;
     CDB2_MAX_AUTO_CONSUME_ROWS = CDB2_MAX_AUTO_CONSUME_ROWS_DEFAULT;
+    CDB2_ROW_BATCH = CDB2_ROW_BATCH_DEFAULT;
     COMDB2DB_TIMEOUT = COMDB2DB_TIMEOUT_DEFAULT;
     CDB2_API_CALL_TIMEOUT = CDB2_API_CALL_TIMEOUT_DEFAULT;
     CDB2_SOCKET_TIMEOUT = CDB2_SOCKET_TIMEOUT_DEFAULT;
@@ -1005,6 +1011,22 @@ typedef struct cnonce {
 #define TYPE_LEN 64
 #define POLICY_LEN 24
 
+/* A read submitted with cdb2_async_submit(). The query is kept until its
+   callback has run so it can be resent, with the same cnonce, if the
+   connection drops before the server answers it. */
+struct cdb2_async_query {
+    struct cdb2_async_query *next;
+    char *sql;
+    cnonce_t cnonce;
+    uint64_t timestampus;
+    int n_bindvars;
+    CDB2SQLQUERY__Bindvalue **bindvars;
+    int sent;    /* written on the current connection */
+    int retries;
+    cdb2_async_callback cb;
+    void *arg;
+};
+
 struct cdb2_hndl {
     char dbname[DBNAME_LEN];
     char cluster[64];
@@ -1054,6 +1076,7 @@ struct cdb2_hndl {
     int num_set_commands_sent;
     int is_read;
     unsigned long long rows_read;
+    int batch_row; /* current row of a ROW_BATCH lastresponse */
     int read_intrans_results;
     int first_record_read;
     char **commands;
@@ -1101,6 +1124,11 @@ struct cdb2_hndl {
     struct cdb2_hndl *fdb_hndl;
     int is_child_hndl;
     CDB2SQLQUERY__IdentityBlob *id_blob;
+    struct cdb2_async_query *async_head; /* oldest unanswered first */
+    struct cdb2_async_query *async_tail;
+    int async_npending;
+    int async_primed; /* connection has answered; safe to pipeline */
+    int async_in_cb;
 };
 
 static void *cdb2_protobuf_alloc(void *allocator_data, size_t size)
@@ -1399,6 +1427,10 @@ static void read_comdb2db_cfg(cdb2_hndl_tp *hndl, SBUF2 *s, const char *comdb2db
                 tok = strtok_r(NULL, " :,", &last);
                 if (tok)
                     CDB2_MAX_AUTO_CONSUME_ROWS = atoi(tok);
+            } else if (strcasecmp("row_batch", tok) == 0) {
+                tok = strtok_r(NULL, " :,", &last);
+                if (tok)
+                    CDB2_ROW_BATCH = value_on_off(tok);
             } else if (strcasecmp("comdb2db_timeout", tok) == 0) {
                 tok = strtok_r(NULL, " :,", &last);
                 if (hndl && tok)
@@ -3310,6 +3342,8 @@ static int cdb2_send_query(cdb2_hndl_tp *hndl, cdb2_hndl_tp *event_hndl,
 
     if (hndl && hndl->flags & CDB2_SQL_ROWS) {
         features[n_features++] = CDB2_CLIENT_FEATURES__SQLITE_ROW_FORMAT;
+    } else if (hndl && CDB2_ROW_BATCH) {
+        features[n_features++] = CDB2_CLIENT_FEATURES__ROW_BATCH;
     }
 
     if (hndl && (hndl->flags & CDB2_REQUIRE_FASTSQL) != 0) {
@@ -3477,7 +3511,8 @@ retry_next_record:
 
         if ((hndl->lastresponse->response_type ==
                  RESPONSE_TYPE__COLUMN_VALUES ||
-             hndl->lastresponse->response_type == RESPONSE_TYPE__SQL_ROW) &&
+             hndl->lastresponse->response_type == RESPONSE_TYPE__SQL_ROW ||
+             hndl->lastresponse->response_type == RESPONSE_TYPE__ROW_BATCH) &&
             hndl->lastresponse->error_code != 0) {
             int rc = cdb2_convert_error_code(hndl->lastresponse->error_code);
             if (hndl->in_trans) {
@@ -3486,6 +3521,15 @@ retry_next_record:
             }
             PRINT_AND_RETURN_OK(rc);
         }
+
+        /* Walk the rest of a row batch before going back to the wire */
+        if (hndl->lastresponse->response_type == RESPONSE_TYPE__ROW_BATCH &&
+            hndl->lastresponse->row_batch &&
+            hndl->batch_row + 1 < hndl->lastresponse->row_batch->nrows) {
+            hndl->batch_row++;
+            hndl->rows_read++;
+            PRINT_AND_RETURN_OK(CDB2_OK);
+        }
     }
 
     rc = cdb2_read_record(hndl, &hndl->last_buf, &len, NULL);
@@ -3536,6 +3580,7 @@ retry_next_record:
 
     hndl->lastresponse =
         cdb2__sqlresponse__unpack(&hndl->allocator, len, hndl->last_buf);
+    hndl->batch_row = 0;
     debugprint("hndl->lastresponse->response_type=%d\n",
                hndl->lastresponse->response_type);
 
@@ -3554,7 +3599,8 @@ retry_next_record:
     }
 
     if (hndl->lastresponse->response_type == RESPONSE_TYPE__COLUMN_VALUES ||
-        hndl->lastresponse->response_type == RESPONSE_TYPE__SQL_ROW) {
+        hndl->lastresponse->response_type == RESPONSE_TYPE__SQL_ROW ||
+        hndl->lastresponse->response_type == RESPONSE_TYPE__ROW_BATCH) {
         // "Good" rcodes are not retryable
         if (is_retryable(hndl->lastresponse->error_code) &&
             hndl->snapshot_file) {
@@ -3628,7 +3674,8 @@ int cdb2_next_record(cdb2_hndl_tp *hndl)
     } else if (hndl->lastresponse && hndl->first_record_read == 0) {
         hndl->first_record_read = 1;
         if (hndl->lastresponse->response_type == RESPONSE_TYPE__COLUMN_VALUES ||
-            hndl->lastresponse->response_type == RESPONSE_TYPE__SQL_ROW) {
+            hndl->lastresponse->response_type == RESPONSE_TYPE__SQL_ROW ||
+            hndl->lastresponse->response_type == RESPONSE_TYPE__ROW_BATCH) {
             rc = hndl->lastresponse->error_code;
         } else if (hndl->lastresponse->response_type ==
                    RESPONSE_TYPE__LAST_ROW) {
@@ -3767,6 +3814,12 @@ int cdb2_close(cdb2_hndl_tp *hndl)
     if (hndl->ack)
         ack(hndl);
 
+    if (hndl->async_head) {
+        /* Never auto-consume or pool a connection with queries in flight. */
+        clear_responses(hndl);
+        async_free_all(hndl);
+    }
+
     if (hndl->auto_consume_timeout_ms > 0 && hndl->sb && !hndl->in_trans && hndl->firstresponse &&
         (!hndl->lastresponse || (hndl->lastresponse->response_type != RESPONSE_TYPE__LAST_ROW))) {
         int nrec = 0;
@@ -5244,6 +5297,11 @@ int cdb2_run_statement_typed(cdb2_hndl_tp *hndl, const char *sql, int ntypes,
     int overwrite_rc = 0;
     cdb2_event *e = NULL;
 
+    if (hndl->async_head) {
+        sprintf(hndl->errstr, "%s: Pipelined queries are pending", __func__);
+        return CDB2ERR_BADSTATE;
+    }
+
     if (hndl->fdb_hndl) {
         cdb2_close(hndl->fdb_hndl);
         hndl->fdb_hndl = NULL;
@@ -5321,6 +5379,398 @@ after_callback:
     return rc;
 }
 
+static void async_free_query(struct cdb2_async_query *q)
+{
+    for (int i = 0; i < q->n_bindvars; i++) {
+        free(q->bindvars[i]->varname);
+        free(q->bindvars[i]->value.data);
+        free(q->bindvars[i]);
+    }
+    free(q->bindvars);
+    free(q->sql);
+    free(q);
+}
+
+static void async_free_all(cdb2_hndl_tp *hndl)
+{
+    struct cdb2_async_query *q;
+    while ((q = hndl->async_head) != NULL) {
+        hndl->async_head = q->next;
+        async_free_query(q);
+    }
+    hndl->async_tail = NULL;
+    hndl->async_npending = 0;
+}
+
+/* The caller may rebind or free its variables as soon as submit returns,
+   so take a private copy of everything the query points to. */
+static int async_copy_bindvars(cdb2_hndl_tp *hndl, struct cdb2_async_query *q)
+{
+    if (hndl->n_bindvars == 0)
+        return 0;
+    q->bindvars = calloc(hndl->n_bindvars, sizeof(*q->bindvars));
+    if (q->bindvars == NULL)
+        return -1;
+    for (int i = 0; i < hndl->n_bindvars; i++) {
+        CDB2SQLQUERY__Bindvalue *from = hndl->bindvars[i];
+        CDB2SQLQUERY__Bindvalue *to = malloc(sizeof(*to));
+        if (to == NULL)
+            return -1;
+        *to = *from;
+        to->varname = NULL;
+        to->value.data = NULL;
+        q->bindvars[q->n_bindvars++] = to;
+        if (from->varname && (to->varname = strdup(from->varname)) == NULL)
+            return -1;
+        if (from->value.data) {
+            to->value.data = malloc(from->value.len ? from->value.len : 1);
+            if (to->value.data == NULL)
+                return -1;
+            memcpy(to->value.data, from->value.data, from->value.len);
+        }
+    }
+    return 0;
+}
+
+/* Responses to pipelined queries may still be in flight, so the socket must
+   never go back to sockpool from here. */
+static void async_disconnect(cdb2_hndl_tp *hndl)
+{
+    clear_responses(hndl);
+    free(hndl->first_buf);
+    hndl->first_buf = NULL;
+    newsql_disconnect(hndl, hndl->sb, __LINE__);
+}
+
+static int async_send(cdb2_hndl_tp *hndl, struct cdb2_async_query *q)
+{
+    cnonce_t cnonce = hndl->cnonce;
+    uint64_t timestampus = hndl->timestampus;
+    int rc;
+
+    hndl->cnonce = q->cnonce;
+    hndl->timestampus = q->timestampus;
+    rc = cdb2_send_query(hndl, hndl, hndl->sb, hndl->dbname, q->sql,
+                         hndl->num_set_commands, hndl->num_set_commands_sent,
+                         hndl->commands, q->n_bindvars, q->bindvars, 0, NULL,
+                         0, 0, q->retries, 0, __LINE__);
+    hndl->cnonce = cnonce;
+    hndl->timestampus = timestampus;
+    return rc;
+}
+
+/* Write every queued query that the current connection has not seen,
+   reconnecting if needed. Only the head is written to a new connection: the
+   server may answer it with an SSL upgrade or a dbinfo redirect, and anything
+   sent behind it would be lost. */
+static int async_flush(cdb2_hndl_tp *hndl)
+{
+    struct cdb2_async_query *q;
+    int tries = 0;
+
+again:
+    if (hndl->sb == NULL) {
+        if (hndl->sslerr != 0 || tries++ >= hndl->max_retries)
+            return CDB2ERR_CONNECT_ERROR;
+        if (tries > hndl->num_hosts) {
+            int tmsec = (tries - hndl->num_hosts) * 100;
+            poll(NULL, 0, tmsec > 1000 ? 1000 : tmsec);
+        }
+        hndl->async_primed = 0;
+        for (q = hndl->async_head; q; q = q->next) {
+            if (q->sent) {
+                q->sent = 0;
+                q->retries++;
+            }
+        }
+        cdb2_connect_sqlhost(hndl);
+        goto again;
+    }
+
+    for (q = hndl->async_head; q; q = q->next) {
+        if (q->sent)
+            continue;
+        if (q != hndl->async_head && !hndl->async_primed)
+            break;
+        if (async_send(hndl, q) != 0) {
+            async_disconnect(hndl);
+            goto again;
+        }
+        q->sent = 1;
+    }
+    return 0;
+}
+
+/* Read the first response and the first row of the query at the head of the
+   queue. Returns 1 if the query has to be sent again; otherwise stores the
+   value to hand to the callback in *rcp. */
+static int async_read_first(cdb2_hndl_tp *hndl, struct cdb2_async_query *q,
+                            int *rcp)
+{
+    int rc, len, type = 0;
+
+    clear_responses(hndl);
+    hndl->rows_read = 0;
+    hndl->first_record_read = 0;
+
+    rc = cdb2_read_record(hndl, &hndl->first_buf, &len, &type);
+    if (rc != 0 || hndl->first_buf == NULL) {
+        debugprint("cdb2_read_record rc=%d, resending\n", rc);
+        async_disconnect(hndl);
+        return 1;
+    }
+
+    if (type == RESPONSE_HEADER__SQL_RESPONSE_SSL) {
+        free(hndl->first_buf);
+        hndl->first_buf = NULL;
+        hndl->s_sslmode = PEER_SSL_REQUIRE;
+        /* Not a real retry: upgrade this connection and send it again. */
+        if (try_ssl(hndl, hndl->sb) != 0)
+            async_disconnect(hndl);
+        hndl->sent_client_info = 0;
+        q->sent = 0;
+        return 1;
+    }
+
+    if (type == RESPONSE_HEADER__DBINFO_RESPONSE) {
+        if (!(hndl->flags & CDB2_DIRECT_CPU)) {
+            CDB2DBINFORESPONSE *dbinfo_resp =
+                cdb2__dbinforesponse__unpack(NULL, len, hndl->first_buf);
+            if (dbinfo_resp) {
+                parse_dbresponse(dbinfo_resp, hndl->hosts, hndl->ports,
+                                 &hndl->master, &hndl->num_hosts,
+                                 &hndl->num_hosts_sameroom, hndl->debug_trace,
+                                 &hndl->s_sslmode);
+                cdb2__dbinforesponse__free_unpacked(dbinfo_resp, NULL);
+            }
+            hndl->connected_host = -1;
+            if (hndl->sess != NULL) {
+                SSL_SESSION_free(hndl->sess->sessobj);
+                hndl->sess->sessobj = NULL;
+            }
+        }
+        async_disconnect(hndl);
+        return 1;
+    }
+
+    if ((rc = cdb2_add_ssl_session(hndl)) != 0) {
+        async_disconnect(hndl);
+        *rcp = rc;
+        return 0;
+    }
+
+    hndl->firstresponse = cdb2__sqlresponse__unpack(NULL, len, hndl->first_buf);
+    if (hndl->firstresponse == NULL) {
+        async_disconnect(hndl);
+        *rcp = CDB2ERR_CORRUPT_RESPONSE;
+        return 0;
+    }
+
+    switch (hndl->firstresponse->error_code) {
+    case CDB2__ERROR_CODE__WRONG_DB:
+        for (int i = 0; i < hndl->num_hosts; i++)
+            hndl->ports[i] = -1;
+        /* fall through */
+    case CDB2__ERROR_CODE__MASTER_TIMEOUT:
+    case CDB2__ERROR_CODE__CHANGENODE:
+    case CDB2__ERROR_CODE__APPSOCK_LIMIT:
+        async_disconnect(hndl);
+        return 1;
+    default:
+        break;
+    }
+
+    if (hndl->firstresponse->foreign_db) {
+        sprintf(hndl->errstr, "%s: Can't pipeline a query on fdb %s:%s",
+                __func__, hndl->firstresponse->foreign_db,
+                hndl->firstresponse->foreign_class);
+        async_disconnect(hndl);
+        *rcp = CDB2ERR_NOTSUPPORTED;
+        return 0;
+    }
+
+    if (hndl->firstresponse->response_type != RESPONSE_TYPE__COLUMN_NAMES) {
+        sprintf(hndl->errstr, "%s: Unknown response type %d", __func__,
+                hndl->firstresponse->response_type);
+        async_disconnect(hndl);
+        *rcp = -1;
+        return 0;
+    }
+
+    if (is_retryable(hndl->firstresponse->error_code)) {
+        async_disconnect(hndl);
+        return 1;
+    }
+
+    hndl->async_primed = 1;
+    hndl->node_seq = 0;
+    bzero(hndl->hosts_connected, sizeof(hndl->hosts_connected));
+
+    if (hndl->firstresponse->error_code) {
+        *rcp = cdb2_convert_error_code(hndl->firstresponse->error_code);
+        return 0;
+    }
+
+    rc = cdb2_next_record_int(hndl, 0);
+    if (rc == CDB2_OK || rc == CDB2_OK_DONE) {
+        *rcp = CDB2_OK;
+        return 0;
+    }
+    if (hndl->sb == NULL) {
+        /* Nothing has been handed to the application yet. */
+        async_disconnect(hndl);
+        return 1;
+    }
+    *rcp = cdb2_convert_error_code(rc);
+    return 0;
+}
+
+int cdb2_async_submit(cdb2_hndl_tp *hndl, const char *sql,
+                      cdb2_async_callback cb, void *arg)
+{
+    struct cdb2_async_query *q;
+    struct timeval tv;
+    int rc;
+
+    if (sql == NULL || cb == NULL) {
+        sprintf(hndl->errstr, "%s: sql and callback are required", __func__);
+        return CDB2ERR_BADREQ;
+    }
+    sql = cdb2_skipws(sql);
+
+    /* Only plain reads are safe to pipeline: writes need a transaction, and
+       stored procedures may read from the socket while they run. */
+    if (hndl->in_trans || hndl->is_hasql) {
+        sprintf(hndl->errstr, "%s: Not supported in a transaction or with hasql",
+                __func__);
+        return CDB2ERR_NOTSUPPORTED;
+    }
+    if (is_sql_read(sql) != 1 || strncasecmp(sql, "exec", 4) == 0) {
+        sprintf(hndl->errstr, "%s: Only SELECT statements can be pipelined",
+                __func__);
+        return CDB2ERR_NOTSUPPORTED;
+    }
+    for (int i = 0; i < hndl->n_bindvars; i++) {
+        if (hndl->bindvars[i]->carray) {
+            sprintf(hndl->errstr, "%s: Array bindings can't be pipelined",
+                    __func__);
+            return CDB2ERR_NOTSUPPORTED;
+        }
+    }
+
+    if (hndl->async_head == NULL) {
+        if (hndl->fdb_hndl) {
+            cdb2_close(hndl->fdb_hndl);
+            hndl->fdb_hndl = NULL;
+        }
+        consume_previous_query(hndl);
+        clear_snapshot_info(hndl, __LINE__);
+    }
+
+    q = calloc(1, sizeof(*q));
+    if (q == NULL || (q->sql = strdup(sql)) == NULL ||
+        async_copy_bindvars(hndl, q) != 0) {
+        if (q)
+            async_free_query(q);
+        sprintf(hndl->errstr, "%s: Out of memory", __func__);
+        return CDB2ERR_MALLOC;
+    }
+    if ((rc = next_cnonce(hndl)) != 0) {
+        async_free_query(q);
+        return rc;
+    }
+    q->cnonce = hndl->cnonce;
+    gettimeofday(&tv, NULL);
+    q->timestampus = ((uint64_t)tv.tv_sec) * 1000000 + tv.tv_usec;
+    q->cb = cb;
+    q->arg = arg;
+
+    if (hndl->async_tail)
+        hndl->async_tail->next = q;
+    else
+        hndl->async_head = q;
+    hndl->async_tail = q;
+    hndl->async_npending++;
+
+    /* A connection failure is reported by cdb2_async_poll(), which retries
+       first. */
+    async_flush(hndl);
+
+    if (log_calls)
+        fprintf(stderr, "%p> cdb2_async_submit(%p, \"%s\") = 0\n",
+                (void *)pthread_self(), hndl, sql);
+    return 0;
+}
+
+int cdb2_async_fd(cdb2_hndl_tp *hndl)
+{
+    if (hndl->async_head && hndl->sb == NULL)
+        async_flush(hndl);
+    return hndl->sb ? sbuf2fileno(hndl->sb) : -1;
+}
+
+int cdb2_async_pending(cdb2_hndl_tp *hndl)
+{
+    return hndl->async_npending;
+}
+
+/* Run the callback of every query whose response has arrived, waiting up to
+   timeoutms for the first one. Returns the number of callbacks run. */
+int cdb2_async_poll(cdb2_hndl_tp *hndl, int timeoutms)
+{
+    struct cdb2_async_query *q;
+    int ncompleted = 0;
+
+    if (hndl->async_in_cb) {
+        sprintf(hndl->errstr, "%s: Can't poll from a callback", __func__);
+        return CDB2ERR_BADSTATE;
+    }
+
+    while ((q = hndl->async_head) != NULL) {
+        int rc = CDB2_OK;
+
+        if (q->retries >= hndl->max_retries) {
+            sprintf(hndl->errstr, "%s: Maximum number of retries done.",
+                    __func__);
+            rc = CDB2ERR_TRAN_IO_ERROR;
+        } else if (async_flush(hndl) != 0) {
+            sprintf(hndl->errstr, "%s: Cannot connect to db", __func__);
+            rc = CDB2ERR_CONNECT_ERROR;
+        } else {
+            if (sbuf2pending(hndl->sb) <= 0) {
+                struct pollfd pfd = {.fd = sbuf2fileno(hndl->sb),
+                                     .events = POLLIN};
+                if (poll(&pfd, 1, ncompleted ? 0 : timeoutms) <= 0)
+                    break;
+            }
+            if (async_read_first(hndl, q, &rc))
+                continue;
+        }
+
+        hndl->async_in_cb = 1;
+        q->cb(hndl, q->arg, rc);
+        hndl->async_in_cb = 0;
+
+        /* Whatever the callback left unread belongs to this query. */
+        while (cdb2_next_record_int(hndl, 0) == CDB2_OK)
+            ;
+        clear_responses(hndl);
+        hndl->rows_read = 0;
+
+        hndl->async_head = q->next;
+        if (hndl->async_head == NULL)
+            hndl->async_tail = NULL;
+        hndl->async_npending--;
+        async_free_query(q);
+        ncompleted++;
+    }
+
+    if (log_calls)
+        fprintf(stderr, "%p> cdb2_async_poll(%p, %d) = %d\n",
+                (void *)pthread_self(), hndl, timeoutms, ncompleted);
+    return ncompleted;
+}
+
 int cdb2_numcolumns(cdb2_hndl_tp *hndl)
 {
     int rc;
@@ -5458,6 +5908,20 @@ static int col_values_flattened(CDB2SQLRESPONSE *resp)
     return (resp->has_flat_col_vals && resp->flat_col_vals);
 }
 
+/* Column `col' of the current row of a ROW_BATCH response */
+static ProtobufCBinaryData *batch_col_value(cdb2_hndl_tp *hndl, int col, int *isnull)
+{
+    CDB2SQLRESPONSE__Rowbatch *rb = hndl->lastresponse->row_batch;
+    CDB2SQLRESPONSE__Rowbatch__Column *c;
+    if (col < 0 || col >= rb->n_cols)
+        return NULL;
+    c = rb->cols[col];
+    if (hndl->batch_row >= c->n_values)
+        return NULL;
+    *isnull = (hndl->batch_row < c->n_isnulls) ? c->isnulls[hndl->batch_row] : 0;
+    return &c->values[hndl->batch_row];
+}
+
 int cdb2_column_size(cdb2_hndl_tp *hndl, int col)
 {
     if (hndl->fdb_hndl)
@@ -5472,6 +5936,12 @@ int cdb2_column_size(cdb2_hndl_tp *hndl, int col)
     /* sqlite row */
     if (hndl->lastresponse->has_sqlite_row)
         return lastresponse->sqlite_row.len;
+    /* one of several rows */
+    if (lastresponse->row_batch) {
+        int isnull;
+        ProtobufCBinaryData *v = batch_col_value(hndl, col, &isnull);
+        return v ? v->len : -1;
+    }
     /* data came back in the parent CDB2SQLRESPONSE structure */
     return (col_values_flattened(lastresponse)) ? lastresponse->values[col].len : -1;
 }
@@ -5496,6 +5966,17 @@ void *cdb2_column_value(cdb2_hndl_tp *hndl, int col)
     /* sqlite row */
     if (hndl->lastresponse->has_sqlite_row)
         return lastresponse->sqlite_row.data;
+    /* one of several rows */
+    if (lastresponse->row_batch) {
+        int isnull;
+        ProtobufCBinaryData *v = batch_col_value(hndl, col, &isnull);
+        if (v == NULL || isnull)
+            return NULL;
+        /* handle empty values */
+        if (v->len == 0)
+            return (void *)"";
+        return v->data;
+    }
     /* data came back in the parent CDB2SQLRESPONSE structure */
     if (col_values_flattened(lastresponse)) {
         /* handle empty values */
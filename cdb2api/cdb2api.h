@@ -226,6 +226,16 @@ int cdb2_run_statement(cdb2_hndl_tp *hndl, const char *sql);
 int cdb2_run_statement_typed(cdb2_hndl_tp *hndl, const char *sql, int ntypes,
                              int *types);
 
+/* Pipelined reads: submit any number of statements, then call
+   cdb2_async_poll() when cdb2_async_fd() is readable. Callbacks run in
+   submission order and may read their result set with cdb2_next_record(). */
+typedef void (*cdb2_async_callback)(cdb2_hndl_tp *hndl, void *arg, int rc);
+int cdb2_async_submit(cdb2_hndl_tp *hndl, const char *sql,
+                      cdb2_async_callback cb, void *arg);
+int cdb2_async_fd(cdb2_hndl_tp *hndl);
+int cdb2_async_poll(cdb2_hndl_tp *hndl, int timeoutms);
+int cdb2_async_pending(cdb2_hndl_tp *hndl);
+
 int cdb2_numcolumns(cdb2_hndl_tp *hndl);
 const char *cdb2_column_name(cdb2_hndl_tp *hndl, int col);
 int cdb2_column_type(cdb2_hndl_tp *hndl, int col);
@@ -227,63 +227,90 @@ static uint32_t space_reqd(uint32_t r, uint32_t s)
            (s > 1 ? (varint_need(s) + s) : s);
 }
 
-/* Check if 'sz' bytes repeat */
-static uint32_t repeats(Data in, uint32_t sz, uint32_t *r_)
+/* Return index of first byte where a and b differ, or n if they don't. */
+static size_t mismatch_scalar(const uint8_t *a, const uint8_t *b, size_t n)
 {
-    uint32_t r;
-    r = *r_ = 0;
-    if (in.sz < (sz * 2))
-        return 0;
-    uint8_t *bp, *bx, bt;
-    uint16_t *wp, word;
-    switch (sz) {
-    case 1:
-        bt = *in.dt;        // 1st byte
-        bp = in.dt + sz;    // byte ptr
-        bx = in.dt + in.sz; // byte ptr max
-#ifndef _SUN_SOURCE
-        if (in.sz > 16) {
-            size_t qz = in.sz - in.sz % 8; // # of quads
-            uint64_t qw;
-            memset(&qw, bt, sizeof(qw));             // 1st quad
-            uint64_t *qp = (uint64_t *)in.dt;        // quad ptr
-            uint64_t *qx = (uint64_t *)(in.dt + qz); // quad ptr max
-            while (qp < qx && *qp == qw)
-                ++qp;
-            if ((uint8_t *)qp != in.dt) {
-                if (qp < qx) // last quad != 1st
-                    --qp;
-                bp = (uint8_t *)qp;
-            }
-        }
-#endif
-        // check remainder byte at a time
-        while (bp < bx && *bp == bt)
-            ++bp;
-        r = bp - in.dt - 1;
-        break;
+    size_t i = 0;
 #ifndef _SUN_SOURCE
-    case 2:
-        word = *(uint16_t *)in.dt;
-        wp = (uint16_t *)(in.dt + sz);
-        in.sz -= (in.sz % sz);
-        while ((in.sz -= sz) != 0 && word == *wp) {
-            ++wp;
-            ++r;
-        }
-        break;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t x, y;
+        memcpy(&x, a + i, sizeof(x));
+        memcpy(&y, b + i, sizeof(y));
+        if (x != y)
+            break;
+    }
 #endif
-    default:
-        bp = in.dt + sz;
-        in.sz -= (in.sz % sz);
-        while ((in.sz -= sz) != 0) {
-            if (memcmp(in.dt, bp, sz))
-                break;
-            bp += sz;
-            ++r;
-        }
-        break;
+    while (i < n && a[i] == b[i])
+        ++i;
+    return i;
+}
+
+#ifdef __x86_64__
+#include <immintrin.h>
+
+/* SSE2 is part of the x86_64 baseline: no dispatch needed */
+static size_t mismatch_sse2(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i y = _mm_loadu_si128((const __m128i *)(b + i));
+        unsigned m = _mm_movemask_epi8(_mm_cmpeq_epi8(x, y));
+        if (m != 0xffff)
+            return i + __builtin_ctz(~m);
     }
+    return i + mismatch_scalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static size_t mismatch_avx2(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i *)(b + i));
+        unsigned m = _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y));
+        if (m != 0xffffffff)
+            return i + __builtin_ctz(~m);
+    }
+    return i + mismatch_sse2(a + i, b + i, n - i);
+}
+#endif
+
+typedef size_t (*mismatch_t)(const uint8_t *, const uint8_t *, size_t);
+static mismatch_t mismatch_func;
+
+static mismatch_t mismatch_select(void)
+{
+#ifdef __x86_64__
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return mismatch_avx2;
+    return mismatch_sse2;
+#else
+    return mismatch_scalar;
+#endif
+}
+
+static inline size_t mismatch(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    /* racing initializers all store the same value */
+    if (mismatch_func == NULL)
+        mismatch_func = mismatch_select();
+    return mismatch_func(a, b, n);
+}
+
+/* Check if 'sz' bytes repeat
+ * The first 'sz' bytes repeat r times when in[i] == in[i + sz] for every i
+ * in [0, r * sz), so this is a single mismatch scan of the input against
+ * itself shifted by 'sz'. Only whole repeats within in.sz are counted. */
+static uint32_t repeats(Data in, uint32_t sz, uint32_t *r_)
+{
+    *r_ = 0;
+    if (in.sz < (sz * 2) || in.dt[0] != in.dt[sz])
+        return 0;
+    size_t n = in.sz - (in.sz % sz) - sz;
+    uint32_t r = mismatch(in.dt, in.dt + sz, n) / sz;
     *r_ = r;
     return r;
 }
@@ -529,6 +556,17 @@ int decompressComdb2RLE(Comdb2RLE *d)
             memset(output.dt, *p, r);
             output.dt += r;
             output.sz -= r;
+        } else if (r >= 4) {
+            /* lay down one copy, then keep doubling what's been written */
+            uint32_t done = s;
+            memcpy(output.dt, p, s);
+            while (done < reqd) {
+                uint32_t n = done < reqd - done ? done : reqd - done;
+                memcpy(output.dt + done, output.dt, n);
+                done += n;
+            }
+            output.dt += reqd;
+            output.sz -= reqd;
         } else
             for (uint32_t i = 0; i <= r; ++i) {
                 switch (s) {
@@ -79,6 +79,12 @@ int analyze_database(SBUF2 *sb, int scale, int override_llmeta);
  */
 void handle_backout(SBUF2 *sb, char *table);
 
+/**
+ * Shift the row counts in sqlite_stat1 for table by delta rows and reload
+ * stats, without rerunning analyze.
+ */
+int analyze_refresh_stat1_rows(const char *table, int64_t delta);
+
 /* rename idx old to new for table tbl */
 void add_idx_stats(const char *tbl, const char *oldname, const char *newname);
 
@@ -39,6 +39,7 @@ const char *aa_lastepoch_str = "autoanalyze_lastepoch";
 const char *aa_needs_analyze_time_str = "autoanalyze_needs_analyze_time";
 static volatile int auto_analyze_running = 0;
 int gbl_debug_aa;
+int gbl_autoanalyze_incremental_pct = 0;
 extern int gbl_is_physical_replicant;
 
 /* ctime_r no-new-line */
@@ -68,6 +69,8 @@ void reset_aa_counter(char *tblname)
     XCHANGE64(tbl->aa_saved_counter, 0);
     XCHANGE64(tbl->aa_lastepoch, (int64_t)time(NULL));
     XCHANGE64(tbl->aa_needs_analyze_time, 0);
+    XCHANGE64(tbl->aa_net_rows, 0);
+    XCHANGE64(tbl->aa_refresh_counter, 0);
 
     if (save_freq > 0 && thedb->master == gbl_myhostname) {
         // save updated counter
@@ -142,6 +145,48 @@ void *auto_analyze_table(void *arg)
     return NULL;
 }
 
+struct aa_refresh {
+    char *tblname;
+    int64_t counter;  /* autoanalyze counter the refresh accounts for */
+    int64_t net_rows; /* rows to add to the stat1 row counts */
+};
+
+/* auto_analyze_refresh_table() brings the row counts in sqlite_stat1 up to
+ * date from the write counters instead of rerunning analyze. It will free
+ * its argument.
+ */
+static void *auto_analyze_refresh_table(void *arg)
+{
+    struct aa_refresh *r = arg;
+    bdb_state_type *bdb_state = thedb->bdb_env;
+
+    bdb_thread_event(thedb->bdb_env, BDBTHR_EVENT_START_RDWR);
+    int rc = analyze_refresh_stat1_rows(r->tblname, r->net_rows);
+    bdb_thread_event(thedb->bdb_env, BDBTHR_EVENT_DONE_RDWR);
+
+    BDB_READLOCK(__func__);
+    rdlock_schema_lk();
+    struct dbtable *tbl = get_dbtable_by_name(r->tblname);
+    if (tbl) {
+        if (rc == 0) {
+            XCHANGE64(tbl->aa_refresh_counter, r->counter);
+        } else {
+            /* give the rows back, next refresh or analyze will pick them up */
+            ATOMIC_ADD64(tbl->aa_net_rows, r->net_rows);
+        }
+    }
+    unlock_schema_lk();
+    BDB_RELLOCK();
+
+    ctrace("AUTOANALYZE: Refreshed row counts of Table %s by %" PRId64 " rows, counter (%" PRId64 ") rc %d\n",
+           r->tblname, r->net_rows, r->counter, rc);
+
+    free(r->tblname);
+    free(r);
+    auto_analyze_running = 0;
+    return NULL;
+}
+
 static void get_saved_counter_epochs(tran_type *trans, char *tblname, int64_t *aa_counter, int64_t *aa_lastepoch,
                                      int64_t *aa_needs_analyze_time)
 {
@@ -437,6 +482,39 @@ void *auto_analyze_main(void *unused)
             ((newautoanalyze_counter > min_ops && now - lastepoch > min_time) ||
              (min_percent > 0 && new_aa_percnt > min_percent))) {
 
+            // While the table has changed by less than autoanalyze_incremental_pct
+            // since the last analyze, only shift the stat1 row counts by the net
+            // inserts/deletes we have counted, at most once every min_ops changes.
+            if (gbl_autoanalyze_incremental_pct > 0 && new_aa_percnt < gbl_autoanalyze_incremental_pct) {
+                int64_t refresh_counter = ATOMIC_LOAD64(tbl->aa_refresh_counter);
+                if (newautoanalyze_counter - refresh_counter <= min_ops)
+                    continue;
+                int64_t net_rows = XCHANGE64(tbl->aa_net_rows, 0);
+                if (net_rows == 0) {
+                    XCHANGE64(tbl->aa_refresh_counter, newautoanalyze_counter);
+                    continue;
+                }
+                ctrace("AUTOANALYZE: Refreshing Table %s, counter (%" PRId64 "), percent %f < incremental pct %d\n",
+                       tbl->tablename, newautoanalyze_counter, new_aa_percnt, gbl_autoanalyze_incremental_pct);
+                struct aa_refresh *r = malloc(sizeof(struct aa_refresh));
+                if (r)
+                    r->tblname = strdup(tbl->tablename);
+                if (!r || !r->tblname) {
+                    logmsg(LOGMSG_ERROR, "%s: out of memory refreshing %s\n", __func__, tbl->tablename);
+                    free(r);
+                    /* give the rows back for the next try */
+                    ATOMIC_ADD64(tbl->aa_net_rows, net_rows);
+                    continue;
+                }
+                r->counter = newautoanalyze_counter;
+                r->net_rows = net_rows;
+                auto_analyze_running = 1; // will be reset by
+                                          // auto_analyze_refresh_table()
+                pthread_t refresh;
+                Pthread_create(&refresh, &gbl_pthread_attr_detached, auto_analyze_refresh_table, r);
+                continue;
+            }
+
             if (!((newautoanalyze_counter > min_ops && now - lastepoch > min_time)))
                 ctrace("AUTOANALYZE: Forcing analyze because new_aa_percnt %f > min_percent %d\n",
                        new_aa_percnt, min_percent);
@@ -371,6 +371,7 @@ int gbl_init_with_odh = 1;
 int gbl_init_with_queue_odh = 1;
 int gbl_init_with_queue_compr = BDB_COMPRESS_LZ4;
 int gbl_init_with_queue_persistent_seq = 0;
+int gbl_init_with_queue_shards = 1;
 int gbl_init_with_ipu = 1;
 int gbl_init_with_instant_sc = 1;
 int gbl_init_with_compr = BDB_COMPRESS_CRLE;
@@ -4943,6 +4944,9 @@ void *statthd(void *p)
                     }
 
                     ATOMIC_ADD64(tbl->aa_saved_counter, (curr - prev));
+                    ATOMIC_ADD64(tbl->aa_net_rows,
+                                 (tbl->write_count[RECORD_WRITE_INS] - tbl->saved_write_count[RECORD_WRITE_INS]) -
+                                     (tbl->write_count[RECORD_WRITE_DEL] - tbl->saved_write_count[RECORD_WRITE_DEL]));
                     log_tbl_item(tbl->write_count[RECORD_WRITE_INS], &tbl->saved_write_count[RECORD_WRITE_INS],
                                  NULL, 0, "inserted rows", &hdr, statlogger, tbl, 0);
                     log_tbl_item(tbl->write_count[RECORD_WRITE_UPD], &tbl->saved_write_count[RECORD_WRITE_UPD],
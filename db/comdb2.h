@@ -415,7 +415,8 @@ enum DB_METADATA {
     META_QUEUE_ODH = -14,
     META_QUEUE_COMPRESS = -15,
     META_QUEUE_PERSISTENT_SEQ = -16,
-    META_QUEUE_SEQ = -17
+    META_QUEUE_SEQ = -17,
+    META_QUEUE_SHARDS = -18
 };
 
 enum CONSTRAINT_FLAGS {
@@ -666,6 +667,8 @@ typedef struct dbtable {
     int64_t aa_saved_counter; // zeroed out at autoanalyze
     int64_t aa_lastepoch;
     int64_t aa_needs_analyze_time; // time when analyze is needed for table in request mode, otherwise 0
+    int64_t aa_net_rows; // inserts minus deletes since stat1 row counts were last set
+    int64_t aa_refresh_counter; // aa_saved_counter when stat1 row counts were last refreshed
     int64_t read_count; // counter for reads to this table
     int64_t index_used_count;   // counter for number of times a table index was used
 
@@ -734,6 +737,8 @@ typedef struct dbtable {
 
     int sc_live_logical;
     unsigned long long *sc_genids; /* schemachange stripe pointers */
+    struct sc_stripe_ranges *sc_ranges; /* schemachange pointers per key
+                                           range, if stripes are split */
 
     /* All writer threads have to grab the lock in read/write mode.  If a live
      * schema change is in progress then they have to do extra stuff. */
@@ -1123,6 +1128,8 @@ typedef struct osql_bp_timings {
     unsigned long long replication_start; /* time replication */
     unsigned long long replication_end;   /* time replication */
     unsigned int retries;                 /* retried bplog transaction */
+    unsigned long long idx_applied;       /* time for defered index ops */
+    unsigned int idx_children;            /* child trans they were spread on */
 } osql_bp_timings_t;
 
 struct query_effects {
@@ -1245,6 +1252,7 @@ struct osql_target {
     SBUF2 *sb;
     int (*send)(struct osql_target *target, int usertype, void *data,
                 int datalen, int nodelay, void *tail, int tailen);
+    struct osql_batch *batch; /* coalescing of ops, see osql_batch_begin */
 };
 typedef struct osql_target osql_target_t;
 
@@ -1421,6 +1429,10 @@ struct ireq {
     uint8_t **idxInsert;
     uint8_t **idxDelete;
 
+    /* readonly schema change: per-index key collectors for indexes that are
+       built bottom-up once all records are converted; NULL otherwise */
+    struct bdb_bulk_ix **bulk_ix;
+
     /* osql prefault step index */
     int *osql_step_ix;
 
@@ -1807,6 +1819,7 @@ extern int gbl_init_with_genid48;
 extern int gbl_init_with_odh;
 extern int gbl_init_with_queue_odh;
 extern int gbl_init_with_queue_persistent_seq;
+extern int gbl_init_with_queue_shards;
 extern int gbl_init_with_ipu;
 extern int gbl_init_with_instant_sc;
 extern int gbl_init_with_compr;
@@ -2517,6 +2530,9 @@ int get_db_queue_persistent_seq_tran(struct dbtable *, int *persist,
 int put_db_queue_sequence(struct dbtable *db, tran_type *, long long seq);
 int get_db_queue_sequence(struct dbtable *db, long long *seq);
 int get_db_queue_sequence_tran(struct dbtable *, long long *seq, tran_type *);
+int put_db_queue_shards(struct dbtable *db, tran_type *, int nshards);
+int get_db_queue_shards(struct dbtable *db, int *nshards);
+int get_db_queue_shards_tran(struct dbtable *, int *nshards, tran_type *);
 int put_db_compress(struct dbtable *db, tran_type *, int compress);
 int get_db_compress(struct dbtable *db, int *compress);
 int get_db_compress_tran(struct dbtable *, int *compress, tran_type *);
@@ -2647,6 +2663,9 @@ int dbq_consume(struct ireq *iq, void *trans, int consumer,
 int dbq_consume_genid(struct ireq *, void *trans, int consumer, const genid_t);
 int dbq_get(struct ireq *iq, int consumer, const struct bdb_queue_cursor *prev, struct bdb_queue_found **fnddta,
             size_t *fnddtalen, size_t *fnddtaoff, struct bdb_queue_cursor *fnd, long long *seq, uint32_t lockid);
+int dbq_get_batch(struct ireq *iq, int consumer, const struct bdb_queue_cursor *prev, int maxitems, size_t maxbytes,
+                  struct bdb_queue_found **fnddta, struct bdb_queue_cursor *fnd, long long *seq, int *nfound,
+                  uint32_t lockid);
 void dbq_get_item_info(const struct bdb_queue_found *fnd, size_t *dtaoff, size_t *dtalen);
 unsigned long long dbq_item_genid(const struct bdb_queue_found *dta);
 typedef int (*dbq_walk_callback_t)(int consumern, size_t item_length,
@@ -125,6 +125,10 @@ extern int gbl_master_swing_osql_verbose;
 extern int gbl_master_swing_sock_restart_sleep;
 extern int gbl_max_lua_instructions;
 extern int gbl_max_sqlcache;
+extern int gbl_stmt_cache_stats;
+extern int gbl_stmt_cache_stats_size;
+extern int gbl_sql_key_projection;
+extern int gbl_schema_conv_progs;
 extern int __gbl_max_mpalloc_sleeptime;
 extern int gbl_mem_nice;
 extern int gbl_notimeouts;
@@ -361,6 +365,26 @@ extern char *gbl_user_vers_spfile_name;
 extern char *gbl_timepart_file_name;
 extern char *gbl_machine_class;
 extern int gbl_ref_sync_pollms;
+extern int gbl_mp_lockless_fget;
+extern int gbl_newsql_row_batch_rows;
+extern int gbl_newsql_row_batch_bytes;
+extern int gbl_osql_batch_bytes;
+extern int gbl_osql_batch_compress;
+extern int gbl_bplog_apply_threads;
+extern int gbl_bplog_apply_parallel_min;
+extern int gbl_sc_bulk_build_indexes;
+extern int gbl_sc_stripe_ranges;
+extern int gbl_fdb_remsql_hndl_cache;
+extern int gbl_fdb_remsql_projection;
+extern int gbl_physrep_batch_logs;
+extern int gbl_tranlog_batch_bytes;
+extern int gbl_debug_tranlog_no_batch;
+extern int gbl_debug_tranlog_truncate_batch;
+extern int gbl_analyze_block_sampling;
+extern int gbl_analyze_block_sample_min_pages;
+extern double gbl_analyze_block_sample_rse;
+extern int gbl_autoanalyze_incremental_pct;
+extern int gbl_sql_hashjoin;
 extern int gbl_ref_sync_wait_txnlist;
 extern int gbl_ref_sync_iterations;
 extern int gbl_sc_pause_at_end;
@@ -553,6 +577,7 @@ extern int gbl_net_maxconn;
 extern int gbl_force_direct_io;
 extern int gbl_seekscan_maxsteps;
 extern int gbl_wal_osync;
+extern int gbl_log_group_commit_usec;
 extern uint64_t gbl_sc_headroom;
 
 extern int gbl_unexpected_last_type_warn;
@@ -571,6 +596,7 @@ int gbl_new_leader_duration = 3;
 extern int gbl_transaction_grace_period;
 extern int gbl_partition_sc_reorder;
 extern int gbl_dohsql_joins;
+extern int gbl_dohsql_scan_shards;
 extern int gbl_altersc_latency;
 extern int gbl_altersc_delay_usec;
 extern int gbl_altersc_latency_thr;
@@ -639,6 +665,19 @@ static int init_with_queue_compr_update(void *context, void *algo)
     return 0;
 }
 
+static int osql_batch_compress_update(void *context, void *algo)
+{
+    int compr = bdb_compr2algo((char *)algo);
+    if (compr != BDB_COMPRESS_NONE && compr != BDB_COMPRESS_ZLIB &&
+        compr != BDB_COMPRESS_LZ4) {
+        logmsg(LOGMSG_ERROR, "Unsupported osql batch compression: %s\n",
+               (char *)algo);
+        return 1;
+    }
+    gbl_osql_batch_compress = compr;
+    return 0;
+}
+
 static int init_with_rowlocks_update(void *context, void *unused)
 {
     gbl_init_with_rowlocks = 1;
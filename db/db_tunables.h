@@ -806,6 +806,16 @@ REGISTER_TUNABLE("maxretries", "Maximum number of times a "
                                "deadlock. (Default: 500)",
                  TUNABLE_INTEGER, &gbl_maxretries, 0, NULL,
                  maxretries_verify, NULL, NULL);
+REGISTER_TUNABLE("sql_key_projection",
+                 "Only convert the index key fields a statement reads into "
+                 "sqlite format; leave the others as NULLs. (Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_sql_key_projection, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("schema_conversion_programs",
+                 "Compile per schema-pair conversion programs so record and "
+                 "key conversions skip per-row field lookups. (Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_schema_conv_progs, 0, NULL, NULL, NULL,
+                 NULL);
 REGISTER_TUNABLE(
     "max_sqlcache_hints",
     "Maximum number of \"hinted\" query plans to keep (global). (Default: 100)",
@@ -815,6 +825,18 @@ REGISTER_TUNABLE("max_sqlcache_per_thread",
                  "cache is per-thread). (Default: 10)",
                  TUNABLE_INTEGER, &gbl_max_sqlcache, READONLY, NULL, NULL, NULL,
                  NULL);
+REGISTER_TUNABLE("stmt_cache_stats",
+                 "Collect statement cache statistics across all sql threads "
+                 "by fingerprint, and prefer evicting globally cold "
+                 "statements. Prepared statements are still per-thread. "
+                 "(Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_stmt_cache_stats, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("stmt_cache_stats_size",
+                 "Maximum number of fingerprints tracked by "
+                 "stmt_cache_stats. (Default: 1000)",
+                 TUNABLE_INTEGER, &gbl_stmt_cache_stats_size, 0, NULL, NULL,
+                 NULL, NULL);
 REGISTER_TUNABLE("maxt", NULL, TUNABLE_INTEGER, &gbl_maxthreads,
                  NOZERO, NULL, NULL, maxt_update, NULL);
 REGISTER_TUNABLE(
@@ -2192,6 +2214,12 @@ REGISTER_TUNABLE("debug_add_replication_latency", "Sleep after distributed commi
                  TUNABLE_BOOLEAN, &gbl_debug_add_replication_latency, EXPERIMENTAL | INTERNAL, 
                  NULL, NULL, NULL, NULL);
 
+REGISTER_TUNABLE("memp_lockless_fget",
+                 "Look up resident cache pages without taking the hash bucket "
+                 "lock.  (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_mp_lockless_fget, EXPERIMENTAL, NULL,
+                 NULL, NULL, NULL);
+
 REGISTER_TUNABLE("ref_sync_pollms",
                  "Set pollms for ref_sync thread.  "
                  "(Default: 250)",
@@ -2449,6 +2477,10 @@ REGISTER_TUNABLE("seekscan_maxsteps", "Overrides the max number of steps for a s
                  &gbl_seekscan_maxsteps, SIGNED, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("wal_osync", "Open WAL files using the O_SYNC flag (Default: off)", TUNABLE_BOOLEAN, &gbl_wal_osync, 0,
                  NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("log_group_commit_usec",
+                 "When commits arrive concurrently, a log flush waits this many microseconds for more commits to "
+                 "share its fsync. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_log_group_commit_usec, 0, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("sc_headroom", "Percentage threshold for low headroom calculation. (Default: 10)", TUNABLE_DOUBLE,
                  &gbl_sc_headroom, INTERNAL | SIGNED, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("sc_protobuf", "Enable protobuf schema change object (Default: on)", TUNABLE_BOOLEAN, &gbl_sc_protobuf,
@@ -2515,6 +2547,10 @@ REGISTER_TUNABLE("partition_sc_reorder", "If the schema change is serialized for
 
 REGISTER_TUNABLE("dohsql_joins", "Enable to support joins in parallel sql execution (default: on)", TUNABLE_BOOLEAN,
                  &gbl_dohsql_joins, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("dohsql_scan_shards",
+                 "Split single table aggregate scans across this many data stripe shards (0 or 1 disables). "
+                 "(Default: 0)",
+                 TUNABLE_INTEGER, &gbl_dohsql_scan_shards, 0, NULL, NULL, NULL, NULL);
 
 REGISTER_TUNABLE("altersc_latency", "Enable tracking master queue latency and delay alter schema changes if too high",
                  TUNABLE_BOOLEAN, &gbl_altersc_latency, 0, NULL, NULL, NULL, NULL);
@@ -2560,4 +2596,77 @@ REGISTER_TUNABLE("comdb2_oplog_preserve_seqno", "Preserve max value of the seqno
 REGISTER_TUNABLE("queue_nonodh_scan_limit", "For comdb2_queues, stop queue scan at this depth (Default: 10000)", TUNABLE_INTEGER, &gbl_nonodh_queue_scan_limit, 0, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("always_request_log_req", "Always request the next log record on replicant if there is a gap (default: off)", TUNABLE_BOOLEAN, &gbl_always_request_log_req, 0, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("nudge_replication_when_idle", "If we haven't seen any replication events in a while, request some (default: off)", TUNABLE_BOOLEAN, &gbl_nudge_replication_when_idle, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("newsql_row_batch_rows",
+                 "Max rows in one response to clients that read row batches. 0 or 1 sends one row per response. "
+                 "(Default: 256)",
+                 TUNABLE_INTEGER, &gbl_newsql_row_batch_rows, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("newsql_row_batch_bytes",
+                 "Send a row batch once it holds this many bytes of column values. (Default: 65536)",
+                 TUNABLE_INTEGER, &gbl_newsql_row_batch_bytes, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("osql_batch_bytes",
+                 "Replicants coalesce the ops of a transaction into frames of up to this many bytes before "
+                 "sending them to the master. All nodes must understand batched ops. 0 disables. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_osql_batch_bytes, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("osql_batch_compress",
+                 "Compress the frames of coalesced ops (see osql_batch_bytes) with none, zlib or lz4. "
+                 "(Default: none)",
+                 TUNABLE_ENUM, &gbl_osql_batch_compress, 0, init_with_compr_value, NULL,
+                 osql_batch_compress_update, NULL);
+REGISTER_TUNABLE("bplog_apply_threads",
+                 "Master applies the defered index ops of large transactions on up to this many threads, one child "
+                 "transaction per index. 0 applies them serially. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_bplog_apply_threads, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("bplog_apply_parallel_min",
+                 "Minimum number of defered index ops in a transaction before bplog_apply_threads are used. "
+                 "(Default: 1000)",
+                 TUNABLE_INTEGER, &gbl_bplog_apply_parallel_min, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("sc_bulk_build_indexes",
+                 "Readonly schema changes collect the keys of the indexes they rebuild and build each btree "
+                 "bottom-up once all records are converted. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_sc_bulk_build_indexes, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("sc_stripe_ranges",
+                 "Split each stripe into up to this many key ranges, picked by sampling its btree, and convert each "
+                 "range on its own thread during schema change. (Default: 1)",
+                 TUNABLE_INTEGER, &gbl_sc_stripe_ranges, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("fdb_remsql_hndl_cache",
+                 "Keep up to this many idle cdb2api handles per foreign db for remote sql cursors. (Default: 8)",
+                 TUNABLE_INTEGER, &gbl_fdb_remsql_hndl_cache, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("fdb_remsql_projection",
+                 "Remote sql data cursors only request the columns the statement reads. (Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_fdb_remsql_projection, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("physrep_batch_logs", "Physical replicants ask the source for log records in batches. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_physrep_batch_logs, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("tranlog_batch_bytes",
+                 "Maximum size of a batch of log records returned by comdb2_transaction_logs. (Default: 1048576)",
+                 TUNABLE_INTEGER, &gbl_tranlog_batch_bytes, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("debug_tranlog_no_batch",
+                 "Fail batched comdb2_transaction_logs queries like a source that predates batching. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_debug_tranlog_no_batch, EXPERIMENTAL | INTERNAL, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("debug_tranlog_truncate_batch",
+                 "Cut the last log record of every comdb2_transaction_logs batch short. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_debug_tranlog_truncate_batch, EXPERIMENTAL | INTERNAL, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("init_with_queue_shards",
+                 "Queues created while this is set spread their adds over this many shards, picked by writer, to "
+                 "avoid contending on the last page of the queue. Consumers merge the shards in genid order. "
+                 "(Default: 1, max: 16)",
+                 TUNABLE_INTEGER, &gbl_init_with_queue_shards, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("analyze_block_sampling",
+                 "Sampled analyze reads a random subset of index pages instead of scanning the whole file, and stops "
+                 "once the row count estimate is within analyze_block_sample_rse. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_analyze_block_sampling, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("analyze_block_sample_min_pages",
+                 "Minimum number of pages block-sampling analyze reads from an index. (Default: 1000)",
+                 TUNABLE_INTEGER, &gbl_analyze_block_sample_min_pages, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("analyze_block_sample_rse",
+                 "Block-sampling analyze stops once the relative standard error of its row count estimate is at most "
+                 "this. (Default: 0.01)",
+                 TUNABLE_DOUBLE, &gbl_analyze_block_sample_rse, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("autoanalyze_incremental_pct",
+                 "While a table has changed by less than this percent since it was last analyzed, autoanalyze only "
+                 "updates the row counts in sqlite_stat1 from the write counters. 0 disables. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_autoanalyze_incremental_pct, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("sql_hashjoin",
+                 "Let the planner build automatic indexes on equi-join columns as hash tables, probed in constant "
+                 "time. Rows of such joins come back in no particular order. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_sql_hashjoin, 0, NULL, NULL, NULL, NULL);
 #endif /* _DB_TUNABLES_H */
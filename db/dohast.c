@@ -25,6 +25,7 @@
 int gbl_dohast_disable = 0;
 int gbl_dohast_verbose = 0;
 int gbl_dohsql_joins = 1;
+int gbl_dohsql_scan_shards = 0;
 
 static void node_free(dohsql_node_t **pnode, sqlite3 *db);
 static void _save_params(Parse *pParse, dohsql_node_t *node);
@@ -33,6 +34,7 @@ static char *_gen_col_expr(Vdbe *v, Expr *expr, SrcList *srcs,
                            struct params_info **pParamsOut);
 
 static dohsql_node_t *gen_select(Vdbe *v, Select *p);
+static int scan_shard_combine(const Expr *pExpr);
 
 
 static char *generate_columns(Vdbe *v, ExprList *c, SrcList *srcs,
@@ -279,6 +281,11 @@ char *sqlite_struct_to_string(Vdbe *v, Select *p, Expr *extraRows,
                     tbl = sqlite3_mprintf("%s\"%w\"", tmp, p->pSrc->a[i].zName);
                 }
             }
+            if (p->pSrc->a[i].fg.notIndexed) {
+                sqlite3_free(tmp);
+                tmp = tbl;
+                tbl = sqlite3_mprintf("%s NoT InDeXeD", tmp);
+            }
         } else {
             /* subquery */
             dohsql_node_t *subnode = gen_select(v, p->pSrc->a[i].pSelect);
@@ -555,6 +562,9 @@ static void node_free(dohsql_node_t **pnode, sqlite3 *db)
     if ((*pnode)->order_dir) {
         free((*pnode)->order_dir);
     }
+    free((*pnode)->combine);
+    free((*pnode)->coll);
+    free((*pnode)->scan_tbl);
     free(*pnode);
     *pnode = NULL;
 }
@@ -693,6 +703,160 @@ static int skip_tables(Select *p)
     return 0;
 }
 
+/* how partial results of aggregate pExpr are merged, 0 if they cannot be */
+static int scan_shard_combine(const Expr *pExpr)
+{
+    static const struct {
+        const char *name;
+        int op;
+    } aggs[] = {{"count", DOHSQL_COMBINE_COUNT}, {"sum", DOHSQL_COMBINE_SUM},
+                {"total", DOHSQL_COMBINE_TOTAL}, {"min", DOHSQL_COMBINE_MIN},
+                {"max", DOHSQL_COMBINE_MAX}};
+    int i;
+
+    if (pExpr->op != TK_AGG_FUNCTION || ExprHasProperty(pExpr, EP_Distinct) ||
+        ExprHasProperty(pExpr, EP_WinFunc))
+        return 0;
+    if (pExpr->x.pList && pExpr->x.pList->nExpr > 1)
+        return 0;
+    for (i = 0; i < sizeof(aggs) / sizeof(aggs[0]); i++) {
+        if (strcasecmp(pExpr->u.zToken, aggs[i].name) == 0) {
+            /* only count takes no arguments */
+            if (!pExpr->x.pList && aggs[i].op != DOHSQL_COMBINE_COUNT)
+                return 0;
+            return aggs[i].op;
+        }
+    }
+    return 0;
+}
+
+static int _subqueryCallback(Walker *pWalker, Expr *pExpr)
+{
+    if (ExprHasProperty(pExpr, EP_xIsSelect) || pExpr->op == TK_SELECT ||
+        pExpr->op == TK_EXISTS) {
+        pWalker->eCode = 1;
+        return WRC_Abort;
+    }
+    return WRC_Continue;
+}
+
+/* a subquery could open another cursor on the sharded table */
+static int has_subquery(Select *p)
+{
+    Walker w = {0};
+
+    w.xExprCallback = _subqueryCallback;
+    sqlite3WalkExprList(&w, p->pEList);
+    if (p->pWhere)
+        sqlite3WalkExpr(&w, p->pWhere);
+    return w.eCode;
+}
+
+/**
+ * A single table aggregate like "select count(*), max(a) from t where b>0"
+ * can be split across the data stripes; every shard scans its own stripes
+ * and the coordinator merges the partial aggregates.
+ * Returns the union of "nshards" identical shard queries, or NULL
+ *
+ */
+static dohsql_node_t *gen_scan_shards(Vdbe *v, Select *p)
+{
+    struct SrcList_item *src;
+    ExprList *cols = p->pEList;
+    dohsql_node_t *node;
+    int nshards = gbl_dohsql_scan_shards;
+    int *combine;
+    CollSeq **coll;
+    char **saved;
+    int i;
+
+    if (nshards > gbl_dtastripe)
+        nshards = gbl_dtastripe;
+    if (gbl_dohsql_max_threads && nshards > gbl_dohsql_max_threads)
+        nshards = gbl_dohsql_max_threads;
+    if (nshards < 2)
+        return NULL;
+
+    if (p->pPrior || p->pWith || p->pGroupBy || p->pHaving || p->pLimit ||
+        p->pOrderBy || (p->selFlags & SF_Distinct) || p->pSrc->nSrc != 1)
+        return NULL;
+    src = &p->pSrc->a[0];
+    if (!src->pTab || src->pTab->iDb > 1 || src->pTab->pSelect ||
+        IsVirtual(src->pTab) || src->pSelect || src->fg.isIndexedBy ||
+        has_subquery(p))
+        return NULL;
+    /* plain "select count(*) from t" is answered by bdb_direct_count */
+    if (!p->pWhere && cols->nExpr == 1 &&
+        scan_shard_combine(cols->a[0].pExpr) == DOHSQL_COMBINE_COUNT &&
+        !cols->a[0].pExpr->x.pList)
+        return NULL;
+
+    combine = malloc(cols->nExpr * sizeof(int));
+    coll = calloc(cols->nExpr, sizeof(CollSeq *));
+    saved = malloc(cols->nExpr * sizeof(char *));
+    node = calloc(1, sizeof(dohsql_node_t) + nshards * sizeof(void *));
+    if (!combine || !coll || !saved || !node)
+        goto err;
+    for (i = 0; i < cols->nExpr; i++) {
+        Expr *pExpr = cols->a[i].pExpr;
+        if (!(combine[i] = scan_shard_combine(pExpr)))
+            goto err;
+        if (!cols->a[i].zName && !cols->a[i].zSpan)
+            goto err;
+        /* merge min/max with the collation the shards compared with */
+        if (combine[i] == DOHSQL_COMBINE_MIN ||
+            combine[i] == DOHSQL_COMBINE_MAX)
+            coll[i] = sqlite3ExprCollSeq(v->pParse, pExpr->x.pList->a[0].pExpr);
+    }
+    if (!(node->scan_tbl = strdup(src->pTab->zName)))
+        goto err;
+
+    node->type = AST_TYPE_UNION;
+    node->nodes = (dohsql_node_t **)(node + 1);
+    node->ncols = cols->nExpr;
+    node->combine = combine;
+    node->coll = coll;
+    combine = NULL;
+    coll = NULL;
+
+    /* shards scan the table, regardless of the index the planner likes;
+     * keep the client visible column names */
+    for (i = 0; i < cols->nExpr; i++) {
+        saved[i] = cols->a[i].zName;
+        if (!cols->a[i].zName)
+            cols->a[i].zName = cols->a[i].zSpan;
+    }
+    src->fg.notIndexed = 1;
+    for (i = 0; i < nshards; i++) {
+        node->nodes[i] = gen_oneselect(v, p, NULL, NULL, NULL, 0);
+        if (!node->nodes[i])
+            break;
+        node->nnodes++;
+    }
+    src->fg.notIndexed = 0;
+    for (i = 0; i < cols->nExpr; i++)
+        cols->a[i].zName = saved[i];
+    free(saved);
+
+    if (node->nnodes != nshards) {
+        node_free(&node, v->db);
+        return NULL;
+    }
+    node->sql = sqlite3_mprintf("%s", node->nodes[0]->sql);
+    if (!node->sql)
+        node_free(&node, v->db);
+    return node;
+
+err:
+    free(combine);
+    free(coll);
+    free(saved);
+    if (node)
+        free(node->scan_tbl);
+    free(node);
+    return NULL;
+}
+
 static dohsql_node_t *gen_select(Vdbe *v, Select *p)
 {
     Select *crt;
@@ -761,6 +925,12 @@ static dohsql_node_t *gen_select(Vdbe *v, Select *p)
                     logmsg(LOGMSG_USER, "We can push remotely to %d %s db %p\n",
                            remoteIdb, remoteDb, v->db);
                 ret->remotedb = remoteIdb;
+            } else if (gbl_dohsql_scan_shards > 1) {
+                dohsql_node_t *sharded = gen_scan_shards(v, p);
+                if (sharded) {
+                    node_free(&ret, v->db);
+                    ret = sharded;
+                }
             }
         }
     } else
@@ -877,6 +1047,22 @@ void ast_print(ast_t *ast)
 
 extern int comdb2IsPrepareOnly(Parse*);
 
+/* does the plan read through an index? */
+static int plan_uses_index(Parse *pParse)
+{
+    Vdbe *v = pParse->pVdbe;
+    int i;
+
+    if (!v)
+        return 0;
+    for (i = 0; i < v->nOp; i++) {
+        if (v->aOp[i].opcode == OP_OpenRead &&
+            v->aOp[i].p4type == P4_KEYINFO)
+            return 1;
+    }
+    return 0;
+}
+
 int comdb2_check_parallel(Parse *pParse)
 {
     if (comdb2IsPrepareOnly(pParse))
@@ -918,6 +1104,14 @@ int comdb2_check_parallel(Parse *pParse)
     }
 
     if (node->type == AST_TYPE_UNION) {
+        /* a sharded scan only pays off against a full table scan */
+        if (node->combine && plan_uses_index(pParse)) {
+            if (gbl_dohast_verbose)
+                logmsg(LOGMSG_USER, "%p Indexed plan, not sharding \"%s\"\n",
+                       (void *)pthread_self(), node->sql);
+            return 0;
+        }
+
         _save_params(pParse, node);
 
         if (gbl_dohast_verbose) {
@@ -1029,7 +1223,7 @@ static int _exprCallback(Walker *pWalker, Expr *pExpr)
         }
         return WRC_Abort;
     case TK_AGG_FUNCTION:
-        if (strcasecmp(pExpr->u.zToken, "count") == 0) {
+        if (scan_shard_combine(pExpr)) {
             return WRC_Continue;
         }
         /* fallthrough */
@@ -19,6 +19,7 @@
 #include "sql.h"
 #include "shard_range.h"
 #include "sqliteInt.h"
+#include "vdbeInt.h"
 #include "queue.h"
 #include "reqlog.h"
 #include "dohsql.h"
@@ -123,16 +124,25 @@ struct dohsql {
     int order_size;
     int *order_dir;
     int nparams;
+    /* sharded scan support */
+    int *combine;  /* per column merge, see enum dohsql_combine */
+    CollSeq **coll; /* per column min/max collation */
+    char *scan_tbl; /* the table whose data cursors are sharded */
+    int combined;  /* the merged row was returned */
     /* stats */
     dohsql_req_stats_t stats;
 };
 
+/* row_src of the row merged from all the shards of a sharded scan */
+#define COMBINED_ROW_SRC (-1)
+
 struct dohsql_stats {
     long long num_reqs;
     int max_distribution;
     int max_queue_len;
     int max_free_queue_len;
     long long max_queue_bytes;
+    long long num_scan_shards; /* engines run by sharded scans */
 };
 typedef struct dohsql_stats dohsql_stats_t;
 
@@ -518,7 +528,7 @@ static int dohsql_dist_sqlite_error(struct sqlclntstate *clnt,
     int errcode;
     int src = conns->row_src;
 
-    if (src == 0) {
+    if (src == 0 || src == COMBINED_ROW_SRC) {
         return sqlite_stmt_error(stmt, errstr);
     }
 
@@ -557,7 +567,13 @@ static int dohsql_dist_param_value(struct sqlclntstate *clnt,
 static void donate_current_row(dohsql_t *conns, int locked)
 {
     if (conns->row) {
-        if (conns->row_src) {
+        if (conns->row_src == COMBINED_ROW_SRC) {
+            /* coordinator owns the merged row */
+            sqlite3UnpackedResultFree(&conns->row->unpacked, conns->ncols);
+            free(conns->row);
+            conns->row = NULL;
+            conns->row_src = 0;
+        } else if (conns->row_src) {
             /* free what coordinator allocated before sending the row back */
             if (conns->row->unpacked) {
                 sqlite3UnpackedResultFree(&conns->row->unpacked, conns->ncols);
@@ -870,6 +886,105 @@ got_row:
     return SQLITE_ROW;
 }
 
+/* merge one shard's aggregate into the accumulator */
+static void combine_value(int op, CollSeq *pColl, Mem *acc, Mem *val)
+{
+    int type = sqlite3_value_type(val);
+    i64 sum;
+
+    switch (op) {
+    case DOHSQL_COMBINE_COUNT:
+        sqlite3VdbeMemSetInt64(acc, ((acc->flags & MEM_Int) ? acc->u.i : 0) +
+                                        sqlite3_value_int64(val));
+        break;
+    case DOHSQL_COMBINE_SUM:
+    case DOHSQL_COMBINE_TOTAL:
+        if (type == SQLITE_NULL)
+            break;
+        if (acc->flags & MEM_Null) {
+            sqlite3VdbeMemCopy(acc, val);
+            break;
+        }
+        /* integer sums stay integer; an overflow turns into a real sum */
+        if ((acc->flags & MEM_Int) && type == SQLITE_INTEGER &&
+            !__builtin_add_overflow(acc->u.i, sqlite3_value_int64(val), &sum)) {
+            acc->u.i = sum;
+            break;
+        }
+        sqlite3VdbeMemSetDouble(acc, sqlite3_value_double(acc) +
+                                         sqlite3_value_double(val));
+        break;
+    case DOHSQL_COMBINE_MIN:
+    case DOHSQL_COMBINE_MAX:
+        if (type == SQLITE_NULL)
+            break;
+        if (acc->flags & MEM_Null) {
+            sqlite3VdbeMemCopy(acc, val);
+            break;
+        }
+        int cmp = sqlite3MemCompare(acc, val, pColl);
+        if ((op == DOHSQL_COMBINE_MIN && cmp > 0) ||
+            (op == DOHSQL_COMBINE_MAX && cmp < 0))
+            sqlite3VdbeMemCopy(acc, val);
+        break;
+    }
+}
+
+/**
+ * Sharded aggregate scan: every shard returns one row of partial
+ * aggregates; drain them all and return a single merged row
+ *
+ */
+static int dohsql_dist_next_row_combined(struct sqlclntstate *clnt,
+                                         sqlite3_stmt *stmt)
+{
+    dohsql_t *conns = clnt->conns;
+    Mem *acc;
+    row_t *row;
+    int rc, i;
+
+    if (conns->combined) {
+        donate_current_row(conns, 0);
+        return SQLITE_DONE;
+    }
+
+    acc = sqlite3_malloc64(sizeof(Mem) * conns->ncols);
+    row = calloc(1, sizeof(row_t));
+    if (!acc || !row) {
+        sqlite3_free(acc);
+        free(row);
+        _signal_children_master_is_done(conns);
+        return SQLITE_NOMEM;
+    }
+    bzero(acc, sizeof(Mem) * conns->ncols);
+    for (i = 0; i < conns->ncols; i++) {
+        acc[i].flags = MEM_Null;
+        acc[i].enc = SQLITE_UTF8;
+    }
+
+    while ((rc = dohsql_dist_next_row(clnt, stmt)) == SQLITE_ROW) {
+        for (i = 0; i < conns->ncols; i++)
+            combine_value(conns->combine[i], conns->coll[i], &acc[i],
+                          dohsql_dist_column_value(clnt, stmt, i));
+    }
+    if (rc != SQLITE_DONE) {
+        sqlite3UnpackedResultFree(&acc, conns->ncols);
+        free(row);
+        return rc;
+    }
+
+    if (gbl_dohsql_verbose)
+        logmsg(LOGMSG_USER, "%p %s: merged %d shard rows\n",
+               (void *)pthread_self(), __func__, conns->nrows);
+
+    donate_current_row(conns, 0);
+    row->unpacked = acc;
+    conns->row = row;
+    conns->row_src = COMBINED_ROW_SRC;
+    conns->combined = 1;
+    return SQLITE_ROW;
+}
+
 static int dohsql_write_response(struct sqlclntstate *c, int t, void *a, int i)
 {
     if (gbl_plugin_api_debug)
@@ -1088,8 +1203,12 @@ static void _master_clnt_set(struct sqlclntstate *clnt)
     clnt->adapter_backup = clnt->adapter;
 
     clnt->plugin.column_count = dohsql_dist_column_count;
-    clnt->plugin.next_row = (clnt->conns->order) ? dohsql_dist_next_row_ordered
-                                                 : dohsql_dist_next_row;
+    if (clnt->conns->combine)
+        clnt->plugin.next_row = dohsql_dist_next_row_combined;
+    else if (clnt->conns->order)
+        clnt->plugin.next_row = dohsql_dist_next_row_ordered;
+    else
+        clnt->plugin.next_row = dohsql_dist_next_row;
     clnt->plugin.column_type = dohsql_dist_column_type;
     clnt->plugin.column_int64 = dohsql_dist_column_int64;
     clnt->plugin.column_double = dohsql_dist_column_double;
@@ -1200,6 +1319,18 @@ int dohsql_distribute(dohsql_node_t *node)
         }
         flags = THDPOOL_FORCE_DISPATCH;
     }
+    if (node->combine) {
+        /* each engine, coordinator included, scans its own stripes */
+        conns->combine = node->combine;
+        conns->coll = node->coll;
+        conns->scan_tbl = node->scan_tbl;
+        node->combine = NULL;
+        node->coll = NULL;
+        node->scan_tbl = NULL;
+        clnt->scan_shard = 0;
+        clnt->scan_nshards = conns->nconns;
+        clnt->scan_shard_tbl = conns->scan_tbl;
+    }
     /* there is a slack to allow non-coordinator tasks to drain;
      * it is still possible to fill the sql queue; force the 
      * worker shards on the queue in any case
@@ -1223,6 +1354,11 @@ int dohsql_distribute(dohsql_node_t *node)
         if ((rc = _shard_connect(clnt, &conns->conns[i], node->nodes[i]->sql,
                                  nparams, params)) != 0)
             return rc;
+        if (conns->combine) {
+            conns->conns[i].clnt->scan_shard = i;
+            conns->conns[i].clnt->scan_nshards = conns->nconns;
+            conns->conns[i].clnt->scan_shard_tbl = conns->scan_tbl;
+        }
 
         if (i > 0) {
             struct string_ref *sr = create_string_ref(node->nodes[i]->sql);
@@ -1244,6 +1380,8 @@ int dohsql_distribute(dohsql_node_t *node)
 
     if (gbl_dohsql_track_stats) {
         gbl_dohsql_stats_dirty.num_reqs++;
+        if (conns->combine)
+            gbl_dohsql_stats_dirty.num_scan_shards += conns->nconns;
         if (gbl_dohsql_stats_dirty.max_distribution < conns->nconns)
             gbl_dohsql_stats_dirty.max_distribution = conns->nconns;
 
@@ -1318,6 +1456,8 @@ int dohsql_end_distribute(struct sqlclntstate *clnt, struct reqlogger *logger)
     if (likely(gbl_dohsql_track_stats)) {
         Pthread_mutex_lock(&dohsql_stats_mtx);
         gbl_dohsql_stats.num_reqs++;
+        if (conns->combine)
+            gbl_dohsql_stats.num_scan_shards += conns->nconns;
         if (gbl_dohsql_stats.max_distribution < conns->nconns)
             gbl_dohsql_stats.max_distribution = conns->nconns;
         if (gbl_dohsql_stats.max_queue_len < conns->stats.max_queue_len)
@@ -1343,6 +1483,11 @@ int dohsql_end_distribute(struct sqlclntstate *clnt, struct reqlogger *logger)
         free(conns->order);
         free(conns->order_dir);
     }
+    free(conns->combine);
+    free(conns->coll);
+    free(conns->scan_tbl);
+    clnt->scan_shard = clnt->scan_nshards = 0;
+    clnt->scan_shard_tbl = NULL;
     clnt_plugin_reset(clnt);
     clnt->conns = NULL;
     free(conns);
@@ -1931,6 +2076,9 @@ void dohsql_stats(void)
 {
     logmsg(LOGMSG_USER, "Num requests: %lld [%lld]\n",
            gbl_dohsql_stats.num_reqs, gbl_dohsql_stats_dirty.num_reqs);
+    logmsg(LOGMSG_USER, "Sharded scan engines: %lld [%lld]\n",
+           gbl_dohsql_stats.num_scan_shards,
+           gbl_dohsql_stats_dirty.num_scan_shards);
     logmsg(LOGMSG_USER, "Max distribution: %d [%d]\n",
            gbl_dohsql_stats.max_distribution,
            gbl_dohsql_stats_dirty.max_distribution);
@@ -25,6 +25,15 @@ struct params_info {
     struct param_data *params;
 };
 
+/* how a sharded scan merges one aggregate column across shards */
+enum dohsql_combine {
+    DOHSQL_COMBINE_COUNT = 1,
+    DOHSQL_COMBINE_SUM = 2,
+    DOHSQL_COMBINE_TOTAL = 3,
+    DOHSQL_COMBINE_MIN = 4,
+    DOHSQL_COMBINE_MAX = 5
+};
+
 struct dohsql_node {
     enum ast_type type;
     char *sql;
@@ -36,6 +45,9 @@ struct dohsql_node {
     int nparams;
     int remotedb;
     struct params_info *params;
+    int *combine; /* sharded scan: per column enum dohsql_combine */
+    struct CollSeq **coll; /* sharded scan: per column min/max collation */
+    char *scan_tbl;        /* sharded scan: the table split across shards */
 };
 typedef struct dohsql_node dohsql_node_t;
 
@@ -83,6 +83,11 @@ int gbl_fdb_io_error_retries_phase_2_poll = 100;
 int gbl_fdb_auth_enabled = 1;
 int gbl_fdb_remsql_cdb2api = 1;
 int gbl_fdb_emulate_old = 0;
+int gbl_fdb_remsql_hndl_cache = 8;
+int gbl_fdb_remsql_projection = 1;
+
+/* rows we are willing to drain from a closing cursor to cache its handle */
+#define FDB_HNDL_DRAIN_ROWS 16
 
 struct fdb_tbl;
 struct fdb;
@@ -166,6 +171,10 @@ struct fdb {
 
     int server_version; /* save the server_version */
     ssl_mode ssl; /* does this server needs ssl */
+
+    cdb2_hndl_tp **hndls; /* idle cdb2api cursor handles, reused on open */
+    int nhndls;
+    pthread_mutex_t hndls_mtx;
 };
 
 /* cache of foreign dbs */
@@ -224,6 +233,8 @@ struct fdb_cursor {
     uuid_t tiduuid; /* UUID/fastseed storage for transaction, if any, or 0 */
     char *node;     /* connected to where? */
     int need_ssl;   /* uses ssl */
+    fdb_t *hndl_fdb; /* if set, cache the cdb2api handle here on close */
+    int hndl_reused; /* cdb2api handle came from the fdb handle cache */
 };
 
 typedef struct fdb_systable_info {
@@ -439,6 +450,10 @@ void __free_fdb(fdb_t *fdb)
     Pthread_mutex_destroy(&fdb->sqlstats_mtx);
     Pthread_mutex_destroy(&fdb->dbcon_mtx);
     Pthread_mutex_destroy(&fdb->users_mtx);
+    for (int i = 0; i < fdb->nhndls; i++)
+        cdb2_close(fdb->hndls[i]);
+    free(fdb->hndls);
+    Pthread_mutex_destroy(&fdb->hndls_mtx);
     free(fdb);
 }
 
@@ -518,6 +533,7 @@ static void init_fdb(fdb_t * fdb, const char * dbname, enum mach_class class, in
     Pthread_mutex_init(&fdb->sqlstats_mtx, NULL);
     Pthread_mutex_init(&fdb->dbcon_mtx, NULL);
     Pthread_mutex_init(&(fdb->users_mtx), NULL);
+    Pthread_mutex_init(&fdb->hndls_mtx, NULL);
 }
 
 /**
@@ -2516,13 +2532,56 @@ cdb2_hndl_tp* fdb_connect(const char *dbname, enum mach_class inclass, int local
     return hndl;
 }
 
+/**
+ * Get an idle cdb2api handle for this foreign db, if one is cached
+ *
+ */
+static cdb2_hndl_tp *_fdb_hndl_get(fdb_t *fdb)
+{
+    cdb2_hndl_tp *hndl = NULL;
+
+    Pthread_mutex_lock(&fdb->hndls_mtx);
+    if (fdb->nhndls > 0)
+        hndl = fdb->hndls[--fdb->nhndls];
+    Pthread_mutex_unlock(&fdb->hndls_mtx);
+
+    return hndl;
+}
+
+/**
+ * Cache an idle cdb2api handle for reuse by the next cursor to this foreign
+ * db; returns 0 if cached, the caller closes it otherwise
+ *
+ */
+static int _fdb_hndl_put(fdb_t *fdb, cdb2_hndl_tp *hndl)
+{
+    int rc = -1;
+
+    /* the identity blob belongs to the client we were running for */
+    cdb2_setIdentityBlob(hndl, NULL);
+
+    Pthread_mutex_lock(&fdb->hndls_mtx);
+    if (fdb->nhndls < gbl_fdb_remsql_hndl_cache) {
+        cdb2_hndl_tp **hndls =
+            realloc(fdb->hndls, (fdb->nhndls + 1) * sizeof(cdb2_hndl_tp *));
+        if (hndls) {
+            fdb->hndls = hndls;
+            fdb->hndls[fdb->nhndls++] = hndl;
+            rc = 0;
+        }
+    }
+    Pthread_mutex_unlock(&fdb->hndls_mtx);
+
+    return rc;
+}
+
 static fdb_cursor_if_t *_cursor_open_remote_cdb2api(sqlclntstate *clnt,
                                                     fdb_t *fdb, int server_version,
                                                     int flags, int version,
                                                     int rootpage, int use_ssl)
 {
     fdb_cursor_if_t *fdbc_if;
-    fdb_cursor_t *fdbc;
+    fdb_cursor_t *fdbc = NULL;
     const char *class;
     int rc;
 
@@ -2553,10 +2612,20 @@ static fdb_cursor_if_t *_cursor_open_remote_cdb2api(sqlclntstate *clnt,
     _cursor_set_common(fdbc_if, NULL, flags, use_ssl);
 
 
-    fdbc->fcon.api.hndl = fdb_connect(fdb->dbname, fdb->class, fdb->local, &class,
-                                      CDB2_SQL_ROWS);
-    if (!fdbc->fcon.api.hndl)
-        goto error;
+    /* sqlite_master cursors carry REMSQL_SCHEMA, don't share those */
+    if (rootpage != 1) {
+        fdbc->hndl_fdb = fdb;
+        fdbc->fcon.api.hndl = _fdb_hndl_get(fdb);
+    }
+    if (fdbc->fcon.api.hndl) {
+        fdbc->hndl_reused = 1;
+        class = fdb->local ? "local" : mach_class_class2name(fdb->class);
+    } else {
+        fdbc->fcon.api.hndl = fdb_connect(fdb->dbname, fdb->class, fdb->local,
+                                          &class, CDB2_SQL_ROWS);
+        if (!fdbc->fcon.api.hndl)
+            goto error;
+    }
 
     /* SET parameters for remsql */
     /* NOTE: a remote server that does not support yet cdb2api protocol
@@ -2585,6 +2654,8 @@ done:
     return fdbc_if;
 
 error:
+    if (fdbc && fdbc->fcon.api.hndl)
+        cdb2_close(fdbc->fcon.api.hndl);
     free(fdbc_if);
     fdbc_if = NULL;
     goto done;
@@ -2874,7 +2945,27 @@ static void fdb_cursor_close_on_open(BtCursor *pCur, int cache)
             }
             fdb_msg_clean_message(fdbc->msg);
         } else {
-            cdb2_close(fdbc->fcon.api.hndl);
+            cdb2_hndl_tp *hndl = fdbc->fcon.api.hndl;
+            int i;
+
+            if (!cache || gbl_fdb_remsql_hndl_cache <= 0)
+                fdbc->hndl_fdb = NULL;
+
+            /* finish short leftover streams (i.e. index lookups) so the
+             * handle can be reused by the next cursor to this db */
+            for (i = 0; fdbc->hndl_fdb &&
+                        fdbc->streaming == FDB_CUR_STREAMING &&
+                        i < FDB_HNDL_DRAIN_ROWS; i++) {
+                int irc = cdb2_next_record(hndl);
+                if (irc == CDB2_OK_DONE)
+                    fdbc->streaming = FDB_CUR_IDLE;
+                else if (irc != CDB2_OK)
+                    fdbc->streaming = FDB_CUR_ERROR;
+            }
+            if (!fdbc->hndl_fdb || fdbc->streaming != FDB_CUR_IDLE ||
+                _fdb_hndl_put(fdbc->hndl_fdb, hndl)) {
+                cdb2_close(hndl);
+            }
         }
 
         free(pCur->fdbc);
@@ -2945,6 +3036,16 @@ static char *_build_run_sql_from_hint(BtCursor *pCur, Mem *m, int ncols,
             using_col_filter = 1;
         } else {
             tableName = fdbc->ent->name;
+
+            /* only ship the columns the statement reads */
+            if (gbl_fdb_remsql_projection &&
+                !(pCur->open_flags & BTREE_WRCSR)) {
+                columnsDesc = sqlite3DescribeTableColumns(
+                    sqlitedb, tableName, fdbc->ent->tbl->fdb->dbname,
+                    pCur->col_mask);
+                if (columnsDesc)
+                    using_col_filter = 1;
+            }
         }
     }
 
@@ -5741,23 +5842,39 @@ static int _fdb_cdb2api_send_set(fdb_cursor_t *fdbc)
         } \
     } while (0);
 
+/* the timezone a new cdb2api handle sends when the client has not set one */
+static const char *_fdb_default_tzname(void)
+{
+    const char *tz = getenv("COMDB2TZ");
+    if (!tz)
+        tz = getenv("TZ");
+    if (!tz)
+        tz = "America/New_York";
+    return tz;
+}
+
 static int _fdb_client_set_options(sqlclntstate *clnt,
-                                   cdb2_hndl_tp *hndl)
+                                   cdb2_hndl_tp *hndl, int reused)
 {
     char str[256];
     int rc = 0;
 
-    /* we only pass a subset of SET options */
-    if (clnt->query_timeout) {
+    /* we only pass a subset of SET options; a reused handle may carry
+     * a previous client's settings, so those are always reset */
+    if (clnt->query_timeout || reused) {
         SET_INT("MAXQUERYTIME", clnt->query_timeout);
     }
     if (clnt->tzname[0]) {
         SET_STR("TIMEZONE", clnt->tzname);
+    } else if (reused) {
+        SET_STR("TIMEZONE", _fdb_default_tzname());
     }
     char *dtprec = clnt->dtprec == DTTZ_PREC_MSEC ? "M" : "U";
     SET_STR("DATETIME PRECISION", dtprec);
     if (clnt->prepare_only) {
         SET_STR("PREPARE_ONLY", "ON");
+    } else if (reused) {
+        SET_STR("PREPARE_ONLY", "OFF");
     }
     fdb_client_set_identityBlob(clnt, hndl);
 
@@ -5788,11 +5905,13 @@ static int _fdb_run_sql(BtCursor *pCur, char *sql)
         return rc;
 
     /* client set options */
-    rc = _fdb_client_set_options(pCur->clnt, hndl);
+    rc = _fdb_client_set_options(pCur->clnt, hndl, fdbc->hndl_reused);
 
     /* NOTE: we can extract column type here and use typed call */
     rc = cdb2_run_statement(hndl, sql);
-    if (rc) {
+    if (!rc) {
+        fdbc->streaming = FDB_CUR_STREAMING;
+    } else {
         errstr = cdb2_errstr(hndl);
         if (rc == CDB2ERR_PREPARE_ERROR) {
             /* NOTE: we need to check here for pre-cdb2api
@@ -5930,7 +6049,10 @@ version_retry:
         if (rc == CDB2_OK) {
             rc = IX_FNDMORE;
         } else if (rc == CDB2_OK_DONE) {
+            fdbc->streaming = FDB_CUR_IDLE;
             rc = IX_EMPTY;
+        } else {
+            fdbc->streaming = FDB_CUR_ERROR;
         }
     }
 
@@ -5989,7 +6111,10 @@ version_retry:
         if (rc == CDB2_OK) {
             rc = IX_FNDMORE;
         } else if (rc == CDB2_OK_DONE) {
+            fdbc->streaming = FDB_CUR_IDLE;
             rc = IX_EMPTY;
+        } else {
+            fdbc->streaming = FDB_CUR_ERROR;
         }
     }
 
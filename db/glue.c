@@ -4141,6 +4141,10 @@ int backend_open_tran(struct dbenv *dbenv, tran_type *tran, uint32_t flags)
         }
 
         set_bdb_queue_option_flags(queue, queue->odh, compress, persist);
+
+        int shards;
+        get_db_queue_shards_tran(queue, &shards, tran);
+        bdb_set_queue_shards(queue->handle, shards);
     }
 
     for (ii = 0; ii < dbenv->num_dbs; ii++) {
@@ -4674,6 +4678,9 @@ get_put_db(queue_persistent_seq, META_QUEUE_PERSISTENT_SEQ)
 // put_db_queue_sequence
 get_put_db_ll(queue_sequence, META_QUEUE_SEQ)
 
+// get_db_queue_shards, get_db_queue_shards_tran, put_db_queue_shards
+get_put_db(queue_shards, META_QUEUE_SHARDS)
+
 static int put_meta_int(const char *table, void *tran, int rrn, int key,
                         int value)
 {
@@ -5494,6 +5501,75 @@ done:
     return rc;
 }
 
+/* Batched dbq_get(): up to maxitems items after prevcursor, read in a single
+ * cursor pass under one table lock.  Returns 0 with *nfound > 0, or the same
+ * error codes as dbq_get(). */
+int dbq_get_batch(struct ireq *iq, int consumer, const struct bdb_queue_cursor *prevcursor, int maxitems,
+                  size_t maxbytes, struct bdb_queue_found **fnddta, struct bdb_queue_cursor *fndcursor,
+                  long long *seq, int *nfound, uint32_t lockid)
+{
+    int bdberr;
+    uint32_t savedlid;
+    void *bdb_handle;
+    int retries = 0;
+    int rc;
+
+    *nfound = 0;
+    bdb_handle = get_bdb_handle_ireq(iq, AUXDB_NONE);
+    if (!bdb_handle)
+        return ERR_NO_AUXDB;
+
+    tran_type *tran = NULL;
+retry:
+    rc = trans_start(iq, NULL, (void *)&tran);
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "%s: trans_start rc %d\n", __func__, rc);
+        goto done;
+    }
+
+    /* As in dbq_get(), the queue lock goes with the curtran */
+    if (lockid) {
+        bdb_get_tran_lockerid(tran, &savedlid);
+        bdb_set_tran_lockerid(tran, lockid);
+    }
+
+    iq->gluewhere = "bdb_queue_get_batch";
+    rc = bdb_queue_get_batch(bdb_handle, tran, consumer, prevcursor, maxitems, maxbytes, fnddta, fndcursor, seq,
+                             nfound, &bdberr);
+    iq->gluewhere = "bdb_queue_get_batch done";
+    if (rc != 0) {
+        if (bdberr == BDBERR_DEADLOCK) {
+            iq->retries++;
+            if (++retries < gbl_maxretries && !lockid) {
+                n_retries++;
+                poll(0, 0, (rand() % 500 + 10));
+                bdb_tran_abort(bdb_handle, tran, &bdberr);
+                goto retry;
+            }
+            if (!lockid) {
+                logmsg(LOGMSG_ERROR, "*ERROR* bdb_queue_get_batch too much contention %d count %d\n", bdberr,
+                       retries);
+            }
+            rc = lockid ? IX_NOTFND : ERR_INTERNAL;
+        } else if (bdberr == BDBERR_FETCH_DTA || bdberr == BDBERR_LOCK_DESIRED) {
+            rc = IX_NOTFND;
+        } else {
+            rc = map_unhandled_bdb_rcode("bdb_queue_get_batch", bdberr, 0);
+        }
+    }
+done:
+    if (tran) {
+        if (lockid) {
+            bdb_set_tran_lockerid(tran, savedlid);
+        }
+        if (bdb_tran_abort(bdb_handle, tran, &bdberr)) {
+            logmsg(LOGMSG_FATAL, "%s:%d failed to abort transaction: %d\n", __FILE__, __LINE__, bdberr);
+            exit(1);
+        }
+    }
+    return rc;
+}
+
 unsigned long long dbq_item_genid(const struct bdb_queue_found *dta)
 {
     return bdb_queue_item_genid(dta);
@@ -23,6 +23,8 @@
 #include "sqloffload.h"
 #include "eventlog.h"
 #include "tohex.h"
+#include "thdpool.h"
+#include "sql.h"
 
 
 extern int gbl_partial_indexes;
@@ -439,7 +441,17 @@ int add_record_indices(struct ireq *iq, void *trans, blob_buffer_t *blobs,
         if (iq->osql_step_ix)
             gbl_osqlpf_step[*(iq->osql_step_ix)].step += 2;
 
-        if (reorder) {
+        if (iq->bulk_ix && iq->bulk_ix[ixnum]) {
+            int bdberr = 0;
+            rc = bdb_bulk_ix_add(iq->bulk_ix[ixnum], key, *genid, od_dta_tail,
+                                 od_tail_len, ix_isnullk(iq->usedb, key, ixnum),
+                                 &bdberr);
+            if (rc) {
+                *ixfailnum = ixnum;
+                rc = ERR_INTERNAL;
+                ERR(rc, "bdb_bulk_ix_add", 0);
+            }
+        } else if (reorder) {
             // if not datacopy, no need to save od_dta_tail
             void *data = NULL;
             int datalen = 0;
@@ -1329,6 +1341,409 @@ int insert_defered_tbl(struct ireq *iq, void *od_dta, size_t od_len,
 }
 #endif
 
+/* Apply one op of the defered table; errors are reported by the caller
+ * through defered_op_error() */
+static int apply_defered_op(struct ireq *iq, void *trans, dtikey_t *ditk,
+                            void *od_dta_tail, int od_tail_len)
+{
+    int rc;
+
+    if (ditk->type == DIT_ADD) {
+        int addrrn = 2;
+        /* add the key */
+        rc = ix_addk(iq, trans, ditk->ixkey, ditk->ixnum, ditk->genid, addrrn,
+                     od_dta_tail, od_tail_len,
+                     ix_isnullk(iq->usedb, ditk->ixkey, ditk->ixnum));
+
+        if (iq->debug) {
+            reqprintf(iq, "ADDKYCNSTRT  TBL %s IX %d RRN %d KEY ",
+                      ditk->usedb->tablename, ditk->ixnum, addrrn);
+            int ixkeylen = getkeysize(ditk->usedb, ditk->ixnum);
+            reqdumphex(iq, ditk->ixkey, ixkeylen);
+            reqmoref(iq, " RC %d", rc);
+        }
+    } else if (ditk->type == DIT_DEL) {
+        int delrrn = 0;
+#ifndef NDEBUG
+        char *tblname = iq->usedb->tablename;
+        struct dbtable *tbl = get_dbtable_by_name(tblname);
+        assert(tbl == iq->usedb);
+#endif
+        rc = ix_delk(iq, trans, ditk->ixkey, ditk->ixnum, delrrn, ditk->genid,
+                     ix_isnullk(iq->usedb, ditk->ixkey, ditk->ixnum));
+        if (iq->debug) {
+            reqprintf(iq, "ix_delk IX %d KEY ", ditk->ixnum);
+            reqdumphex(iq, ditk->ixkey, getkeysize(ditk->usedb, ditk->ixnum));
+            reqmoref(iq, " RC %d", rc);
+        }
+    } else if (ditk->type == DIT_UPD) {
+        rc = ix_upd_key(
+            iq, trans, ditk->ixkey, ditk->usedb->ix_keylen[ditk->ixnum],
+            ditk->ixnum, ditk->genid, ditk->newgenid, od_dta_tail, od_tail_len,
+            ix_isnullk(ditk->usedb, ditk->ixkey, ditk->ixnum));
+        if (iq->debug) {
+            reqprintf(iq, "upd_key IX %d (%s) GENID 0x%016llx ", ditk->ixnum,
+                      iq->usedb->ixschema[ditk->ixnum]->csctag,
+                      ditk->newgenid);
+            reqdumphex(iq, ditk->ixkey, ditk->usedb->ix_keylen[ditk->ixnum]);
+            reqmoref(iq, " RC %d", rc);
+        }
+    } else {
+        abort();
+    }
+
+    return rc;
+}
+
+static int defered_op_error(struct ireq *iq, dtikey_t *ditk, int rc,
+                            int *ixout, int *errout)
+{
+    *ixout = ditk->ixnum;
+
+    if (ditk->type == DIT_ADD) {
+        if (rc == IX_DUP) {
+            reqerrstr(iq, COMDB2_CSTRT_RC_DUP,
+                      "add key constraint "
+                      "duplicate key '%s' on "
+                      "table '%s' index %d",
+                      get_keynm_from_db_idx(ditk->usedb, ditk->ixnum),
+                      ditk->usedb->tablename, ditk->ixnum);
+
+            //*blkpos = curop->blkpos;
+
+            *errout = OP_FAILED_UNIQ;
+            return rc;
+        }
+        reqerrstr(iq, COMDB2_CSTRT_RC_INTL_ERR,
+                  "add key berkley error for key '%s' on index %d",
+                  get_keynm_from_db_idx(ditk->usedb, ditk->ixnum),
+                  ditk->ixnum);
+
+        //*blkpos = curop->blkpos;
+
+        *errout = OP_FAILED_INTERNAL;
+
+        if (ERR_INTERNAL == rc) {
+            /* Exit & have the cluster elect another master */
+            if (gbl_exit_on_internal_error) {
+                exit(1);
+            }
+
+            rc = ERR_NOMASTER;
+        }
+    } else if (ditk->type == DIT_DEL) {
+        if (rc == IX_NOTFND) {
+            reqerrstrhdr(iq, "Table '%s' ", ditk->usedb->tablename);
+            reqerrstr(iq, COMDB2_DEL_RC_INVL_KEY, "key not found on index %d",
+                      ditk->ixnum);
+        }
+        *errout = OP_FAILED_INTERNAL + ERR_DEL_KEY;
+    } else {
+        *errout = OP_FAILED_INTERNAL + ERR_DEL_KEY;
+    }
+    return rc;
+}
+
+/* Parallel apply of the defered table.
+ *
+ * The table is sorted by (table, index, key), so it splits into runs that
+ * each touch a single index btree.  Big enough transactions hand every run
+ * to a worker, each in its own child transaction of the block processor
+ * transaction.  Children are begun and committed by this thread in table
+ * and index order, so the outcome and the lock hand-off to the parent are
+ * the same on every attempt; siblings never write the same btree.
+ */
+int gbl_bplog_apply_threads = 0;
+int gbl_bplog_apply_parallel_min = 1000;
+
+struct defered_op {
+    dit_t type;
+    short ixlen;
+    int od_tail_len;
+    unsigned long long genid;
+    unsigned long long newgenid;
+    char data[1]; /* ixlen bytes of key followed by the tail */
+};
+
+struct defered_apply {
+    pthread_mutex_t lk;
+    pthread_cond_t cd;
+    int pending;
+    struct ireq *iq;
+};
+
+struct defered_run {
+    struct defered_apply *apply;
+    struct dbtable *usedb;
+    short ixnum;
+    int nops;
+    struct defered_op **ops;
+    tran_type *trans;
+    int rc;
+    int failed; /* index of the op that failed */
+};
+
+static struct thdpool *defered_apply_pool;
+static pthread_once_t defered_apply_once = PTHREAD_ONCE_INIT;
+
+static void defered_apply_thd_start(struct thdpool *pool, void *thddata)
+{
+    backend_thread_event(thedb, COMDB2_THR_EVENT_START_RDWR);
+}
+
+static void defered_apply_thd_end(struct thdpool *pool, void *thddata)
+{
+    backend_thread_event(thedb, COMDB2_THR_EVENT_DONE_RDWR);
+}
+
+static void defered_apply_pool_init(void)
+{
+    defered_apply_pool = thdpool_create("bplogapplypool", 0);
+    if (!gbl_exit_on_pthread_create_fail)
+        thdpool_unset_exit(defered_apply_pool);
+    thdpool_set_init_fn(defered_apply_pool, defered_apply_thd_start);
+    thdpool_set_delt_fn(defered_apply_pool, defered_apply_thd_end);
+    thdpool_set_minthds(defered_apply_pool, 0);
+    thdpool_set_linger(defered_apply_pool, 10);
+    thdpool_set_maxqueue(defered_apply_pool, 10000);
+}
+
+static void defered_op_to_key(struct defered_run *run, struct defered_op *op,
+                              dtikey_t *ditk)
+{
+    ditk->usedb = run->usedb;
+    ditk->ixnum = run->ixnum;
+    ditk->ixlen = op->ixlen;
+    memcpy(ditk->ixkey, op->data, op->ixlen);
+    memset(ditk->ixkey + op->ixlen, 0, sizeof(ditk->ixkey) - op->ixlen);
+    ditk->type = op->type;
+    ditk->genid = op->genid;
+    ditk->newgenid = op->newgenid;
+}
+
+static void defered_run_apply(struct defered_run *run)
+{
+    struct ireq wiq = *run->apply->iq;
+    dtikey_t ditk;
+
+    /* private request: tracing and errstr stay with the block processor */
+    wiq.debug = 0;
+    wiq.usedb = run->usedb;
+
+    for (int i = 0; i < run->nops; i++) {
+        struct defered_op *op = run->ops[i];
+        defered_op_to_key(run, op, &ditk);
+        run->rc = apply_defered_op(&wiq, run->trans, &ditk,
+                                   op->od_tail_len ? op->data + op->ixlen : NULL,
+                                   op->od_tail_len);
+        if (run->rc) {
+            run->failed = i;
+            break;
+        }
+    }
+}
+
+static void defered_run_done(struct defered_run *run)
+{
+    struct defered_apply *apply = run->apply;
+    Pthread_mutex_lock(&apply->lk);
+    if (--apply->pending == 0)
+        Pthread_cond_signal(&apply->cd);
+    Pthread_mutex_unlock(&apply->lk);
+}
+
+static void defered_run_pp(struct thdpool *pool, void *work, void *thddata,
+                           int op)
+{
+    struct defered_run *run = work;
+    switch (op) {
+    case THD_RUN:
+        defered_run_apply(run);
+        break;
+    case THD_FREE:
+        run->rc = ERR_INTERNAL;
+        break;
+    }
+    defered_run_done(run);
+}
+
+static void free_defered_runs(struct defered_run *runs, int nruns)
+{
+    for (int i = 0; i < nruns; i++) {
+        for (int j = 0; j < runs[i].nops; j++)
+            free(runs[i].ops[j]);
+        free(runs[i].ops);
+    }
+    free(runs);
+}
+
+/* Returns 1 and sets *rcout if the table was applied in parallel; 0 if the
+ * caller should go the serial way, with the cursor back on the first row */
+static int process_defered_table_parallel(struct ireq *iq, void *trans,
+                                          void *cur, int *ixout, int *errout,
+                                          int *rcout)
+{
+    struct defered_apply apply = {.iq = iq};
+    struct defered_run *runs = NULL;
+    int nruns = 0, nops = 0;
+    int err, rc;
+
+    if (gbl_bplog_apply_threads <= 0 || gbl_rowlocks ||
+        is_rowlocks_transaction(trans))
+        return 0;
+
+    /* first pass: count runs and ops to see if it is worth it */
+    struct dbtable *lastdb = NULL;
+    int lastix = -1;
+    for (rc = IX_OK; rc == IX_OK;
+         rc = bdb_temp_table_next(thedb->bdb_env, cur, &err)) {
+        dtikey_t *ditk = (dtikey_t *)bdb_temp_table_key(cur);
+        if (ditk->usedb != lastdb || ditk->ixnum != lastix) {
+            lastdb = ditk->usedb;
+            lastix = ditk->ixnum;
+            nruns++;
+        }
+        nops++;
+    }
+
+    if (rc != IX_PASTEOF || nruns < 2 || nops < gbl_bplog_apply_parallel_min)
+        goto serial;
+
+    runs = calloc(nruns, sizeof(struct defered_run));
+    if (!runs)
+        goto serial;
+
+    if (bdb_temp_table_first(thedb->bdb_env, cur, &err) != IX_OK) {
+        free(runs);
+        goto serial;
+    }
+
+    /* second pass: copy each run out of the temp table */
+    int irun = -1, cap = 0;
+    for (rc = IX_OK; rc == IX_OK;
+         rc = bdb_temp_table_next(thedb->bdb_env, cur, &err)) {
+        dtikey_t *ditk = (dtikey_t *)bdb_temp_table_key(cur);
+        int od_tail_len = bdb_temp_table_datasize(cur);
+        struct defered_run *run;
+
+        if (irun < 0 || ditk->usedb != runs[irun].usedb ||
+            ditk->ixnum != runs[irun].ixnum) {
+            run = &runs[++irun];
+            run->apply = &apply;
+            run->usedb = ditk->usedb;
+            run->ixnum = ditk->ixnum;
+            cap = 0;
+        }
+        run = &runs[irun];
+
+        if (run->nops == cap) {
+            cap = cap ? cap * 2 : 64;
+            struct defered_op **ops = realloc(run->ops, cap * sizeof(*ops));
+            if (!ops)
+                goto oom;
+            run->ops = ops;
+        }
+
+        struct defered_op *op =
+            malloc(offsetof(struct defered_op, data) + ditk->ixlen + od_tail_len);
+        if (!op)
+            goto oom;
+        op->type = ditk->type;
+        op->ixlen = ditk->ixlen;
+        op->od_tail_len = od_tail_len;
+        op->genid = ditk->genid;
+        op->newgenid = ditk->newgenid;
+        memcpy(op->data, ditk->ixkey, ditk->ixlen);
+        if (od_tail_len)
+            memcpy(op->data + ditk->ixlen, bdb_temp_table_data(cur),
+                   od_tail_len);
+        run->ops[run->nops++] = op;
+    }
+    if (rc != IX_PASTEOF) {
+        free_defered_runs(runs, nruns);
+        reqerrstr(iq, COMDB2_CSTRT_RC_INVL_REC, "cannot get add list record");
+        *errout = OP_FAILED_INTERNAL;
+        *rcout = rc;
+        return 1;
+    }
+
+    unsigned long long start = osql_log_time();
+
+    /* children are begun here, in order; BDB_READLOCK stays with us */
+    int nbegun;
+    for (nbegun = 0; nbegun < nruns; nbegun++) {
+        rc = trans_start_nonlogical(iq, trans, &runs[nbegun].trans);
+        if (rc) {
+            *errout = OP_FAILED_INTERNAL;
+            break;
+        }
+    }
+
+    if (rc == 0) {
+        Pthread_mutex_init(&apply.lk, NULL);
+        Pthread_cond_init(&apply.cd, NULL);
+        pthread_once(&defered_apply_once, defered_apply_pool_init);
+        thdpool_set_maxthds(defered_apply_pool, gbl_bplog_apply_threads);
+
+        apply.pending = nruns;
+        for (int i = 0; i < nruns; i++) {
+            if (thdpool_enqueue(defered_apply_pool, defered_run_pp, &runs[i], 0,
+                                NULL, THDPOOL_FORCE_QUEUE) != 0) {
+                /* no room, do it ourselves */
+                defered_run_apply(&runs[i]);
+                defered_run_done(&runs[i]);
+            }
+        }
+
+        Pthread_mutex_lock(&apply.lk);
+        while (apply.pending > 0)
+            Pthread_cond_wait(&apply.cd, &apply.lk);
+        Pthread_mutex_unlock(&apply.lk);
+        Pthread_cond_destroy(&apply.cd);
+        Pthread_mutex_destroy(&apply.lk);
+
+        /* report the first failure in table and index order, as the serial
+         * apply would have */
+        for (int i = 0; i < nruns; i++) {
+            if (runs[i].rc) {
+                dtikey_t ditk;
+                defered_op_to_key(&runs[i], runs[i].ops[runs[i].failed], &ditk);
+                iq->usedb = ditk.usedb;
+                rc = defered_op_error(iq, &ditk, runs[i].rc, ixout, errout);
+                break;
+            }
+        }
+    }
+
+    if (rc == 0) {
+        for (int i = 0; i < nruns; i++) {
+            int irc = trans_commit(iq, runs[i].trans, gbl_myhostname);
+            if (irc != 0) { /* this shouldnt happen */
+                logmsg(LOGMSG_FATAL, "%s:%d TRANS_COMMIT FAILED RC %d",
+                       __func__, __LINE__, irc);
+                comdb2_die(0);
+            }
+        }
+        iq->usedb = runs[nruns - 1].usedb;
+    } else {
+        for (int i = nbegun - 1; i >= 0; i--)
+            trans_abort(iq, runs[i].trans);
+    }
+
+    iq->timings.idx_applied = osql_log_time() - start;
+    iq->timings.idx_children = nruns;
+
+    free_defered_runs(runs, nruns);
+    *rcout = rc;
+    return 1;
+
+oom:
+    free_defered_runs(runs, nruns);
+    logmsg(LOGMSG_ERROR, "%s: out of memory copying %d ops\n", __func__, nops);
+serial:
+    return bdb_temp_table_first(thedb->bdb_env, cur, &err) == IX_OK ? 0 : -1;
+}
+
 int process_defered_table(struct ireq *iq, void *trans, int *blkpos, int *ixout,
                           int *errout)
 {
@@ -1362,6 +1777,22 @@ int process_defered_table(struct ireq *iq, void *trans, int *blkpos, int *ixout,
         goto done;
     }
 
+    iq->timings.idx_applied = 0;
+    iq->timings.idx_children = 0;
+
+    int parallel = process_defered_table_parallel(iq, trans, cur, ixout,
+                                                  errout, &rc);
+    if (parallel) {
+        if (parallel < 0) {
+            reqerrstr(iq, COMDB2_CSTRT_RC_INVL_REC, "cannot get add list record");
+            *errout = OP_FAILED_INTERNAL;
+            rc = ERR_INTERNAL;
+        }
+        goto done;
+    }
+
+    unsigned long long start = osql_log_time();
+
     while (rc == IX_OK) {
         dtikey_t *ditk = (dtikey_t *)bdb_temp_table_key(cur);
         void *od_dta_tail = bdb_temp_table_data(cur);
@@ -1369,101 +1800,10 @@ int process_defered_table(struct ireq *iq, void *trans, int *blkpos, int *ixout,
 
         iq->usedb = ditk->usedb;
 
-        if (ditk->type == DIT_ADD) {
-            int addrrn = 2;
-            /* add the key */
-            rc = ix_addk(iq, trans, ditk->ixkey, ditk->ixnum, ditk->genid,
-                         addrrn, od_dta_tail, od_tail_len,
-                         ix_isnullk(iq->usedb, ditk->ixkey, ditk->ixnum));
-
-            if (iq->debug) {
-                reqprintf(iq, "ADDKYCNSTRT  TBL %s IX %d RRN %d KEY ",
-                          ditk->usedb->tablename, ditk->ixnum, addrrn);
-                int ixkeylen = getkeysize(ditk->usedb, ditk->ixnum);
-                reqdumphex(iq, ditk->ixkey, ixkeylen);
-                reqmoref(iq, " RC %d", rc);
-            }
-
-            if (rc == IX_DUP) {
-                reqerrstr(iq, COMDB2_CSTRT_RC_DUP,
-                          "add key constraint "
-                          "duplicate key '%s' on "
-                          "table '%s' index %d",
-                          get_keynm_from_db_idx(ditk->usedb, ditk->ixnum),
-                          ditk->usedb->tablename, ditk->ixnum);
-
-                //*blkpos = curop->blkpos;
-
-                *errout = OP_FAILED_UNIQ;
-                *ixout = ditk->ixnum;
-                goto done;
-            } else if (rc != 0) {
-                reqerrstr(iq, COMDB2_CSTRT_RC_INTL_ERR,
-                          "add key berkley error for key '%s' on index %d",
-                          get_keynm_from_db_idx(ditk->usedb, ditk->ixnum),
-                          ditk->ixnum);
-
-                //*blkpos = curop->blkpos;
-
-                *errout = OP_FAILED_INTERNAL;
-                *ixout = ditk->ixnum;
-
-                if (ERR_INTERNAL == rc) {
-                    /* Exit & have the cluster elect another master */
-                    if (gbl_exit_on_internal_error) {
-                        exit(1);
-                    }
-
-                    rc = ERR_NOMASTER;
-                }
-                goto done;
-            }
-        } else if (ditk->type == DIT_DEL) {
-            int delrrn = 0;
-#ifndef NDEBUG
-            char *tblname = iq->usedb->tablename;
-            struct dbtable *tbl = get_dbtable_by_name(tblname);
-            assert(tbl == iq->usedb);
-#endif
-            rc = ix_delk(iq, trans, ditk->ixkey, ditk->ixnum, delrrn,
-                         ditk->genid,
-                         ix_isnullk(iq->usedb, ditk->ixkey, ditk->ixnum));
-            if (iq->debug) {
-                reqprintf(iq, "ix_delk IX %d KEY ", ditk->ixnum);
-                reqdumphex(iq, ditk->ixkey,
-                           getkeysize(ditk->usedb, ditk->ixnum));
-                reqmoref(iq, " RC %d", rc);
-            }
-            if (rc != 0) {
-                if (rc == IX_NOTFND) {
-                    reqerrstrhdr(iq, "Table '%s' ", ditk->usedb->tablename);
-                    reqerrstr(iq, COMDB2_DEL_RC_INVL_KEY,
-                              "key not found on index %d", ditk->ixnum);
-                }
-                *errout = OP_FAILED_INTERNAL + ERR_DEL_KEY;
-                *ixout = ditk->ixnum;
-                goto done;
-            }
-
-        } else if (ditk->type == DIT_UPD) {
-            rc = ix_upd_key(
-                iq, trans, ditk->ixkey, ditk->usedb->ix_keylen[ditk->ixnum],
-                ditk->ixnum, ditk->genid, ditk->newgenid, od_dta_tail,
-                od_tail_len, ix_isnullk(ditk->usedb, ditk->ixkey, ditk->ixnum));
-            if (iq->debug) {
-                reqprintf(iq, "upd_key IX %d (%s) GENID 0x%016llx ",
-                          ditk->ixnum, iq->usedb->ixschema[ditk->ixnum]->csctag, ditk->newgenid);
-                reqdumphex(iq, ditk->ixkey, ditk->usedb->ix_keylen[ditk->ixnum]);
-                reqmoref(iq, " RC %d", rc);
-            }
-
-            if (rc != 0) {
-                *errout = OP_FAILED_INTERNAL + ERR_DEL_KEY;
-                *ixout = ditk->ixnum;
-                goto done;
-            }
-        } else {
-            abort();
+        rc = apply_defered_op(iq, trans, ditk, od_dta_tail, od_tail_len);
+        if (rc != 0) {
+            rc = defered_op_error(iq, ditk, rc, ixout, errout);
+            goto done;
         }
 
         /* get next record from table */
@@ -1472,6 +1812,8 @@ int process_defered_table(struct ireq *iq, void *trans, int *blkpos, int *ixout,
     if (rc == IX_PASTEOF)
         rc = IX_OK;
 
+    iq->timings.idx_applied = osql_log_time() - start;
+
 done:
     truncate_defered_index_tbl();
     // We can also delete if we are done with the tmptbl
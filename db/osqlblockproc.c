@@ -215,8 +215,9 @@ blocksql_tran_t *osql_bplog_create(int is_uuid, int is_reorder)
     tran->is_uuid = is_uuid;
     Pthread_mutex_init(&tran->store_mtx, NULL);
 
-    /* init temporary table and cursor */
-    tran->db = bdb_temp_array_create(thedb->bdb_env, &bdberr);
+    /* init temporary table and cursor; every key ends in a unique seq */
+    tran->db = bdb_temp_array_create_flags(thedb->bdb_env,
+                                           BDB_TEMP_TABLE_SKIPLIST, &bdberr);
     if (!tran->db || bdberr) {
         logmsg(LOGMSG_ERROR, "%s: failed to create temp table bdberr=%d\n",
                __func__, bdberr);
@@ -228,7 +229,8 @@ blocksql_tran_t *osql_bplog_create(int is_uuid, int is_reorder)
 
     tran->is_reorder_on = is_reorder;
     if (tran->is_reorder_on) {
-        tran->db_ins = bdb_temp_array_create(thedb->bdb_env, &bdberr);
+        tran->db_ins = bdb_temp_array_create_flags(
+            thedb->bdb_env, BDB_TEMP_TABLE_SKIPLIST, &bdberr);
         if (!tran->db_ins) {
             // We can stll work without a INS table
             logmsg(LOGMSG_ERROR,
@@ -610,6 +612,18 @@ static int _pre_process_saveop(osql_sess_t *sess, blocksql_tran_t *tran,
  * Returns 0 if success
  *
  */
+struct batch_saveop {
+    osql_sess_t *sess;
+    blocksql_tran_t *tran;
+};
+
+static int batch_saveop(void *arg, int type, char *op, int oplen)
+{
+    struct batch_saveop *b = arg;
+    osql_comm_is_done(b->sess, type, op, oplen, NULL, NULL);
+    return osql_bplog_saveop(b->sess, b->tran, op, oplen, type);
+}
+
 int osql_bplog_saveop(osql_sess_t *sess, blocksql_tran_t *tran, char *rpl,
                       int rplen, int type)
 {
@@ -617,6 +631,16 @@ int osql_bplog_saveop(osql_sess_t *sess, blocksql_tran_t *tran, char *rpl,
     oplog_key_t key = {0};
     int bdberr;
 
+    if (type == OSQL_BATCH) {
+        /* several ops coalesced by the replicant; save them one by one */
+        struct batch_saveop b = {.sess = sess, .tran = tran};
+        rc = osqlcomm_batch_foreach(rpl, rplen, batch_saveop, &b);
+        if (rc)
+            logmsg(LOGMSG_ERROR, "%s: fail to unpack batch seq=%u rc=%d\n",
+                   __func__, tran->seq, rc);
+        return rc;
+    }
+
 #if DEBUG_REORDER
     logmsg(LOGMSG_DEBUG, "REORDER: saving for sess %p\n", sess);
     uuidstr_t us;
@@ -1213,11 +1237,14 @@ void osql_bplog_time_done(osql_bp_timings_t *tms)
 
     snprintf0(
         msg, sizeof(msg),
-        "Total %llu (sql=%llu upd=%llu repl=%llu signal=%llu retries=%u) [",
+        "Total %llu (sql=%llu upd=%llu idx=%llu/%u repl=%llu signal=%llu "
+        "retries=%u) [",
         tms->req_finished - tms->req_received, /* total time */
         tms->req_alldone -
             tms->req_received, /* time to get sql processing done */
         tms->req_applied - tms->req_alldone,    /* time to apply updates */
+        tms->idx_applied,  /* part of it spent on defered index ops */
+        tms->idx_children, /* child transactions used for them */
         tms->req_sentrc - tms->replication_end, /* time to sent rc back to
                                                    sql (non-relevant for
                                                    blocksql*/
@@ -58,6 +58,13 @@
 #include "sc_logic.h"
 #include "eventlog.h"
 #include <disttxn.h>
+#include <zlib.h>
+#include <lz4.h>
+#include "comdb2_atomic.h"
+
+#if LZ4_VERSION_NUMBER < 10701
+#define LZ4_compress_default LZ4_compress_limitedOutput
+#endif
 
 #define MAX_CLUSTER REPMAX
 
@@ -3282,6 +3289,14 @@ static inline int osql_nettype_is_uuid(int type)
 
 static osql_stats_t stats[OSQL_MAX_REQ] = {{0}};
 
+/* ops coalesced by osql_batch_send */
+static struct {
+    int64_t frames;
+    int64_t ops;
+    int64_t rawbytes;
+    int64_t sentbytes;
+} batch_stats;
+
 /* echo service */
 #define MAX_ECHOES 256
 #define MAX_LATENCY 1000
@@ -3701,6 +3716,9 @@ int osql_comm_is_done(osql_sess_t *sess, int type, char *rpl, int rpllen,
     case OSQL_QBLOB:
     case OSQL_STARTGEN:
         break;
+    case OSQL_BATCH:
+        /* the ops inside are classified as they get unpacked */
+        break;
     case OSQL_DONE_SNAP:
         osql_extract_snap_info(sess, rpl, rpllen);
         /* fall-through */
@@ -5540,6 +5558,14 @@ int osql_comm_quick_stat(void)
                reqtypes[i], stats[i].snd, stats[i].snd_failed, stats[i].rcv,
                stats[i].rcv_failed, stats[i].rcv_rdndt);
     }
+    if (batch_stats.frames) {
+        logmsg(LOGMSG_USER,
+               "batched frames %" PRId64 " ops %" PRId64 " bytes %" PRId64
+               " sent %" PRId64 "\n",
+               ATOMIC_LOAD64(batch_stats.frames), ATOMIC_LOAD64(batch_stats.ops),
+               ATOMIC_LOAD64(batch_stats.rawbytes),
+               ATOMIC_LOAD64(batch_stats.sentbytes));
+    }
     return 0;
 }
 
@@ -8592,6 +8618,345 @@ static void osql_extract_snap_info(osql_sess_t *sess, void *rpl, int rpllen)
     }
 }
 
+/* Coalescing of bplog ops.
+ *
+ * With osql_batch_bytes set, a replicant buffers the ops it ships to the
+ * master and sends them together as one OSQL_BATCH frame, either when the
+ * buffer fills up or ahead of the next op sent with nodelay (done, xerr,
+ * serial ranges...), which keeps the ops in order.  The frame reuses the
+ * uuid header of the first op, followed by osql_batch_hdr_t and a payload
+ * of [int len][op] records, compressed if osql_batch_compress is set.  The
+ * master unpacks the frame and saves each op on its own, so the bplog is
+ * the same whether batching was on or not.
+ */
+int gbl_osql_batch_bytes = 0;
+int gbl_osql_batch_compress = BDB_COMPRESS_NONE;
+
+typedef struct osql_batch_hdr {
+    int nops;   /* number of ops in the frame */
+    int compr;  /* BDB_COMPRESS_NONE, _ZLIB or _LZ4 */
+    int rawlen; /* length of the payload once uncompressed */
+    int len;    /* length of the payload on the wire */
+} osql_batch_hdr_t;
+
+enum { OSQLCOMM_BATCH_HDR_LEN = 4 + 4 + 4 + 4 };
+
+BB_COMPILE_TIME_ASSERT(osqlcomm_batch_hdr_len,
+                       sizeof(osql_batch_hdr_t) == OSQLCOMM_BATCH_HDR_LEN);
+
+/* room kept at the start of the buffers for the frame headers */
+#define OSQL_BATCH_PREFIX (OSQLCOMM_UUID_RPL_TYPE_LEN + OSQLCOMM_BATCH_HDR_LEN)
+
+struct osql_batch {
+    /* the transport send routine we are wrapping */
+    int (*send)(struct osql_target *target, int usertype, void *data,
+                int datalen, int nodelay, void *tail, int tailen);
+    int usertype; /* net type of the buffered ops */
+    int nops;
+    int len; /* bytes used in buf, headers included */
+    int cap;
+    uint8_t *buf;
+    int zcap;
+    uint8_t *zbuf;
+};
+
+static uint8_t *osqlcomm_batch_hdr_put(const osql_batch_hdr_t *p_hdr,
+                                       uint8_t *p_buf,
+                                       const uint8_t *p_buf_end)
+{
+    if (p_buf_end < p_buf || OSQLCOMM_BATCH_HDR_LEN > (p_buf_end - p_buf))
+        return NULL;
+
+    p_buf = buf_put(&(p_hdr->nops), sizeof(p_hdr->nops), p_buf, p_buf_end);
+    p_buf = buf_put(&(p_hdr->compr), sizeof(p_hdr->compr), p_buf, p_buf_end);
+    p_buf = buf_put(&(p_hdr->rawlen), sizeof(p_hdr->rawlen), p_buf, p_buf_end);
+    p_buf = buf_put(&(p_hdr->len), sizeof(p_hdr->len), p_buf, p_buf_end);
+
+    return p_buf;
+}
+
+static const uint8_t *osqlcomm_batch_hdr_get(osql_batch_hdr_t *p_hdr,
+                                             const uint8_t *p_buf,
+                                             const uint8_t *p_buf_end)
+{
+    if (p_buf_end < p_buf || OSQLCOMM_BATCH_HDR_LEN > (p_buf_end - p_buf))
+        return NULL;
+
+    p_buf = buf_get(&(p_hdr->nops), sizeof(p_hdr->nops), p_buf, p_buf_end);
+    p_buf = buf_get(&(p_hdr->compr), sizeof(p_hdr->compr), p_buf, p_buf_end);
+    p_buf = buf_get(&(p_hdr->rawlen), sizeof(p_hdr->rawlen), p_buf, p_buf_end);
+    p_buf = buf_get(&(p_hdr->len), sizeof(p_hdr->len), p_buf, p_buf_end);
+
+    return p_buf;
+}
+
+/* Compress "rawlen" bytes of payload from b->buf into b->zbuf; returns the
+ * algorithm used, or BDB_COMPRESS_NONE if it did not pay off */
+static int osql_batch_compress(struct osql_batch *b, int rawlen, int *len)
+{
+    const uint8_t *src = b->buf + OSQL_BATCH_PREFIX;
+    uint8_t *dst;
+    int algo = gbl_osql_batch_compress;
+
+    if (algo != BDB_COMPRESS_ZLIB && algo != BDB_COMPRESS_LZ4)
+        return BDB_COMPRESS_NONE;
+
+    if (b->zcap < b->cap) {
+        uint8_t *zbuf = realloc(b->zbuf, b->cap);
+        if (!zbuf)
+            return BDB_COMPRESS_NONE;
+        b->zbuf = zbuf;
+        b->zcap = b->cap;
+    }
+    dst = b->zbuf + OSQL_BATCH_PREFIX;
+
+    /* only keep the compressed payload if it is smaller */
+    if (algo == BDB_COMPRESS_LZ4) {
+        int n = LZ4_compress_default((const char *)src, (char *)dst, rawlen,
+                                     rawlen - 1);
+        if (n <= 0)
+            return BDB_COMPRESS_NONE;
+        *len = n;
+    } else {
+        uLongf destLen = rawlen - 1;
+        if (compress2(dst, &destLen, src, rawlen, Z_BEST_SPEED) != Z_OK)
+            return BDB_COMPRESS_NONE;
+        *len = destLen;
+    }
+    return algo;
+}
+
+static int osql_batch_flush(osql_target_t *target)
+{
+    struct osql_batch *b = target->batch;
+    int nops = b->nops;
+    int rawlen = b->len - OSQL_BATCH_PREFIX;
+    int rc;
+
+    if (nops == 0)
+        return 0;
+
+    b->nops = 0;
+    b->len = OSQL_BATCH_PREFIX;
+
+    if (nops == 1) {
+        /* nothing to coalesce, ship the op as is */
+        return b->send(target, b->usertype,
+                       b->buf + OSQL_BATCH_PREFIX + sizeof(int),
+                       rawlen - sizeof(int), 0, NULL, 0);
+    }
+
+    osql_uuid_rpl_t hd;
+    osql_batch_hdr_t bhd = {0};
+    uint8_t *frame = b->buf;
+
+    /* the frame borrows the uuid header of its first op */
+    if (!osqlcomm_uuid_rpl_type_get(&hd, b->buf + OSQL_BATCH_PREFIX + sizeof(int),
+                                    b->buf + b->cap)) {
+        logmsg(LOGMSG_ERROR, "%s:%s returns NULL\n", __func__,
+               "osqlcomm_uuid_rpl_type_get");
+        return -1;
+    }
+    hd.type = OSQL_BATCH;
+
+    bhd.nops = nops;
+    bhd.rawlen = bhd.len = rawlen;
+    bhd.compr = osql_batch_compress(b, rawlen, &bhd.len);
+    if (bhd.compr != BDB_COMPRESS_NONE)
+        frame = b->zbuf;
+
+    uint8_t *p_buf = frame, *p_buf_end = frame + OSQL_BATCH_PREFIX;
+    if (!(p_buf = osqlcomm_uuid_rpl_type_put(&hd, p_buf, p_buf_end)) ||
+        !(p_buf = osqlcomm_batch_hdr_put(&bhd, p_buf, p_buf_end))) {
+        logmsg(LOGMSG_ERROR, "%s: failed to pack batch header\n", __func__);
+        return -1;
+    }
+
+    rc = b->send(target, b->usertype, frame, OSQL_BATCH_PREFIX + bhd.len, 0,
+                 NULL, 0);
+    if (rc == 0) {
+        ATOMIC_ADD64(batch_stats.frames, 1);
+        ATOMIC_ADD64(batch_stats.ops, nops);
+        ATOMIC_ADD64(batch_stats.rawbytes, rawlen);
+        ATOMIC_ADD64(batch_stats.sentbytes, bhd.len);
+    }
+    return rc;
+}
+
+static int osql_batch_send(osql_target_t *target, int usertype, void *data,
+                           int datalen, int nodelay, void *tail, int tailen)
+{
+    struct osql_batch *b = target->batch;
+    int limit = gbl_osql_batch_bytes;
+    int oplen = datalen + (tail ? tailen : 0);
+    int need = sizeof(int) + oplen;
+    int rc;
+
+    if (nodelay || limit <= 0 || need > limit ||
+        !osql_nettype_is_uuid(usertype) ||
+        datalen < OSQLCOMM_UUID_RPL_TYPE_LEN ||
+        (b->nops && usertype != b->usertype)) {
+        /* whatever is buffered must reach the master first */
+        if ((rc = osql_batch_flush(target)) != 0)
+            return rc;
+        return b->send(target, usertype, data, datalen, nodelay, tail, tailen);
+    }
+
+    if (b->len - OSQL_BATCH_PREFIX + need > limit &&
+        (rc = osql_batch_flush(target)) != 0)
+        return rc;
+
+    if (b->len + need > b->cap) {
+        int cap = OSQL_BATCH_PREFIX + limit;
+        uint8_t *buf = realloc(b->buf, cap);
+        if (!buf) {
+            logmsg(LOGMSG_ERROR, "%s: failed to malloc %d bytes\n", __func__,
+                   cap);
+            return -1;
+        }
+        b->buf = buf;
+        b->cap = cap;
+    }
+
+    uint8_t *p_buf = b->buf + b->len;
+    p_buf = buf_put(&oplen, sizeof(oplen), p_buf, b->buf + b->cap);
+    memcpy(p_buf, data, datalen);
+    if (tail && tailen > 0)
+        memcpy(p_buf + datalen, tail, tailen);
+
+    b->len += need;
+    b->usertype = usertype;
+    b->nops++;
+
+    return 0;
+}
+
+/**
+ * Start coalescing the ops sent to target, if enabled
+ *
+ */
+void osql_batch_begin(osql_target_t *target)
+{
+    struct osql_batch *b = target->batch;
+
+    if (target->send == osql_batch_send) {
+        /* replay on the same target, drop what was left from last time */
+        b->nops = 0;
+        b->len = OSQL_BATCH_PREFIX;
+        return;
+    }
+
+    /* local masters route packets without any wire to save on */
+    if (gbl_osql_batch_bytes <= 0 || target->host == NULL ||
+        target->host == gbl_myhostname || target->host == db_eid_invalid)
+        return;
+
+    if (!b) {
+        b = target->batch = calloc(1, sizeof(struct osql_batch));
+        if (!b)
+            return;
+    }
+    b->send = target->send;
+    b->nops = 0;
+    b->len = OSQL_BATCH_PREFIX;
+    target->send = osql_batch_send;
+}
+
+/**
+ * Release the coalescing buffers of target
+ *
+ */
+void osql_batch_free(osql_target_t *target)
+{
+    struct osql_batch *b = target->batch;
+
+    if (!b)
+        return;
+    if (target->send == osql_batch_send)
+        target->send = b->send;
+    free(b->buf);
+    free(b->zbuf);
+    free(b);
+    target->batch = NULL;
+}
+
+/**
+ * Unpack an OSQL_BATCH frame and call "apply" for each op it carries,
+ * in the order they were sent
+ *
+ */
+int osqlcomm_batch_foreach(char *rpl, int rplen,
+                           int (*apply)(void *arg, int type, char *op,
+                                        int oplen),
+                           void *arg)
+{
+    const uint8_t *p_buf = (const uint8_t *)rpl + OSQLCOMM_UUID_RPL_TYPE_LEN;
+    const uint8_t *p_buf_end = (const uint8_t *)rpl + rplen;
+    osql_batch_hdr_t bhd;
+    char *raw = NULL;
+    int rc = 0;
+
+    if (!(p_buf = osqlcomm_batch_hdr_get(&bhd, p_buf, p_buf_end)) ||
+        bhd.len != p_buf_end - p_buf || bhd.rawlen < 0) {
+        logmsg(LOGMSG_ERROR, "%s: malformed batch header\n", __func__);
+        return -1;
+    }
+
+    switch (bhd.compr) {
+    case BDB_COMPRESS_NONE:
+        break;
+    case BDB_COMPRESS_LZ4:
+    case BDB_COMPRESS_ZLIB:
+        raw = malloc(bhd.rawlen);
+        if (!raw) {
+            logmsg(LOGMSG_ERROR, "%s: failed to malloc %d bytes\n", __func__,
+                   bhd.rawlen);
+            return -1;
+        }
+        if (bhd.compr == BDB_COMPRESS_LZ4) {
+            rc = LZ4_decompress_safe((const char *)p_buf, raw, bhd.len,
+                                     bhd.rawlen) != bhd.rawlen;
+        } else {
+            uLongf destLen = bhd.rawlen;
+            rc = uncompress((Bytef *)raw, &destLen, p_buf, bhd.len) != Z_OK ||
+                 destLen != bhd.rawlen;
+        }
+        if (rc) {
+            logmsg(LOGMSG_ERROR, "%s: failed to uncompress %d bytes algo %d\n",
+                   __func__, bhd.len, bhd.compr);
+            free(raw);
+            return -1;
+        }
+        p_buf = (const uint8_t *)raw;
+        p_buf_end = p_buf + bhd.rawlen;
+        break;
+    default:
+        logmsg(LOGMSG_ERROR, "%s: unknown batch compression %d\n", __func__,
+               bhd.compr);
+        return -1;
+    }
+
+    for (int i = 0; i < bhd.nops && rc == 0; i++) {
+        osql_uuid_rpl_t hd;
+        int oplen;
+
+        if (!(p_buf = buf_get(&oplen, sizeof(oplen), p_buf, p_buf_end)) ||
+            oplen < 0 || oplen > p_buf_end - p_buf ||
+            !osqlcomm_uuid_rpl_type_get(&hd, p_buf, p_buf + oplen) ||
+            hd.type == OSQL_BATCH) {
+            logmsg(LOGMSG_ERROR, "%s: malformed op %d of %d\n", __func__, i,
+                   bhd.nops);
+            rc = -1;
+            break;
+        }
+        rc = apply(arg, hd.type, (char *)p_buf, oplen);
+        p_buf += oplen;
+    }
+
+    free(raw);
+    return rc;
+}
+
 #define UNK_ERR_SEND_RETRY 10
 
 int offload_net_send(const char *host, int usertype, void *data, int datalen,
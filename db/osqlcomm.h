@@ -460,4 +460,26 @@ int osql_finalize_scs(struct ireq *iq, tran_type *trans);
  */
 int osqlcomm_host_known(const char *tohost);
 
+/**
+ * Start coalescing the ops sent to target, if enabled
+ *
+ */
+void osql_batch_begin(osql_target_t *target);
+
+/**
+ * Release the coalescing buffers of target
+ *
+ */
+void osql_batch_free(osql_target_t *target);
+
+/**
+ * Unpack an OSQL_BATCH frame and call "apply" for each op it carries,
+ * in the order they were sent
+ *
+ */
+int osqlcomm_batch_foreach(char *rpl, int rplen,
+                           int (*apply)(void *arg, int type, char *op,
+                                        int oplen),
+                           void *arg);
+
 #endif
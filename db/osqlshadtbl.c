@@ -720,7 +720,10 @@ static int create_tablecursor(bdb_state_type *bdb_env, struct tmp_table **ptbl,
         return -1;
     }
 
-    tbl->table = bdb_temp_array_create(bdb_env, bdberr);
+    /* every shadow key carries a synthetic genid or seq of its own, so
+     * no key is stored twice */
+    tbl->table =
+        bdb_temp_array_create_flags(bdb_env, BDB_TEMP_TABLE_SKIPLIST, bdberr);
 
     if (!tbl->table) {
         logmsg(LOGMSG_ERROR, "%s: bdb_temp_table_create failed, bderr=%d\n",
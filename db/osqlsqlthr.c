@@ -363,14 +363,22 @@ int osql_sock_start_deferred(struct sqlclntstate *clnt)
 
 static int osql_begin(struct sqlclntstate *clnt, int type, int keep_rqid)
 {
+    int rc;
+
     /* note: custom interface can still delegate to osql over net */
     if (clnt->begin) {
         if (!clnt->begin(clnt, type, keep_rqid))
-            return 0;
+            goto done;
     }
 
     /* default */
-    return osql_begin_net(clnt, type, keep_rqid);
+    rc = osql_begin_net(clnt, type, keep_rqid);
+    if (rc)
+        return rc;
+
+done:
+    osql_batch_begin(&clnt->osql.target);
+    return 0;
 }
 
 static int osql_end(struct sqlclntstate *clnt)
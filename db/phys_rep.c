@@ -21,6 +21,7 @@
 #include <time.h>
 #include <string.h>
 #include <pthread.h>
+#include <arpa/inet.h>
 #include <stdint.h>
 #include <unistd.h>
 #include <time.h>
@@ -29,11 +30,13 @@
 #include <bdbglue.h>
 #include "phys_rep_lsn.h"
 #include "dbinc/rep_types.h"
+#include "dbinc/db_swap.h"
 
 #include "comdb2.h"
 #include "truncate_log.h"
 #include "reversesql.h"
 #include "reverse_conn.h"
+#include "tranlog.h"
 
 #include <parse_lsn.h>
 #include <logmsg.h>
@@ -58,6 +61,7 @@ int gbl_physrep_debug = 0;
 int gbl_physrep_reconnect_interval = 600; // force re-registration every 10 mins
 int gbl_physrep_reconnect_penalty = 0;
 int gbl_blocking_physrep = 0;
+int gbl_physrep_batch_logs = 0;
 int gbl_physrep_fanout = 8;
 int gbl_physrep_max_candidates = 6;
 int gbl_physrep_max_pending_replicants = 10;
@@ -689,6 +693,111 @@ static LOG_INFO handle_record(cdb2_hndl_tp *repl_db, LOG_INFO prev_info)
     return next_info;
 }
 
+extern __thread int physrep_out_of_order;
+
+/* A source that predates batching can't prepare the batched query; any other
+ * failure (timeouts, a source going down) is worth retrying as a batch. */
+static int batch_unsupported_error(cdb2_hndl_tp *repl_db, int rc)
+{
+    const char *err;
+
+    if (rc != CDB2ERR_PREPARE_ERROR)
+        return 0;
+    err = cdb2_errstr(repl_db);
+    return err && (strstr(err, "no such column") != NULL || strstr(err, "no such function") != NULL ||
+                   strstr(err, "wrong number of arguments") != NULL);
+}
+
+/* Apply a row of a batched comdb2_transaction_logs query, which carries a
+ * run of consecutive log records (see TRANLOG_BATCH_HDRSZ).  The records are
+ * applied under a single bdb readlock, and we wait for the acks of our own
+ * replicants once, for the last commit in the batch, rather than after every
+ * commit. */
+static int handle_batch(cdb2_hndl_tp *repl_db, LOG_INFO *prev_info)
+{
+    bdb_state_type *bdb_state = thedb->bdb_env;
+    uint8_t *buf = (uint8_t *)cdb2_column_value(repl_db, 4);
+    int len = cdb2_column_size(repl_db, 4);
+    DB_LSN commit_lsn = {0};
+    void *commit_rec = NULL;
+    int off = 0, rc = 0;
+
+    BDB_READLOCK("physrep_apply_batch");
+    while (stop_physrep_worker == 0 && off + TRANLOG_BATCH_HDRSZ <= len) {
+        uint32_t hdr[3];
+        unsigned int file, offset;
+        u_int32_t rectype;
+        int reclen;
+        uint8_t *rec;
+
+        memcpy(hdr, buf + off, TRANLOG_BATCH_HDRSZ);
+        file = ntohl(hdr[0]);
+        offset = ntohl(hdr[1]);
+        reclen = ntohl(hdr[2]);
+        rec = buf + off + TRANLOG_BATCH_HDRSZ;
+        if (reclen < (int)sizeof(rectype) || reclen > len - off - TRANLOG_BATCH_HDRSZ) {
+            physrep_logmsg(LOGMSG_ERROR, "%s:%d: Malformed log batch at lsn %u:%u (len %d)\n", __func__, __LINE__,
+                           file, offset, reclen);
+            rc = -1;
+            break;
+        }
+        off += TRANLOG_BATCH_HDRSZ + reclen;
+
+        /* The first batch starts with the record we asked from */
+        if (file < prev_info->file || (file == prev_info->file && offset <= prev_info->offset))
+            continue;
+
+        if (gbl_physrep_debug) {
+            physrep_logmsg(LOGMSG_USER, "%s:%d: Processing record (lsn %u:%u)\n", __func__, __LINE__, file, offset);
+        }
+
+        if (prev_info->file < file) {
+            rc = apply_log(bdb_state, prev_info->file, get_next_offset(bdb_state->dbenv, *prev_info), REP_NEWFILE,
+                           NULL, 0);
+            if (rc != 0) {
+                physrep_logmsg(LOGMSG_FATAL, "%s:%d: Something went wrong with applying the logs (rc: %d)\n",
+                               __func__, __LINE__, rc);
+                exit(1);
+            }
+        }
+
+        LOGCOPY_32(&rectype, rec);
+        rc = apply_log(bdb_state, file, offset, REP_LOG, rec, reclen);
+        /* As in handle_record(), only the ack wait decides the fate of a commit */
+        if (rc != 0 && !is_commit(rectype)) {
+            physrep_logmsg(LOGMSG_FATAL, "%s:%d: Something went wrong with applying the logs (rc: %d)\n", __func__,
+                           __LINE__, rc);
+            exit(1);
+        }
+        rc = 0;
+
+        prev_info->file = file;
+        prev_info->offset = offset;
+        prev_info->size = reclen;
+
+        if (is_commit(rectype)) {
+            commit_lsn.file = file;
+            commit_lsn.offset = offset;
+            commit_rec = rec;
+        }
+        if (physrep_out_of_order)
+            break;
+    }
+    BDB_RELLOCK();
+
+    if (commit_rec) {
+        int start = comdb2_time_epochms();
+        if (physrep_bdb_wait_for_seqnum(bdb_state, &commit_lsn, commit_rec) != 0) {
+            physrep_logmsg(LOGMSG_ERROR, "%s:%d bdb_wait_for_seqnum_from_all() failed\n", __func__, __LINE__);
+        } else if (gbl_physrep_debug) {
+            physrep_logmsg(LOGMSG_USER, "%s:%d: Got ACKs for %u:%u, (waited: %d ms)\n", __func__, __LINE__,
+                           commit_lsn.file, commit_lsn.offset, comdb2_time_epochms() - start);
+        }
+    }
+
+    return rc;
+}
+
 static int register_self(cdb2_hndl_tp *repl_metadb)
 {
     const size_t nodes_list_sz = REPMAX * (255+1) + 3;
@@ -1229,15 +1338,16 @@ static int do_wait_for_reverse_conn(cdb2_hndl_tp *repl_metadb) {
        This is the database/node that to replicant connects to retrieve and
        apply physical logs.
 */
-extern __thread int physrep_out_of_order;
 static void *physrep_worker(void *args)
 {
     comdb2_name_thread(__func__);
 
     volatile int64_t gen, highest_gen = 0;
-    size_t sql_cmd_len = 150;
+    size_t sql_cmd_len = 200;
     char sql_cmd[sql_cmd_len];
     int do_truncate = 0;
+    int use_batch = 0;
+    int batch_unsupported = 0;
     int rc;
     int now;
     int is_revconn = -1;
@@ -1307,6 +1417,7 @@ repl_loop:
         if (repl_db_connected == 0) {
             cdb2_hndl_tp *repl_metadb = NULL;
 
+            batch_unsupported = 0;
             if ((rc = get_metadb_hndl(&repl_metadb)) != 0) {
                 goto sleep_and_retry;
             }
@@ -1424,10 +1535,21 @@ repl_loop:
 
         prev_info = info;
 
-        rc = snprintf(sql_cmd, sql_cmd_len,
-                      "select * from comdb2_transaction_logs('{%u:%u}'%s)",
-                      info.file, info.offset,
-                      (gbl_blocking_physrep ? ", NULL, 1" : ""));
+        /* Sources that predate batching fail on the nrecords column; fall back
+         * to one record per row until we reconnect. */
+        use_batch = gbl_physrep_batch_logs && !gbl_deferred_phys_flag && !batch_unsupported;
+        if (use_batch) {
+            rc = snprintf(sql_cmd, sql_cmd_len,
+                          "select lsn, rectype, generation, timestamp, payload, nrecords "
+                          "from comdb2_transaction_logs('{%u:%u}', NULL, %d)",
+                          info.file, info.offset,
+                          TRANLOG_FLAGS_BATCH | (gbl_blocking_physrep ? TRANLOG_FLAGS_BLOCK : 0));
+        } else {
+            rc = snprintf(sql_cmd, sql_cmd_len,
+                          "select * from comdb2_transaction_logs('{%u:%u}'%s)",
+                          info.file, info.offset,
+                          (gbl_blocking_physrep ? ", NULL, 1" : ""));
+        }
         if (rc < 0 || rc >= sql_cmd_len)
             physrep_logmsg(LOGMSG_ERROR, "%s:%d Command buffer is not long enough!\n", __func__, __LINE__);
         if (gbl_physrep_debug)
@@ -1435,6 +1557,11 @@ repl_loop:
         if ((rc = cdb2_run_statement(repl_db, sql_cmd)) != CDB2_OK) {
             physrep_logmsg(LOGMSG_ERROR, "Couldn't query the database, rcode=%d '%s' retrying\n", rc,
                            cdb2_errstr(repl_db));
+            /* Keep the connection: reconnecting would try batching again */
+            if (use_batch && batch_unsupported_error(repl_db, rc)) {
+                batch_unsupported = 1;
+                goto sleep_and_retry;
+            }
             close_repl_connection(repl_db_cnct, repl_db, __func__, __LINE__);
             goto sleep_and_retry;
         }
@@ -1444,13 +1571,20 @@ repl_loop:
                 physrep_logmsg(LOGMSG_USER, "%s:%d: Can't find the next record (rc: %d '%s')\n", __func__, __LINE__, rc,
                                cdb2_errstr(repl_db));
             }
+            if (use_batch && batch_unsupported_error(repl_db, rc)) {
+                batch_unsupported = 1;
+                goto sleep_and_retry;
+            }
             close_repl_connection(repl_db_cnct, repl_db, __func__, __LINE__);
             goto sleep_and_retry;
         }
 
-        /* our log matches, so apply each record log received */
+        /* our log matches, so apply each record log received.  In batch mode
+         * the first row also carries the records that follow ours. */
+        int have_row = use_batch;
         while (stop_physrep_worker == 0 && thedb->master == gbl_myhostname && !do_truncate &&
-               (rc = cdb2_next_record(repl_db)) == CDB2_OK) {
+               (have_row || (rc = cdb2_next_record(repl_db)) == CDB2_OK)) {
+            have_row = 0;
             /* check the generation id to make sure the master hasn't
              * switched */
 
@@ -1468,7 +1602,13 @@ repl_loop:
                 goto repl_loop;
             }
 
-            prev_info = handle_record(repl_db, prev_info);
+            if (!use_batch) {
+                prev_info = handle_record(repl_db, prev_info);
+            } else if (handle_batch(repl_db, &prev_info) != 0) {
+                close_repl_connection(repl_db_cnct, repl_db, __func__, __LINE__);
+                do_truncate = 1;
+                goto repl_loop;
+            }
             if (physrep_out_of_order) {
                 physrep_out_of_order = 0;
                 do_truncate = 1;
@@ -119,6 +119,9 @@ extern int gbl_osql_verify_retries_max;
 
 static pthread_mutex_t testguard = PTHREAD_MUTEX_INITIALIZER;
 void bdb_locktest(void *);
+int bdb_deadlocktest(void *, int);
+void bdb_lock_fastpath_bench(void *, int, int);
+int bdb_lock_fastpath_test(void *);
 void bdb_berktest(void *, uint32_t);
 void bdb_berktest_multi(void *);
 void bdb_berktest_commit_delay(uint32_t);
@@ -4415,6 +4418,20 @@ clipper_usage:
            logmsg(LOGMSG_USER, ", upto a max of %d", gbl_testcompr_max);
         }
        logmsg(LOGMSG_USER, "\n");
+    } else if (tokcmp(tok, ltok, "convtest") == 0) {
+        char table[MAXTABLELEN];
+        tok = segtok(line, lline, &st, &ltok);
+        if (ltok == 0) {
+            logmsg(LOGMSG_USER, "convtest <tbl> [nrows] - Check and time record and key "
+                                "conversions for table tbl\n");
+            return -1;
+        }
+        tokcpy0(tok, ltok, table, sizeof(table));
+        tok = segtok(line, lline, &st, &ltok);
+        int nrows = ltok ? toknum(tok, ltok) : 1000000;
+        if (nrows <= 0)
+            nrows = 1000000;
+        schema_conversion_bench(table, nrows);
     } else if (tokcmp(tok, ltok, "decimal_rounding") == 0) {
        tok = segtok(line, lline, &st, &ltok);
        if (ltok > 0 && tok[0]) {
@@ -4624,6 +4641,19 @@ clipper_usage:
             Pthread_mutex_unlock(&testguard);
         }
 #   endif
+    } else if (tokcmp(tok, ltok, "lock_fastpath_bench") == 0) {
+        int nthds = 0;
+        int secs = 0;
+        tok = segtok(line, lline, &st, &ltok);
+        if (ltok > 0) {
+            nthds = toknum(tok, ltok);
+            tok = segtok(line, lline, &st, &ltok);
+            if (ltok > 0)
+                secs = toknum(tok, ltok);
+        }
+        Pthread_mutex_lock(&testguard);
+        bdb_lock_fastpath_bench(thedb->bdb_env, nthds, secs);
+        Pthread_mutex_unlock(&testguard);
     } else if (tokcmp(tok, ltok, "deadlock_policy_override") == 0) {
        tok = segtok(line, lline, &st, &ltok);
        if (ltok > 0) {
@@ -5010,6 +5040,18 @@ clipper_usage:
             Pthread_mutex_lock(&testguard);
             bdb_locktest(thedb->bdb_env);
             Pthread_mutex_unlock(&testguard);
+        } else if (tokcmp(tok, ltok, "bdb_deadlock") == 0) {
+            int rounds = 0;
+            tok = segtok(line, lline, &st, &ltok);
+            if (ltok > 0)
+                rounds = toknum(tok, ltok);
+            Pthread_mutex_lock(&testguard);
+            bdb_deadlocktest(thedb->bdb_env, rounds);
+            Pthread_mutex_unlock(&testguard);
+        } else if (tokcmp(tok, ltok, "lock_fastpath") == 0) {
+            Pthread_mutex_lock(&testguard);
+            bdb_lock_fastpath_test(thedb->bdb_env);
+            Pthread_mutex_unlock(&testguard);
         } else if (tokcmp(tok, ltok, "bad_osql") == 0) {
             osql_send_test();
         } else if (tokcmp(tok, ltok, "reversesql") == 0) {
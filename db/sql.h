@@ -62,8 +62,6 @@ enum transaction_level {
  * we can have a small pool of sql threads with big stacks, and a large pool
  * of appsock threads with small stacks. */
 
-#define FINGERPRINTSZ 16
-
 #define CHECK_NEXT_QUERIES 20
 
 /* Static rootpages numbers. */
@@ -686,6 +684,7 @@ struct features {
     unsigned allow_master_exec : 1;
     unsigned allow_master_dbinfo : 1;
     unsigned queue_me : 1;
+    unsigned row_batch : 1;
 };
 
 /* Client specific sql state */
@@ -846,6 +845,9 @@ struct sqlclntstate {
     int verify_retries; /* how many verify retries we've borne */
     int verifyretry_off;
     int pageordertablescan;
+    int scan_shard;   /* sharded dohsql scan: data cursors visit stripes */
+    int scan_nshards; /* scan_shard, scan_shard + scan_nshards, ... */
+    const char *scan_shard_tbl; /* only data cursors on this table */
     int snapshot; /* snapshot epoch placeholder */
     int snapshot_file;
     int snapshot_offset;
@@ -987,6 +989,8 @@ struct sqlclntstate {
     int8_t rowbuffer;
     /* 1 if client has requested flat column values. */
     int flat_col_vals;
+    /* 1 if client can read several rows per response. */
+    int row_batch;
     plugin_func *recover_ddlk;
     replay_func *recover_ddlk_fail;
     unsigned loading_stat: 1;
@@ -1081,6 +1085,10 @@ struct temptable {
     int flags;
     Btree *owner;
     struct sp_tmptbl *sp_tmptbl;
+    int nHashField;           /* hash join: leading key fields hashed */
+    int hj_seeking;           /* hash join: nexts stay on hj_probe */
+    UnpackedRecord *hj_probe; /* hash join: key of the last seek */
+    void *hj_probe_key;
 };
 
 struct Btree {
@@ -19,9 +19,25 @@
 #include "sql.h"
 #include "lrucache.h"
 #include "dohsql.h" // dohsql_wait_for_master()
+#include "comdb2_atomic.h"
 
 int gbl_max_sqlcache = 10;
 int gbl_enable_sql_stmt_caching = STMT_CACHE_ALL;
+int gbl_stmt_cache_stats = 1;
+int gbl_stmt_cache_stats_size = 1000;
+
+/* When a thread cache overflows, this many of its least recently used
+ * entries are considered and the one with the fewest hits across all
+ * threads is evicted. */
+#define STMT_CACHE_EVICT_WINDOW 4
+
+/* A vdbe belongs to the sqlite3 handle (and schema copy) of the thread that
+ * prepared it, so it can't be handed over to another sql thread.  What the
+ * threads share instead is one reference counted record per fingerprint:
+ * the hit/prepare counts of every thread, used to keep globally hot
+ * statements cached under pressure, and reported by comdb2_stmt_cache. */
+static hash_t *shared_stmt_hash = NULL;
+static pthread_mutex_t shared_stmt_lk = PTHREAD_MUTEX_INITIALIZER;
 
 extern int gbl_debug_temptables;
 static int stmt_cache_finalize_entry(stmt_cache_entry_t *entry);
@@ -35,23 +51,128 @@ static int query_data_func(struct sqlclntstate *clnt, void **data, int *sz,
         return 0;
 }
 
+/* Drop shared entries no thread is caching anymore; shared_stmt_lk held */
+static void shared_stmt_purge_unused(void)
+{
+    void *ent;
+    unsigned int bkt;
+    int n = 0;
+    shared_stmt_entry_t **unused =
+        malloc(hash_get_num_entries(shared_stmt_hash) * sizeof(*unused));
+    if (!unused)
+        return;
+    for (shared_stmt_entry_t *e = hash_first(shared_stmt_hash, &ent, &bkt); e;
+         e = hash_next(shared_stmt_hash, &ent, &bkt)) {
+        if (e->refcnt == 0)
+            unused[n++] = e;
+    }
+    for (int i = 0; i < n; i++) {
+        hash_del(shared_stmt_hash, unused[i]);
+        free(unused[i]->zNormSql);
+        free(unused[i]);
+    }
+    free(unused);
+}
+
+/* Find or create the shared entry for a freshly prepared stmt and take a
+ * reference on it.  Returns NULL if the stmt has no normalized sql (query
+ * fingerprinting is off) or the shared table is full. */
+static shared_stmt_entry_t *shared_stmt_acquire(sqlite3_stmt *stmt)
+{
+    unsigned char fingerprint[FINGERPRINTSZ];
+    size_t nNormSql;
+    shared_stmt_entry_t *e;
+
+    if (!gbl_stmt_cache_stats)
+        return NULL;
+    const char *zNormSql = sqlite3_normalized_sql(stmt);
+    if (!zNormSql)
+        return NULL;
+    calc_fingerprint(zNormSql, &nNormSql, fingerprint);
+    int64_t bytes = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_MEMUSED, 0);
+
+    Pthread_mutex_lock(&shared_stmt_lk);
+    if (shared_stmt_hash == NULL)
+        shared_stmt_hash = hash_init(FINGERPRINTSZ);
+    e = hash_find(shared_stmt_hash, fingerprint);
+    if (e == NULL) {
+        if (hash_get_num_entries(shared_stmt_hash) >= gbl_stmt_cache_stats_size)
+            shared_stmt_purge_unused();
+        if (hash_get_num_entries(shared_stmt_hash) >= gbl_stmt_cache_stats_size ||
+            (e = calloc(1, sizeof(shared_stmt_entry_t))) == NULL) {
+            Pthread_mutex_unlock(&shared_stmt_lk);
+            return NULL;
+        }
+        memcpy(e->fingerprint, fingerprint, FINGERPRINTSZ);
+        e->zNormSql = strdup(zNormSql);
+        hash_add(shared_stmt_hash, e);
+    }
+    e->refcnt++;
+    e->prepares++;
+    e->bytes = bytes;
+    Pthread_mutex_unlock(&shared_stmt_lk);
+    return e;
+}
+
+static void shared_stmt_release(shared_stmt_entry_t *e, int invalidated)
+{
+    if (e == NULL)
+        return;
+    Pthread_mutex_lock(&shared_stmt_lk);
+    assert(e->refcnt > 0);
+    e->refcnt--;
+    if (invalidated)
+        e->invalidations++;
+    Pthread_mutex_unlock(&shared_stmt_lk);
+}
+
+static inline int64_t shared_stmt_hits(stmt_cache_entry_t *entry)
+{
+    return entry->shared ? ATOMIC_LOAD64(entry->shared->hits) : 0;
+}
+
+/* Visit every shared entry with shared_stmt_lk held (comdb2_stmt_cache) */
+void shared_stmt_cache_foreach(void (*func)(shared_stmt_entry_t *, void *),
+                               void *arg)
+{
+    void *ent;
+    unsigned int bkt;
+    Pthread_mutex_lock(&shared_stmt_lk);
+    if (shared_stmt_hash) {
+        for (shared_stmt_entry_t *e = hash_first(shared_stmt_hash, &ent, &bkt);
+             e; e = hash_next(shared_stmt_hash, &ent, &bkt)) {
+            func(e, arg);
+        }
+    }
+    Pthread_mutex_unlock(&shared_stmt_lk);
+}
+
 static int stmt_cache_finalize_entry_cb(void *stmt_entry, void *args)
 {
-    (void)args;
-    return stmt_cache_finalize_entry(stmt_entry);
+    stmt_cache_entry_t *entry = stmt_entry;
+    if (args && *(int *)args && entry->shared) {
+        shared_stmt_release(entry->shared, 1);
+        entry->shared = NULL;
+    }
+    return stmt_cache_finalize_entry(entry);
 }
 
-/* Teardown statement cache */
-int stmt_cache_delete(stmt_cache_t *stmt_cache)
+static int stmt_cache_delete_int(stmt_cache_t *stmt_cache, int invalidated)
 {
     assert(stmt_cache && stmt_cache->hash);
     /* iterate through the hash table and finalize all the statements */
-    hash_for(stmt_cache->hash, stmt_cache_finalize_entry_cb, NULL);
+    hash_for(stmt_cache->hash, stmt_cache_finalize_entry_cb, &invalidated);
     hash_clear(stmt_cache->hash);
     hash_free(stmt_cache->hash);
     return 0;
 }
 
+/* Teardown statement cache */
+int stmt_cache_delete(stmt_cache_t *stmt_cache)
+{
+    return stmt_cache_delete_int(stmt_cache, 0);
+}
+
 static int strcmpfunc_stmt(char *a, char *b, int len)
 {
     return strcmp(a, b);
@@ -133,6 +254,7 @@ int stmt_cache_requeue_old_entry(stmt_cache_t *stmt_cache, stmt_cache_entry_t *e
 
 static void stmt_cache_free_entry(stmt_cache_entry_t *entry)
 {
+    shared_stmt_release(entry->shared, 0);
     if (entry->query && gbl_debug_temptables) {
         free(entry->query);
         entry->query = NULL;
@@ -151,10 +273,33 @@ static int stmt_cache_finalize_entry(stmt_cache_entry_t *entry)
     return 0;
 }
 
+/* Pick the eviction victim among the last few entries of a full list: the
+ * one with the fewest hits across all threads, oldest first on ties. */
+static stmt_cache_entry_t *stmt_cache_pick_victim(stmt_cache_entry_t *bot)
+{
+    stmt_cache_entry_t *victim = bot;
+    if (!gbl_stmt_cache_stats)
+        return victim;
+    int64_t victim_hits = shared_stmt_hits(victim);
+    stmt_cache_entry_t *entry = bot->lnk.prev;
+    for (int i = 1; entry && i < STMT_CACHE_EVICT_WINDOW;
+         i++, entry = entry->lnk.prev) {
+        int64_t hits = shared_stmt_hits(entry);
+        if (hits < victim_hits) {
+            victim = entry;
+            victim_hits = hits;
+        }
+    }
+    return victim;
+}
+
 static int stmt_cache_delete_last_entry(stmt_cache_t *stmt_cache, void *list)
 {
     int rc;
-    stmt_cache_entry_t *entry = listc_rbl(list);
+    stmt_cache_entry_t *bot = (list == &stmt_cache->param_stmt_list)
+                                  ? LISTC_BOT(&stmt_cache->param_stmt_list)
+                                  : LISTC_BOT(&stmt_cache->noparam_stmt_list);
+    stmt_cache_entry_t *entry = listc_rfl(list, stmt_cache_pick_victim(bot));
     rc = hash_del(stmt_cache->hash, entry);
     if (rc) {
         logmsg(LOGMSG_ERROR, "%s:%d failed to delete entry (rc: %d)\n",
@@ -232,7 +377,10 @@ int stmt_cache_add_new_entry(stmt_cache_t *stmt_cache, const char *sql,
     else
         entry->query = NULL;
 
-    return stmt_cache_requeue_old_entry(stmt_cache, entry);
+    int rc = stmt_cache_requeue_old_entry(stmt_cache, entry);
+    if (rc == 0)
+        entry->shared = shared_stmt_acquire(stmt);
+    return rc;
 }
 
 int stmt_cache_find_and_remove_entry(stmt_cache_t *stmt_cache, const char *sql, stmt_cache_entry_t **entry)
@@ -258,7 +406,7 @@ int stmt_cache_reset(stmt_cache_t *stmt_cache)
     if (!stmt_cache)
         return 0;
 
-    stmt_cache_delete(stmt_cache);
+    stmt_cache_delete_int(stmt_cache, 1);
     if (!stmt_cache_new(stmt_cache)) {
         return 1;
     }
@@ -482,11 +630,16 @@ int stmt_cache_get(struct sqlthdstate *thd, struct sqlclntstate *clnt,
         }
     }
 
+    if (rec->stmt_entry && rec->stmt_entry->shared)
+        ATOMIC_ADD64(rec->stmt_entry->shared->hits, 1);
+
     if (rec->stmt) {
         rec->sql = sqlite3_sql(rec->stmt); // save expanded query
         if ((prepFlags & PREPARE_ONLY) == 0) {
             int rc = sqlite3LockStmtTables(rec->stmt);
             if (rc) {
+                shared_stmt_release(rec->stmt_entry->shared, 1);
+                rec->stmt_entry->shared = NULL;
                 stmt_cache_remove_entry(thd->stmt_cache, rec->stmt_entry, 1);
                 stmt_cache_free_entry(rec->stmt_entry);
                 rec->stmt_entry = NULL;
@@ -26,6 +26,7 @@
 
 #define MAX_HASH_SQL_LENGTH 8192
 #define HINT_LEN 127
+#define FINGERPRINTSZ 16
 
 enum STMT_CACHE_FLAGS {
     STMT_CACHE_NONE = 0,  /* disable statement caching */
@@ -51,6 +52,19 @@ enum query_data_type { QUERY_STMT_DATA = 1, QUERY_HINT_DATA = 2 };
 /* Forward declaration */
 struct sqlclntstate;
 
+/* Shared (process-wide) record of a cached statement, one per fingerprint.
+   The vdbe itself stays in the per-thread cache since it is bound to the
+   sqlite3 handle that prepared it. */
+typedef struct shared_stmt_entry {
+    unsigned char fingerprint[FINGERPRINTSZ];
+    char *zNormSql;
+    int refcnt;            /* thread cache entries referencing this */
+    int64_t hits;          /* executions served from a thread cache */
+    int64_t prepares;      /* times compiled into a thread cache */
+    int64_t invalidations; /* cached copies dropped by schema change */
+    int64_t bytes;         /* memory used by one compiled copy */
+} shared_stmt_entry_t;
+
 typedef int(plugin_query_data_func)(struct sqlclntstate *, void **, int *, int,
                                     int);
 
@@ -64,6 +78,8 @@ typedef struct stmt_cache_entry {
 
     plugin_query_data_func *qd_func; /* Pointer to the current client info */
 
+    shared_stmt_entry_t *shared; /* process-wide stats, may be NULL */
+
     LINKC_T(struct stmt_cache_entry) lnk;
 } stmt_cache_entry_t;
 
@@ -98,4 +114,5 @@ int stmt_cache_find_and_remove_entry(stmt_cache_t *stmt_cache, const char *sql,
 int stmt_cache_add_new_entry(stmt_cache_t *stmt_cache, const char *sql, const char *actual_sql, sqlite3_stmt *stmt,
                              struct sqlclntstate *clnt);
 int stmt_cache_requeue_old_entry(stmt_cache_t *, stmt_cache_entry_t *);
+void shared_stmt_cache_foreach(void (*)(shared_stmt_entry_t *, void *), void *);
 #endif /* !__INCLUDED_SQL_STMT_CACHE_H */
@@ -1396,6 +1396,118 @@ void add_idx_stats(const char *tbl, const char *oldname, const char *newname)
     }
 }
 
+/* stat with its row count (1st field) replaced by count, an sql expression */
+static char *stat1_set_count(const char *count)
+{
+    return sqlite3_mprintf("case when instr(stat, ' ') > 0 "
+                           "then (%s) || substr(stat, instr(stat, ' ')) "
+                           "else cast((%s) as text) end",
+                           count, count);
+}
+
+/* Adjust the row count (1st field of stat) of every sqlite_stat1 entry of
+ * table by delta rows, leaving the per-column selectivities as they are,
+ * and have all nodes reload stats. Used by autoanalyze to keep row counts
+ * current between full analyze runs. A partial index only holds some of the
+ * rows, so its count is scaled by the change in table rows instead. Nothing
+ * is done to sqlite_stat4 samples.
+ */
+int analyze_refresh_stat1_rows(const char *table, int64_t delta)
+{
+    struct sqlclntstate clnt;
+    char *partial = NULL, *full = NULL;
+    char *set_full = NULL, *set_partial = NULL;
+    char *sql = NULL, *sql_partial = NULL;
+    int rc = -1;
+
+    if (NULL == get_dbtable_by_name("sqlite_stat1"))
+        return -1;
+
+    if (delta == 0)
+        return 0;
+
+    /* quoted names of the partial and the other indexes, as in stat1;
+     * analyze saves each index under its old style <table>_ix_<n> name too */
+    rdlock_schema_lk();
+    struct dbtable *tbl = get_dbtable_by_name(table);
+    for (int i = 0; tbl && i < tbl->nix; ++i) {
+        struct schema *ix = tbl->ixschema[i];
+        if (ix->sqlitetag == NULL)
+            continue;
+        char **list = ix->where ? &partial : &full;
+        char *l = sqlite3_mprintf("%s%s%Q,'%q_ix_%d'", *list ? *list : "",
+                                  *list ? "," : "", ix->sqlitetag,
+                                  tbl->tablename, i);
+        sqlite3_free(*list);
+        *list = l;
+    }
+    unlock_schema_lk();
+
+    set_full = sqlite3_mprintf("max(1, cast(stat as integer) + %lld)",
+                               (long long)delta);
+    char *set = stat1_set_count(set_full);
+    if (partial) {
+        sql = sqlite3_mprintf("update sqlite_stat1 set stat = %s where "
+                              "tbl='%q' and (idx is null or idx not in (%s))",
+                              set, table, partial);
+    } else {
+        sql = sqlite3_mprintf("update sqlite_stat1 set stat = %s where "
+                              "tbl='%q'",
+                              set, table);
+    }
+    sqlite3_free(set);
+
+    /* the table's row count is the count of any full index; the partial
+     * ones are left alone if there is none */
+    if (partial && full) {
+        char *rows = sqlite3_mprintf(
+            "(select max(cast(stat as integer)) from sqlite_stat1 where "
+            "tbl='%q' and idx in (%s))",
+            table, full);
+        set_partial = sqlite3_mprintf(
+            "max(1, cast(cast(stat as integer) * (%s + %lld) * 1.0 / %s "
+            "as integer))",
+            rows, (long long)delta, rows);
+        set = stat1_set_count(set_partial);
+        sql_partial = sqlite3_mprintf("update sqlite_stat1 set stat = %s "
+                                      "where tbl='%q' and idx in (%s) and "
+                                      "%s > 0",
+                                      set, table, partial, rows);
+        sqlite3_free(set);
+        sqlite3_free(rows);
+    }
+
+    start_internal_sql_clnt(&clnt);
+    clnt.dbtran.mode = TRANLEVEL_RECOM;
+    rc = run_internal_sql_clnt(&clnt, "begin");
+    if (rc == 0) {
+        /* partial indexes first, they scale by the full indexes' old count */
+        if (sql_partial)
+            rc = run_internal_sql_clnt(&clnt, sql_partial);
+        if (rc == 0)
+            rc = run_internal_sql_clnt(&clnt, sql);
+        rc = run_internal_sql_clnt(&clnt, rc ? "rollback" : "commit") || rc;
+    }
+    end_internal_sql_clnt(&clnt);
+
+    sqlite3_free(sql);
+    sqlite3_free(sql_partial);
+    sqlite3_free(set_full);
+    sqlite3_free(set_partial);
+    sqlite3_free(partial);
+    sqlite3_free(full);
+
+    if (rc) {
+        logmsg(LOGMSG_ERROR, "%s: failed to refresh stat1 for %s rc %d\n",
+               __func__, table, rc);
+        return rc;
+    }
+
+    int bdberr;
+    bdb_llog_analyze(thedb->bdb_env, 1, &bdberr);
+    return 0;
+}
+
 int do_analyze(char *tbl, int percent)
 {
     SBUF2 *sb2 = sbuf2open(fileno(stdout), 0);
@@ -896,6 +896,22 @@ void done_sql_thread(void)
     bdb_temp_table_maybe_reset_priority_thread(thedb->bdb_env, 1);
 }
 
+int gbl_sql_key_projection = 1;
+
+/* Fields of pCur's keys that the statement reads, as set by OP_ColumnsUsed
+   (bit 63 covers fields 63 and up), or 0 if every field must be converted.
+   Write cursors always convert everything since the key may be compared
+   or rewritten as a whole. */
+static inline unsigned long long cursor_col_mask(BtCursor *pCur)
+{
+    if (!gbl_sql_key_projection || !pCur || (pCur->open_flags & BTREE_WRCSR))
+        return 0;
+    return pCur->col_mask;
+}
+
+#define COL_MASK_USED(mask, fnum)                                              \
+    ((mask) == 0 || ((mask) & (1ULL << ((fnum) < 63 ? (fnum) : 63))))
+
 static int ondisk_to_sqlite_tz(struct dbtable *db, struct schema *s, void *inp,
                                int rrn, unsigned long long genid, void *outp,
                                int maxout, int nblobs, void **blob,
@@ -916,6 +932,7 @@ static int ondisk_to_sqlite_tz(struct dbtable *db, struct schema *s, void *inp,
     int ncols = 0;
     int nField;
     int rec_srt_off = gbl_sort_nulls_correctly ? 0 : 1;
+    unsigned long long col_mask = cursor_col_mask(pCur);
 
     /* Raw index optimization */
     if (pCur && pCur->nCookFields >= 0)
@@ -936,9 +953,14 @@ static int ondisk_to_sqlite_tz(struct dbtable *db, struct schema *s, void *inp,
 
     for (fnum = 0; fnum < nField; fnum++) {
         memset(&m[fnum], 0, sizeof(Mem));
-        rc = get_data(pCur, s, in, fnum, &m[fnum], 1, tzname);
-        if (rc)
-            goto done;
+        if (!COL_MASK_USED(col_mask, fnum)) {
+            /* never read by the statement, leave a NULL placeholder */
+            m[fnum].flags = MEM_Null;
+        } else {
+            rc = get_data(pCur, s, in, fnum, &m[fnum], 1, tzname);
+            if (rc)
+                goto done;
+        }
         type[fnum] =
             sqlite3VdbeSerialType(&m[fnum], SQLITE_DEFAULT_FILE_FORMAT, &sz);
         datasz += sz;
@@ -1002,7 +1024,7 @@ done:
     /* revert back the flipped fields */
     for (i = 0; i < nField; i++) {
         f = &s->member[i];
-        if (f->flags & INDEX_DESCEND) {
+        if ((f->flags & INDEX_DESCEND) && COL_MASK_USED(col_mask, i)) {
             xorbuf(in + f->offset + rec_srt_off, f->len - rec_srt_off);
         }
     }
@@ -2996,6 +3018,139 @@ static int cursor_move_index(BtCursor *pCur, int *pRes, int how)
     return outrc;
 }
 
+/* Hash join keys that compare equal in sqlite3VdbeRecordCompare must hash
+ * alike. Numbers hash by value, so 1 and 1.0 meet; text and blobs hash by
+ * their bytes. Values compared through a conversion (comdb2 datetimes,
+ * intervals, small floats) or through a non-binary collation get
+ * HASHJOIN_UNHASHED. The bdb layer shows such keys to every probe, and a
+ * probe that cannot be hashed scans the whole table. */
+#define HASHJOIN_UNHASHED 0
+
+static uint32_t hashjoin_hash(UnpackedRecord *rec, int nField)
+{
+    uint32_t h = 0, fh;
+    i64 iv;
+    double rv;
+    int i;
+
+    for (i = 0; i < nField; i++) {
+        Mem *m = &rec->aMem[i];
+        CollSeq *pColl = rec->pKeyInfo->aColl[i];
+
+        if (m->flags & (MEM_Datetime | MEM_Interval | MEM_Small | MEM_Xor))
+            return HASHJOIN_UNHASHED;
+
+        if (m->flags & MEM_Null) {
+            fh = 1;
+        } else if (m->flags & MEM_Int) {
+            iv = m->u.i;
+            fh = crc32c((uint8_t *)&iv, sizeof(iv));
+        } else if (m->flags & MEM_Real) {
+            rv = m->u.r;
+            if (rv >= -9223372036854775808.0 && rv < 9223372036854775808.0 &&
+                (iv = (i64)rv) == rv)
+                fh = crc32c((uint8_t *)&iv, sizeof(iv));
+            else
+                fh = crc32c((uint8_t *)&rv, sizeof(rv)) ^ 2;
+        } else if (m->flags & MEM_Str) {
+            if (pColl && sqlite3StrICmp(pColl->zName, sqlite3StrBINARY))
+                return HASHJOIN_UNHASHED;
+            fh = crc32c((uint8_t *)m->z, m->n) ^ 3;
+        } else if ((m->flags & (MEM_Blob | MEM_Zero)) == MEM_Blob) {
+            fh = crc32c((uint8_t *)m->z, m->n) ^ 4;
+        } else {
+            return HASHJOIN_UNHASHED;
+        }
+        h = (h ^ fh) * 0x9e3779b1;
+    }
+
+    return (h == HASHJOIN_UNHASHED) ? 1 : h;
+}
+
+/* Step a hash join cursor past entries that merely share the probe's hash */
+static int hashjoin_match(BtCursor *pCur, int rc)
+{
+    struct temptable *tmp = pCur->tmptable;
+    int bdberr = 0;
+
+    while (rc == IX_FND &&
+           sqlite3VdbeRecordCompare(bdb_temp_table_keysize(tmp->cursor),
+                                    bdb_temp_table_key(tmp->cursor),
+                                    tmp->hj_probe) != 0) {
+        rc = bdb_temp_table_next_norewind(thedb->bdb_env, tmp->cursor,
+                                          &bdberr);
+    }
+    return rc;
+}
+
+static int hashjoin_moveto(BtCursor *pCur, UnpackedRecord *pIdxKey, int *pRes)
+{
+    struct temptable *tmp = pCur->tmptable;
+    UnpackedRecord *probe;
+    Mem mem = {{0}};
+    uint32_t hash;
+    int bdberr = 0;
+    int rc;
+
+    /* The seek key lives in vdbe registers; sqlite3BtreeNext needs a copy
+     * of its own. */
+    if (tmp->hj_probe == NULL) {
+        tmp->hj_probe = sqlite3VdbeAllocUnpackedRecord(pCur->pKeyInfo);
+        if (tmp->hj_probe == NULL)
+            return SQLITE_NOMEM;
+    }
+    sqlite3VdbeRecordPack(pIdxKey, &mem);
+    free(tmp->hj_probe_key);
+    tmp->hj_probe_key = malloc(mem.n);
+    if (tmp->hj_probe_key == NULL) {
+        sqlite3VdbeMemRelease(&mem);
+        return SQLITE_NOMEM;
+    }
+    memcpy(tmp->hj_probe_key, mem.z, mem.n);
+    sqlite3VdbeRecordUnpack(pCur->pKeyInfo, mem.n, tmp->hj_probe_key,
+                            tmp->hj_probe);
+    sqlite3VdbeMemRelease(&mem);
+
+    probe = tmp->hj_probe;
+    if (probe->nField > pIdxKey->nField)
+        probe->nField = pIdxKey->nField;
+    probe->default_rc = 0;
+    tmp->hj_seeking = 1;
+
+    hash = HASHJOIN_UNHASHED;
+    if (probe->nField >= tmp->nHashField)
+        hash = hashjoin_hash(probe, tmp->nHashField);
+    if (hash == HASHJOIN_UNHASHED)
+        rc = bdb_temp_table_first(thedb->bdb_env, tmp->cursor, &bdberr);
+    else
+        rc = bdb_temp_hashjoin_find(thedb->bdb_env, tmp->cursor, hash,
+                                    &bdberr);
+
+    rc = hashjoin_match(pCur, rc);
+    if (rc == IX_FND) {
+        *pRes = 0;
+        return SQLITE_OK;
+    }
+    if (rc == IX_NOTFND || rc == IX_PASTEOF || rc == IX_EMPTY) {
+        /* nothing to join; OP_SeekGE checks sqlite3BtreeEof */
+        pCur->empty = 1;
+        *pRes = -1;
+        return SQLITE_OK;
+    }
+    logmsg(LOGMSG_ERROR, "%s: hash join probe rc %d bdberr %d\n", __func__, rc,
+           bdberr);
+    return SQLITE_INTERNAL;
+}
+
+/* OP_OpenAutoindex tells a hash join build table how many leading columns
+ * make up its hash key. */
+void sqlite3BtreeCursorHashJoin(BtCursor *pCur, int nField)
+{
+    if (pCur->cursor_class == CURSORCLASS_TEMPTABLE &&
+        bdb_is_hashjoin(pCur->tmptable->tbl))
+        pCur->tmptable->nHashField = nField;
+}
+
 static int tmptbl_cursor_move(BtCursor *pCur, int *pRes, int how)
 {
     int bdberr = 0;
@@ -3008,6 +3163,7 @@ static int tmptbl_cursor_move(BtCursor *pCur, int *pRes, int how)
 
     switch (how) {
     case CFIRST:
+        pCur->tmptable->hj_seeking = 0;
         rc = bdb_temp_table_first(thedb->bdb_env, pCur->tmptable->cursor,
                                   &bdberr);
         break;
@@ -3025,6 +3181,8 @@ static int tmptbl_cursor_move(BtCursor *pCur, int *pRes, int how)
     case CNEXT:
         rc = bdb_temp_table_next_norewind(thedb->bdb_env,
                                           pCur->tmptable->cursor, &bdberr);
+        if (pCur->tmptable->hj_seeking)
+            rc = hashjoin_match(pCur, rc);
         break;
     }
 
@@ -5600,12 +5758,16 @@ int sqlite3BtreeCreateTable(Btree *pBt, int *piTable, int flags)
     if (pBt->is_hashtable) {
         pNewTbl->tbl = bdb_temp_hashtable_create(thedb->bdb_env, &bdberr);
         if (pNewTbl->tbl != NULL) ATOMIC_ADD32(gbl_sql_temptable_count, 1);
+    } else if (flags & BTREE_HASHJOIN) {
+        pNewTbl->tbl = bdb_temp_hashjoin_create(thedb->bdb_env, &bdberr);
+        if (pNewTbl->tbl != NULL) ATOMIC_ADD32(gbl_sql_temptable_count, 1);
     } else if (tmptbl_clone) {
         pNewTbl->sp_tmptbl = tmptbl_clone->sp_tmptbl;
         pNewTbl->tbl = tmptbl_clone->tbl;
         pNewTbl->owner = tmptbl_clone->owner;
     } else {
-        pNewTbl->tbl = bdb_temp_table_create(thedb->bdb_env, &bdberr);
+        pNewTbl->tbl = bdb_temp_table_create_flags(
+            thedb->bdb_env, BDB_TEMP_TABLE_SKIPLIST, &bdberr);
         if (pNewTbl->tbl != NULL) ATOMIC_ADD32(gbl_sql_temptable_count, 1);
     }
     if (pNewTbl->tbl == NULL) {
@@ -5958,7 +6120,9 @@ int sqlite3BtreeMovetoUnpacked(BtCursor *pCur, /* The cursor to be moved */
     pCur->prev_is_eof = 0;
 
     if (pCur->bt->is_temporary) {
-        if (pIdxKey) {
+        if (pIdxKey && pCur->tmptable->nHashField) {
+            return hashjoin_moveto(pCur, pIdxKey, pRes);
+        } else if (pIdxKey) {
             if (bdb_is_hashtable(pCur->tmptable->tbl)) {
                 Mem mem = {{0}};
                 sqlite3VdbeRecordPack(pIdxKey, &mem);
@@ -6750,6 +6914,10 @@ int sqlite3BtreeCloseCursor(BtCursor *pCur)
                     goto done;
                 }
             }
+            if (pCur->tmptable && pCur->tmptable->hj_probe)
+                sqlite3DbFree(pCur->pKeyInfo->db, pCur->tmptable->hj_probe);
+            if (pCur->tmptable)
+                free(pCur->tmptable->hj_probe_key);
             free(pCur->tmptable);
             pCur->tmptable = NULL;
         }
@@ -8535,6 +8703,11 @@ sqlite3BtreeCursor_cursor(Btree *pBt,      /* The btree */
         return rc;
     }
 
+    if (clnt->scan_nshards > 1 && cur->ixnum == -1 &&
+        strcasecmp(cur->db->tablename, clnt->scan_shard_tbl) == 0)
+        cur->bdbcur->setstripeshard(cur->bdbcur, clnt->scan_shard,
+                                    clnt->scan_nshards);
+
     if (gbl_expressions_indexes && !sqlite3_stmt_readonly((sqlite3_stmt *)cur->vdbe) && cur->db->ix_expr) {
         if (!clnt->idxInsert)
             clnt->idxInsert = calloc(MAXINDEX, sizeof(uint8_t *));
@@ -9068,7 +9241,13 @@ int sqlite3BtreeInsert(
             sqlite3VdbeRecordUnpack(pCur->pKeyInfo, nKey, pKey, rec);
         }
 
-        if (pCur->ixnum == -1) {
+        if (rec && pCur->tmptable->nHashField) {
+            /* hash join build side: the key is the whole row */
+            rc = bdb_temp_hashjoin_put(
+                thedb->bdb_env, pCur->tmptable->tbl,
+                hashjoin_hash(rec, pCur->tmptable->nHashField), (void *)pKey,
+                nKey, &bdberr);
+        } else if (pCur->ixnum == -1) {
             /* data */
             rc = pCur->cursor_put(thedb->bdb_env, pCur->tmptable->tbl,
                                   (void *)&nKey, sizeof(unsigned long long),
@@ -11008,7 +11187,7 @@ int sqlite3BtreeCount(BtCursor *pCur, i64 *pnEntry)
         rc = SQLITE_OK;
     } else if (pCur->cursor_count) {
         rc = pCur->cursor_count(pCur, &count);
-    } else if (gbl_direct_count && !clnt->intrans &&
+    } else if (gbl_direct_count && !clnt->intrans && clnt->scan_nshards <= 1 &&
                clnt->dbtran.mode != TRANLEVEL_SNAPISOL &&
                clnt->dbtran.mode != TRANLEVEL_SERIAL &&
                (pCur->cursor_class == CURSORCLASS_TABLE ||
@@ -5439,6 +5439,7 @@ void reset_clnt(struct sqlclntstate *clnt, int initial)
     clnt->sqltick = 0;
     clnt->rowbuffer = 1;
     clnt->flat_col_vals = 0;
+    clnt->row_batch = 0;
     clnt->request_fp = 0;
     clnt->can_redirect_fdb = 0;
     clnt->force_fdb_push_redirect = 0;
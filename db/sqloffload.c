@@ -600,6 +600,7 @@ int osql_clean_sqlclntstate(struct sqlclntstate *clnt)
 
     if (osql->tablename)
         free(osql->tablename);
+    osql_batch_free(&osql->target);
     if (!osql_shadtbl_empty(clnt))
         osql_shadtbl_close(clnt);
     if (osql->history)
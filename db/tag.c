@@ -60,6 +60,7 @@
 #include "schemachange.h" /* sc_errf() */
 #include "dynschematypes.h"
 #include "fdb_fend.h"
+#include "comdb2_atomic.h"
 
 extern struct dbenv *thedb;
 extern pthread_mutex_t csc2_subsystem_mtx;
@@ -70,6 +71,7 @@ const int gbl_ondisk_ver_len = sizeof ".ONDISK.VER.255xx";
 
 int _dbg_tags = 0;
 int gbl_debug_alter_sequences_sleep = 0;
+int gbl_schema_conv_progs = 1;
 
 #define TAGLOCK_RW_LOCK
 #ifdef TAGLOCK_RW_LOCK
@@ -1546,6 +1548,8 @@ struct schema * alloc_schema(char *tag, int nmembers, int flags)
         free(tag);
         return NULL;
     }
+    static unsigned schema_gen = 0;
+    to->gen = ATOMIC_ADD32(schema_gen, 1);
     to->tag = tag;
     to->nmembers = nmembers;
     to->member = calloc(to->nmembers, sizeof(struct field));
@@ -1987,6 +1991,163 @@ int static_tag_blob_conversion(const struct schema *scm, void *record, blob_buff
     return 0;
 }
 
+/*
+ * Conversion programs.
+ *
+ * Converting a record from one schema to another looks up every
+ * target field by name in the source schema and dispatch on the type pair
+ * for every row.  A program resolves that once per (from, to) pair: one
+ * step per target field holding the source field and the kernel to run.
+ * Fields whose server-to-server conversion is a plain byte copy (same type
+ * and length) are copied directly; everything else goes through
+ * stag_to_stag_field() with the source index already resolved.
+ *
+ * Programs hang off the target schema and are freed with either schema.
+ * They are keyed by the source schema's address and generation, so a schema
+ * reallocated at the same address never matches a stale program.
+ *
+ * Lookups walk to->convprogs without a lock; a program is fully built
+ * before the atomic store that publishes it.  Programs are only unlinked
+ * and freed when a schema is freed, which happens under the schema write
+ * lock, so no lockless walker can be on them.
+ */
+enum { CONV_GENERIC = 0, CONV_COPY = 1, CONV_COPY_XOR = 2 };
+
+#define MAX_CONV_PROGS 32
+
+struct convprog_step {
+    int from_idx; /* -1 if the target field is not in the source */
+    int kernel;
+};
+
+struct convprog {
+    const struct schema *from;
+    struct schema *to;
+    unsigned from_gen;
+    struct convprog *next; /* in to->convprogs */
+    LINKC_T(struct convprog) lnk; /* in all_convprogs */
+    int nsteps;
+    struct convprog_step step[];
+};
+
+static pthread_mutex_t convprog_lk = PTHREAD_MUTEX_INITIALIZER;
+/* every cached program, so that a freed source schema finds its own */
+static LISTC_T(struct convprog) all_convprogs;
+static int all_convprogs_inited;
+
+/* Drop the programs converting into or out of a schema being freed */
+static void free_conv_progs(struct schema *schema)
+{
+    struct convprog *p, *tmp, **pp;
+
+    Pthread_mutex_lock(&convprog_lk);
+    if (!all_convprogs_inited) {
+        Pthread_mutex_unlock(&convprog_lk);
+        return;
+    }
+    LISTC_FOR_EACH_SAFE(&all_convprogs, p, tmp, lnk)
+    {
+        if (p->to != schema && p->from != schema)
+            continue;
+        for (pp = &p->to->convprogs; *pp != p; pp = &(*pp)->next)
+            ;
+        (void)XCHANGE64(*pp, p->next);
+        p->to->nconvprogs--;
+        listc_rfl(&all_convprogs, p);
+        free(p);
+    }
+    Pthread_mutex_unlock(&convprog_lk);
+}
+
+/* server types whose same-type, same-length conversion is a memcpy */
+static inline int conv_is_plain_copy(int type)
+{
+    switch (type) {
+    case SERVER_BINT:
+    case SERVER_BREAL:
+    case SERVER_INTVYM:
+    case SERVER_INTVDS:
+    case SERVER_INTVDSUS:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static struct convprog *compile_conv_prog(struct schema *from,
+                                          struct schema *to)
+{
+    struct convprog *p =
+        calloc(1, offsetof(struct convprog, step) +
+                      to->nmembers * sizeof(struct convprog_step));
+    if (!p)
+        return NULL;
+    p->from = from;
+    p->to = to;
+    p->from_gen = from->gen;
+    p->nsteps = to->nmembers;
+    for (int i = 0; i < to->nmembers; i++) {
+        struct field *to_field = &to->member[i];
+        struct convprog_step *step = &p->step[i];
+        step->from_idx = (from == to)
+                             ? i
+                             : find_field_idx_in_tag(from, to_field->name);
+        step->kernel = CONV_GENERIC;
+        if (step->from_idx < 0 || to_field->isExpr)
+            continue;
+        if (gbl_replicate_local &&
+            strcasecmp(to_field->name, "comdb2_seqno") == 0)
+            continue;
+        struct field *from_field = &from->member[step->from_idx];
+        if (from_field->type != to_field->type ||
+            from_field->len != to_field->len ||
+            !conv_is_plain_copy(to_field->type))
+            continue;
+        step->kernel = ((from_field->flags & INDEX_DESCEND) !=
+                        (to_field->flags & INDEX_DESCEND))
+                           ? CONV_COPY_XOR
+                           : CONV_COPY;
+    }
+    return p;
+}
+
+/* Return the cached program converting from -> to, compiling it on first
+ * use.  NULL means use the interpreted path (programs disabled, dynamic
+ * tags, or too many programs already cached for this target). */
+static const struct convprog *get_conv_prog(struct schema *from,
+                                            struct schema *to)
+{
+    struct convprog *p;
+
+    if (!gbl_schema_conv_progs || (from->flags & SCHEMA_DYNAMIC) ||
+        (to->flags & SCHEMA_DYNAMIC))
+        return NULL;
+
+    for (p = ATOMIC_LOAD64(to->convprogs); p; p = ATOMIC_LOAD64(p->next)) {
+        if (p->from == from && p->from_gen == from->gen)
+            return p;
+    }
+
+    Pthread_mutex_lock(&convprog_lk);
+    for (p = to->convprogs; p; p = p->next) {
+        if (p->from == from && p->from_gen == from->gen)
+            break;
+    }
+    if (p == NULL && to->nconvprogs < MAX_CONV_PROGS &&
+        (p = compile_conv_prog(from, to)) != NULL) {
+        if (!all_convprogs_inited) {
+            listc_init(&all_convprogs, offsetof(struct convprog, lnk));
+            all_convprogs_inited = 1;
+        }
+        listc_abl(&all_convprogs, p);
+        p->next = to->convprogs;
+        (void)XCHANGE64(to->convprogs, p);
+        to->nconvprogs++;
+    }
+    Pthread_mutex_unlock(&convprog_lk);
+    return p;
+}
+
 /* Form server side record from client record.
 *
 * Inputs:
@@ -2110,11 +2271,13 @@ static int ctag_to_stag_int(struct dbtable *table, const char *ctag,
         }
     }
 
+    const struct convprog *prog = get_conv_prog(from, to);
     for (field = 0; field < to->nmembers; field++) {
         int outdtsz = 0;
         blob_buffer_t *outblob = NULL;
         to_field = &to->member[field];
-        field_idx = find_field_idx_in_tag(from, to_field->name);
+        field_idx = prog ? prog->step[field].from_idx
+                         : find_field_idx_in_tag(from, to_field->name);
         /* field in index set to be descending if converting from
            a client index and that field is marked descending
            */
@@ -3553,6 +3716,75 @@ int stag_set_key_null(struct dbtable *table, const char *tag, const char *inkey,
     return 0;
 }
 
+static int run_conv_prog(const struct convprog *prog,
+                         const struct dbtable *tbl, struct schema *fromsch,
+                         struct schema *tosch, const char *inbuf, char *outbuf,
+                         int flags, struct convert_failure *fail_reason,
+                         blob_buffer_t *inblobs, blob_buffer_t *outblobs,
+                         int maxblobs, const char *tzname)
+{
+    int rec_srt_off = gbl_sort_nulls_correctly ? 0 : 1;
+
+    for (int field = 0; field < prog->nsteps; field++) {
+        const struct convprog_step *step = &prog->step[field];
+        if (step->kernel == CONV_GENERIC) {
+            int rc = stag_to_stag_field(tbl, inbuf, outbuf, flags, fail_reason,
+                                        inblobs, outblobs, maxblobs, tzname,
+                                        step->from_idx, field, fromsch, tosch);
+            if (rc)
+                return rc;
+            continue;
+        }
+        struct field *from_field = &fromsch->member[step->from_idx];
+        struct field *to_field = &tosch->member[field];
+        if (field_is_null(fromsch, from_field, inbuf)) {
+            /* nulls are normalised (or rejected) by the generic path */
+            int rc = stag_to_stag_field(tbl, inbuf, outbuf, flags, fail_reason,
+                                        inblobs, outblobs, maxblobs, tzname,
+                                        step->from_idx, field, fromsch, tosch);
+            if (rc)
+                return rc;
+            continue;
+        }
+        memcpy(outbuf + to_field->offset, inbuf + from_field->offset,
+               to_field->len);
+        if (step->kernel == CONV_COPY_XOR)
+            xorbuf(outbuf + to_field->offset + rec_srt_off,
+                   to_field->len - rec_srt_off);
+    }
+    return 0;
+}
+
+/* Convert with a compiled program, or field by field if prog is NULL */
+static int stag_to_stag_conv(const struct convprog *prog,
+                             const struct dbtable *tbl, struct schema *fromsch,
+                             struct schema *tosch, const char *inbuf,
+                             char *outbuf, int flags,
+                             struct convert_failure *fail_reason,
+                             blob_buffer_t *inblobs, blob_buffer_t *outblobs,
+                             int maxblobs, const char *tzname)
+{
+    if (prog)
+        return run_conv_prog(prog, tbl, fromsch, tosch, inbuf, outbuf, flags,
+                             fail_reason, inblobs, outblobs, maxblobs, tzname);
+
+    for (int field = 0; field < tosch->nmembers; field++) {
+        int field_idx;
+
+        if (fromsch == tosch) {
+            field_idx = field;
+        } else {
+            field_idx = find_field_idx_in_tag(fromsch, tosch->member[field].name);
+        }
+        int rc = stag_to_stag_field(tbl, inbuf, outbuf, flags, fail_reason, inblobs,
+                                    outblobs, maxblobs, tzname, field_idx,
+                                    field, fromsch, tosch);
+        if (rc)
+            return rc;
+    }
+    return 0;
+}
+
 /*
  * On success only outblobs will be valid, there is no need to free up inblobs.
  * On failure the caller should free inblobs and outblobs.
@@ -3577,21 +3809,9 @@ static int _stag_to_stag_buf_flags_blobs(const struct dbtable *tbl, struct schem
         fail_reason->target_schema = tosch;
     }
 
-    for (int field = 0; field < tosch->nmembers; field++) {
-        int field_idx;
-
-        if (fromsch == tosch) {
-            field_idx = field;
-        } else {
-            field_idx = find_field_idx_in_tag(fromsch, tosch->member[field].name);
-        }
-        int rc = stag_to_stag_field(tbl, inbuf, outbuf, flags, fail_reason, inblobs,
-                                    outblobs, maxblobs, tzname, field_idx,
-                                    field, fromsch, tosch);
-        if (rc)
-            return rc;
-    }
-    return 0;
+    return stag_to_stag_conv(get_conv_prog(fromsch, tosch), tbl, fromsch, tosch,
+                             inbuf, outbuf, flags, fail_reason, inblobs,
+                             outblobs, maxblobs, tzname);
 }
 
 int *get_tag_mapping(struct schema *fromsch, struct schema *tosch)
@@ -3657,13 +3877,19 @@ int stag_to_stag_buf_cachedmap(const struct dbtable *tbl, int tagmap[],
         maxblobs = 0;
     }
 
-    for (int field = 0; field < to->nmembers; field++) {
-        rc = stag_to_stag_field(tbl, inbuf, outbuf, flags, fail_reason, inblobs,
-                                p_newblobs, maxblobs, NULL, tagmap[field],
-                                field, from, to);
+    const struct convprog *prog = get_conv_prog(from, to);
+    if (prog) {
+        rc = run_conv_prog(prog, tbl, from, to, inbuf, outbuf, flags,
+                           fail_reason, inblobs, p_newblobs, maxblobs, NULL);
+    } else {
+        for (int field = 0; field < to->nmembers; field++) {
+            rc = stag_to_stag_field(tbl, inbuf, outbuf, flags, fail_reason,
+                                    inblobs, p_newblobs, maxblobs, NULL,
+                                    tagmap[field], field, from, to);
 
-        if (rc)
-            break;
+            if (rc)
+                break;
+        }
     }
 
     if (inblobs) /* if we were given blobs */
@@ -6135,6 +6361,7 @@ static void freeschema_internals(struct schema *schema)
         freeschema(schema->partial_datacopy, 0);
         schema->partial_datacopy = NULL;
     }
+    free_conv_progs(schema);
 }
 
 void freeschema(struct schema *schema, int free_ix)
@@ -6222,6 +6449,7 @@ void freedb_int(dbtable *db, dbtable *replace)
     free(db->ixschema);
     if (db->sc_genids)
         free(db->sc_genids);
+    free(db->sc_ranges);
 
     if (db->instant_schema_change) {
         for (i = 0; i < sizeof db->dbstore / sizeof db->dbstore[0]; ++i) {
@@ -6845,3 +7073,180 @@ const char *sc_tag_change_subtype_text(sc_tag_change_subtype subtype)
         subtype = SC_TAG_CHANGE_UNKNOWN;
     return reasons[subtype];
 }
+
+static double conv_bench_run(struct dbtable *db, const struct convprog *prog,
+                             struct schema *from, struct schema *to,
+                             const char *rec, char *out, int nrows)
+{
+    int64_t start = comdb2_time_epochus();
+    for (int i = 0; i < nrows; i++)
+        stag_to_stag_conv(prog, db, from, to, rec, out, 0, NULL, NULL, NULL, 0,
+                          NULL);
+    int64_t elapsed = comdb2_time_epochus() - start;
+    return elapsed > 0 ? (double)nrows * 1000000 / elapsed : 0;
+}
+
+#define CONV_BENCH_NRECS 16
+
+/* Fill record n of the conversion check.  Record 0 is all NULL; the others
+ * set every field from a string derived from n, except for a few NULLs and
+ * whatever a string can't be converted to (blobs), which stay NULL. */
+static void conv_bench_fill(struct schema *sc, char *rec, int n)
+{
+    char buf[64];
+
+    for (int i = 0; i < sc->nmembers; i++) {
+        struct field *f = &sc->member[i];
+        int outdtsz = 0;
+        int rc = -1;
+
+        switch (f->type) {
+        case SERVER_DATETIME:
+        case SERVER_DATETIMEUS:
+            snprintf(buf, sizeof(buf), "2024-%02d-%02dT%02d%02d%02d.%06d UTC",
+                     n % 12 + 1, n % 28 + 1, n % 24, n * 7 % 60, n * 13 % 60,
+                     n * 104729 % 1000000);
+            break;
+        case SERVER_INTVYM:
+            snprintf(buf, sizeof(buf), "%s%d-%d", n % 3 ? "" : "-", n, n % 12);
+            break;
+        case SERVER_INTVDS:
+        case SERVER_INTVDSUS:
+            snprintf(buf, sizeof(buf), "%s%d %02d:%02d:%02d.%06d",
+                     n % 3 ? "" : "-", n, n % 24, n % 60, n * 7 % 60,
+                     n * 104729 % 1000000);
+            break;
+        case SERVER_DECIMAL:
+        case SERVER_BREAL:
+            snprintf(buf, sizeof(buf), "%s%d.%03d", n % 3 ? "" : "-", n * 977,
+                     n * 31 % 1000);
+            break;
+        case SERVER_UINT:
+            snprintf(buf, sizeof(buf), "%d", n * 7919);
+            break;
+        default:
+            snprintf(buf, sizeof(buf), "%s%d", n % 3 ? "" : "-", n * 7919);
+            break;
+        }
+        if (n > 0 && ((n + i) % 5 != 0 || (f->flags & NO_NULL)))
+            rc = CLIENT_to_SERVER(buf, strlen(buf) + 1, CLIENT_CSTR, 0, NULL,
+                                  NULL, rec + f->offset, f->len, f->type, 0,
+                                  &outdtsz, &f->convopts, NULL);
+        if (rc)
+            NULL_to_SERVER(rec + f->offset, f->len, f->type);
+    }
+}
+
+/* Convert every check record from -> to field by field and with prog.
+ * Returns the number of records on which the two disagree, in return code
+ * or in any byte of the output. */
+static int conv_bench_compare(struct dbtable *db, const struct convprog *prog,
+                              struct schema *from, struct schema *to,
+                              char *rec, char *out1, char *out2, int outlen)
+{
+    int nbad = 0;
+
+    for (int n = 0; n < CONV_BENCH_NRECS; n++) {
+        conv_bench_fill(from, rec, n);
+        memset(out1, 0, outlen);
+        memset(out2, 0, outlen);
+        int rc1 = stag_to_stag_conv(NULL, db, from, to, rec, out1, 0, NULL,
+                                    NULL, NULL, 0, NULL);
+        int rc2 = stag_to_stag_conv(prog, db, from, to, rec, out2, 0, NULL,
+                                    NULL, NULL, 0, NULL);
+        if (rc1 != rc2 || (rc1 == 0 && memcmp(out1, out2, outlen) != 0)) {
+            logmsg(LOGMSG_ERROR,
+                   "%s %s -> %s: record %d converts differently (rc %d vs %d)\n",
+                   db->tablename, from->tag, to->tag, n, rc1, rc2);
+            nbad++;
+        }
+    }
+    return nbad;
+}
+
+/* Check that record -> key and record -> record conversions of a table come
+ * out byte for byte the same with the interpreted and the compiled conversion
+ * paths, then time both.  The schema_conversion_programs tunable is left
+ * alone: each path is picked per call. */
+void schema_conversion_bench(const char *tablename, int nrows)
+{
+    struct dbtable *db = get_dbtable_by_name(tablename);
+    if (db == NULL) {
+        logmsg(LOGMSG_ERROR, "%s: no such table %s\n", __func__, tablename);
+        return;
+    }
+    struct schema *ondisk = get_schema(db, -1);
+    if (ondisk == NULL)
+        return;
+
+    int reclen = get_size_of_schema(ondisk);
+    int outlen = reclen > MAXKEYLEN ? reclen : MAXKEYLEN;
+    char *rec = calloc(1, reclen);
+    char *out = calloc(1, outlen);
+    char *out2 = calloc(1, outlen);
+    if (rec == NULL || out == NULL || out2 == NULL)
+        goto done;
+
+    int nbad = 0;
+    for (int ixnum = -1; ixnum < db->nix; ixnum++) {
+        struct schema *to = ondisk;
+        if (ixnum >= 0) {
+            int isexpr = 0;
+            to = get_schema(db, ixnum);
+            for (int i = 0; to && i < to->nmembers; i++)
+                isexpr |= to->member[i].isExpr;
+            if (to == NULL || isexpr) {
+                logmsg(LOGMSG_USER, "%s: skipping index %d\n", __func__,
+                       ixnum);
+                continue;
+            }
+        }
+        struct convprog *prog = compile_conv_prog(ondisk, to);
+        if (prog == NULL)
+            goto done;
+        nbad += conv_bench_compare(db, prog, ondisk, to, rec, out, out2,
+                                   get_size_of_schema(to));
+
+        conv_bench_fill(ondisk, rec, 1);
+        double interp = conv_bench_run(db, NULL, ondisk, to, rec, out, nrows);
+        double compiled = conv_bench_run(db, prog, ondisk, to, rec, out, nrows);
+        free(prog);
+        logmsg(LOGMSG_USER,
+               "%s %s -> %s: %d rows, interpreted %.0f rows/sec, "
+               "compiled %.0f rows/sec\n",
+               tablename, ondisk->tag, to->tag, nrows, interp, compiled);
+    }
+
+    /* A dynamic tag is never given a cached program, and converts the same
+     * from a copy of the record schema either way */
+    struct schema *dyn = clone_schema(ondisk);
+    if (dyn == NULL)
+        goto done;
+    dyn->flags |= SCHEMA_DYNAMIC;
+    struct convprog *prog = compile_conv_prog(dyn, ondisk);
+    if (get_conv_prog(dyn, ondisk) != NULL) {
+        logmsg(LOGMSG_ERROR, "%s: dynamic schema got a cached program\n",
+               tablename);
+        nbad++;
+    }
+    if (prog) {
+        nbad += conv_bench_compare(db, prog, dyn, ondisk, rec, out, out2,
+                                   reclen);
+        free(prog);
+    }
+    for (int i = 0; i < dyn->nix; i++)
+        freeschema(dyn->ix[i], 0);
+    free(dyn->ix);
+    freeschema(dyn, 0);
+
+    if (nbad == 0)
+        logmsg(LOGMSG_USER, "%s: conversion paths agree\n", tablename);
+    else
+        logmsg(LOGMSG_ERROR, "%s: conversion paths disagree on %d records\n",
+               tablename, nbad);
+
+done:
+    free(rec);
+    free(out);
+    free(out2);
+}
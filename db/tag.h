@@ -24,6 +24,7 @@
 
 struct ireq;
 struct dbtable;
+struct convprog;
 
 /* libcmacc2 populates these structures.
    Schema records are added from upon parsing a "csc" directive.
@@ -74,6 +75,9 @@ struct schema {
     char *sqlitetag;
     int *datacopy;
     char *where;
+    unsigned gen;                  /* unique per allocated schema */
+    struct convprog *convprogs;    /* compiled conversions into this schema */
+    int nconvprogs;
 #if defined STACK_TAG_SCHEMA
     int frames;
     void *buf[MAX_TAG_STACK_FRAMES];
@@ -462,6 +466,7 @@ int load_csc2_versions(struct dbtable *table, tran_type *tran);
 
 /* NOTE: tag is already strdup-ed */
 struct schema * alloc_schema(char *tag, int nmembers, int flags);
+void schema_conversion_bench(const char *tablename, int nrows);
 
 /* return how many tags a table has */
 int get_table_tags_count(const char *tblname, int columns);
@@ -156,6 +156,8 @@ struct dbconsumer_t {
     struct bdb_queue_cursor last;
     struct bdb_queue_cursor fnd;
     genid_t genid;
+    genid_t *batch; /* ids of the events returned by get_batch() */
+    int nbatch;
     int push_tid;
     int push_seq;
     int push_epoch;
@@ -185,6 +187,7 @@ static void reset_sp(SP);
 static void setup_clnt_for_sp(struct sqlclntstate *);
 
 static const int dbq_delay_ms = 1000; // ms
+static const int dbq_max_batch = 1000;
 
 static struct timespec setup_dbq_ts(int delay_ms)
 {
@@ -663,6 +666,65 @@ char *sp_column_name(struct response_data *arg, int col)
     return parent->clntname[col];
 }
 
+// Call with q->lock held.
+// Unlocks q->lock on return.
+// Returns  -2:stopped -1:error  0:IX_NOTFND  1:IX_FND
+// If IX_FND will push a Lua array of up to maxitems events on stack.
+static int dbq_poll_batch_int(Lua L, dbconsumer_t *q, int maxitems, size_t maxbytes)
+{
+    SP sp = getsp(L);
+    struct sqlclntstate *clnt = sp->clnt;
+    struct bdb_queue_found **items = malloc(maxitems * sizeof(*items));
+    struct bdb_queue_cursor *cursors = malloc(maxitems * sizeof(*cursors));
+    long long *seqs = malloc(maxitems * sizeof(*seqs));
+    int n = 0;
+    int rc = -1;
+    if (items && cursors && seqs) {
+        rc = dbq_get_batch(&q->iq, 0, &q->last, maxitems, maxbytes, items, cursors, seqs, &n,
+                           bdb_get_lid_from_cursortran(clnt->dbtran.cursor_tran));
+    }
+    Pthread_mutex_unlock(q->lock);
+    comdb2_sql_tick_no_recover_deadlock();
+    sp->num_instructions = 0;
+    if (!items || !cursors || !seqs) {
+        luabb_error(L, sp, "failed to allocate batch of %d events", maxitems);
+        rc = -1;
+    } else if (rc == 0) {
+        genid_t *batch = realloc(q->batch, n * sizeof(genid_t));
+        if (batch == NULL) {
+            luabb_error(L, sp, "failed to allocate batch of %d events", n);
+            rc = -1;
+            goto out;
+        }
+        q->batch = batch;
+        q->nbatch = 0;
+        lua_createtable(L, n, 0);
+        for (int i = 0; i < n; ++i) {
+            char *err;
+            struct qfound f = {.item = items[i], .seq = seqs[i]};
+            q->fnd = cursors[i];
+            if ((rc = push_trigger_args_int(L, q, &f, &err)) != 1) {
+                luabb_error(L, sp, err);
+                free(err);
+                goto out;
+            }
+            q->batch[q->nbatch++] = q->genid;
+            lua_rawseti(L, -2, i + 1);
+        }
+        rc = 1;
+    } else if (rc == IX_NOTFND) {
+        rc = 0;
+    } else {
+        rc = -1;
+    }
+out:
+    for (int i = 0; i < n; ++i) free(items[i]);
+    free(items);
+    free(cursors);
+    free(seqs);
+    return rc;
+}
+
 // Call with q->lock held.
 // Unlocks q->lock on return.
 // Returns  -2:stopped -1:error  0:IX_NOTFND  1:IX_FND
@@ -682,6 +744,7 @@ static int dbq_poll_int(Lua L, dbconsumer_t *q)
     sp->num_instructions = 0;
     if (rc == 0) {
         char *err;
+        q->nbatch = 0;
         rc = push_trigger_args_int(L, q, &f, &err);
         free(f.item);
         if (rc != 1) {
@@ -697,7 +760,8 @@ static int dbq_poll_int(Lua L, dbconsumer_t *q)
     return -1;
 }
 
-static int dbq_poll(Lua L, dbconsumer_t *q, int delay_ms)
+// maxitems > 0 asks for an array of events, see dbq_poll_batch_int()
+static int dbq_poll(Lua L, dbconsumer_t *q, int delay_ms, int maxitems, size_t maxbytes)
 {
     SP sp = getsp(L);
     while (1) {
@@ -716,7 +780,8 @@ static int dbq_poll(Lua L, dbconsumer_t *q, int delay_ms)
         }
 again:  status = *q->status;
         if (status == TRIGGER_SUBSCRIPTION_OPEN) {
-            rc = dbq_poll_int(L, q); // call will release q->lock
+            // call will release q->lock
+            rc = maxitems ? dbq_poll_batch_int(L, q, maxitems, maxbytes) : dbq_poll_int(L, q);
         } else if (status == TRIGGER_SUBSCRIPTION_PAUSED) {
             if (stop_waiting(L, q)) {
                 Pthread_mutex_unlock(q->lock);
@@ -758,7 +823,7 @@ again:  status = *q->status;
 static int dbconsumer_get_int(Lua L, dbconsumer_t *q)
 {
     int rc;
-    while ((rc = dbq_poll(L, q, dbq_delay_ms)) == 0)
+    while ((rc = dbq_poll(L, q, dbq_delay_ms, 0, 0)) == 0)
         ;
     return rc;
 }
@@ -823,13 +888,42 @@ static int dbconsumer_poll(Lua L)
     if (delay_ms < 0) {
         delay_ms = 0;
     }
-    int rc = dbq_poll(L, q, delay_ms);
+    int rc = dbq_poll(L, q, delay_ms, 0, 0);
     if (rc >= 0) {
         return rc;
     }
     return luaL_error(L, getsp(L)->error);
 }
 
+// q:get_batch(n [, bytes]) blocks like q:get() until there is an event,
+// then returns an array of up to n events (fewer once their payloads add up
+// to bytes), all read in one pass over the queue.
+static int dbconsumer_get_batch(Lua L)
+{
+    dbconsumer_t *q = luaL_checkudata(L, 1, dbtypes.dbconsumer);
+    lua_Number arg = luaL_checknumber(L, 2);
+    lua_Integer maxitems, maxbytes = 0;
+    lua_number2integer(maxitems, arg);
+    if (!lua_isnoneornil(L, 3)) {
+        arg = luaL_checknumber(L, 3);
+        lua_number2integer(maxbytes, arg);
+    }
+    if (maxitems <= 0) {
+        return luaL_error(L, "bad argument for batch size");
+    }
+    if (maxitems > dbq_max_batch) {
+        maxitems = dbq_max_batch;
+    }
+    if (maxbytes < 0) {
+        maxbytes = 0;
+    }
+    int rc;
+    while ((rc = dbq_poll(L, q, dbq_delay_ms, maxitems, maxbytes)) == 0)
+        ;
+    if (rc > 0) return rc;
+    return luaL_error(L, getsp(L)->error);
+}
+
 static inline int push_and_return(Lua L, int rc)
 {
     lua_pushinteger(L, rc);
@@ -855,6 +949,7 @@ static void reset_consumer_cursor(SP sp)
     if (!q) return;
     sp->clnt->osql_max_trans = q->osql_max_trans;
     q->genid = 0;
+    q->nbatch = 0;
     memset(&q->fnd, 0, sizeof(q->fnd));
     memset(&q->last, 0, sizeof(q->last));
 }
@@ -865,14 +960,8 @@ static void reset_consumer_cursor(SP sp)
 ** Start a new transaction in either case.
 ** Commit transaction only for (1)
 */
-static int dbconsumer_consume(Lua L)
+static int dbconsumer_consume_int(Lua L, dbconsumer_t *q, const genid_t *genids, int n)
 {
-    dbconsumer_t *q = luaL_checkudata(L, 1, dbtypes.dbconsumer);
-
-    if (q->genid == 0) {
-        return push_and_return(L, -1);
-    }
-
     int rc = 0;
     const char *err = NULL;
     SP sp = getsp(L);
@@ -894,7 +983,10 @@ static int dbconsumer_consume(Lua L)
                        __func__, clnt->intrans, err, rc);
         }
     }
-    if ((rc = osql_dbq_consume_logic(clnt, q->info.spname, q->genid)) != 0) {
+    for (int i = 0; i < n && rc == 0; ++i) {
+        rc = osql_dbq_consume_logic(clnt, q->info.spname, genids[i]);
+    }
+    if (rc != 0) {
         if (implicit_txn) {
             err = db_rollback_int(L, &rc);
             if (err || rc || clnt->intrans) {
@@ -915,6 +1007,32 @@ static int dbconsumer_consume(Lua L)
     return push_and_return(L, rc);
 }
 
+static int dbconsumer_consume(Lua L)
+{
+    dbconsumer_t *q = luaL_checkudata(L, 1, dbtypes.dbconsumer);
+    if (q->genid == 0) {
+        return push_and_return(L, -1);
+    }
+    return dbconsumer_consume_int(L, q, &q->genid, 1);
+}
+
+// Consume every event returned by the last get_batch() in one transaction.
+static int dbconsumer_consume_batch(Lua L)
+{
+    dbconsumer_t *q = luaL_checkudata(L, 1, dbtypes.dbconsumer);
+    if (q->nbatch == 0) {
+        return push_and_return(L, -1);
+    }
+    /* like next(), the batch's consumes don't count against the sp's limit */
+    struct sqlclntstate *clnt = getsp(L)->clnt;
+    if (clnt->osql_max_trans)
+        clnt->osql_max_trans += q->nbatch;
+    int nret = dbconsumer_consume_int(L, q, q->batch, q->nbatch);
+    /* errors don't return here; a second call must not consume it again */
+    q->nbatch = 0;
+    return nret;
+}
+
 static int dbconsumer_next(Lua L)
 {
     dbconsumer_t *q = luaL_checkudata(L, 1, dbtypes.dbconsumer);
@@ -982,6 +1100,8 @@ static int dbconsumer_free(Lua L)
     ctrace("%s:%s %016" PRIx64 " unregister done\n", q->type, q->info.spname, q->info.trigger_cookie);
     SP sp = getsp(L);
     sp->clnt->osql_max_trans = q->osql_max_trans;
+    free(q->batch);
+    q->batch = NULL;
     return 0;
 }
 
@@ -5233,6 +5353,8 @@ static const struct luaL_Reg dbconsumer_funcs[] = {
     {"get", dbconsumer_get},
     {"poll", dbconsumer_poll},
     {"consume", dbconsumer_consume},
+    {"get_batch", dbconsumer_get_batch},
+    {"consume_batch", dbconsumer_consume_batch},
     {"next", dbconsumer_next},
     {"emit", dbconsumer_emit},
     {"emit_timeout", dbconsumer_emit_timeout},
@@ -623,6 +623,119 @@ static int newsql_send_postponed_row(struct sqlclntstate *clnt)
     return appdata->write_postponed(clnt);
 }
 
+/* Max rows and bytes to pack into a ROW_BATCH response */
+int gbl_newsql_row_batch_rows = 256;
+int gbl_newsql_row_batch_bytes = 64 * 1024;
+
+static int newsql_can_batch(struct sqlclntstate *clnt, struct response_data *arg, int postpone)
+{
+    /* rows that have to go out alone: postponed and ping-pong rows, rows
+     * the client may skip on retry, and rows it wants unbuffered */
+    return clnt->row_batch && clnt->rowbuffer && gbl_newsql_row_batch_rows > 1 && !postpone && !arg->pingpong &&
+           !clnt->num_retry && !clnt->fdb_push;
+}
+
+static int newsql_send_row_batch(struct sqlclntstate *clnt)
+{
+    struct newsql_appdata *appdata = clnt->appdata;
+    struct newsql_row_batch *b = appdata->row_batch;
+    if (b == NULL || b->nrows == 0)
+        return 0;
+
+    int ncols = b->ncols;
+    CDB2SQLRESPONSE__Rowbatch__Column cols[ncols];
+    CDB2SQLRESPONSE__Rowbatch__Column *colp[ncols];
+    for (int i = 0; i < ncols; ++i) {
+        ProtobufCBinaryData *v = &b->values[i * b->cap];
+        for (int j = 0; j < b->nrows; ++j)
+            v[j].data = v[j].len ? b->buf + (uintptr_t)v[j].data : NULL;
+        cdb2__sqlresponse__rowbatch__column__init(&cols[i]);
+        cols[i].n_values = cols[i].n_isnulls = b->nrows;
+        cols[i].values = v;
+        cols[i].isnulls = &b->isnulls[i * b->cap];
+        colp[i] = &cols[i];
+    }
+    CDB2SQLRESPONSE__Rowbatch rb;
+    cdb2__sqlresponse__rowbatch__init(&rb);
+    rb.nrows = b->nrows;
+    rb.n_cols = ncols;
+    rb.cols = colp;
+
+    CDB2SQLRESPONSE r = CDB2__SQLRESPONSE__INIT;
+    r.response_type = RESPONSE_TYPE__ROW_BATCH;
+    r.row_batch = &rb;
+
+    b->nrows = 0;
+    b->used = 0;
+    return newsql_response(clnt, &r, 0);
+}
+
+/* Copy a row into the pending batch; send the batch once it is full. */
+static int newsql_batch_row(struct sqlclntstate *clnt, int ncols, ProtobufCBinaryData *bd,
+                            protobuf_c_boolean *isnulls)
+{
+    struct newsql_appdata *appdata = clnt->appdata;
+    struct newsql_row_batch *b = appdata->row_batch;
+    int rc;
+
+    if (b == NULL && (b = appdata->row_batch = calloc(1, sizeof(*b))) == NULL)
+        return -1;
+    if (b->nrows && b->ncols != ncols && (rc = newsql_send_row_batch(clnt)) != 0)
+        return rc;
+    if (b->nrows == 0 && (b->cap != gbl_newsql_row_batch_rows || b->ncols != ncols)) {
+        int cap = gbl_newsql_row_batch_rows;
+        ProtobufCBinaryData *values = realloc(b->values, sizeof(*values) * cap * ncols);
+        if (values == NULL)
+            return -1;
+        b->values = values;
+        protobuf_c_boolean *nulls = realloc(b->isnulls, sizeof(*nulls) * cap * ncols);
+        if (nulls == NULL)
+            return -1;
+        b->isnulls = nulls;
+        b->cap = cap;
+        b->ncols = ncols;
+    }
+
+    size_t need = 0;
+    for (int i = 0; i < ncols; ++i)
+        need += bd[i].len;
+    if (b->used + need > b->size) {
+        size_t size = b->size ? b->size * 2 : 4096;
+        while (size < b->used + need)
+            size *= 2;
+        uint8_t *buf = realloc(b->buf, size);
+        if (buf == NULL)
+            return -1;
+        b->buf = buf;
+        b->size = size;
+    }
+
+    for (int i = 0; i < ncols; ++i) {
+        ProtobufCBinaryData *v = &b->values[i * b->cap + b->nrows];
+        v->len = bd[i].len;
+        v->data = (uint8_t *)(uintptr_t)b->used;
+        if (bd[i].len)
+            memcpy(b->buf + b->used, bd[i].data, bd[i].len);
+        b->used += bd[i].len;
+        b->isnulls[i * b->cap + b->nrows] = isnulls[i];
+    }
+    if (++b->nrows >= b->cap || b->used >= gbl_newsql_row_batch_bytes)
+        return newsql_send_row_batch(clnt);
+    return 0;
+}
+
+static void newsql_free_row_batch(struct newsql_appdata *appdata)
+{
+    struct newsql_row_batch *b = appdata->row_batch;
+    if (b == NULL)
+        return;
+    free(b->values);
+    free(b->isnulls);
+    free(b->buf);
+    free(b);
+    appdata->row_batch = NULL;
+}
+
 #define newsql_null(cols, i)                                                   \
     do {                                                                       \
         cols[i].has_isnull = 1;                                                \
@@ -710,6 +823,13 @@ static int newsql_row(struct sqlclntstate *clnt, struct response_data *arg,
                       int postpone)
 {
     sqlite3_stmt *stmt = arg->stmt;
+    int batch = newsql_can_batch(clnt, arg, postpone);
+    if (!batch) {
+        /* keep rows in order behind anything already batched */
+        int rc = newsql_send_row_batch(clnt);
+        if (rc)
+            return rc;
+    }
     if (!clnt->fdb_push && stmt == NULL) {
         return newsql_send_postponed_row(clnt);
     }
@@ -719,6 +839,7 @@ static int newsql_row(struct sqlclntstate *clnt, struct response_data *arg,
     assert(ncols == appdata->col_info.count);
 
     int flip = endianness_mismatch(clnt);
+    int flat = clnt->flat_col_vals || batch;
 
     /* nested column values */
     CDB2SQLRESPONSE__Column cols[ncols];
@@ -732,12 +853,12 @@ static int newsql_row(struct sqlclntstate *clnt, struct response_data *arg,
     memset(&isnulls, 0, sizeof(protobuf_c_boolean) * ncols);
 
     for (int i = 0; i < ncols; ++i) {
-        if (!clnt->flat_col_vals)
+        if (!flat)
             value[i] = &cols[i];
         cdb2__sqlresponse__column__init(&cols[i]);
         if (is_column_type_null(clnt, stmt, i)) {
             newsql_null(cols, i);
-            if (clnt->flat_col_vals)
+            if (flat)
                 isnulls[i] = cols[i].has_isnull ? cols[i].isnull : 0;
             continue;
         }
@@ -809,12 +930,15 @@ static int newsql_row(struct sqlclntstate *clnt, struct response_data *arg,
             return -1;
         }
 
-        if (clnt->flat_col_vals)
+        if (flat)
             bd[i] = cols[i].value;
     }
+    if (batch)
+        return newsql_batch_row(clnt, ncols, bd, isnulls);
+
     CDB2SQLRESPONSE r = CDB2__SQLRESPONSE__INIT;
     r.response_type = RESPONSE_TYPE__COLUMN_VALUES;
-    if (clnt->flat_col_vals) {
+    if (flat) {
         r.has_flat_col_vals = 1;
         r.flat_col_vals = 1;
         r.n_values = r.n_isnulls = ncols;
@@ -1120,6 +1244,13 @@ static int newsql_raw_payload(struct sqlclntstate *c, void *a) {
 
 static int newsql_write_response(struct sqlclntstate *c, int t, void *a, int i)
 {
+    /* Anything but another row (or a heartbeat, which the client skips)
+     * goes out behind the rows batched so far. */
+    if (t != RESPONSE_ROW && t != RESPONSE_HEARTBEAT) {
+        int rc = newsql_send_row_batch(c);
+        if (rc)
+            return rc;
+    }
     switch (t) {
     case RESPONSE_COLUMNS: return newsql_columns(c, a);
     case RESPONSE_COLUMNS_LUA: return newsql_columns_lua(c, a);
@@ -2348,6 +2479,9 @@ int newsql_first_run(struct sqlclntstate *clnt, CDB2SQLQUERY *sql_query)
         appdata->protocol_version = NEWSQL_PROTOCOL_COMPAT;
     if (clnt->features.can_redirect_fdb)
         clnt->can_redirect_fdb = 1;
+    if (clnt->features.row_batch && !clnt->sqlite_row_format &&
+        appdata->protocol_version == NEWSQL_PROTOCOL_ORIGINAL)
+        clnt->row_batch = 1;
 
     if (sql_query->client_info) {
         newsql_set_client_info(clnt, sql_query, 1);
@@ -2488,6 +2622,8 @@ void newsql_reset(struct sqlclntstate *clnt)
         handle_sql_intrans_unrecoverable_error(clnt);
     }
     reset_clnt(clnt, 0);
+    if (clnt->appdata)
+        newsql_free_row_batch(clnt->appdata);
     clnt->tzname[0] = 0;
     clnt->osql.count_changes = 1;
     clnt->heartbeat = 1;
@@ -2503,6 +2639,7 @@ void free_newsql_appdata(struct sqlclntstate *clnt)
         free(appdata->postponed);
         appdata->postponed = NULL;
     }
+    newsql_free_row_batch(appdata);
     free(appdata->col_info.type);
 }
 
@@ -49,6 +49,20 @@ struct newsql_postponed_data {
     uint8_t *row;
 };
 
+/* Rows waiting to go out in one ROW_BATCH response. Values are column-major
+ * with a stride of `cap' rows; their data pointers hold offsets into `buf'
+ * until the batch is sent, since `buf' may move as it grows. */
+struct newsql_row_batch {
+    int ncols;
+    int nrows;
+    int cap;
+    ProtobufCBinaryData *values;
+    protobuf_c_boolean *isnulls;
+    uint8_t *buf;
+    size_t used;
+    size_t size;
+};
+
 typedef enum {
     NEWSQL_PROTOCOL_ORIGINAL,
     NEWSQL_PROTOCOL_COMPAT
@@ -66,6 +80,7 @@ typedef enum {
     int8_t send_intrans_response;                                              \
     int8_t protocol_version;                                              \
     struct newsql_postponed_data *postponed;                                   \
+    struct newsql_row_batch *row_batch;                                        \
     struct sql_col_info col_info;
 
 void newsql_setup_clnt(struct sqlclntstate *);
@@ -587,6 +587,7 @@ static void process_features(struct newsql_appdata_evbuffer *appdata) {
         case CDB2_CLIENT_FEATURES__ALLOW_MASTER_EXEC: clnt->features.allow_master_exec = 1; break;
         case CDB2_CLIENT_FEATURES__ALLOW_MASTER_DBINFO: clnt->features.allow_master_dbinfo = 1; break;
         case CDB2_CLIENT_FEATURES__ALLOW_QUEUING: clnt->features.queue_me = 1; break;
+        case CDB2_CLIENT_FEATURES__ROW_BATCH: clnt->features.row_batch = 1; break;
         }
     }
 }
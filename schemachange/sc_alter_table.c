@@ -565,6 +565,24 @@ int do_alter_table(struct ireq *iq, struct schema_change_type *s,
         clean_exit();
     }
 
+    /* a bulk index build that was cut short left records in the new btrees
+     * without their keys; convert everything again into an empty table */
+    if (s->resume && (rc = sc_bulk_ix_interrupted(newdb)) != 0) {
+        if (rc < 0 || delete_temp_table(iq, newdb) ||
+            open_temp_db_resume(iq, newdb, new_prefix, 0, 0, tran) ||
+            clear_sc_progress(newdb)) {
+            sc_errf(s, "failed to restart interrupted bulk index build\n");
+            change_schemas_recover(s->tablename);
+            if (local_lock)
+                unlock_schema_lk();
+            decrement_sc_yet_to_resume_counter();
+            return -1;
+        }
+        sc_printf(s, "[%s] bulk index build was interrupted, converting all "
+                     "records again\n",
+                  s->tablename);
+    }
+
     if (local_lock)
         unlock_schema_lk();
 
@@ -17,6 +17,7 @@
 #include <memory_sync.h>
 #include "schemachange.h"
 #include "sc_callbacks.h"
+#include "sc_records.h"
 #include "sc_global.h"
 #include "sc_add_table.h"
 #include "sc_schema.h"
@@ -111,10 +112,14 @@ static int reload_stripe_info(tran_type *tran, uint32_t lid)
 }
 
 /* if genid <= sc_genids[stripe] then schemachange has already processed up to
- * that point */
-int is_genid_right_of_stripe_pointer(bdb_state_type *bdb_state,
-                                     unsigned long long genid,
-                                     unsigned long long *sc_genids)
+ * that point; when the stripe is split into key ranges the pointer of the
+ * range the genid falls in is used instead */
+/* the schema change pointer of the stripe, or of the stripe range, that
+ * genid falls in */
+unsigned long long get_genid_stripe_pointer(bdb_state_type *bdb_state,
+                                            unsigned long long genid,
+                                            unsigned long long *sc_genids,
+                                            struct sc_stripe_ranges *ranges)
 {
     int stripe = get_dtafile_from_genid(genid);
     if (stripe < 0 || stripe >= gbl_dtastripe) {
@@ -122,25 +127,31 @@ int is_genid_right_of_stripe_pointer(bdb_state_type *bdb_state,
                __func__, genid, stripe);
         abort();
     }
-    if (!sc_genids[stripe]) {
-        /* A genid of zero is invalid.  So, if the schema change cursor is at
-         * genid zero it means pretty conclusively that it hasn't done anything
-         * yet so we cannot possibly be behind the cursor. */
-        return 1;
+    if (ranges && ranges->nranges[stripe] > 1) {
+        int k = 0, last = ranges->nranges[stripe] - 1;
+        while (k < last &&
+               bdb_inplace_cmp_genids(bdb_state, genid,
+                                      ranges->bound[stripe][k]) > 0)
+            k++;
+        return ranges->ptr[stripe][k];
     }
-    return bdb_inplace_cmp_genids(bdb_state, genid, sc_genids[stripe]) > 0;
+    return sc_genids[stripe];
 }
 
-unsigned long long get_genid_stripe_pointer(unsigned long long genid,
-                                            unsigned long long *sc_genids)
+int is_genid_right_of_stripe_pointer(bdb_state_type *bdb_state,
+                                     unsigned long long genid,
+                                     unsigned long long *sc_genids,
+                                     struct sc_stripe_ranges *ranges)
 {
-    int stripe = get_dtafile_from_genid(genid);
-    if (stripe < 0 || stripe >= gbl_dtastripe) {
-        logmsg(LOGMSG_FATAL, "%s: genid 0x%llx stripe %d out of range!\n",
-               __func__, genid, stripe);
-        abort();
+    unsigned long long ptr =
+        get_genid_stripe_pointer(bdb_state, genid, sc_genids, ranges);
+    if (!ptr) {
+        /* A genid of zero is invalid.  So, if the schema change cursor is at
+         * genid zero it means pretty conclusively that it hasn't done anything
+         * yet so we cannot possibly be behind the cursor. */
+        return 1;
     }
-    return sc_genids[stripe];
+    return bdb_inplace_cmp_genids(bdb_state, genid, ptr) > 0;
 }
 
 /* delete from new btree when genid is older than schemachange position
@@ -259,7 +270,8 @@ int live_sc_post_update_delayed_key_adds_int(struct ireq *iq, void *trans,
     /* need to check where the cursor is, even tho that check was done once in
      * post_update */
     int is_gen_gt_scptr = is_genid_right_of_stripe_pointer(
-        iq->usedb->handle, newgenid, usedb->sc_to->sc_genids);
+        iq->usedb->handle, newgenid, usedb->sc_to->sc_genids,
+        usedb->sc_to->sc_ranges);
     if (is_gen_gt_scptr) {
         if (iq->debug) {
             reqprintf(iq, "live_sc_post_update_delayed_key_adds_int: skip "
@@ -202,6 +202,7 @@ int perform_trigger_update_replicant(tran_type *tran, const char *queue_name, sc
     int ndests;
     int compr;
     int persist;
+    int shards;
     char **dests;
     int bdberr;
 
@@ -350,6 +351,8 @@ int perform_trigger_update_replicant(tran_type *tran, const char *queue_name, sc
             get_db_queue_persistent_seq_tran(db, &persist, tran);
         }
         bdb_set_queue_odh_options(db->handle, db->odh, compr, persist);
+        get_db_queue_shards_tran(db, &shards, tran);
+        bdb_set_queue_shards(db->handle, shards);
     }
 
 done:
@@ -551,8 +554,15 @@ static int perform_trigger_update_int(struct schema_change_type *sc, tran_type *
             goto done;
         }
 
+        if (gbl_init_with_queue_shards > 1 &&
+            (rc = put_db_queue_shards(db, tran, gbl_init_with_queue_shards)) != 0) {
+            logmsg(LOGMSG_ERROR, "failed to set queue-shards, rc %d\n", rc);
+            goto done;
+        }
+
         db->odh = sc->headers;
         bdb_set_queue_odh_options(db->handle, sc->headers, sc->compress, sc->persistent_seq);
+        bdb_set_queue_shards(db->handle, gbl_init_with_queue_shards);
 
         /* create a procedure (needs to go away, badly) */
         rc = javasp_do_procedure_op(JAVASP_OP_LOAD, tablename, NULL, config);
@@ -37,6 +37,8 @@
 #include "debug_switches.h"
 
 int gbl_logical_live_sc = 0;
+int gbl_sc_bulk_build_indexes = 0;
+int gbl_sc_stripe_ranges = 1;
 
 extern __thread snap_uid_t *osql_snap_info; /* contains cnonce */
 extern int gbl_partial_indexes;
@@ -188,6 +190,84 @@ static inline void lkcounter_check(struct convert_record_data *data, int now)
         bdb_attr_get(data->from->dbenv->bdb_attr, BDB_ATTR_SC_USE_NUM_THREADS));
 }
 
+/* llmeta high genid slots past the stripes keep the bounds and progress of
+ * split stripes, so that a resumed schema change converts the same ranges */
+#define SC_RANGE_SLOT(stripe, k, what)                                         \
+    (MAXDTASTRIPE + ((stripe)*SC_MAX_STRIPE_RANGES + (k)) * 2 + (what))
+enum { SC_RANGE_BOUND = 0, SC_RANGE_PTR = 1 };
+
+/* forget the ranges of an earlier schema change on this table */
+static int clear_sc_ranges(struct dbtable *db)
+{
+    unsigned long long genid;
+    int bdberr, stripe, k, what;
+
+    for (stripe = 0; stripe < db->dtastripe; ++stripe) {
+        for (k = 0; k < SC_MAX_STRIPE_RANGES; ++k) {
+            int more = 0;
+            for (what = SC_RANGE_PTR; what >= SC_RANGE_BOUND; --what) {
+                int slot = SC_RANGE_SLOT(stripe, k, what);
+                if (bdb_get_high_genid(db->tablename, slot, &genid, &bdberr) ||
+                    bdberr != BDBERR_NOERROR)
+                    return -1;
+                if (genid == 0)
+                    continue;
+                if (bdb_set_high_genid_stripe(NULL, db->tablename, slot, 0ULL,
+                                              &bdberr) ||
+                    bdberr != BDBERR_NOERROR)
+                    return -1;
+                if (what == SC_RANGE_BOUND)
+                    more = 1;
+            }
+            if (!more)
+                break;
+        }
+    }
+    return 0;
+}
+
+/* set while a schema change builds its indexes in bulk: the new btrees then
+ * hold records whose keys only the convert threads' collectors have */
+#define SC_BULK_SLOT SC_RANGE_SLOT(MAXDTASTRIPE, 0, SC_RANGE_BOUND)
+
+static int set_sc_bulk(struct dbtable *db, int on)
+{
+    int bdberr;
+
+    if (bdb_set_high_genid_stripe(NULL, db->tablename, SC_BULK_SLOT,
+                                  on ? 1ULL : 0ULL, &bdberr) ||
+        bdberr != BDBERR_NOERROR)
+        return -1;
+    return 0;
+}
+
+/* returns 1 if the schema change on db stopped while building indexes in
+ * bulk, 0 if not, <0 on error */
+int sc_bulk_ix_interrupted(struct dbtable *db)
+{
+    unsigned long long genid;
+    int bdberr;
+
+    if (bdb_get_high_genid(db->tablename, SC_BULK_SLOT, &genid, &bdberr) ||
+        bdberr != BDBERR_NOERROR)
+        return -1;
+    return genid != 0;
+}
+
+/* forget all the progress saved in llmeta, for a resume that starts over on
+ * an empty new table */
+int clear_sc_progress(struct dbtable *db)
+{
+    int bdberr;
+
+    if (bdb_clear_high_genid(NULL, db->tablename, db->dtastripe, &bdberr) ||
+        bdberr != BDBERR_NOERROR)
+        return -1;
+    if (clear_sc_ranges(db))
+        return -1;
+    return set_sc_bulk(db, 0);
+}
+
 /* If the schema is resuming it sets sc_genids to be the last genid for each
  * stripe.
  * If the schema change is not resuming it sets them all to zero
@@ -220,6 +300,16 @@ int init_sc_genids(struct dbtable *db, struct schema_change_type *s)
                                  "genids\n");
             return -1;
         }
+        if (clear_sc_ranges(db)) {
+            logmsg(LOGMSG_ERROR, "init_sc_genids: failed to clear stripe "
+                                 "ranges\n");
+            return -1;
+        }
+        if (sc_bulk_ix_interrupted(db) && set_sc_bulk(db, 0)) {
+            logmsg(LOGMSG_ERROR, "init_sc_genids: failed to clear bulk index "
+                                 "build\n");
+            return -1;
+        }
 
         bzero(sc_genids, sizeof(unsigned long long) * MAXDTASTRIPE);
         return 0;
@@ -417,11 +507,20 @@ static int report_sc_progress(struct convert_record_data *data, int now)
         data->prev_nrecs = data->nrecs;
 
         /* print thread specific stats */
-        sc_printf(data->s,
-                  "[%s] progress stripe %d changed genids %u progress %lld"
-                  " recs +%lld (%lld r/s)\n",
-                  data->from->tablename, data->stripe, data->n_genids_changed,
-                  data->nrecs, diff_nrecs, diff_nrecs / copy_sc_report_freq);
+        if (data->to->sc_ranges)
+            sc_printf(data->s,
+                      "[%s] progress stripe %d range %d changed genids %u "
+                      "progress %lld recs +%lld (%lld r/s)\n",
+                      data->from->tablename, data->stripe, data->range,
+                      data->n_genids_changed, data->nrecs, diff_nrecs,
+                      diff_nrecs / copy_sc_report_freq);
+        else
+            sc_printf(data->s,
+                      "[%s] progress stripe %d changed genids %u progress %lld"
+                      " recs +%lld (%lld r/s)\n",
+                      data->from->tablename, data->stripe,
+                      data->n_genids_changed, data->nrecs, diff_nrecs,
+                      diff_nrecs / copy_sc_report_freq);
 
         /* now do global sc data */
         int res = print_aggregate_sc_stat(data, now, copy_sc_report_freq);
@@ -614,6 +713,66 @@ static void increment_sc_logbytes(int64_t bytes)
     Pthread_mutex_unlock(&sc_bps_lk);
 }
 
+/* progress of a stripe is kept in llmeta unless the new data file has it */
+static int sc_progress_in_llmeta(struct dbtable *to)
+{
+    if (to->plan && to->plan->dta_plan)
+        return 0; /* the genid is in new dta */
+    return !is_dta_being_rebuilt(to->plan);
+}
+
+/* the genid vector a thread of a split stripe scans from */
+static unsigned long long *sc_range_scan_genids(struct convert_record_data *data)
+{
+    struct sc_stripe_ranges *r = data->to->sc_ranges;
+    int stripe = data->stripe, k = data->range;
+    unsigned long long ptr = r->ptr[stripe][k];
+
+    if (!ptr && k > 0)
+        ptr = r->bound[stripe][k - 1];
+    data->range_genids[stripe] = ptr;
+    return data->range_genids;
+}
+
+/* advance the schema change pointer of this thread's stripe or range */
+static inline void sc_set_progress(struct convert_record_data *data,
+                                   unsigned long long genid)
+{
+    if (data->to->sc_ranges)
+        data->to->sc_ranges->ptr[data->stripe][data->range] = genid;
+    else
+        data->sc_genids[data->stripe] = genid;
+}
+
+/* Everything up to the bound of this thread's range has been converted.  The
+ * last range to finish closes the stripe like an unsplit stripe does. */
+static int sc_range_finished(struct convert_record_data *data)
+{
+    struct sc_stripe_ranges *r = data->to->sc_ranges;
+    int stripe = data->stripe, k = data->range, rc = 0;
+
+    if (k == r->nranges[stripe] - 1)
+        r->ptr[stripe][k] = -1ULL;
+    else
+        r->ptr[stripe][k] = r->bound[stripe][k];
+    sc_printf(data->s, "[%s] finished stripe %d range %d\n",
+              data->from->tablename, stripe, k);
+
+    if (ATOMIC_ADD32(r->ndone[stripe], 1) != r->nranges[stripe])
+        return 0;
+
+    data->sc_genids[stripe] = -1ULL;
+    if (sc_progress_in_llmeta(data->to)) {
+        int bdberr;
+        rc = bdb_set_high_genid_stripe(NULL, data->to->tablename, stripe,
+                                       -1ULL, &bdberr);
+        if (rc != 0) rc = -1; // convert_record expects -1
+    }
+    sc_printf(data->s, "[%s] finished stripe %d, setting genid %llx, rc %d\n",
+              data->from->tablename, stripe, data->sc_genids[stripe], rc);
+    return rc;
+}
+
 /* converts a single record and prepares for the next one
  * should be called from a while loop
  * param data: pointer to all the state information
@@ -709,9 +868,11 @@ static int convert_record(struct convert_record_data *data)
 
     if (data->scanmode == SCAN_PARALLEL || data->scanmode == SCAN_PAGEORDER) {
         if (data->scanmode == SCAN_PARALLEL) {
-            rc = dtas_next(&data->iq, data->sc_genids, &genid, &data->stripe, 1,
-                           data->dta_buf, data->trans, data->from->lrl, &dtalen,
-                           NULL);
+            rc = dtas_next(&data->iq,
+                           data->to->sc_ranges ? sc_range_scan_genids(data)
+                                               : data->sc_genids,
+                           &genid, &data->stripe, 1, data->dta_buf,
+                           data->trans, data->from->lrl, &dtalen, NULL);
         } else {
             rc = dtas_next_pageorder(
                 &data->iq, data->sc_genids, &genid, &data->stripe, 1,
@@ -722,6 +883,14 @@ static int convert_record(struct convert_record_data *data)
         logmsg(LOGMSG_DEBUG, "(%u) %s rc=%d genid %llx (%llu)\n", (unsigned int)pthread_self(), __func__, rc, genid,
                genid);
 #endif
+        /* past the end of our range */
+        if (rc == 0 && data->to->sc_ranges &&
+            data->range < data->to->sc_ranges->nranges[data->stripe] - 1 &&
+            bdb_inplace_cmp_genids(
+                data->to->handle, genid,
+                data->to->sc_ranges->bound[data->stripe][data->range]) > 0)
+            return sc_range_finished(data);
+
         if (rc == 0) {
             dta = data->dta_buf;
             check_genid = bdb_normalise_genid(data->to->handle, genid);
@@ -759,6 +928,9 @@ static int convert_record(struct convert_record_data *data)
                 return 0;
             }
 
+            if (data->to->sc_ranges)
+                return sc_range_finished(data);
+
             // AZ: determine what locks we hold at this time
             // bdb_dump_active_locks(data->to->handle, stdout);
             data->sc_genids[data->stripe] = -1ULL;
@@ -1022,13 +1194,20 @@ static int convert_record(struct convert_record_data *data)
     }
 
     /* if we have been rebuilding the data files we're gonna
-       call bdb_get_high_genid to resume, not look at llmeta */
-    if (usellmeta && !is_dta_being_rebuilt(data->to->plan) &&
+       call bdb_get_high_genid to resume, not look at llmeta.
+       a bulk index build starts over on resume, see sc_bulk_ix_interrupted */
+    if (usellmeta && !is_dta_being_rebuilt(data->to->plan) && !data->bulk_ix &&
         (data->nrecs %
          BDB_ATTR_GET(thedb->bdb_attr, INDEXREBUILD_SAVE_EVERY_N)) == 0) {
         int bdberr;
-        rc = bdb_set_high_genid(data->trans, data->to->tablename, genid,
-                                &bdberr);
+        if (data->to->sc_ranges)
+            rc = bdb_set_high_genid_stripe(
+                data->trans, data->to->tablename,
+                SC_RANGE_SLOT(data->stripe, data->range, SC_RANGE_PTR), genid,
+                &bdberr);
+        else
+            rc = bdb_set_high_genid(data->trans, data->to->tablename, genid,
+                                    &bdberr);
         if (rc != 0) {
             if (bdberr == BDBERR_DEADLOCK)
                 rc = RC_INTERNAL_RETRY;
@@ -1106,7 +1285,7 @@ err:
 
             sc_errf(data->s, "Skipping duplicate entry in index %d rrn %d genid 0x%llx\n",
                     ixfailnum, rrn, genid);
-            data->sc_genids[data->stripe] = genid;
+            sc_set_progress(data, genid);
             logbytes = bdb_tran_logbytes(data->trans);
             increment_sc_logbytes(logbytes - estimate);
             trans_abort(&data->iq, data->trans);
@@ -1133,7 +1312,7 @@ err:
     /* Advance our progress markers */
     data->nrecs++;
     if (data->scanmode == SCAN_PARALLEL || data->scanmode == SCAN_PAGEORDER) {
-        data->sc_genids[data->stripe] = genid;
+        sc_set_progress(data, genid);
     }
 
     // now do the commit
@@ -1339,6 +1518,307 @@ static void stop_sc_redo_wait(bdb_state_type *bdb_state,
 int gbl_sc_pause_at_end = 0;
 int gbl_sc_is_at_end = 0;
 
+/* keys moved into a bulk-built index per transaction */
+#define SC_BULK_KEYS_PER_TRAN 10000
+
+/* A readonly schema change has the new table to itself, so the indexes it
+ * rebuilds can be collected as sorted keys and built bottom-up after the
+ * scan.  Resumed schema changes already have keys in the new btrees and are
+ * built the usual way; one that stopped during a bulk build has records
+ * without keys, so do_alter_table starts it over on an empty table. */
+static int sc_bulk_ix_wanted(struct convert_record_data *data)
+{
+    struct schema_change_type *s = data->s;
+
+    return gbl_sc_bulk_build_indexes && !data->live && !s->resume &&
+           !s->use_new_genids && !gbl_logical_live_sc &&
+           s->schema_change != SC_CONSTRAINT_CHANGE;
+}
+
+static void sc_bulk_ix_close(struct convert_record_data *data)
+{
+    if (!data->bulk_ix)
+        return;
+    for (int ix = 0; ix < data->to->nix; ix++)
+        bdb_bulk_ix_close(data->bulk_ix[ix]);
+    free(data->bulk_ix);
+    data->bulk_ix = NULL;
+    data->iq.bulk_ix = NULL;
+}
+
+static int sc_bulk_ix_open(struct convert_record_data *data)
+{
+    struct dbtable *to = data->to;
+    int bdberr;
+
+    data->bulk_ix = calloc(to->nix, sizeof(struct bdb_bulk_ix *));
+    if (!data->bulk_ix) {
+        sc_errf(data->s, "%s: out of memory\n", __func__);
+        return -1;
+    }
+    for (int ix = 0; ix < to->nix; ix++) {
+        /* index is carried over from the old table */
+        if (gbl_use_plan && to->plan && to->plan->ix_plan[ix] != -1)
+            continue;
+        data->bulk_ix[ix] = bdb_bulk_ix_open(to->handle, ix, &bdberr);
+        if (!data->bulk_ix[ix] && bdberr != BDBERR_NOERROR) {
+            sc_errf(data->s, "failed to open bulk collector for index %d "
+                             "bdberr %d\n", ix, bdberr);
+            sc_bulk_ix_close(data);
+            return -1;
+        }
+    }
+    data->iq.bulk_ix = data->bulk_ix;
+    return 0;
+}
+
+/* Merge what every convert thread collected for each index and build it. */
+static int sc_bulk_ix_load(struct convert_record_data *data,
+                           struct convert_record_data *parts, int nparts)
+{
+    struct dbtable *to = data->to;
+    struct bdb_bulk_ix *ixparts[nparts];
+    int rc = 0, bdberr = 0;
+
+    for (int ix = 0; ix < to->nix && rc == 0; ix++) {
+        struct bdb_bulk_ix_load *load;
+        int have = 0, done = 0;
+
+        for (int i = 0; i < nparts; i++) {
+            ixparts[i] = parts[i].bulk_ix ? parts[i].bulk_ix[ix] : NULL;
+            if (ixparts[i])
+                have = 1;
+        }
+        if (!have)
+            continue;
+
+        load = bdb_bulk_ix_load_begin(ixparts, nparts, &bdberr);
+        if (!load) {
+            sc_errf(data->s, "failed to start bulk build of index %d "
+                             "bdberr %d\n", ix, bdberr);
+            return -1;
+        }
+
+        while (!done) {
+            tran_type *tran = NULL;
+
+            if (gbl_sc_abort || to->sc_abort ||
+                (data->s->iq && data->s->iq->sc_should_abort)) {
+                sc_errf(data->s, "Schema change aborted\n");
+                rc = -1;
+                break;
+            }
+
+            throttle_sc_logbytes(0);
+            if ((rc = trans_start_sc(&data->iq, NULL, &tran)) != 0) {
+                sc_errf(data->s, "error %d starting transaction\n", rc);
+                rc = -1;
+                break;
+            }
+            done = bdb_bulk_ix_load_step(load, tran, SC_BULK_KEYS_PER_TRAN,
+                                         &bdberr);
+            if (done == 1)
+                rc = bdb_bulk_ix_load_end(load, tran, &bdberr);
+            else if (done < 0)
+                rc = -1;
+            if (rc) {
+                trans_abort(&data->iq, tran);
+                if (bdberr == BDBERR_ADD_DUPE)
+                    sc_client_error(data->s,
+                                    "Could not add duplicate entry in index %d",
+                                    ix);
+                else
+                    sc_errf(data->s, "bulk build of index %d failed bdberr %d\n",
+                            ix, bdberr);
+                break;
+            }
+            increment_sc_logbytes(bdb_tran_logbytes(tran));
+            if ((rc = trans_commit(&data->iq, tran, gbl_myhostname)) != 0) {
+                sc_errf(data->s, "%s: trans_commit failed with rcode %d\n",
+                        __func__, rc);
+                rc = -1;
+                break;
+            }
+        }
+
+        if (rc == 0)
+            sc_printf(data->s, "[%s] built index %d bottom-up from %lld keys\n",
+                      to->tablename, ix, bdb_bulk_ix_load_count(load));
+        bdb_bulk_ix_load_free(load);
+    }
+    return rc;
+}
+
+/* On resume, pick up where each range of a split stripe got to */
+static int load_sc_ranges(struct convert_record_data *data,
+                          struct sc_stripe_ranges *r)
+{
+    struct dbtable *to = data->to;
+    unsigned long long genid;
+    int bdberr, rc, stripe, k, split = 0;
+
+    for (stripe = 0; stripe < gbl_dtastripe; ++stripe) {
+        r->nranges[stripe] = 1;
+        for (k = 0; k < SC_MAX_STRIPE_RANGES - 1; ++k) {
+            if (bdb_get_high_genid(to->tablename,
+                                   SC_RANGE_SLOT(stripe, k, SC_RANGE_BOUND),
+                                   &genid, &bdberr) ||
+                bdberr != BDBERR_NOERROR)
+                return -1;
+            if (genid == 0)
+                break;
+            r->bound[stripe][k] = genid;
+            r->nranges[stripe] = k + 2;
+        }
+        /* a finished stripe goes by sc_genids alone */
+        if (data->sc_genids[stripe] == -1ULL)
+            r->nranges[stripe] = 1;
+        if (r->nranges[stripe] == 1)
+            continue;
+        split = 1;
+
+        for (k = 0; k < r->nranges[stripe]; ++k) {
+            int last = (k == r->nranges[stripe] - 1);
+            if (sc_progress_in_llmeta(to)) {
+                rc = bdb_get_high_genid(to->tablename,
+                                        SC_RANGE_SLOT(stripe, k, SC_RANGE_PTR),
+                                        &genid, &bdberr);
+                if (rc || bdberr != BDBERR_NOERROR)
+                    return -1;
+            } else {
+                /* the newest record converted into the range */
+                rc = bdb_find_newest_genid_upto(
+                    to->handle, NULL, stripe,
+                    last ? -1ULL : r->bound[stripe][k], &genid, &bdberr);
+                if (rc < 0)
+                    return -1;
+                if (rc == 1 ||
+                    (k > 0 && bdb_inplace_cmp_genids(
+                                  to->handle, genid,
+                                  r->bound[stripe][k - 1]) <= 0))
+                    genid = 0;
+            }
+            r->ptr[stripe][k] = genid;
+            sc_printf(data->s, "[%s] resuming stripe %2d range %2d from "
+                               "0x%016llx\n",
+                      to->tablename, stripe, k, genid);
+        }
+    }
+    return split;
+}
+
+/* Cut each stripe into gbl_sc_stripe_ranges key ranges of about the same
+ * size, sampled from the btree of the old data file */
+static int split_sc_ranges(struct convert_record_data *data,
+                           struct sc_stripe_ranges *r)
+{
+    int nranges = gbl_sc_stripe_ranges;
+    int bdberr, rc, stripe, k, split = 0;
+
+    if (nranges > SC_MAX_STRIPE_RANGES)
+        nranges = SC_MAX_STRIPE_RANGES;
+    for (stripe = 0; stripe < gbl_dtastripe; ++stripe) {
+        rc = bdb_dtastripe_sample_splits(data->from->handle, stripe,
+                                         nranges - 1, r->bound[stripe],
+                                         &bdberr);
+        if (rc < 0) {
+            sc_errf(data->s, "[%s] failed to sample stripe %d bdberr %d, "
+                             "converting it whole\n",
+                    data->from->tablename, stripe, bdberr);
+            rc = 0;
+        }
+        r->nranges[stripe] = rc + 1;
+        for (k = 0; k < rc; ++k) {
+            if (bdb_set_high_genid_stripe(
+                    NULL, data->to->tablename,
+                    SC_RANGE_SLOT(stripe, k, SC_RANGE_BOUND),
+                    r->bound[stripe][k], &bdberr) ||
+                bdberr != BDBERR_NOERROR)
+                return -1;
+        }
+        if (rc > 0)
+            split = 1;
+        sc_printf(data->s, "[%s] converting stripe %d in %d ranges\n",
+                  data->from->tablename, stripe, r->nranges[stripe]);
+    }
+    return split;
+}
+
+/* returns 1 if an interrupted schema change left split stripes in llmeta */
+static int sc_ranges_saved(struct dbtable *to)
+{
+    unsigned long long genid;
+    int bdberr, stripe;
+
+    for (stripe = 0; stripe < to->dtastripe; ++stripe) {
+        if (bdb_get_high_genid(to->tablename,
+                               SC_RANGE_SLOT(stripe, 0, SC_RANGE_BOUND), &genid,
+                               &bdberr) ||
+            bdberr != BDBERR_NOERROR)
+            return -1;
+        if (genid != 0)
+            return 1;
+    }
+    return 0;
+}
+
+/* Split stripes so that more than one thread can convert each of them.  Only
+ * the parallel scan converts by genid, and logical live schema change tracks
+ * whole stripes, so both keep one thread per stripe. */
+static int init_sc_ranges(struct convert_record_data *data)
+{
+    struct schema_change_type *s = data->s;
+    struct sc_stripe_ranges *r;
+    int rc;
+
+    free(data->to->sc_ranges);
+    data->to->sc_ranges = NULL;
+
+    if (data->scanmode != SCAN_PARALLEL || gbl_logical_live_sc ||
+        s->use_new_genids) {
+        if (!s->resume)
+            return 0;
+        /* the saved progress is per range; resuming with one pointer per
+         * stripe would skip the records left behind in the lower ranges */
+        rc = sc_ranges_saved(data->to);
+        if (rc)
+            sc_errf(s, "[%s] %s stripe ranges, cannot resume in this mode\n",
+                    data->to->tablename,
+                    rc < 0 ? "failed to look for" : "found saved");
+        return rc ? -1 : 0;
+    }
+    if (!s->resume && gbl_sc_stripe_ranges <= 1)
+        return 0;
+
+    r = calloc(1, sizeof(*r));
+    if (!r) {
+        sc_errf(s, "%s: out of memory\n", __func__);
+        return -1;
+    }
+    rc = s->resume ? load_sc_ranges(data, r) : split_sc_ranges(data, r);
+    if (rc <= 0) {
+        if (rc)
+            sc_errf(s, "[%s] failed to %s stripe ranges\n", data->to->tablename,
+                    s->resume ? "load" : "save");
+        free(r);
+        return rc;
+    }
+    data->to->sc_ranges = r;
+    return 0;
+}
+
+/* number of convert threads: one per range of each stripe */
+static int sc_num_convert_threads(struct dbtable *to)
+{
+    int stripe, n = 0;
+
+    if (!to->sc_ranges)
+        return gbl_dtastripe;
+    for (stripe = 0; stripe < gbl_dtastripe; ++stripe)
+        n += to->sc_ranges->nranges[stripe];
+    return n;
+}
+
 int convert_all_records(struct dbtable *from, struct dbtable *to,
                         unsigned long long *sc_genids,
                         struct schema_change_type *s)
@@ -1412,13 +1892,17 @@ int convert_all_records(struct dbtable *from, struct dbtable *to,
         bzero(&data.blbcopy, sizeof(data.blbcopy));
     }
 
+    if (init_sc_ranges(&data))
+        return -1;
+    int nthreads = sc_num_convert_threads(to);
+
     data.cmembers = calloc(1, sizeof(struct common_members));
     int sc_threads =
         bdb_attr_get(data.from->dbenv->bdb_attr, BDB_ATTR_SC_USE_NUM_THREADS);
-    if (sc_threads <= 0 || sc_threads > gbl_dtastripe) {
+    if (sc_threads <= 0 || sc_threads > nthreads) {
         bdb_attr_set(data.from->dbenv->bdb_attr, BDB_ATTR_SC_USE_NUM_THREADS,
-                     gbl_dtastripe);
-        sc_threads = gbl_dtastripe;
+                     nthreads);
+        sc_threads = nthreads;
     }
     data.cmembers->maxthreads = sc_threads;
     data.cmembers->is_decrease_thrds = bdb_attr_get(
@@ -1530,14 +2014,35 @@ int convert_all_records(struct dbtable *from, struct dbtable *to,
     }
 
     /* if were not in parallel, dont start any threads */
+    int bulk = sc_bulk_ix_wanted(&data);
+    if (bulk && set_sc_bulk(to, 1)) {
+        sc_errf(s, "[%s] failed to save bulk index build\n", to->tablename);
+        return -1;
+    }
     if (data.scanmode != SCAN_PARALLEL && data.scanmode != SCAN_PAGEORDER) {
-        convert_records_thd(&data);
-        outrc = data.outrc;
+        if (bulk && sc_bulk_ix_open(&data))
+            outrc = -1;
+        else {
+            convert_records_thd(&data);
+            outrc = data.outrc;
+        }
+        if (outrc == 0 && bulk)
+            outrc = sc_bulk_ix_load(&data, &data, 1);
+        sc_bulk_ix_close(&data);
     } else {
-        struct convert_record_data threadData[gbl_dtastripe];
-        int threadSkipped[gbl_dtastripe];
+        struct convert_record_data *threadData;
+        int *threadSkipped;
         pthread_attr_t attr;
-        int rc = 0;
+        int rc = 0, stripe, range;
+
+        threadData = calloc(nthreads, sizeof(struct convert_record_data));
+        threadSkipped = calloc(nthreads, sizeof(int));
+        if (!threadData || !threadSkipped) {
+            sc_errf(data.s, "%s: out of memory\n", __func__);
+            free(threadData);
+            free(threadSkipped);
+            return -1;
+        }
 
         data.isThread = 1;
 
@@ -1545,24 +2050,42 @@ int convert_all_records(struct dbtable *from, struct dbtable *to,
         Pthread_attr_setstacksize(&attr, DEFAULT_THD_STACKSZ);
         Pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
 
-        /* start one thread for each stripe */
-        for (ii = 0; ii < gbl_dtastripe; ++ii) {
+        /* start one thread for each stripe, or each range of a split one */
+        for (ii = 0, stripe = 0, range = 0; ii < nthreads; ++ii) {
             /* create a copy of the data, modifying the necessary
              * thread specific values
              */
             threadData[ii] = data;
-            threadData[ii].stripe = ii;
+            threadData[ii].stripe = stripe;
+            threadData[ii].range = range;
+            if (!to->sc_ranges || ++range == to->sc_ranges->nranges[stripe]) {
+                range = 0;
+                ++stripe;
+            }
 
-            if (sc_genids[ii] == -1ULL) {
-                sc_printf(threadData[ii].s, "[%s] stripe %d was done\n",
-                          from->tablename, threadData[ii].stripe);
+            if (sc_genids[threadData[ii].stripe] == -1ULL) {
+                if (threadData[ii].range == 0)
+                    sc_printf(threadData[ii].s, "[%s] stripe %d was done\n",
+                              from->tablename, threadData[ii].stripe);
                 threadSkipped[ii] = 1;
                 continue;
             } else
                 threadSkipped[ii] = 0;
 
-            sc_printf(threadData[ii].s, "[%s] starting thread for stripe: %d\n",
-                      from->tablename, threadData[ii].stripe);
+            if (to->sc_ranges)
+                sc_printf(threadData[ii].s,
+                          "[%s] starting thread for stripe: %d range: %d\n",
+                          from->tablename, threadData[ii].stripe,
+                          threadData[ii].range);
+            else
+                sc_printf(threadData[ii].s,
+                          "[%s] starting thread for stripe: %d\n",
+                          from->tablename, threadData[ii].stripe);
+
+            if (bulk && sc_bulk_ix_open(&threadData[ii])) {
+                outrc = -1;
+                break;
+            }
 
             /* start thread */
             /* convert_records_thd( &threadData[ ii ]); |+ serialized calls +|*/
@@ -1583,7 +2106,7 @@ int convert_all_records(struct dbtable *from, struct dbtable *to,
         }
 
         /* wait for all convert threads to complete */
-        for (ii = 0; ii < gbl_dtastripe; ++ii) {
+        for (ii = 0; ii < nthreads; ++ii) {
             void *ret;
 
             if (threadSkipped[ii]) continue;
@@ -1614,6 +2137,13 @@ int convert_all_records(struct dbtable *from, struct dbtable *to,
 
         /* destroy attr */
         Pthread_attr_destroy(&attr);
+
+        if (outrc == 0 && bulk)
+            outrc = sc_bulk_ix_load(&data, threadData, nthreads);
+        for (ii = 0; ii < nthreads; ++ii)
+            sc_bulk_ix_close(&threadData[ii]);
+        free(threadData);
+        free(threadSkipped);
     }
 
     print_final_sc_stat(&data);
@@ -1640,6 +2170,16 @@ int convert_all_records(struct dbtable *from, struct dbtable *to,
         data.tagmap = NULL;
     }
 
+    /* every stripe is done, a resume goes by sc_genids alone */
+    if (outrc == 0 && to->sc_ranges && clear_sc_ranges(to)) {
+        sc_errf(s, "[%s] failed to clear stripe ranges\n", to->tablename);
+        outrc = -1;
+    }
+    if (outrc == 0 && bulk && set_sc_bulk(to, 0)) {
+        sc_errf(s, "[%s] failed to clear bulk index build\n", to->tablename);
+        outrc = -1;
+    }
+
     if (s->logical_livesc) {
         if (outrc == 0) {
             sc_printf(s, "[%s] All convert threads finished\n",
@@ -2975,7 +3515,8 @@ static int live_sc_redo_update(struct convert_record_data *data, DB_LOGC *logc,
 
     if (!data->s->sc_convert_done[rec->dtastripe] &&
         is_genid_right_of_stripe_pointer(data->to->handle, genid,
-                                         data->sc_genids)) {
+                                         data->sc_genids,
+                                         data->to->sc_ranges)) {
         /* if the newgenid is to the right of the sc cursor, we only need to
          * delete the old record */
         rc = del_new_record(&data->iq, data->trans, oldgenid, -1ULL,
@@ -3156,7 +3697,8 @@ static int live_sc_redo_logical_rec(struct convert_record_data *data,
     }
     if (!data->s->sc_convert_done[rec->dtastripe] &&
         is_genid_right_of_stripe_pointer(data->to->handle, rec->genid,
-                                         data->sc_genids)) {
+                                         data->sc_genids,
+                                         data->to->sc_ranges)) {
         /* skip those still to the right of sc cursor */
 #ifdef LOGICAL_LIVESC_DEBUG
         logmsg(LOGMSG_DEBUG, "%s:%d genid %llx is to the right of stripe pointer\n", __func__, __LINE__, rec->genid);
@@ -21,6 +21,7 @@
 #include <bdb/bdb_int.h>
 
 extern int gbl_logical_live_sc;
+extern int gbl_sc_stripe_ranges;
 
 struct common_members {
     int64_t ndeadlocks;
@@ -32,6 +33,19 @@ struct common_members {
     uint32_t total_lasttime;     // last time we computed total stats
 };
 
+#define SC_MAX_STRIPE_RANGES 16
+
+/* Key ranges a stripe is split into, so that one stripe can be converted by
+ * several threads.  Range k of a stripe holds the genids in
+ * (bound[k - 1], bound[k]]; the last range has no upper bound.  ptr[k] plays
+ * the part sc_genids[stripe] does for an unsplit stripe. */
+struct sc_stripe_ranges {
+    int nranges[MAXDTASTRIPE];
+    int ndone[MAXDTASTRIPE];
+    unsigned long long bound[MAXDTASTRIPE][SC_MAX_STRIPE_RANGES];
+    unsigned long long ptr[MAXDTASTRIPE][SC_MAX_STRIPE_RANGES];
+};
+
 struct redo_genid_lsns {
     unsigned long long genid;
     DB_LSN lsn;
@@ -57,6 +71,8 @@ struct convert_record_data {
     struct dbtable *from, *to;
     unsigned long long *sc_genids;
     int stripe;
+    int range; /* key range of the stripe, see struct sc_stripe_ranges */
+    unsigned long long range_genids[MAXDTASTRIPE]; /* scan position */
     struct dtadump *dmp;
     char *lastkey, *curkey;
     char key1[MAXKEYLEN], key2[MAXKEYLEN];
@@ -85,6 +101,8 @@ struct convert_record_data {
                                     constraint violation on */
     LISTC_T(struct redo_genid_lsns) redo_lsns;
     hash_t *redo_genids;
+    struct bdb_bulk_ix **bulk_ix; /* this thread's collectors, indexed by ix;
+                                     see sc_bulk_build_indexes */
 };
 
 int convert_all_records(struct dbtable *from, struct dbtable *to,
@@ -98,6 +116,10 @@ void convert_record_data_cleanup(struct convert_record_data *data);
 
 int init_sc_genids(struct dbtable *db, struct schema_change_type *s);
 
+int sc_bulk_ix_interrupted(struct dbtable *db);
+
+int clear_sc_progress(struct dbtable *db);
+
 void live_sc_enter_exclusive_all(bdb_state_type *, tran_type *);
 
 void *live_sc_logical_redo_thd(struct convert_record_data *data);
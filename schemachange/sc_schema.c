@@ -615,7 +615,8 @@ void verify_schema_change_constraint(struct ireq *iq, void *trans,
         goto unlock;
 
     if (is_genid_right_of_stripe_pointer(usedb->handle, newgenid,
-                                         usedb->sc_to->sc_genids)) {
+                                         usedb->sc_to->sc_genids,
+                                         usedb->sc_to->sc_ranges)) {
         goto unlock;
     }
 
@@ -613,7 +613,8 @@ int live_sc_post_delete_int(struct ireq *iq, void *trans,
     }
 
     if (is_genid_right_of_stripe_pointer(iq->usedb->handle, genid,
-                                         iq->usedb->sc_to->sc_genids)) {
+                                         iq->usedb->sc_to->sc_genids,
+                                         iq->usedb->sc_to->sc_ranges)) {
         return 0;
     }
 
@@ -711,7 +712,8 @@ int live_sc_post_add_int(struct ireq *iq, void *trans, unsigned long long genid,
     }
 
     if (is_genid_right_of_stripe_pointer(iq->usedb->handle, genid,
-                                         iq->usedb->sc_to->sc_genids)) {
+                                         iq->usedb->sc_to->sc_genids,
+                                         iq->usedb->sc_to->sc_ranges)) {
         return 0;
     }
 
@@ -801,14 +803,15 @@ int live_sc_post_update_int(struct ireq *iq, void *trans,
     }
 
     unsigned long long *sc_genids = iq->usedb->sc_to->sc_genids;
+    struct sc_stripe_ranges *sc_ranges = iq->usedb->sc_to->sc_ranges;
     if (iq->debug) {
         reqpushprefixf(iq, "live_sc_post_update: ");
     }
 
     int is_oldgen_gt_scptr = is_genid_right_of_stripe_pointer(
-        iq->usedb->handle, oldgenid, sc_genids);
+        iq->usedb->handle, oldgenid, sc_genids, sc_ranges);
     int is_newgen_gt_scptr = is_genid_right_of_stripe_pointer(
-        iq->usedb->handle, newgenid, sc_genids);
+        iq->usedb->handle, newgenid, sc_genids, sc_ranges);
     int rc = 0;
 
     // spelling this out for legibility, various situations:
@@ -818,15 +821,18 @@ int live_sc_post_update_int(struct ireq *iq, void *trans,
         if (iq->debug)
             reqprintf(iq,
                       "C1: scptr 0x%llx ... oldgenid 0x%llx newgenid 0x%llx ",
-                      get_genid_stripe_pointer(oldgenid, sc_genids), oldgenid,
-                      newgenid);
+                      get_genid_stripe_pointer(iq->usedb->handle, oldgenid,
+                                               sc_genids, sc_ranges),
+                      oldgenid, newgenid);
     } else if (is_newgen_gt_scptr &&
                !is_oldgen_gt_scptr) // case 2) oldgenid  .^....  newgenid
     {
         if (iq->debug)
             reqprintf(
                 iq, "C2: oldgenid 0x%llx ... scptr 0x%llx ... newgenid 0x%llx ",
-                oldgenid, get_genid_stripe_pointer(oldgenid, sc_genids),
+                oldgenid,
+                get_genid_stripe_pointer(iq->usedb->handle, oldgenid,
+                                         sc_genids, sc_ranges),
                 newgenid);
         rc = live_sc_post_del_record(iq, trans, oldgenid, old_dta, del_keys,
                                      oldblobs);
@@ -836,7 +842,9 @@ int live_sc_post_update_int(struct ireq *iq, void *trans,
         if (iq->debug)
             reqprintf(
                 iq, "C3: newgenid 0x%llx ...scptr 0x%llx ... oldgenid 0x%llx ",
-                newgenid, get_genid_stripe_pointer(oldgenid, sc_genids),
+                newgenid,
+                get_genid_stripe_pointer(iq->usedb->handle, oldgenid,
+                                         sc_genids, sc_ranges),
                 oldgenid);
         rc = unodhfy_if_necessary(iq, blobs, maxblobs);
         if (rc == 0)
@@ -849,7 +857,8 @@ int live_sc_post_update_int(struct ireq *iq, void *trans,
             reqprintf(iq,
                       "C4: oldgenid 0x%llx newgenid 0x%llx ... scptr 0x%llx",
                       oldgenid, newgenid,
-                      get_genid_stripe_pointer(oldgenid, sc_genids));
+                      get_genid_stripe_pointer(iq->usedb->handle, oldgenid,
+                                               sc_genids, sc_ranges));
         rc = unodhfy_if_necessary(iq, blobs, maxblobs);
         if (rc == 0)
             rc = live_sc_post_upd_record(iq, trans, oldgenid, old_dta, newgenid,
@@ -0,0 +1,113 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "comdb2.h"
+#include "sql.h"
+#include "comdb2systblInt.h"
+#include "ezsystables.h"
+#include "comdb2_atomic.h"
+#include "tohex.h"
+
+typedef struct systable_stmtcache {
+    char *fingerprint;
+    char *zNormSql;
+    int64_t threads;
+    int64_t hits;
+    int64_t prepares;
+    double hit_rate;
+    int64_t invalidations;
+    int64_t bytes;
+
+    char fp[FINGERPRINTSZ * 2 + 1];
+} systable_stmtcache_t;
+
+typedef struct getstmtcache {
+    int count;
+    int alloc;
+    systable_stmtcache_t *records;
+} getstmtcache_t;
+
+static void collect(shared_stmt_entry_t *e, void *user)
+{
+    getstmtcache_t *q = (getstmtcache_t *)user;
+    systable_stmtcache_t *i;
+    if (q->count >= q->alloc) {
+        int alloc = q->alloc ? q->alloc * 2 : 16;
+        systable_stmtcache_t *r = realloc(q->records, alloc * sizeof(*r));
+        if (!r)
+            return;
+        q->records = r;
+        q->alloc = alloc;
+    }
+
+    i = &q->records[q->count++];
+    memset(i, 0, sizeof(*i));
+    util_tohex(i->fp, (char *)e->fingerprint, FINGERPRINTSZ);
+    i->zNormSql = e->zNormSql ? strdup(e->zNormSql) : NULL;
+    i->threads = e->refcnt;
+    i->hits = ATOMIC_LOAD64(e->hits);
+    i->prepares = e->prepares;
+    if (i->hits + i->prepares > 0)
+        i->hit_rate = (double)i->hits / (i->hits + i->prepares);
+    i->invalidations = e->invalidations;
+    i->bytes = e->bytes;
+}
+
+static int get_stmtcache(void **data, int *records)
+{
+    getstmtcache_t q = {0};
+    shared_stmt_cache_foreach(collect, &q);
+    /* fingerprint points into the record itself; fix up after realloc */
+    for (int i = 0; i < q.count; i++)
+        q.records[i].fingerprint = q.records[i].fp;
+    *data = q.records;
+    *records = q.count;
+    return 0;
+}
+
+static void free_stmtcache(void *p, int n)
+{
+    systable_stmtcache_t *t = (systable_stmtcache_t *)p;
+    for (int i = 0; i < n; i++)
+        free(t[i].zNormSql);
+    free(p);
+}
+
+sqlite3_module systblStmtCacheModule = {
+    .access_flag = CDB2_ALLOW_USER,
+};
+
+int systblStmtCacheInit(sqlite3 *db)
+{
+    return create_system_table(db, "comdb2_stmt_cache",
+        &systblStmtCacheModule, get_stmtcache, free_stmtcache,
+        sizeof(systable_stmtcache_t),
+        CDB2_CSTRING, "fingerprint", -1,
+        offsetof(systable_stmtcache_t, fingerprint),
+        CDB2_CSTRING, "normalized_sql", -1,
+        offsetof(systable_stmtcache_t, zNormSql),
+        CDB2_INTEGER, "threads", -1, offsetof(systable_stmtcache_t, threads),
+        CDB2_INTEGER, "hits", -1, offsetof(systable_stmtcache_t, hits),
+        CDB2_INTEGER, "prepares", -1, offsetof(systable_stmtcache_t, prepares),
+        CDB2_REAL, "hit_rate", -1, offsetof(systable_stmtcache_t, hit_rate),
+        CDB2_INTEGER, "invalidations", -1,
+        offsetof(systable_stmtcache_t, invalidations),
+        CDB2_INTEGER, "bytes", -1, offsetof(systable_stmtcache_t, bytes),
+        SYSTABLE_END_OF_FIELDS);
+}
@@ -182,6 +182,8 @@ int comdb2SystblInit(
     rc = systblActivelocksInit(db);
   if (rc == SQLITE_OK)
     rc = systblSqlpoolQueueInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblStmtCacheInit(db);
   if (rc == SQLITE_OK)
     rc = systblNetUserfuncsInit(db);
   if (rc == SQLITE_OK)
@@ -19,6 +19,7 @@
 #include "tranlog.h"
 #include <assert.h>
 #include <string.h>
+#include <arpa/inet.h>
 #include "comdb2.h"
 #include "build/db.h"
 #include "dbinc/db_swap.h"
@@ -44,9 +45,13 @@
 #define TRANLOG_COLUMN_CHILDUTXNID  13
 #define TRANLOG_COLUMN_LSN_FILE     14 /* Useful for sorting records by LSN */
 #define TRANLOG_COLUMN_LSN_OFFSET   15
+#define TRANLOG_COLUMN_NRECORDS     16
 
 extern int gbl_apprec_gen;
 int gbl_tranlog_default_timeout = 30;
+int gbl_tranlog_batch_bytes = 1048576;
+int gbl_debug_tranlog_no_batch = 0;
+int gbl_debug_tranlog_truncate_batch = 0;
 
 /* Modeled after generate_series */
 typedef struct tranlog_cursor tranlog_cursor;
@@ -71,6 +76,12 @@ struct tranlog_cursor {
   int timeout;
   DB_LOGC *logc;             /* Log Cursor */
   DBT data;
+  int nBatch;                /* Records in batch, 0 if not batching */
+  DB_LSN batchLsn;           /* LSN of the first record in batch */
+  u_int32_t batchGen;        /* Highest generation in batch */
+  uint8_t *batch;
+  size_t batchLen;
+  size_t batchAlloc;
 };
 
 static int tranlogConnect(
@@ -84,7 +95,7 @@ static int tranlogConnect(
   int rc;
 
   rc = sqlite3_declare_vtab(db,
-     "CREATE TABLE x(minlsn hidden,maxlsn hidden,flags hidden,timeout hidden,blocklsn hidden,lsn,rectype integer,generation integer,timestamp integer,payload,txnid integer,utxnid integer,maxutxnid hidden, childutxnid hidden, lsnfile hidden, lsnoffset hidden)");
+     "CREATE TABLE x(minlsn hidden,maxlsn hidden,flags hidden,timeout hidden,blocklsn hidden,lsn,rectype integer,generation integer,timestamp integer,payload,txnid integer,utxnid integer,maxutxnid hidden, childutxnid hidden, lsnfile hidden, lsnoffset hidden, nrecords hidden)");
   if( rc==SQLITE_OK ){
     pNew = *ppVtab = sqlite3_malloc( sizeof(*pNew) );
     if( pNew==0 ) return SQLITE_NOMEM;
@@ -120,6 +131,8 @@ static int tranlogClose(sqlite3_vtab_cursor *cur){
   }
   if (pCur->data.data)
       free(pCur->data.data);
+  if (pCur->batch)
+      free(pCur->batch);
   if (pCur->minLsnStr)
       sqlite3_free(pCur->minLsnStr);
   if (pCur->maxLsnStr)
@@ -142,6 +155,7 @@ int gbl_tranlog_incoherent_timeout = 10;
 int gbl_tranlog_maxpoll = 60;
 extern int comdb2_sql_tick();
 extern int bdb_am_i_coherent(bdb_state_type *bdb_state);
+static int tranlog_fill_batch(tranlog_cursor *pCur);
 
 /*
 ** Advance a tranlog cursor to the next log entry
@@ -326,6 +340,12 @@ static int tranlogNext(sqlite3_vtab_cursor *cur)
       }
   }
 
+  pCur->nBatch = 0;
+  if ((pCur->flags & TRANLOG_FLAGS_BATCH) && !pCur->hitLast) {
+      if ((rc = tranlog_fill_batch(pCur)) != 0)
+          return rc;
+  }
+
   pCur->iRowid++;
   return SQLITE_OK;
 }
@@ -547,9 +567,100 @@ u_int64_t get_timestamp_from_matchable_record(char *data)
     return -1;
 }
 
+static u_int32_t get_generation_from_record(char *data)
+{
+    u_int32_t rectype = 0;
+
+    if (data)
+        LOGCOPY_32(&rectype, data);
+
+    normalize_rectype(&rectype);
+
+    if (rectype == DB___txn_regop_gen || rectype == DB___txn_regop_gen_endianize)
+        return get_generation_from_regop_gen_record(data);
+
+    if (rectype == DB___txn_dist_commit)
+        return get_generation_from_dist_commit_record(data);
+
+    if (rectype == DB___txn_dist_abort)
+        return get_generation_from_dist_abort_record(data);
+
+    if (rectype == DB___txn_regop_rowlocks || rectype == DB___txn_regop_rowlocks_endianize)
+        return get_generation_from_regop_rowlocks_record(data);
+
+    if (rectype == DB___txn_ckp || rectype == DB___txn_ckp_recovery)
+        return get_generation_from_ckp_record(data);
+
+    return 0;
+}
+
+static int tranlog_batch_add(tranlog_cursor *pCur)
+{
+    size_t need = pCur->batchLen + TRANLOG_BATCH_HDRSZ + pCur->data.size;
+    uint32_t hdr[3];
+    u_int32_t gen;
+
+    if (need > pCur->batchAlloc) {
+        size_t alloc = pCur->batchAlloc ? pCur->batchAlloc : 65536;
+        while (alloc < need)
+            alloc *= 2;
+        uint8_t *batch = realloc(pCur->batch, alloc);
+        if (batch == NULL)
+            return SQLITE_NOMEM;
+        pCur->batch = batch;
+        pCur->batchAlloc = alloc;
+    }
+
+    hdr[0] = htonl(pCur->curLsn.file);
+    hdr[1] = htonl(pCur->curLsn.offset);
+    hdr[2] = htonl(pCur->data.size);
+    memcpy(pCur->batch + pCur->batchLen, hdr, TRANLOG_BATCH_HDRSZ);
+    memcpy(pCur->batch + pCur->batchLen + TRANLOG_BATCH_HDRSZ, pCur->data.data, pCur->data.size);
+    pCur->batchLen = need;
+
+    if (pCur->nBatch++ == 0)
+        pCur->batchLsn = pCur->curLsn;
+    if ((gen = get_generation_from_record(pCur->data.data)) > pCur->batchGen)
+        pCur->batchGen = gen;
+    return SQLITE_OK;
+}
+
+/*
+** Pack the record the cursor is on, and whatever follows it that is already
+** in the log, into one row.  Only plain ascending scans are batched: durable,
+** descending and bounded scans return one record per row as before.  The
+** cursor is left on the last record packed, so the next call picks up (or
+** blocks) right after it.
+*/
+static int tranlog_fill_batch(tranlog_cursor *pCur)
+{
+    DB_LSN lsn;
+    int rc;
+
+    if (pCur->flags & (TRANLOG_FLAGS_DURABLE | TRANLOG_FLAGS_DESCENDING))
+        return SQLITE_OK;
+    if (pCur->maxLsn.file > 0 || pCur->blockLsn.file > 0)
+        return SQLITE_OK;
+
+    pCur->batchLen = 0;
+    pCur->batchGen = 0;
+    if ((rc = tranlog_batch_add(pCur)) != SQLITE_OK)
+        return rc;
+
+    while (pCur->batchLen < (size_t)gbl_tranlog_batch_bytes) {
+        if (pCur->logc->get(pCur->logc, &lsn, &pCur->data, DB_NEXT) != 0)
+            break;
+        pCur->curLsn = lsn;
+        if ((rc = tranlog_batch_add(pCur)) != SQLITE_OK)
+            return rc;
+    }
+    return SQLITE_OK;
+}
+
 /*
 ** Return values of columns for the row at which the series_cursor
-** is currently pointing.
+** is currently pointing.  In batch mode, lsn, generation and payload
+** describe the whole batch; the other columns describe its last record.
 */
 static int tranlogColumn(
   sqlite3_vtab_cursor *cur,   /* The cursor */
@@ -610,7 +721,7 @@ static int tranlogColumn(
         if (!pCur->curLsnStr) {
             pCur->curLsnStr = sqlite3_malloc(32);
         }
-        tranlog_lsn_to_str(pCur->curLsnStr, &pCur->curLsn);
+        tranlog_lsn_to_str(pCur->curLsnStr, pCur->nBatch ? &pCur->batchLsn : &pCur->curLsn);
         sqlite3_result_text(ctx, pCur->curLsnStr, -1, NULL);
         break;
     case TRANLOG_COLUMN_RECTYPE:
@@ -619,30 +730,10 @@ static int tranlogColumn(
         sqlite3_result_int64(ctx, rectype);
         break;
     case TRANLOG_COLUMN_GENERATION:
-        if (pCur->data.data)
-            LOGCOPY_32(&rectype, pCur->data.data); 
-
-        normalize_rectype(&rectype);
-
-        if (rectype == DB___txn_regop_gen || rectype == DB___txn_regop_gen_endianize){
-            generation = get_generation_from_regop_gen_record(pCur->data.data);
-        }
-
-        if (rectype == DB___txn_dist_commit){
-            generation = get_generation_from_dist_commit_record(pCur->data.data);
-        }
-
-        if (rectype == DB___txn_dist_abort){
-            generation = get_generation_from_dist_abort_record(pCur->data.data);
-        }
-
-        if (rectype == DB___txn_regop_rowlocks || rectype == DB___txn_regop_rowlocks_endianize) {
-            generation = get_generation_from_regop_rowlocks_record(pCur->data.data);
-        }
-
-        if (rectype == DB___txn_ckp || rectype == DB___txn_ckp_recovery) {
-            generation = get_generation_from_ckp_record(pCur->data.data);
-        }
+        if (pCur->nBatch)
+            generation = pCur->batchGen;
+        else
+            generation = get_generation_from_record(pCur->data.data);
 
         if (generation > 0) {
             sqlite3_result_int64(ctx, generation);
@@ -703,7 +794,14 @@ static int tranlogColumn(
         }
         break;
     case TRANLOG_COLUMN_LOG:
-        sqlite3_result_blob(ctx, pCur->data.data, pCur->data.size, NULL);
+        if (pCur->nBatch) {
+            /* Test hook: cut the last record short */
+            size_t len = pCur->batchLen;
+            if (gbl_debug_tranlog_truncate_batch && len > TRANLOG_BATCH_HDRSZ)
+                len--;
+            sqlite3_result_blob(ctx, pCur->batch, len, NULL);
+        } else
+            sqlite3_result_blob(ctx, pCur->data.data, pCur->data.size, NULL);
         break;
     case TRANLOG_COLUMN_CHILDUTXNID:
         if (pCur->data.data)
@@ -726,6 +824,9 @@ static int tranlogColumn(
     case TRANLOG_COLUMN_LSN_OFFSET:
         sqlite3_result_int(ctx, pCur->curLsn.offset);
         break;
+    case TRANLOG_COLUMN_NRECORDS:
+        sqlite3_result_int(ctx, pCur->nBatch ? pCur->nBatch : 1);
+        break;
   }
   return SQLITE_OK;
 }
@@ -817,6 +918,15 @@ static int tranlogBestIndex(
   int nArg = 0;          /* Number of arguments that seriesFilter() expects */
 
   const struct sqlite3_index_constraint *pConstraint;
+
+  /* Test hook: answer like a source that predates batching */
+  if( gbl_debug_tranlog_no_batch
+   && (pIdxInfo->colUsed & ((sqlite3_uint64)1 << TRANLOG_COLUMN_NRECORDS)) ){
+    sqlite3_free(tab->zErrMsg);
+    tab->zErrMsg = sqlite3_mprintf("no such column: nrecords");
+    return SQLITE_ERROR;
+  }
+
   pConstraint = pIdxInfo->aConstraint;
   for(i=0; i<pIdxInfo->nConstraint; i++, pConstraint++){
     if( pConstraint->usable==0 ) continue;
@@ -24,8 +24,14 @@ enum {
     TRANLOG_FLAGS_BLOCK             = 0x1,
     TRANLOG_FLAGS_DURABLE           = 0x2,
     TRANLOG_FLAGS_DESCENDING        = 0x4,
+    TRANLOG_FLAGS_BATCH             = 0x8,
 };
 
+/* With TRANLOG_FLAGS_BATCH, the payload of a row carries as many consecutive
+ * log records as fit in tranlog_batch_bytes.  Each record is preceded by its
+ * lsn file, lsn offset and length, as big-endian 32-bit integers. */
+#define TRANLOG_BATCH_HDRSZ 12
+
 u_int64_t get_timestamp_from_matchable_record(char *data);
 
 #endif
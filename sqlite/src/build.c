@@ -5724,6 +5724,53 @@ char *sqlite3DescribeIndexOrder(
   return ret2;
 }
 
+/*
+** Describe the columns of a remote table that a data cursor needs, for the
+** projection list of the remsql query.  Columns not set in colMask are sent
+** as NULL so the remote row keeps its shape.  Returns NULL if every column
+** is needed (colMask is 0, or all bits set) or the table is not found; the
+** caller then selects "*".
+*/
+char *sqlite3DescribeTableColumns(
+  sqlite3 *db,
+  const char *zName,
+  const char *zDb,
+  unsigned long long colMask)
+{
+  Table *pTbl;
+  char  *ret = NULL, *ret2;
+  int   i;
+  int   nSkipped = 0;
+
+  if( colMask==0 ) return NULL;
+
+  pTbl = sqlite3FindTableCheckOnlyNoAlias(db, zName, zDb);
+  if( !pTbl ) return NULL;
+
+  for(i=0; i<pTbl->nCol; i++){
+    if( IsHiddenColumn(&pTbl->aCol[i]) ){
+      sqlite3_free(ret);
+      return NULL;
+    }
+    if( (colMask & (1ULL<<(i<63 ? i : 63))) ){
+      ret2 = sqlite3_mprintf("%s%s\"%w\"", ret ? ret : "", ret ? ", " : "",
+                             pTbl->aCol[i].zName);
+    }else{
+      ret2 = sqlite3_mprintf("%s%sNULL", ret ? ret : "", ret ? ", " : "");
+      nSkipped++;
+    }
+    sqlite3_free(ret);
+    ret = ret2;
+    if( !ret ) return NULL;
+  }
+
+  if( nSkipped==0 ){
+    sqlite3_free(ret);
+    return NULL;
+  }
+  return ret;
+}
+
 /*
 ** Reset the schema for all remote dbs from an engine.
 */
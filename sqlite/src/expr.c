@@ -6196,7 +6196,16 @@ static char* sqlite3ExprDescribe_inner(
       return ret;
     }
     case TK_COLLATE: {
-      break;
+      char *left = sqlite3ExprDescribe_inner(v, pExpr->pLeft, atRuntime,
+              pParamsOut, srcs);
+      if (!left)
+        return NULL;
+      char *ret = sqlite3_mprintf("( %s COLLATE \"%w\" )", left,
+              pExpr->u.zToken);
+
+      sqlite3_free(left);
+
+      return ret;
     }
     case TK_BITNOT: {
       char *left = sqlite3ExprDescribe_inner(v, pExpr->pLeft, atRuntime,
@@ -6536,16 +6545,24 @@ default_prec:
     }
   }
   if (op == TK_AGG_FUNCTION) {
-      if (pParamsOut /* comes from dohsql */ &&
-              !strcasecmp(pExpr->u.zToken, "count")) {
+      /* dohsql only; the shards' partial results are combined by the
+       * master, so only decomposable aggregates can be described */
+      if (pParamsOut && !ExprHasProperty(pExpr, EP_Distinct) &&
+          (!strcasecmp(pExpr->u.zToken, "count") ||
+           !strcasecmp(pExpr->u.zToken, "sum") ||
+           !strcasecmp(pExpr->u.zToken, "total") ||
+           !strcasecmp(pExpr->u.zToken, "min") ||
+           !strcasecmp(pExpr->u.zToken, "max"))) {
         if (!pExpr->x.pList) {
-          return sqlite3_mprintf("count(*)");
+          if (!strcasecmp(pExpr->u.zToken, "count"))
+            return sqlite3_mprintf("count(*)");
         } else if (pExpr->x.pList->nExpr == 1) {
             char *arguments = sqlite3ExprDescribe_inner(v,
                     pExpr->x.pList->a[0].pExpr, atRuntime, pParamsOut,
                     srcs);
             if (arguments) {
-                char *ret = sqlite3_mprintf("count(%s)", arguments);
+                char *ret = sqlite3_mprintf("%s(%s)", pExpr->u.zToken,
+                                            arguments);
                 sqlite3_free(arguments);
                 return ret;
             }
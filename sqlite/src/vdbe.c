@@ -4396,13 +4396,17 @@ case OP_OpenDup: {
 ** the btree.  The BTREE_OMIT_JOURNAL and BTREE_SINGLE flags are
 ** added automatically.
 */
-/* Opcode: OpenAutoindex P1 P2 * P4 *
+/* Opcode: OpenAutoindex P1 P2 P3 P4 P5
 ** Synopsis: nColumn=P2
 **
 ** This opcode works the same as OP_OpenEphemeral.  It has a
 ** different name to distinguish its use.  Tables created using
 ** by this opcode will be used for automatically created transient
 ** indices in joins.
+**
+** COMDB2: if P5 has BTREE_HASHJOIN, the index is the build side of
+** a hash join keyed on its first P3 columns.  Seeks on it must be
+** equality seeks on those columns, and entries come back unordered.
 */
 case OP_OpenAutoindex: 
 case OP_OpenEphemeral: {
@@ -4459,6 +4463,9 @@ case OP_OpenEphemeral: {
           rc = sqlite3BtreeCursor(p, pCx->pBtx, pCx->pgnoRoot,
                                   BTREE_CUR_WR|BTREE_WRCSR, 0,
                                   pKeyInfo, pCx->uc.pCursor);
+          if( rc==SQLITE_OK && (pOp->p5 & BTREE_HASHJOIN)!=0 ){
+            sqlite3BtreeCursorHashJoin(pCx->uc.pCursor, pOp->p3);
+          }
 #else /* defined(SQLITE_BUILDING_FOR_COMDB2) */
           rc = sqlite3BtreeCursor(pCx->pBtx, pCx->pgnoRoot, BTREE_WRCSR,
                                   pKeyInfo, pCx->uc.pCursor);
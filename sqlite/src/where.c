@@ -45,6 +45,7 @@ static int whereLoopResize(sqlite3*, WhereLoop*, int);
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
 int gbl_disable_seekscan_optimization = 1;
 int gbl_sqlite_stat4_scan = 0;
+int gbl_sql_hashjoin = 0;
 
 int shard_check_parallelism(int iTable);
 int comdb2_shard_table_constraints(Parse *pParse, 
@@ -715,6 +716,49 @@ static int termCanDriveIndex(
   testcase( pTerm->pExpr->op==TK_IS );
   return 1;
 }
+
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+/*
+** Return TRUE if values of affinity aff hash by value.  comdb2 datetimes,
+** intervals, decimals and small floats only compare equal after a
+** conversion, so the btree layer cannot hash them and a probe with such a
+** key would scan the whole build table.
+*/
+static int affinityCanHash(char aff){
+  if( aff>=SQLITE_AFF_DATETIME && aff<=SQLITE_AFF_INTV_SE ) return 0;
+  if( aff==SQLITE_AFF_DECIMAL || aff==SQLITE_AFF_SMALL ) return 0;
+  return 1;
+}
+
+/*
+** Return TRUE if the WHERE clause term pTerm can be a key column of a
+** hash join on table pSrc.  On top of what an automatic index needs, the
+** comparison must use the BINARY collation and both sides must be of a
+** type that hashes by value: equal keys have to hash to the same value,
+** which the btree layer computes from the raw bytes.
+*/
+static int termCanDriveHash(
+  Parse *pParse,                 /* Parsing context */
+  WhereTerm *pTerm,              /* WHERE clause term to check */
+  struct SrcList_item *pSrc,     /* Table we are trying to access */
+  Bitmask notReady               /* Tables in outer loops of the join */
+){
+  Expr *pX;
+  CollSeq *pColl;
+  if( !gbl_sql_hashjoin ) return 0;
+  if( !termCanDriveIndex(pTerm, pSrc, notReady) ) return 0;
+  if( !affinityCanHash(pSrc->pTab->aCol[pTerm->u.leftColumn].affinity) ){
+    return 0;
+  }
+  pX = pTerm->pExpr;
+  if( !affinityCanHash(sqlite3ExprAffinity(pX->pLeft))
+   || !affinityCanHash(sqlite3ExprAffinity(pX->pRight)) ){
+    return 0;
+  }
+  pColl = sqlite3BinaryCompareCollSeq(pParse, pX->pLeft, pX->pRight);
+  return pColl==0 || sqlite3StrICmp(pColl->zName, sqlite3StrBINARY)==0;
+}
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 #endif
 
 
@@ -754,6 +798,9 @@ static void constructAutomaticIndex(
   struct SrcList_item *pTabItem;  /* FROM clause term being indexed */
   int addrCounter = 0;        /* Address where integer counter is initialized */
   int regBase;                /* Array of registers where record is assembled */
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  int isHash = (pLevel->pWLoop->wsFlags & WHERE_AUTO_HASH)!=0;
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 
   /* Generate code to skip over the creation and initialization of the
   ** transient index on 2nd and subsequent iterations of the loop. */
@@ -780,7 +827,12 @@ static void constructAutomaticIndex(
       pPartial = sqlite3ExprAnd(pParse->db, pPartial,
                                 sqlite3ExprDup(pParse->db, pExpr, 0));
     }
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+    if( isHash ? termCanDriveHash(pParse, pTerm, pSrc, notReady)
+               : termCanDriveIndex(pTerm, pSrc, notReady) ){
+#else /* defined(SQLITE_BUILDING_FOR_COMDB2) */
     if( termCanDriveIndex(pTerm, pSrc, notReady) ){
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
       int iCol = pTerm->u.leftColumn;
       Bitmask cMask = iCol>=BMS ? MASKBIT(BMS-1) : MASKBIT(iCol);
       testcase( iCol==BMS );
@@ -804,6 +856,9 @@ static void constructAutomaticIndex(
   pLoop->u.btree.nEq = pLoop->nLTerm = nKeyCol;
   pLoop->wsFlags = WHERE_COLUMN_EQ | WHERE_IDX_ONLY | WHERE_INDEXED
                      | WHERE_AUTO_INDEX;
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  if( isHash ) pLoop->wsFlags |= WHERE_AUTO_HASH;
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 
   /* Count the number of additional columns needed to create a
   ** covering index.  A "covering index" is an index that contains all
@@ -833,7 +888,12 @@ static void constructAutomaticIndex(
   n = 0;
   idxCols = 0;
   for(pTerm=pWC->a; pTerm<pWCEnd; pTerm++){
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+    if( isHash ? termCanDriveHash(pParse, pTerm, pSrc, notReady)
+               : termCanDriveIndex(pTerm, pSrc, notReady) ){
+#else /* defined(SQLITE_BUILDING_FOR_COMDB2) */
     if( termCanDriveIndex(pTerm, pSrc, notReady) ){
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
       int iCol = pTerm->u.leftColumn;
       Bitmask cMask = iCol>=BMS ? MASKBIT(BMS-1) : MASKBIT(iCol);
       testcase( iCol==BMS-1 );
@@ -873,7 +933,13 @@ static void constructAutomaticIndex(
   /* Create the automatic index */
   assert( pLevel->iIdxCur>=0 );
   pLevel->iIdxCur = pParse->nTab++;
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  sqlite3VdbeAddOp3(v, OP_OpenAutoindex, pLevel->iIdxCur, nKeyCol+1,
+                    isHash ? pLoop->u.btree.nEq : 0);
+  if( isHash ) sqlite3VdbeChangeP5(v, BTREE_HASHJOIN);
+#else /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   sqlite3VdbeAddOp2(v, OP_OpenAutoindex, pLevel->iIdxCur, nKeyCol+1);
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   sqlite3VdbeSetP4KeyInfo(pParse, pIdx);
   VdbeComment((v, "for %s", pTable->zName));
 
@@ -3011,6 +3077,17 @@ static int whereLoopAddBtree(
         pNew->nOut = 43;  assert( 43==sqlite3LogEst(20) );
         pNew->rRun = sqlite3LogEstAdd(rLogSize,pNew->nOut);
         pNew->wsFlags = WHERE_AUTO_INDEX;
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+        if( termCanDriveHash(pWInfo->pParse, pTerm, pSrc, 0) ){
+          /* TUNING: A hash join build is one pass over the table, with no
+          ** sort, so drop the log2(N) factor from the setup cost.  A probe
+          ** goes straight to its bucket instead of descending a btree. */
+          pNew->rSetup -= rLogSize;
+          if( pNew->rSetup<0 ) pNew->rSetup = 0;
+          pNew->rRun = pNew->nOut;
+          pNew->wsFlags |= WHERE_AUTO_HASH;
+        }
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
         pNew->prereq = mPrereq | pTerm->prereqRight;
         rc = whereLoopInsert(pBuilder, pNew);
       }
@@ -5345,6 +5422,18 @@ WhereInfo *sqlite3WhereBegin(
           int ii, jj;
           for(ii=0; ii<pIx->nColumn; ii++){
             jj = pIx->aiColumn[ii];
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+            /* Comdb2 leaves unused key columns unconverted (NULL), so also
+            ** mark expression columns and the leading columns the loop seeks
+            ** and compares on, which skip-scan reads without them being
+            ** referenced by the statement. A row-value range compares up to
+            ** nBtm or nTop columns past the equality prefix. */
+            if( jj==XN_EXPR || ii<pLoop->u.btree.nEq +
+                    MAX(MAX(pLoop->u.btree.nBtm, pLoop->u.btree.nTop), 1) ){
+              colUsed |= ((u64)1)<<(ii<63 ? ii : 63);
+              continue;
+            }
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
             if( jj<0 ) continue;
             if( jj>63 ) jj = 63;
             if( (pTabItem->colUsed & MASKBIT(jj))==0 ) continue;
@@ -0,0 +1,12 @@
+local function main(n, batch)
+    local consumer = db:consumer()
+    local count = 0
+    while count < n do
+        local want = n - count
+        if want > batch then want = batch end
+        local events = consumer:get_batch(want)
+        consumer:consume_batch()
+        count = count + #events
+    end
+    db:emit(count)
+end
@@ -0,0 +1,10 @@
+local function main(n)
+    local consumer = db:consumer()
+    local count = 0
+    while count < n do
+        consumer:get()
+        consumer:consume()
+        count = count + 1
+    end
+    db:emit(count)
+end
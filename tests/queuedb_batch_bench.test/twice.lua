@@ -0,0 +1,7 @@
+local function main(batch)
+    local consumer = db:consumer()
+    local events = consumer:get_batch(batch)
+    local first = consumer:consume_batch()
+    local second = consumer:consume_batch()
+    db:emit(#events, first, second)
+end
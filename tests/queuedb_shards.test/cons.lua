@@ -0,0 +1,25 @@
+local function main(n, batch)
+    db:num_columns(3)
+    db:column_name("w", 1) db:column_type("int", 1)
+    db:column_name("i", 2) db:column_type("int", 2)
+    db:column_name("seq", 3) db:column_type("int", 3)
+    local consumer = db:consumer({with_sequence = true})
+    local count = 0
+    while count < n do
+        if batch > 0 then
+            local want = n - count
+            if want > batch then want = batch end
+            local events = consumer:get_batch(want)
+            for _, e in ipairs(events) do
+                db:emit(e.new.w, e.new.i, e.sequence)
+            end
+            consumer:consume_batch()
+            count = count + #events
+        else
+            local e = consumer:get()
+            db:emit(e.new.w, e.new.i, e.sequence)
+            consumer:consume()
+            count = count + 1
+        end
+    end
+end
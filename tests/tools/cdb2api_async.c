@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <poll.h>
+
+#include <cdb2api.h>
+
+#define NQUERIES 100
+
+static int completed;
+static int failed;
+
+static void expect_one(cdb2_hndl_tp *hndl, void *arg, int rc)
+{
+    intptr_t want = (intptr_t)arg;
+
+    if (want != completed) {
+        fprintf(stderr, "out of order: got %ld, expected %d\n", (long)want,
+                completed);
+        failed = 1;
+    }
+    ++completed;
+
+    if (rc != CDB2_OK) {
+        fprintf(stderr, "query %ld: rc %d: %s\n", (long)want, rc,
+                cdb2_errstr(hndl));
+        failed = 1;
+        return;
+    }
+    if ((rc = cdb2_next_record(hndl)) != CDB2_OK) {
+        fprintf(stderr, "query %ld: next rc %d\n", (long)want, rc);
+        failed = 1;
+        return;
+    }
+    if (*(int64_t *)cdb2_column_value(hndl, 0) != want) {
+        fprintf(stderr, "query %ld: got %lld\n", (long)want,
+                (long long)*(int64_t *)cdb2_column_value(hndl, 0));
+        failed = 1;
+    }
+    if (cdb2_next_record(hndl) != CDB2_OK_DONE) {
+        fprintf(stderr, "query %ld: more than one row\n", (long)want);
+        failed = 1;
+    }
+}
+
+/* Leaves its rows unread; the next callback must still see its own. */
+static void skip_rows(cdb2_hndl_tp *hndl, void *arg, int rc)
+{
+    if (rc != CDB2_OK) {
+        fprintf(stderr, "skip_rows: rc %d: %s\n", rc, cdb2_errstr(hndl));
+        failed = 1;
+    }
+    ++completed;
+}
+
+static void expect_error(cdb2_hndl_tp *hndl, void *arg, int rc)
+{
+    if (rc == CDB2_OK) {
+        fprintf(stderr, "expected an error\n");
+        failed = 1;
+    }
+    ++completed;
+}
+
+int main(int argc, char **argv)
+{
+    cdb2_hndl_tp *hndl = NULL;
+    const char *conf = getenv("CDB2_CONFIG");
+    const char *db, *tier;
+    int64_t i;
+    int rc, total = 0;
+
+    if (argc < 2)
+        return 1;
+
+    db = argv[1];
+
+    if (argc > 2)
+        tier = argv[2];
+    else
+        tier = "default";
+
+    if (conf != NULL)
+        cdb2_set_comdb2db_config(conf);
+
+    rc = cdb2_open(&hndl, db, tier, 0);
+    if (rc != 0) {
+        fprintf(stderr, "Error opening a handle: %d: %s.\n",
+                rc, cdb2_errstr(hndl));
+        return 1;
+    }
+
+    if (cdb2_async_submit(hndl, "insert into t values(1)", expect_error,
+                          NULL) != CDB2ERR_NOTSUPPORTED) {
+        fprintf(stderr, "a write was accepted\n");
+        return 1;
+    }
+
+    for (i = 0; i < NQUERIES; i++) {
+        /* &i changes before the query is answered; submit must copy it. */
+        cdb2_clearbindings(hndl);
+        cdb2_bind_param(hndl, "i", CDB2_INTEGER, &i, sizeof(i));
+        rc = cdb2_async_submit(hndl, "select @i", expect_one,
+                               (void *)(intptr_t)i);
+        if (rc != 0) {
+            fprintf(stderr, "submit %ld: %d: %s\n", (long)i, rc,
+                    cdb2_errstr(hndl));
+            return 1;
+        }
+    }
+    cdb2_clearbindings(hndl);
+    total = NQUERIES;
+
+    /* expect_one checks its position in the queue, so these go last. */
+    cdb2_async_submit(hndl, "select value from generate_series(1, 10000)",
+                      skip_rows, NULL);
+    cdb2_async_submit(hndl, "select * from no_such_table", expect_error, NULL);
+    total += 2;
+
+    if (cdb2_run_statement(hndl, "select 1") != CDB2ERR_BADSTATE) {
+        fprintf(stderr, "ran a statement with queries pending\n");
+        return 1;
+    }
+
+    while (cdb2_async_pending(hndl) > 0) {
+        struct pollfd pfd = {.fd = cdb2_async_fd(hndl), .events = POLLIN};
+        if (pfd.fd >= 0 && poll(&pfd, 1, 10000) <= 0) {
+            fprintf(stderr, "timed out with %d pending\n",
+                    cdb2_async_pending(hndl));
+            return 1;
+        }
+        if ((rc = cdb2_async_poll(hndl, 0)) < 0) {
+            fprintf(stderr, "poll rc %d: %s\n", rc, cdb2_errstr(hndl));
+            return 1;
+        }
+    }
+
+    if (completed != total) {
+        fprintf(stderr, "completed %d of %d\n", completed, total);
+        return 1;
+    }
+
+    /* The handle is usable synchronously again. */
+    rc = cdb2_run_statement(hndl, "select 42");
+    if (rc != 0 || cdb2_next_record(hndl) != CDB2_OK ||
+        *(int64_t *)cdb2_column_value(hndl, 0) != 42) {
+        fprintf(stderr, "sync query after async: %d: %s\n", rc,
+                cdb2_errstr(hndl));
+        return 1;
+    }
+    while (cdb2_next_record(hndl) == CDB2_OK)
+        ;
+
+    cdb2_close(hndl);
+    return failed;
+}
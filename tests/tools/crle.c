@@ -20,6 +20,7 @@
 #include <string.h>
 #include <stdio.h>
 #include <alloca.h>
+#include <time.h>
 
 #undef NDEBUG
 #include <assert.h>
@@ -471,8 +472,170 @@ static void test_encode_middle_field_2()
     fprintf(stderr, "passed %s\n", __func__);
 }
 
+/* repeats() as it was before the mismatch scan; the reference for fuzzing */
+static uint32_t repeats_ref(Data in, uint32_t sz, uint32_t *r_)
+{
+    uint32_t r;
+    r = *r_ = 0;
+    if (in.sz < (sz * 2))
+        return 0;
+    uint8_t *bp = in.dt + sz;
+    if (sz == 1) {
+        uint8_t *bx = in.dt + in.sz;
+        while (bp < bx && *bp == *in.dt)
+            ++bp;
+        r = bp - in.dt - 1;
+    } else {
+        in.sz -= (in.sz % sz);
+        while ((in.sz -= sz) != 0) {
+            if (memcmp(in.dt, bp, sz))
+                break;
+            bp += sz;
+            ++r;
+        }
+    }
+    *r_ = r;
+    return r;
+}
+
+/* Fill buf with runs of random patterns and random junk */
+static void fuzz_fill(uint8_t *buf, size_t sz)
+{
+    size_t i = 0;
+    while (i < sz) {
+        size_t len = 1 + rand() % 300;
+        if (len > sz - i)
+            len = sz - i;
+        switch (rand() % 4) {
+        case 0: /* junk */
+            for (size_t j = 0; j < len; ++j)
+                buf[i + j] = rand();
+            break;
+        case 1: /* well known pattern */
+        {
+            int p = rand() % MAXPAT;
+            for (size_t j = 0; j < len; ++j)
+                buf[i + j] = patterns[p][j % psizes[p]];
+            break;
+        }
+        default: /* repeating pattern of a random size */
+        {
+            uint8_t pat[16];
+            size_t psz = 1 + rand() % sizeof(pat);
+            for (size_t j = 0; j < psz; ++j)
+                pat[j] = rand() % 3; /* low entropy: more near misses */
+            for (size_t j = 0; j < len; ++j)
+                buf[i + j] = pat[j % psz];
+            break;
+        }
+        }
+        i += len;
+    }
+}
+
+static void test_fuzz()
+{
+    enum { MAXSZ = 8192, ITER = 20000 };
+    uint8_t *in = malloc(MAXSZ);
+    uint8_t *vec = malloc(MAXSZ * 2);
+    uint8_t *ref = malloc(MAXSZ * 2);
+    uint8_t *dec = malloc(MAXSZ);
+    assert(in && vec && ref && dec);
+    mismatch_t simd = mismatch_select();
+    for (int it = 0; it < ITER; ++it) {
+        size_t sz = 1 + rand() % (it < ITER / 2 ? 64 : MAXSZ);
+        fuzz_fill(in, sz);
+
+        /* run detection at every offset and size matches the reference */
+        for (size_t off = 0; off < sz; off += 1 + rand() % 17) {
+            Data d = {.dt = in + off, .sz = sz - off};
+            for (int s = 0; s < CNT(sizes); ++s) {
+                uint32_t r, rr;
+                mismatch_func = simd;
+                repeats(d, sizes[s], &r);
+                repeats_ref(d, sizes[s], &rr);
+                assert(r == rr);
+            }
+        }
+
+        /* compressed bytes are identical with and without simd */
+        Comdb2RLE c = {.in = in, .insz = sz, .out = vec, .outsz = MAXSZ * 2};
+        mismatch_func = simd;
+        int rc = compressComdb2RLE(&c);
+        Comdb2RLE cr = {.in = in, .insz = sz, .out = ref, .outsz = MAXSZ * 2};
+        mismatch_func = mismatch_scalar;
+        assert(compressComdb2RLE(&cr) == rc);
+        if (rc != 0)
+            continue;
+        assert(c.outsz == cr.outsz);
+        assert(memcmp(vec, ref, c.outsz) == 0);
+
+        Comdb2RLE d = {.in = vec, .insz = c.outsz, .out = dec, .outsz = MAXSZ};
+        assert(decompressComdb2RLE(&d) == 0);
+        assert(d.outsz == sz);
+        assert(memcmp(in, dec, sz) == 0);
+    }
+    mismatch_func = NULL;
+    free(in);
+    free(vec);
+    free(ref);
+    free(dec);
+    fprintf(stderr, "passed %s\n", __func__);
+}
+
+static double bench_mbps(size_t bytes, struct timespec *s, struct timespec *e)
+{
+    double sec = (e->tv_sec - s->tv_sec) + (e->tv_nsec - s->tv_nsec) / 1e9;
+    return sec > 0 ? bytes / sec / (1 << 20) : 0;
+}
+
+/* crle bench [size] [iterations] */
+static int bench(int argc, char *argv[])
+{
+    size_t sz = argc > 2 ? atoi(argv[2]) : 4096;
+    int iter = argc > 3 ? atoi(argv[3]) : 100000;
+    uint8_t *in = malloc(sz);
+    uint8_t *out = malloc(sz * 2);
+    uint8_t *dec = malloc(sz);
+    assert(in && out && dec);
+    srand(0);
+    fuzz_fill(in, sz);
+
+    mismatch_t impl[] = {mismatch_scalar, mismatch_select()};
+    const char *name[] = {"scalar", "simd"};
+    for (int i = 0; i < CNT(impl); ++i) {
+        struct timespec s, e;
+        Comdb2RLE c = {0};
+        mismatch_func = impl[i];
+        clock_gettime(CLOCK_MONOTONIC, &s);
+        for (int j = 0; j < iter; ++j) {
+            c = (Comdb2RLE){.in = in, .insz = sz, .out = out, .outsz = sz * 2};
+            assert(compressComdb2RLE(&c) == 0);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &e);
+        double comp = bench_mbps(sz * iter, &s, &e);
+
+        clock_gettime(CLOCK_MONOTONIC, &s);
+        for (int j = 0; j < iter; ++j) {
+            Comdb2RLE d = {.in = out, .insz = c.outsz, .out = dec, .outsz = sz};
+            assert(decompressComdb2RLE(&d) == 0);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &e);
+        double decomp = bench_mbps(sz * iter, &s, &e);
+        printf("%-6s size:%zu ratio:%.2f compress:%.1f MB/s decompress:%.1f MB/s\n",
+               name[i], sz, (double)sz / c.outsz, comp, decomp);
+    }
+    free(in);
+    free(out);
+    free(dec);
+    return EXIT_SUCCESS;
+}
+
 int main(int argc, char *argv[])
 {
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+        return bench(argc, argv);
+
     test_varint();
     test_repeat();
     test_repeat_rev();
@@ -483,6 +646,7 @@ int main(int argc, char *argv[])
     test_decode();
     test_encode_middle_field();
     test_encode_middle_field_2();
+    test_fuzz();
 
     fprintf(stderr, "PASSED ALL TESTS\n");
     return EXIT_SUCCESS;
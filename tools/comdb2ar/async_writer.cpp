@@ -0,0 +1,208 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include "async_writer.h"
+#include "error.h"
+
+#include <sstream>
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* dlmalloc clashes with malloc definitions, so can't include malloc.h
+ * that defines this properly */
+void *memalign(size_t boundary, size_t size);
+
+AsyncWriter::AsyncWriter(unsigned nthreads, size_t max_buffered,
+                         size_t write_size)
+    : m_pending(0), m_buffered(0), m_max_buffered(max_buffered),
+      m_write_size(write_size), m_stop(false)
+{
+    for (unsigned i = 0; i < nthreads; i++) {
+        m_workers.push_back(std::unique_ptr<Worker>(new Worker()));
+        m_workers.back()->queued = 0;
+    }
+    for (size_t i = 0; i < m_workers.size(); i++) {
+        Worker *w = m_workers[i].get();
+        w->thread = std::thread(&AsyncWriter::run, this, w);
+    }
+}
+
+AsyncWriter::~AsyncWriter()
+// Anything still queued is written out before the threads exit.
+{
+    {
+        std::lock_guard<std::mutex> lk(m_lock);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    for (size_t i = 0; i < m_workers.size(); i++) {
+        m_workers[i]->thread.join();
+    }
+}
+
+void AsyncWriter::run(Worker *w)
+{
+    std::unique_lock<std::mutex> lk(m_lock);
+    while (true) {
+        m_cond.wait(lk, [&] { return m_stop || !w->ops.empty(); });
+        if (w->ops.empty()) {
+            return;
+        }
+        Op op = w->ops.front();
+        w->ops.pop_front();
+        lk.unlock();
+
+        File& f = *op.file;
+        std::string error;
+        if (op.buf == NULL) {
+            f.out.reset();
+        } else if (!f.failed) {
+            size_t off = 0;
+            while (off < op.len) {
+                size_t lim = op.len - off;
+                if (lim > m_write_size) {
+                    lim = m_write_size;
+                }
+                if (!f.out->write((char *)&op.buf[off], lim)) {
+                    std::ostringstream ss;
+                    ss << "Error Writing " << f.name << ": " << errno << " "
+                       << strerror(errno);
+                    error = ss.str();
+                    f.failed = true;
+                    break;
+                }
+                off += lim;
+            }
+        }
+        free(op.buf);
+
+        lk.lock();
+        if (!error.empty() && m_error.empty()) {
+            m_error = error;
+        }
+        m_pending--;
+        m_buffered -= op.alloc;
+        w->queued -= op.alloc;
+        m_cond.notify_all();
+    }
+}
+
+int AsyncWriter::open(std::unique_ptr<fdostream> out, const std::string& name)
+{
+    std::shared_ptr<File> f(new File());
+    f->out = std::move(out);
+    f->name = name;
+    f->failed = false;
+
+    // Give the file to the thread with the least outstanding work
+    std::lock_guard<std::mutex> lk(m_lock);
+    f->worker = 0;
+    for (size_t i = 1; i < m_workers.size(); i++) {
+        if (m_workers[i]->queued < m_workers[f->worker]->queued) {
+            f->worker = i;
+        }
+    }
+    m_files.push_back(f);
+    return m_files.size() - 1;
+}
+
+uint8_t *AsyncWriter::get_buffer(size_t size)
+{
+    size_t alloc = (size + 511) & ~(size_t)511;
+    {
+        std::unique_lock<std::mutex> lk(m_lock);
+        m_cond.wait(lk, [&] {
+            return m_buffered == 0 || m_buffered + alloc <= m_max_buffered;
+        });
+        m_buffered += alloc;
+    }
+
+    uint8_t *buf = NULL;
+#if defined _SUN_SOURCE
+    buf = (uint8_t *)memalign(512, alloc);
+#else
+    if (posix_memalign((void **)&buf, 512, alloc))
+        buf = NULL;
+#endif
+    if (buf == NULL) {
+        std::lock_guard<std::mutex> lk(m_lock);
+        m_buffered -= alloc;
+        throw Error("Failed to allocate output buffer");
+    }
+    return buf;
+}
+
+void AsyncWriter::put_buffer(uint8_t *buf, size_t size)
+{
+    free(buf);
+    {
+        std::lock_guard<std::mutex> lk(m_lock);
+        m_buffered -= (size + 511) & ~(size_t)511;
+    }
+    m_cond.notify_all();
+}
+
+void AsyncWriter::enqueue(const Op& op)
+{
+    {
+        std::lock_guard<std::mutex> lk(m_lock);
+        m_pending++;
+        Worker *w = m_workers[op.file->worker].get();
+        w->ops.push_back(op);
+        w->queued += op.alloc;
+    }
+    m_cond.notify_all();
+}
+
+void AsyncWriter::write(int handle, uint8_t *buf, size_t len)
+{
+    Op op;
+    op.file = m_files[handle];
+    op.buf = buf;
+    op.len = len;
+    op.alloc = (len + 511) & ~(size_t)511;
+    enqueue(op);
+}
+
+void AsyncWriter::close(int handle)
+{
+    Op op;
+    op.file = m_files[handle];
+    op.buf = NULL;
+    op.len = 0;
+    op.alloc = 0;
+    enqueue(op);
+    m_files[handle].reset();
+}
+
+void AsyncWriter::check()
+{
+    std::lock_guard<std::mutex> lk(m_lock);
+    if (!m_error.empty()) {
+        throw Error(m_error);
+    }
+}
+
+void AsyncWriter::finish()
+{
+    {
+        std::unique_lock<std::mutex> lk(m_lock);
+        m_cond.wait(lk, [&] { return m_pending == 0; });
+    }
+    check();
+}
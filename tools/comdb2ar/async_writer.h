@@ -0,0 +1,103 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef INCLUDED_ASYNC_WRITER
+#define INCLUDED_ASYNC_WRITER
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fdostream.h"
+
+class AsyncWriter {
+// Writes extracted files out on a pool of threads, so that reading the
+// archive from stdin doesn't wait on the disk.  Every file is pinned to one
+// thread, which performs its writes in the order they were queued.  The
+// amount of data queued but not yet written is capped; get_buffer() blocks
+// until there is room.
+
+    struct File {
+        std::unique_ptr<fdostream> out;
+        std::string name;
+        size_t worker;
+        bool failed;
+    };
+
+    struct Op {
+        std::shared_ptr<File> file;
+        uint8_t *buf;   // NULL to close the file
+        size_t len;
+        size_t alloc;
+    };
+
+    struct Worker {
+        std::deque<Op> ops;
+        size_t queued;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker> > m_workers;
+    std::vector<std::shared_ptr<File> > m_files;
+    std::mutex m_lock;
+    std::condition_variable m_cond;
+    size_t m_pending;
+    size_t m_buffered;
+    size_t m_max_buffered;
+    size_t m_write_size;
+    bool m_stop;
+    std::string m_error;
+
+    void run(Worker *w);
+    void enqueue(const Op& op);
+
+public:
+    AsyncWriter(unsigned nthreads, size_t max_buffered, size_t write_size);
+    ~AsyncWriter();
+
+    int open(std::unique_ptr<fdostream> out, const std::string& name);
+    // Hand over an opened output file.  Returns a handle for write() and
+    // close().
+
+    uint8_t *get_buffer(size_t size);
+    // Allocate a 512 byte aligned buffer, waiting for queued writes to drain
+    // if needed.  Ownership passes back to the writer on write().
+
+    void put_buffer(uint8_t *buf, size_t size);
+    // Free a buffer from get_buffer(size) that won't be written.
+
+    void write(int handle, uint8_t *buf, size_t len);
+    // Queue buf, which must have come from get_buffer(len), to be appended
+    // to the file.
+
+    void close(int handle);
+    // Queue the close of the file once its writes are done.
+
+    void check();
+    // Throw an Error if any write has failed so far.
+
+    void finish();
+    // Wait for everything queued to be written and closed, then check().
+};
+
+#endif // INCLUDED_ASYNC_WRITER
@@ -62,6 +62,9 @@ const char *help_text[] = {
 "  -D           turn off directio",
 "  -E dbname    create replicant with dbname",
 "  -T type      override physrep type",
+"  -j threads   read (serialise) or write (deserialise) this many files",
+"               in parallel; the archive format is unchanged",
+"  -J bytes     cap the data buffered by -j (default 4 buffers per thread)",
 NULL
 };
 
@@ -112,6 +115,8 @@ int main(int argc, char *argv[])
     bool incr_path_specified = false;
     bool dryrun = false;
     bool copy_physical = false;
+    unsigned parallel = 1;
+    size_t max_buffered = 0;
 
     std::string new_db_name = "";
     std::string new_type = "default";
@@ -128,7 +133,7 @@ int main(int argc, char *argv[])
     ss << root << "/bin/comdb2";
     std::string comdb2_task(ss.str());
 
-    while((c = getopt(argc, argv, "hsSLC:I:b:x:u:rRSkKfODE:T:A")) != EOF) {
+    while((c = getopt(argc, argv, "hsSLC:I:b:x:u:rRSkKfODE:T:Aj:J:")) != EOF) {
         switch(c) {
             case 'O':
                 legacy_mode = true;
@@ -235,6 +240,14 @@ int main(int argc, char *argv[])
                 new_type = std::string(optarg);
                 break;
 
+            case 'j':
+                parallel = std::atoi(optarg) > 1 ? std::atoi(optarg) : 1;
+                break;
+
+            case 'J':
+                max_buffered = std::strtoull(optarg, NULL, 10);
+                break;
+
             case '?':
                 std::cerr << "Unrecognised option: -" << (char)c << std::endl;
                 usage();
@@ -313,7 +326,9 @@ int main(int argc, char *argv[])
                 incr_gen,
                 copy_physical,
                 add_latency,
-                incr_path
+                incr_path,
+                parallel,
+                max_buffered
             );
         } catch(std::exception& e) {
             std::cerr << e.what() << std::endl;
@@ -354,7 +369,9 @@ int main(int argc, char *argv[])
              is_disk_full,
              run_with_done_file,
              incr_ex,
-             dryrun
+             dryrun,
+             parallel,
+             max_buffered
            );
         } catch(std::exception& e) {
             std::cerr << e.what() << std::endl;
@@ -111,13 +111,18 @@ void serialise_database(
   bool incr_gen,
   bool copy_physical,
   bool add_latency,
-  const std::string& incr_path
+  const std::string& incr_path,
+  unsigned parallel,
+  size_t max_buffered
 );
 // Serialise a database into tape archive format and write it to stdout.
 // If support_only is true then only support files (lrl and schema) will
 // be serialised.  If disable_log_deletion and the database is running then
 // it will be advised to hold log file deletion until the backup is complete
 // (highly recommended!)
+// If parallel is greater than one, data files are read ahead on that many
+// threads, holding at most max_buffered bytes (0 for 4 buffers per thread);
+// the archive produced is the same.
 // If legacy_mode is enabled, old file format are not removed after restore
 
 
@@ -134,7 +139,9 @@ void deserialise_database(
   bool& is_disk_full,
   bool run_with_done_file,
   bool incr_mode,
-  bool dryrun
+  bool dryrun,
+  unsigned parallel,
+  size_t max_buffered
 );
 // Deserialise a database from serialised form received on stdin.
 // If lrldestdir and datadestdir are not NULL then the lrl and data files
@@ -145,7 +152,9 @@ void deserialise_database(
 // true then full recovery is run on the resulting database using the binary
 // given by comdb2_task.  If the destination disk reaches or exceeds the
 // specified percent_full during the deserialisation then the operation is
-// halted.
+// halted.  If parallel is greater than one, data files are written out on
+// that many threads while the next file is read from stdin, with at most
+// max_buffered bytes (0 for 4 buffers per thread) queued.
 
 bool isDirectory(const std::string& file);
 
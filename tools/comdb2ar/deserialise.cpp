@@ -10,6 +10,7 @@
 #include "increment.h"
 #include "util.h"
 #include "ar_wrap.h"
+#include "async_writer.h"
 #include "cdb2_constants.h"
 
 #include <cstdlib>
@@ -370,7 +371,9 @@ void deserialise_database(
         bool& is_disk_full,
         bool run_with_done_file,
         bool incr_mode,
-        bool dryrun
+        bool dryrun,
+        unsigned parallel,
+        size_t max_buffered
 )
 // Deserialise a database from serialised from received on stdin.
 // If lrldestdir and datadestdir are not NULL then the lrl and data files
@@ -443,6 +446,15 @@ void deserialise_database(
        unlink(done_file_string.c_str());
     }
 
+    // With more than one thread, data files are written out in the
+    // background while we carry on reading the archive
+    std::unique_ptr<AsyncWriter> writer;
+    if (parallel > 1) {
+        if (max_buffered == 0)
+            max_buffered = parallel * 4 * MAX_BUF_SIZE;
+        writer.reset(new AsyncWriter(parallel, max_buffered, write_size));
+    }
+
 
     while(true) {
 
@@ -512,6 +524,9 @@ void deserialise_database(
         // Alternativelyh, if we're running in incremental mode, then
         // we know we are moving on the the incremental backups
         if(std::memcmp(head.c, zero_head, 512) == 0) {
+            if(writer) {
+                writer->finish();
+            }
             if(incr_mode){
                 std::clog << "Done with base backup, moving on to increments"
                           << std::endl << std::endl;
@@ -532,6 +547,10 @@ void deserialise_database(
             break;
         }
 
+        if(writer) {
+            writer->check();
+        }
+
         // TODO: verify the block check sum
 
         // Get the file name
@@ -664,6 +683,13 @@ void deserialise_database(
         }
         size_t bufsize = pagesize;
 
+        // Sparse files are written inline as they seek around
+        int async_handle = -1;
+        if(writer && of_ptr && !is_text && !file_is_sparse &&
+           filename != "FLUFF") {
+            async_handle = writer->open(std::move(of_ptr), filename);
+        }
+
         while((bufsize << 1) <= MAX_BUF_SIZE) {
             bufsize <<= 1;
         }
@@ -703,10 +729,17 @@ void deserialise_database(
             if (readbytes > bytesleft)
                 readbytes = bytesleft;
 
-            if(readall(0, &buf[0], readbytes) != readbytes)
+            uint8_t *rbuf = buf;
+            if (async_handle != -1)
+               rbuf = writer->get_buffer(readbytes);
+
+            if(readall(0, &rbuf[0], readbytes) != readbytes)
             {
                std::ostringstream ss;
 
+               if (rbuf != buf)
+                  writer->put_buffer(rbuf, readbytes);
+
                if (filename == "FLUFF")
                   return;
 
@@ -719,7 +752,11 @@ void deserialise_database(
             }
 
 
-            if(is_text)
+            if(async_handle != -1)
+            {
+               writer->write(async_handle, rbuf, readbytes);
+            }
+            else if(is_text)
             {
                text.append((char*) &buf[0], readbytes);
             }
@@ -855,6 +892,10 @@ void deserialise_database(
             }
         }
 
+        if(async_handle != -1) {
+            writer->close(async_handle);
+        }
+
         std::clog << "x " << filename << " size=" << filesize
                   << " pagesize=" << pagesize;
 
@@ -15,13 +15,19 @@
 #include "cdb2_constants.h"
 
 #include <cassert>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
+#include <exception>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 #include <algorithm>
@@ -119,17 +125,47 @@ static void serialise_string(const std::string& filename,
  * that defines this properly */
 void *memalign(size_t boundary, size_t size);
 
-static void serialise_file(FileInfo& file, volatile iomap *iomap=NULL, const std::string altpath="",
-                            const std::string incr_path="", bool incr_create = false)
-// Serialise a single file, in tape archive format, onto stdout.  The input
-// filename is expected to be an absolute path.  The name recorded in the
-// tape archive will be relative to dbdir.  Input files outside of dbdir
-// (usually the lrl) will be recorded in the archive as having come from
-// dbdir.
+static uint8_t *alloc_pagebuf(size_t bufsize)
+{
+    uint8_t *pagebuf = NULL;
+#if ! defined  ( _SUN_SOURCE )
+    if(posix_memalign((void**) &pagebuf, 512, bufsize))
+        throw Error("Failed to allocate output buffer");
+#else
+    pagebuf = (uint8_t*) memalign(512, bufsize);
+    if(pagebuf == NULL)
+        throw Error("Failed to allocate output buffer");
+#endif
+    return pagebuf;
+}
+
+static size_t serialise_pagesize(const FileInfo& file)
+{
+    size_t pagesize = file.get_pagesize();
+    if(pagesize == 0) {
+        pagesize = 4096;
+    }
+    return pagesize;
+}
+
+static size_t serialise_bufsize(size_t pagesize)
+// Read the file a page at a time and copy to the output.
+// Use a large buffer if possible
+{
+    size_t bufsize = pagesize;
+    while((bufsize << 1) <= MAX_BUF_SIZE) {
+        bufsize <<= 1;
+    }
+    return bufsize;
+}
+
+static int open_serialise_file(FileInfo& file, const std::string& altpath,
+                               struct stat& st)
+// Open a file for serialisation and stat it.  Returns the open fd, or -1 if
+// the file has vanished and can be skipped.
 {
     const std::string& filename = file.get_filename();
     int flags;
-    bool skip_iomap = false;
     std::ostringstream ss;
 
     // Ensure large file support
@@ -149,9 +185,12 @@ reopen:
     else {
         fd = open(file.get_filepath().c_str(), flags);
     }
-    RIIA_fd fd_guard(fd);
 
     if(fd == -1) {
+        if (fdalt != -1) {
+            close(fdalt);
+            fdalt = -1;
+        }
         /* If this is a log file, we can't ignore it - we need it to run recovery. */
         if (file.get_type() == FileInfo::LOG_FILE) {
             ss << "missing log file " << filename << std::endl;
@@ -168,15 +207,17 @@ reopen:
              * despite this file being unavailable. */
             std::clog << "Error opening file " << file.get_filepath()
                       <<", err: " << std::strerror(errno) << std::endl;
-            return;
+            return -1;
         }
         else
             throw SerialiseError(filename, ss.str());
     }
+    RIIA_fd fdalt_guard(fdalt);
 
-    struct stat st, stalt;
+    struct stat stalt;
     if(fstat(fd, &st) == -1) {
         ss << "cannot stat file: " << std::strerror(errno);
+        close(fd);
         throw SerialiseError(filename, ss.str());
     }
 
@@ -189,11 +230,16 @@ reopen:
 
     // Ignore special files
     if(!S_ISREG(st.st_mode)) {
+        close(fd);
         throw SerialiseError(filename, "not a regular file");
     }
 
-    // Write the header
-    TarHeader head;
+    return fd;
+}
+
+static void write_file_header(const std::string& filename,
+                              const struct stat& st, TarHeader& head)
+{
     head.set_filename(filename);
     head.set_attrs(st);
     head.set_checksum();
@@ -204,152 +250,122 @@ reopen:
         ss << "error writing tar block header: " << std::strerror(errno);
         throw SerialiseError(filename, ss.str());
     }
+}
 
-    // Read the file a page at a time and copy to the output.
-    // Use a large buffer if possible
-    size_t pagesize = file.get_pagesize();
-    if(pagesize == 0) {
-        pagesize = 4096;
-    }
-    size_t bufsize = pagesize;
-    int num_waits = 0;
-    int64_t filesize = 0;
+static ssize_t read_file_chunk(FileInfo& file, int fd, uint8_t *pagebuf,
+                               size_t nbytes, off_t bytesleft, size_t pagesize,
+                               volatile iomap *iomap, bool& skip_iomap,
+                               int& num_waits, std::ofstream& incrFile,
+                               bool incr_create)
+// Read up to nbytes of the file into pagebuf, verifying page checksums (and
+// rereading torn pages) if the file has them.  Returns the number of bytes
+// read.
+{
+    const std::string& filename = file.get_filename();
+    int now;
 
-    while((bufsize << 1) <= MAX_BUF_SIZE) {
-        bufsize <<= 1;
+    while (!skip_iomap && iomap != NULL && iomap->memptrickle_time) {
+        now = time(NULL);
+        if ((now - iomap->memptrickle_time) > 5*60) {
+            std::clog << "long memptrickle (" << now - iomap->memptrickle_time << " seconds), continuing" << std::endl;
+            skip_iomap = true;
+            break;
+        }
+        num_waits++;
+        poll(0, 0, 100);
     }
-#if 0
-    */
-    std::cerr<<"Computed bufsize="<<bufsize<<" for pagesize="<<pagesize<<" file="<<filename<<"\n";
-
-    std::vector<char> pagebuf(bufsize);
-#endif
-    uint8_t *pagebuf = NULL;
-    off_t bytesleft = st.st_size;
-
-#if ! defined  ( _SUN_SOURCE )
-        if(posix_memalign((void**) &pagebuf, 512, bufsize))
-            throw Error("Failed to allocate output buffer");
-#else
-        pagebuf = (uint8_t*) memalign(512, bufsize);
-#endif
 
-    std::string incrFilename = incr_path + "/" + filename + ".incr";
-    std::ofstream incrFile(incrFilename,
-            std::ofstream::binary |
-            std::ofstream::trunc);
-
-    while(bytesleft > 0) {
-        int now;
-        unsigned long long nbytes = bytesleft > bufsize ? bufsize : bytesleft;
-
-        while (!skip_iomap && iomap != NULL && iomap->memptrickle_time) {
-            now = time(NULL);
-            if ((now - iomap->memptrickle_time) > 5*60) {
-                std::clog << "long memptrickle (" << now - iomap->memptrickle_time << " seconds), continuing" << std::endl;
-                skip_iomap = true;
-                break;
-            }
-            num_waits++;
-            poll(0, 0, 100);
-        }
+    ssize_t bytesread = read(fd, &pagebuf[0], nbytes);
+    if(bytesread <= 0) {
+        std::ostringstream ss;
+        ss << "read error after " << bytesleft << " bytes, tried to read " << nbytes << " bytes "
+            << std::strerror(errno);
+        throw SerialiseError(filename, ss.str());
+    }
 
-        ssize_t bytesread = read(fd, &pagebuf[0], nbytes);
-        if(bytesread <= 0) {
+    if (file.get_checksums()) {
+        // Save current offset
+        const off_t offset = lseek(fd, 0, SEEK_CUR);
+        if (offset == (off_t) -1) {
             std::ostringstream ss;
-            ss << "read error after " << bytesleft << " bytes, tried to read " << nbytes << " bytes "
-                << std::strerror(errno);
+            ss << "serialise_file:lseek:initial: " << std::strerror(errno);
             throw SerialiseError(filename, ss.str());
         }
-        filesize += bytesread;
 
-        if (file.get_checksums()) {
-            // Save current offset
-            const off_t offset = lseek(fd, 0, SEEK_CUR);
-            if (offset == (off_t) -1) {
-                std::ostringstream ss;
-                ss << "serialise_file:lseek:initial: " << std::strerror(errno);
-                throw SerialiseError(filename, ss.str());
-            }
+        int retry = 5;
+        ssize_t n = 0;
 
-            int retry = 5;
-            ssize_t n = 0;
+        while (n < bytesread && retry) {
+            PAGE * pagep = (PAGE *) (pagebuf + n);
+            uint32_t verify_cksum;
 
-            while (n < bytesread && retry) {
-                PAGE * pagep = (PAGE *) (pagebuf + n);
-                uint32_t verify_cksum;
+            if ((verify_checksum(pagebuf + n, pagesize, file.get_crypto(),
+                                 file.get_swapped(), &verify_cksum)) == 1) {
+                // checksum verified
+                n += pagesize;
+                retry = 5;
 
-                if ((verify_checksum(pagebuf + n, pagesize, file.get_crypto(),
-                                     file.get_swapped(), &verify_cksum)) == 1) {
-                    // checksum verified
-                    n += pagesize;
-                    retry = 5;
 
+                // If we are in incremental mode, on initial backup creation we want to create the diff files
+                if(incr_create){
+                    incrFile.write((char *) &(LSN(pagep).file), 4);
+                    incrFile.write((char *) &(LSN(pagep).offset), 4);
+                    incrFile.write((char *) &verify_cksum, 4);
+                }
 
-                    // If we are in incremental mode, on initial backup creation we want to create the diff files
-                    if(incr_create){
-                        incrFile.write((char *) &(LSN(pagep).file), 4);
-                        incrFile.write((char *) &(LSN(pagep).offset), 4);
-                        incrFile.write((char *) &verify_cksum, 4);
-                    }
+                continue;
+            }
 
-                    continue;
-                }
+            // Partial page read. Read the page again to see if it passes
+            // checksum verification.
+            if (--retry == 0) {
+                //giving up on this page
+                std::ostringstream ss;
+                ss << "serialise_file:page failed checksum verification";
+                throw SerialiseError(filename, ss.str());
+            }
 
-                // Partial page read. Read the page again to see if it passes
-                // checksum verification.
-                if (--retry == 0) {
-                    //giving up on this page
-                    std::ostringstream ss;
-                    ss << "serialise_file:page failed checksum verification";
-                    throw SerialiseError(filename, ss.str());
-                }
+            // wait 500ms before reading page again
+            poll(0, 0, 500);
 
-                // wait 500ms before reading page again
-                poll(0, 0, 500);
+            // rewind and read the page again
+            off_t rewind = offset - (bytesread - n);
+            rewind = lseek(fd, rewind, SEEK_SET);
+            if (rewind == (off_t) -1) {
+                std::ostringstream ss;
+                ss << "serialise_file:lseek:rewind: " << std::strerror(errno);
+                throw SerialiseError(filename, ss.str());
+            }
 
-                // rewind and read the page again
-                off_t rewind = offset - (bytesread - n);
-                rewind = lseek(fd, rewind, SEEK_SET);
-                if (rewind == (off_t) -1) {
+            ssize_t nread, totalread = 0;
+            while (totalread < pagesize) {
+                nread = read(fd, &pagebuf[0] + n + totalread,
+                             pagesize - totalread);
+                if (nread <= 0) {
                     std::ostringstream ss;
-                    ss << "serialise_file:lseek:rewind: " << std::strerror(errno);
+                    ss << "serialise_file:read: " << std::strerror(errno);
                     throw SerialiseError(filename, ss.str());
                 }
-
-                ssize_t nread, totalread = 0;
-                while (totalread < pagesize) {
-                    nread = read(fd, &pagebuf[0] + n + totalread,
-                                 pagesize - totalread);
-                    if (nread <= 0) {
-                        std::ostringstream ss;
-                        ss << "serialise_file:read: " << std::strerror(errno);
-                        throw SerialiseError(filename, ss.str());
-                    }
-                    totalread += nread;
-                }
-            }
-
-            // Restore to original offset
-            if (offset != lseek(fd, offset, SEEK_SET)) {
-                std::ostringstream ss;
-                ss << "serialise_file:lseek:reset: " << std::strerror(errno);
-                throw SerialiseError(filename, ss.str());
+                totalread += nread;
             }
         }
 
-        ssize_t byteswritten = writeall(1, &pagebuf[0], bytesread);
-        if(byteswritten != bytesread) {
+        // Restore to original offset
+        if (offset != lseek(fd, offset, SEEK_SET)) {
             std::ostringstream ss;
-            ss << "write error after " << bytesleft << "bytes: "
-                << std::strerror(errno);
+            ss << "serialise_file:lseek:reset: " << std::strerror(errno);
             throw SerialiseError(filename, ss.str());
         }
-
-        bytesleft -= bytesread;
     }
 
-    file.set_filesize(filesize);
+    return bytesread;
+}
+
+static void finish_file(const FileInfo& file, const struct stat& st,
+                        size_t pagesize, const TarHeader& head,
+                        off_t bytesleft, int num_waits)
+{
+    const std::string& filename = file.get_filename();
 
     if (num_waits)
         std::clog <<  "paused " << num_waits << " times because db is busy writing." << std::endl;
@@ -380,8 +396,374 @@ reopen:
 
 
     std::clog << std::endl;
-    if (pagebuf)
-        free(pagebuf);
+}
+
+static void serialise_file(FileInfo& file, volatile iomap *iomap=NULL, const std::string altpath="",
+                            const std::string incr_path="", bool incr_create = false)
+// Serialise a single file, in tape archive format, onto stdout.  The input
+// filename is expected to be an absolute path.  The name recorded in the
+// tape archive will be relative to dbdir.  Input files outside of dbdir
+// (usually the lrl) will be recorded in the archive as having come from
+// dbdir.
+{
+    const std::string& filename = file.get_filename();
+    bool skip_iomap = false;
+    struct stat st;
+
+    int fd = open_serialise_file(file, altpath, st);
+    if(fd == -1) {
+        return;
+    }
+    RIIA_fd fd_guard(fd);
+
+    // Write the header
+    TarHeader head;
+    write_file_header(filename, st, head);
+
+    size_t pagesize = serialise_pagesize(file);
+    size_t bufsize = serialise_bufsize(pagesize);
+    int num_waits = 0;
+    int64_t filesize = 0;
+
+    uint8_t *pagebuf = alloc_pagebuf(bufsize);
+    RIIA_malloc free_guard(pagebuf);
+    off_t bytesleft = st.st_size;
+
+    std::string incrFilename = incr_path + "/" + filename + ".incr";
+    std::ofstream incrFile(incrFilename,
+            std::ofstream::binary |
+            std::ofstream::trunc);
+
+    while(bytesleft > 0) {
+        unsigned long long nbytes = bytesleft > bufsize ? bufsize : bytesleft;
+
+        ssize_t bytesread = read_file_chunk(file, fd, pagebuf, nbytes,
+                                            bytesleft, pagesize, iomap,
+                                            skip_iomap, num_waits, incrFile,
+                                            incr_create);
+        filesize += bytesread;
+
+        ssize_t byteswritten = writeall(1, &pagebuf[0], bytesread);
+        if(byteswritten != bytesread) {
+            std::ostringstream ss;
+            ss << "write error after " << bytesleft << "bytes: "
+                << std::strerror(errno);
+            throw SerialiseError(filename, ss.str());
+        }
+
+        bytesleft -= bytesread;
+    }
+
+    file.set_filesize(filesize);
+
+    finish_file(file, st, pagesize, head, bytesleft, num_waits);
+}
+
+class FilePrefetcher {
+// Reads data files ahead of the archive on a pool of threads.  Each thread
+// opens the next file in archive order and reads (and checksum verifies) it
+// into a queue of buffers; the caller then writes the files out strictly in
+// order, so the tar stream is identical to what serialise_file() produces.
+// Buffered data is capped; the file currently being written may read past
+// the cap when the writer is waiting on it, so the pipeline can't wedge
+// behind files further ahead.
+
+    struct Chunk {
+        uint8_t *buf;
+        size_t len;
+        size_t alloc;
+    };
+
+    struct Slot {
+        FileInfo *file;
+        bool opened;
+        bool missing;
+        bool done;
+        std::exception_ptr err;
+        struct stat st;
+        size_t pagesize;
+        int num_waits;
+        int64_t filesize;
+        std::deque<Chunk> chunks;
+
+        Slot(FileInfo *f) : file(f), opened(false), missing(false),
+                            done(false), pagesize(0), num_waits(0),
+                            filesize(0) {}
+    };
+
+    std::vector<Slot> m_slots;
+    std::vector<std::thread> m_threads;
+    std::mutex m_lock;
+    std::condition_variable m_cond;
+    size_t m_next;
+    size_t m_consume;
+    size_t m_buffered;
+    size_t m_max_buffered;
+    bool m_stop;
+
+    volatile iomap *m_iomap;
+    const std::string m_incr_path;
+    bool m_incr_create;
+
+    uint8_t *get_buffer(size_t idx, size_t bufsize);
+    void put_buffer(const Chunk& c);
+    void read_file(size_t idx);
+    void worker();
+
+public:
+    FilePrefetcher(const std::vector<FileInfo*>& files, unsigned nthreads,
+                   size_t max_buffered, volatile iomap *iomap,
+                   const std::string& incr_path, bool incr_create);
+    ~FilePrefetcher();
+
+    void serialise(size_t idx);
+    // Write file idx to stdout.  Must be called for each file in order.
+};
+
+FilePrefetcher::FilePrefetcher(const std::vector<FileInfo*>& files,
+                               unsigned nthreads, size_t max_buffered,
+                               volatile iomap *iomap,
+                               const std::string& incr_path,
+                               bool incr_create)
+    : m_next(0), m_consume(0), m_buffered(0),
+      m_max_buffered(max_buffered ? max_buffered
+                                  : nthreads * 4 * MAX_BUF_SIZE),
+      m_stop(false),
+      m_iomap(iomap), m_incr_path(incr_path), m_incr_create(incr_create)
+{
+    m_slots.reserve(files.size());
+    for (size_t i = 0; i < files.size(); i++) {
+        m_slots.push_back(Slot(files[i]));
+    }
+    for (unsigned i = 0; i < nthreads && i < files.size(); i++) {
+        m_threads.push_back(std::thread(&FilePrefetcher::worker, this));
+    }
+}
+
+FilePrefetcher::~FilePrefetcher()
+{
+    {
+        std::lock_guard<std::mutex> lk(m_lock);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    for (size_t i = 0; i < m_threads.size(); i++) {
+        m_threads[i].join();
+    }
+    for (size_t i = 0; i < m_slots.size(); i++) {
+        for (size_t j = 0; j < m_slots[i].chunks.size(); j++) {
+            free(m_slots[i].chunks[j].buf);
+        }
+    }
+}
+
+uint8_t *FilePrefetcher::get_buffer(size_t idx, size_t bufsize)
+// Reserve bufsize bytes of the read-ahead budget and allocate a buffer.
+// The file being written may go over budget only while the writer has
+// nothing of it queued, so it overshoots by at most one buffer.
+// Returns NULL if the prefetcher is shutting down.
+{
+    {
+        std::unique_lock<std::mutex> lk(m_lock);
+        const Slot& s = m_slots[idx];
+        m_cond.wait(lk, [&] {
+            return m_stop || (idx == m_consume && s.chunks.empty()) ||
+                   m_buffered + bufsize <= m_max_buffered;
+        });
+        if (m_stop) {
+            return NULL;
+        }
+        m_buffered += bufsize;
+    }
+    try {
+        return alloc_pagebuf(bufsize);
+    } catch (...) {
+        put_buffer(Chunk{NULL, 0, bufsize});
+        throw;
+    }
+}
+
+void FilePrefetcher::put_buffer(const Chunk& c)
+{
+    free(c.buf);
+    {
+        std::lock_guard<std::mutex> lk(m_lock);
+        m_buffered -= c.alloc;
+    }
+    m_cond.notify_all();
+}
+
+void FilePrefetcher::read_file(size_t idx)
+{
+    Slot& s = m_slots[idx];
+    FileInfo& file = *s.file;
+    struct stat st;
+
+    int fd = open_serialise_file(file, "", st);
+    if (fd == -1) {
+        std::lock_guard<std::mutex> lk(m_lock);
+        s.missing = true;
+        s.done = true;
+        m_cond.notify_all();
+        return;
+    }
+    RIIA_fd fd_guard(fd);
+
+    size_t pagesize = serialise_pagesize(file);
+    size_t bufsize = serialise_bufsize(pagesize);
+    {
+        std::lock_guard<std::mutex> lk(m_lock);
+        s.st = st;
+        s.pagesize = pagesize;
+        s.opened = true;
+        m_cond.notify_all();
+    }
+
+    std::string incrFilename = m_incr_path + "/" + file.get_filename() + ".incr";
+    std::ofstream incrFile(incrFilename,
+            std::ofstream::binary |
+            std::ofstream::trunc);
+
+    bool skip_iomap = false;
+    int num_waits = 0;
+    int64_t filesize = 0;
+    off_t bytesleft = st.st_size;
+
+    while (bytesleft > 0) {
+        size_t nbytes = bytesleft > bufsize ? bufsize : bytesleft;
+        uint8_t *buf = get_buffer(idx, bufsize);
+        if (buf == NULL) {
+            return;
+        }
+        Chunk c{buf, 0, bufsize};
+        try {
+            c.len = read_file_chunk(file, fd, buf, nbytes, bytesleft, pagesize,
+                                    m_iomap, skip_iomap, num_waits, incrFile,
+                                    m_incr_create);
+        } catch (...) {
+            put_buffer(c);
+            throw;
+        }
+        {
+            std::lock_guard<std::mutex> lk(m_lock);
+            s.chunks.push_back(c);
+        }
+        m_cond.notify_all();
+        bytesleft -= c.len;
+        filesize += c.len;
+    }
+
+    std::lock_guard<std::mutex> lk(m_lock);
+    s.num_waits = num_waits;
+    s.filesize = filesize;
+    s.done = true;
+    m_cond.notify_all();
+}
+
+void FilePrefetcher::worker()
+{
+    while (true) {
+        size_t idx;
+        {
+            std::lock_guard<std::mutex> lk(m_lock);
+            if (m_stop || m_next >= m_slots.size()) {
+                return;
+            }
+            idx = m_next++;
+        }
+        try {
+            read_file(idx);
+        } catch (...) {
+            std::lock_guard<std::mutex> lk(m_lock);
+            m_slots[idx].err = std::current_exception();
+            m_slots[idx].done = true;
+            m_cond.notify_all();
+        }
+    }
+}
+
+void FilePrefetcher::serialise(size_t idx)
+{
+    Slot& s = m_slots[idx];
+    const std::string& filename = s.file->get_filename();
+    struct stat st;
+
+    {
+        std::unique_lock<std::mutex> lk(m_lock);
+        m_consume = idx;
+        m_cond.notify_all();
+        m_cond.wait(lk, [&] { return s.opened || s.done; });
+        if (!s.opened) {
+            if (s.err) {
+                std::rethrow_exception(s.err);
+            }
+            return;
+        }
+        st = s.st;
+    }
+
+    TarHeader head;
+    write_file_header(filename, st, head);
+
+    off_t bytesleft = st.st_size;
+    while (true) {
+        Chunk c;
+        {
+            std::unique_lock<std::mutex> lk(m_lock);
+            m_cond.wait(lk, [&] { return !s.chunks.empty() || s.done; });
+            if (s.chunks.empty()) {
+                if (s.err) {
+                    std::rethrow_exception(s.err);
+                }
+                break;
+            }
+            c = s.chunks.front();
+            s.chunks.pop_front();
+        }
+
+        ssize_t byteswritten = writeall(1, c.buf, c.len);
+        put_buffer(c);
+        if(byteswritten != c.len) {
+            std::ostringstream ss;
+            ss << "write error after " << bytesleft << "bytes: "
+                << std::strerror(errno);
+            throw SerialiseError(filename, ss.str());
+        }
+        bytesleft -= c.len;
+    }
+
+    s.file->set_filesize(s.filesize);
+
+    finish_file(*s.file, st, s.pagesize, head, bytesleft, s.num_waits);
+}
+
+static void serialise_data_files(const std::vector<FileInfo*>& files,
+                                 unsigned parallel, size_t max_buffered,
+                                 volatile iomap *iomap,
+                                 const std::string& incr_path,
+                                 bool incr_create, bool add_latency,
+                                 const std::function<void()>& archive_logs)
+// Serialise the data files in order, calling archive_logs before each one.
+// With parallel > 1 the files are read ahead on that many threads.
+{
+    std::unique_ptr<FilePrefetcher> prefetch;
+    if (parallel > 1) {
+        prefetch.reset(new FilePrefetcher(files, parallel, max_buffered, iomap,
+                                          incr_path, incr_create));
+    }
+
+    for (size_t i = 0; i < files.size(); i++) {
+        archive_logs();
+
+        if (prefetch) {
+            prefetch->serialise(i);
+        } else {
+            serialise_file(*files[i], iomap, "", incr_path, incr_create);
+        }
+        if (add_latency) {
+            sleep(1);
+        }
+    }
 }
 
 std::string replace_dbname(const std::string& replaceWith, const std::string& dbname, 
@@ -761,7 +1143,9 @@ void serialise_database(
   bool incr_gen,
   bool copy_physical,
   bool add_latency,
-  const std::string& incr_path
+  const std::string& incr_path,
+  unsigned parallel,
+  size_t max_buffered
 )
 // Serialise a database into tape archive format and write it to stdout.
 // If support_only is true then only support files (lrl and schema) will
@@ -1358,25 +1742,25 @@ void serialise_database(
         if(!support_files_only) {
 
             long long log_number(lowest_log);
+            std::vector<FileInfo*> files;
             for(std::list<FileInfo>::iterator
                     it = data_files.begin();
                     it != data_files.end();
                     ++it) {
+                files.push_back(&*it);
+            }
 
-                // First, serialise any complete log files that are in the .txn
-                // directory and notify the running database that they can now be
-                // archived.
+            // Before each file, serialise any complete log files that are in
+            // the .txn directory and notify the running database that they
+            // can now be archived.
+            serialise_data_files(files, parallel, max_buffered, iom,
+                                 incr_path, incr_create, add_latency, [&] {
                 long long old_log_number(log_number);
                 serialise_log_files(dbtxndir, dbdir, log_number, true);
                 if(log_number != old_log_number && log_holder.get()) {
                     log_holder->release_log(log_number - 1);
                 }
-
-                serialise_file(*it, iom, "", incr_path, incr_create);
-                if (add_latency) {
-                    sleep(1);
-                }
-            }
+            });
 
             // Serialise all remaining log files, including incomplete ones
             serialise_log_files(dbtxndir, dbdir, log_number, false);
@@ -1458,26 +1842,24 @@ void serialise_database(
         }
 
         // Serialise new files
+        std::vector<FileInfo*> files;
         for(std::vector<FileInfo>::iterator new_it = new_files.begin();
                 new_it != new_files.end();
-                *new_it++
-        ) {
+                ++new_it) {
+            files.push_back(&*new_it);
+        }
 
-            // First, serialise any complete log files that are in the .txn
-            // directory and notify the running database that they can now be
-            // archived.
+        // Before each file, serialise any complete log files that are in the
+        // .txn directory and notify the running database that they can now be
+        // archived.
+        serialise_data_files(files, parallel, max_buffered, iom, incr_path,
+                             true, add_latency, [&] {
             long long old_log_number(log_number);
             serialise_log_files(dbtxndir, dbdir, log_number, true);
             if(log_number != old_log_number && log_holder.get()) {
                 log_holder->release_log(log_number - 1);
             }
-
-            // Ok, now serialise this file.
-            serialise_file(*new_it, iom, "", incr_path, true);
-            if (add_latency) {
-                sleep(1);
-            }
-        }
+        });
 
 
         // Serialise all remaining log files, including incomplete ones
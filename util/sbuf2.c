@@ -113,6 +113,20 @@ int SBUF2_FUNC(sbuf2fileno)(SBUF2 *sb)
     return sb->fd;
 }
 
+int SBUF2_FUNC(sbuf2pending)(SBUF2 *sb)
+{
+    int n;
+    if (sb == NULL)
+        return -1;
+    n = sb->rhd - sb->rtl;
+#if SBUF2_UNGETC
+    n += sb->ungetc_buf_len;
+#endif
+    if (sb->ssl)
+        n += SSL_pending(sb->ssl);
+    return n;
+}
+
 /*just free SBUF2.  don't flush or close fd*/
 int SBUF2_FUNC(sbuf2free)(SBUF2 *sb)
 {